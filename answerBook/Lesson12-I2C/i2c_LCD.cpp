@@ -11,6 +11,9 @@
 #include <Arduino.h>
 #include <Wire.h>
 #include <LiquidCrystal_I2C.h>
+#include <BootSerial.h> // Output that never waits for a host, see lib/BootSerial.
+
+BootSerial console(Serial); // Use instead of Serial, it never blocks.
 
 // Create LCD object for 16x2 display at I2C address 0x3F
 LiquidCrystal_I2C lcd(0x3F, 16, 2);
@@ -27,14 +30,9 @@ void setup()
   Wire.begin(23, 22); 
 
   // Start serial communication at 115200 baud
-  Serial.begin(115200);
+  console.begin(115200);
  
-  // Wait for Serial Monitor to open (not always needed, but good for USB serial)
-  while (!Serial) 
-  {
-    delay(10); // Wait for Serial to be ready
-  } //while()
-  Serial.println("\nI2C Scanner ready");
+  console.println("\nI2C Scanner ready");
 
   // Initialize the LCD
   lcd.init();
@@ -42,6 +40,7 @@ void setup()
   lcd.clear();
   lcd.setCursor(0, 0); // First column, first row
   lcd.print("Hello, World!");
+  console.mark("LCD showing text");
 } // setup()
 
 /**
@@ -49,4 +48,5 @@ void setup()
  */
 void loop() 
 {
+  console.poll(); // Send output that is waiting for the port.
 } // loop()
@@ -0,0 +1,104 @@
+// Fast status display on an I2C 16x2 LCD diplay
+//
+// Same LCD as i2c_LCD.cpp (PCF8574 backpack at address 0x3F) but driven by
+// BufferedLcd (lib/BufferedLcd) instead of LiquidCrystal_I2C. The program
+// keeps a status screen up to date 10 times a second. BufferedLcd only sends
+// the characters that changed, packed into one I2C transfer, so most
+// refreshes send a handful of bytes or nothing at all.
+//
+// Every 2 seconds the Serial Monitor shows how many I2C transactions and bytes
+// the display used and how long refresh() took.
+//
+// Wiring for HUZZAH32 Feather:
+//   SDA: GPIO23 (physical pin 17, labeled "SDA" on the board)
+//   SCL: GPIO22 (physical pin 18, labeled "SCL" on the board)
+//
+// Connect your I2C device's SDA and SCL lines to these pins.
+//
+// Open the Serial Monitor at 115200 baud to view the results.
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <BufferedLcd.h>
+#include <BootSerial.h> // Output that never waits for a host, see lib/BootSerial.
+
+BootSerial console(Serial); // Use instead of Serial, it never blocks.
+
+#define REFRESH_PERIOD_MS 100 // 10 screen updates a second
+#define REPORT_PERIOD_MS 2000 // Bus usage report
+
+// Create LCD object for 16x2 display at I2C address 0x3F
+BufferedLcd lcd(0x3F, 16, 2);
+
+/**
+ * @brief STandrad Arduino setup funciotn that runs at the start of the program.
+ */
+void setup()
+{
+  // Initialize I2C bus on the correct pins for HUZZAH32 Feather
+  // Wire.begin(SDA, SCL, frequency):
+  //   SDA = GPIO23
+  //   SCL = GPIO22
+  //   100 kHz, the most the PCF8574 LCD backpack is rated for.
+  Wire.begin(23, 22, 100000);
+
+  // Start serial communication at 115200 baud
+  console.begin(115200);
+
+  console.println("\nBuffered LCD ready");
+
+  // Initialize the LCD and draw the parts of the screen that never change.
+  lcd.begin();
+  lcd.setCursor(0, 0); // First column, first row
+  lcd.print("Uptime:");
+  lcd.setCursor(0, 1); // First column, second row
+  lcd.print("Loops:");
+  lcd.refresh();
+  console.mark("LCD showing text");
+} // setup()
+
+/**
+ * @brief Standard Arduino main routine.
+ */
+void loop()
+{
+  console.poll(); // Send output that is waiting for the port.
+  static unsigned long lastRefresh = 0;
+  static unsigned long lastReport = 0;
+  static unsigned long loops = 0;
+  static unsigned long refreshUs = 0;
+  static unsigned long refreshes = 0;
+  unsigned long now = millis();
+  loops++;
+
+  if (now - lastRefresh >= REFRESH_PERIOD_MS)
+  {
+    lastRefresh = now;
+
+    // Only the numbers change, the labels drawn in setup() are never resent.
+    lcd.setCursor(8, 0);
+    lcd.print(now / 1000.0, 1);
+    lcd.print("s");
+    lcd.setCursor(7, 1);
+    lcd.print(loops);
+
+    unsigned long start = micros();
+    lcd.refresh();
+    refreshUs += micros() - start;
+    refreshes++;
+  } // if
+
+  if (now - lastReport >= REPORT_PERIOD_MS)
+  {
+    lastReport = now;
+    console.print("<loop> LCD transactions: ");
+    console.print(lcd.transactions());
+    console.print(", bytes: ");
+    console.print(lcd.bytesSent());
+    console.print(", average refresh(): ");
+    console.print(refreshes ? refreshUs / refreshes : 0);
+    console.println(" us");
+    refreshUs = 0;
+    refreshes = 0;
+  } // if
+} // loop()
@@ -13,6 +13,9 @@
 #include <Arduino.h>
 #include <Wire.h>
 #include <LiquidCrystal_I2C.h>
+#include <BootSerial.h> // Output that never waits for a host, see lib/BootSerial.
+
+BootSerial console(Serial); // Use instead of Serial, it never blocks.
 
 // Create LCD object for 16x2 display at I2C address 0x3F
 LiquidCrystal_I2C lcd(0x3F, 16, 2);
@@ -29,14 +32,7 @@ void setup()
   Wire.begin(23, 22); 
 
   // Start serial communication at 115200 baud
-  Serial.begin(115200);
- 
-  // Wait for Serial Monitor to open (not always needed, but good for USB serial)
-  while (!Serial) 
-  {
-    delay(10); // Wait for Serial to be ready
-  } //while()
-
+  console.begin(115200);
 } // setup()
 
 /**
@@ -47,10 +43,11 @@ void setup()
  */
 void loop() 
 {
+  console.poll(); // Send output that is waiting for the port.
   byte error, address;
   int nDevices = 0;
 
-  Serial.println("Scanning I2C bus...");
+  console.println("Scanning I2C bus...");
 
   // I2C addresses range from 1 to 126 (0 and 127 are reserved)
   for (address = 1; address < 127; address++) 
@@ -61,34 +58,34 @@ void loop()
     if (error == 0) 
     {
       // Device responded at this address
-      Serial.print("I2C device found at address 0x");
+      console.print("I2C device found at address 0x");
       if (address < 16)
       {
-        Serial.print("0"); // Print leading zero for single-digit hex
+        console.print("0"); // Print leading zero for single-digit hex
       } // if
-      Serial.print(address, HEX);
-      Serial.println(" !");
+      console.print(address, HEX);
+      console.println(" !");
       nDevices++;
     } // if
     else if (error == 4) 
     {
       // Unknown error occurred
-      Serial.print("Unknown error at address 0x");
+      console.print("Unknown error at address 0x");
       if (address < 16)
       {
-        Serial.print("0");
+        console.print("0");
       } // if
-      Serial.println(address, HEX);
+      console.println(address, HEX);
     } // else if
   } // for
 
   if (nDevices == 0)
   {
-    Serial.println("No I2C devices found\n");
+    console.println("No I2C devices found\n");
   } // if
   else
   {
-    Serial.println("done\n");
+    console.println("done\n");
   } // else
 
   // Wait 5 seconds before scanning again
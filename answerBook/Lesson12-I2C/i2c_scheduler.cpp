@@ -0,0 +1,184 @@
+// Share one I2C bus between a PCA9685 servo driver and a 16x2 LCD without
+// either one waiting for the other.
+//
+// Both devices are set up in setup(). After that every bus access goes
+// through the I2cScheduler (lib/I2cScheduler):
+//   - Servo frames are queued in the SERVO class at 50 Hz.
+//   - LCD text is drawn with BufferedLcd (lib/BufferedLcd) 4 times a second.
+//     Its bursts of changed characters are queued in the DISPLAY class.
+// The scheduler always runs queued servo frames before queued LCD text and,
+// on the ESP32, loop() never waits for the bus (see lib/I2cScheduler for the
+// UNO R4). Every 2 seconds the sketch prints the bus
+// utilization and the latency of each class.
+//
+// Wiring for HUZZAH32 Feather:
+//   SDA: GPIO23 (physical pin 17, labeled "SDA" on the board)
+//   SCL: GPIO22 (physical pin 18, labeled "SCL" on the board)
+//
+// Connect your I2C device's SDA and SCL lines to these pins.
+//
+// Open the Serial Monitor at 115200 baud to view the results.
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <BufferedLcd.h>
+#include <Adafruit_PWMServoDriver.h>
+#include <I2cScheduler.h>
+#include <BootSerial.h> // Output that never waits for a host, see lib/BootSerial.
+
+BootSerial console(Serial); // Use instead of Serial, it never blocks.
+
+#define LCD_ADDRESS 0x3F     // PCF8574A LCD backpack
+#define PCA9685_ADDRESS 0x40 // PCA9685 default address
+#define SERVO_CHANNELS 4     // Channels updated in every servo frame
+#define SERVOMIN 80          // Minimum pulse length count (out of 4096)
+#define SERVOMAX 600         // Maximum pulse length count (out of 4096)
+
+#define SERVO_PERIOD_MS 20    // 50 Hz servo frames
+#define DISPLAY_PERIOD_MS 250 // 4 LCD updates a second
+#define STATS_PERIOD_MS 2000  // Statistics report
+
+// PCA9685 register of channel 0 ON_L. Each channel uses 4 registers.
+#define PCA9685_LED0_ON_L 0x06
+
+BufferedLcd lcd(LCD_ADDRESS, 16, 2);
+Adafruit_PWMServoDriver pca9685 = Adafruit_PWMServoDriver(PCA9685_ADDRESS);
+I2cScheduler i2c(Wire);
+
+int servoDegrees = 0; // Position sent in the next servo frame.
+int servoStep = 2;    // Degrees moved every frame.
+
+// Forward function declarations (not reqiured for Arduino IDE) but is required
+// for PlatformIO IDE.
+void queueServoFrame();
+void queueDisplayLine();
+bool queueLcdBurst(uint8_t address, const uint8_t *data, uint8_t length,
+                   void *context);
+void onServoDone(const I2cTransaction &txn, void *context);
+
+/**
+ * @brief STandrad Arduino setup funciotn that runs at the start of the program.
+ */
+void setup()
+{
+  // Initialize I2C bus on the correct pins for HUZZAH32 Feather
+  // Wire.begin(SDA, SCL, frequency)
+  // 100 kHz for the PCF8574 LCD backpack, which is not rated for more. A
+  // 4 channel servo frame still takes under 2 ms of the 20 ms between frames.
+  Wire.begin(23, 22, 100000);
+
+  // Start serial communication at 115200 baud
+  console.begin(115200);
+  console.println("\nI2C scheduler demo ready");
+
+  // One time device set up, these calls wait for the bus.
+  lcd.begin();
+  lcd.print("Servo angle:");
+  lcd.refresh();
+  console.mark("LCD showing text");
+  pca9685.begin();
+  pca9685.setPWMFreq(50); // Also turns on register auto-increment.
+
+  // From here on the scheduler owns the bus.
+  i2c.begin();
+  lcd.setWriter(queueLcdBurst, &i2c);
+} // setup()
+
+/**
+ * @brief Standard Arduino main routine. Never waits for the bus.
+ */
+void loop()
+{
+  console.poll(); // Send output that is waiting for the port.
+  static unsigned long lastServo = 0;
+  static unsigned long lastDisplay = 0;
+  static unsigned long lastStats = 0;
+  unsigned long now = millis();
+
+  if (now - lastServo >= SERVO_PERIOD_MS)
+  {
+    lastServo = now;
+    queueServoFrame();
+  } // if
+
+  if (now - lastDisplay >= DISPLAY_PERIOD_MS)
+  {
+    lastDisplay = now;
+    queueDisplayLine();
+  } // if
+
+  i2c.poll();     // Runs one transaction on boards without a worker task.
+  i2c.dispatch(); // Completion callbacks run here, in loop() context.
+
+  if (now - lastStats >= STATS_PERIOD_MS)
+  {
+    lastStats = now;
+    i2c.printStats(console);
+  } // if
+} // loop()
+
+/**
+ * @brief Queue one frame that moves every servo channel.
+ *
+ * @details With auto-increment on, all channels are written in a single
+ * transaction: start register, then ON_L, ON_H, OFF_L, OFF_H per channel.
+ */
+void queueServoFrame()
+{
+  servoDegrees += servoStep;
+  if (servoDegrees >= 180 || servoDegrees <= 0)
+  {
+    servoStep = -servoStep;
+  } // if
+  uint16_t pulse = map(servoDegrees, 0, 180, SERVOMIN, SERVOMAX);
+
+  uint8_t frame[1 + 4 * SERVO_CHANNELS];
+  frame[0] = PCA9685_LED0_ON_L;
+  for (uint8_t ch = 0; ch < SERVO_CHANNELS; ch++)
+  {
+    frame[1 + 4 * ch] = 0;             // ON_L
+    frame[2 + 4 * ch] = 0;             // ON_H
+    frame[3 + 4 * ch] = pulse & 0xFF;  // OFF_L
+    frame[4 + 4 * ch] = pulse >> 8;    // OFF_H
+  } // for
+  i2c.write(PCA9685_ADDRESS, I2C_PRIORITY_SERVO, frame, sizeof(frame),
+            onServoDone, nullptr);
+} // queueServoFrame()
+
+/**
+ * @brief Put the servo angle on the second LCD line.
+ *
+ * @details BufferedLcd only sends the digits that changed since the last
+ * refresh, as one burst that queueLcdBurst() hands to the scheduler.
+ */
+void queueDisplayLine()
+{
+  char text[8];
+  snprintf(text, sizeof(text), "%3d deg", servoDegrees);
+  lcd.setCursor(0, 1);
+  lcd.print(text);
+  lcd.refresh();
+} // queueDisplayLine()
+
+/**
+ * @brief BufferedLcd writer that queues bursts at display priority.
+ * @return false only if the display queue is full.
+ */
+bool queueLcdBurst(uint8_t address, const uint8_t *data, uint8_t length,
+                   void *context)
+{
+  I2cScheduler *scheduler = static_cast<I2cScheduler *>(context);
+  return scheduler->write(address, I2C_PRIORITY_DISPLAY, data, length);
+} // queueLcdBurst()
+
+/**
+ * @brief Completion callback for servo frames. Runs in loop() context.
+ */
+void onServoDone(const I2cTransaction &txn, void *context)
+{
+  if (txn.result != 0)
+  {
+    console.print("<onServoDone> Servo frame failed, error ");
+    console.println(txn.result);
+  } // if
+} // onServoDone()
@@ -0,0 +1,114 @@
+/**
+ * @file main-l298nBench.cpp
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Measure what changing the motor's direction costs: three
+ * digitalWrite() calls versus the L298N library's port writes.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details
+ * Same wiring as main.cpp (EN on A3, IN1 on A4, IN2 on A5). Do it with the
+ * motor power off: the motor pins switch between forward and reverse
+ * thousands of times a second. The sketch times, with the CPU cycle counter
+ * (lib/CycleProfiler):
+ * 1. The Lesson 3 way: digitalWrite() on EN, IN1 and IN2.
+ * 2. L298NChannel::set(), the library way.
+ * Each result is the average cycles and microseconds per change of
+ * direction. With digitalWrite() the pins also spend most of that time in a
+ * mix of the old and new mode. The results are printed once, after setup().
+ */
+#include <Arduino.h>
+#include <CycleProfiler.h>
+#include <L298N.h>
+
+#define enA1     A3 // DC Motor controller enable pin.
+#define inA1     A4 // DC Motor controller direction pin 1.
+#define inA2     A5 // DC Motor controller direction pin 2.
+
+// Changes of direction per measurement. Even, so the motor ends in forward.
+#define CHANGES 1000
+
+L298NChannel<enA1, inA1, inA2> motorA; // Motor A of the L298N.
+
+// Forward function declarations (not reqiured for Arduino IDE) but is required
+// for PlatformIO IDE.
+uint32_t timeDigitalWrite();
+uint32_t timeL298N();
+void printResult(const char *name, uint32_t cycles);
+
+/**
+ * @brief Standard Arduino setup function, runs the benchmark once.
+ */
+void setup()
+{
+  Serial.begin(115200);
+  while (!Serial)
+  {
+    delay(10);
+  } // while
+  delay(1000); // Let the Serial Monitor connect.
+  CycleCounter::begin();
+  if (!motorA.begin())
+  {
+    Serial.println("Motor pins do not match this board, nothing to measure.");
+    return;
+  } // if
+  Serial.println("\nL298N benchmark, average per change of direction");
+
+  uint32_t digitalWriteCycles = timeDigitalWrite();
+  uint32_t l298nCycles = timeL298N();
+  motorA.coast();
+
+  printResult("digitalWrite() x3", digitalWriteCycles);
+  printResult("L298NChannel::set()", l298nCycles);
+  Serial.print("Port writes per change: ");
+  Serial.println(motorA.portWrites());
+} // setup()
+
+/**
+ * @brief Standard Arduino loop function. Nothing to do.
+ */
+void loop()
+{
+} // loop()
+
+/**
+ * @brief Total cycles of CHANGES direction changes with digitalWrite().
+ */
+uint32_t timeDigitalWrite()
+{
+  uint32_t start = CycleCounter::now();
+  for (int i = 0; i < CHANGES; i++)
+  {
+    bool forward = (i & 1) == 0;
+    digitalWrite(enA1, HIGH);
+    digitalWrite(inA1, forward ? LOW : HIGH);
+    digitalWrite(inA2, forward ? HIGH : LOW);
+  } // for
+  return CycleCounter::now() - start;
+} // timeDigitalWrite()
+
+/**
+ * @brief Total cycles of CHANGES direction changes with the L298N library.
+ */
+uint32_t timeL298N()
+{
+  uint32_t start = CycleCounter::now();
+  for (int i = 0; i < CHANGES; i++)
+  {
+    motorA.set((i & 1) == 0 ? L298N_FORWARD : L298N_REVERSE);
+  } // for
+  return CycleCounter::now() - start;
+} // timeL298N()
+
+void printResult(const char *name, uint32_t cycles)
+{
+  Serial.print(name);
+  Serial.print(": ");
+  Serial.print(cycles / CHANGES);
+  Serial.print(" cycles, ");
+  Serial.print((float)cycles / CHANGES / CycleCounter::perUs(), 3);
+  Serial.println(" us");
+} // printResult()
@@ -8,11 +8,14 @@
  * @copyright Copyright (c) 2025
  */
 #include <Arduino.h> // Arduino Core for ESP32. Comes with PlatformIO.
+#include <L298N.h> // Motor controller driver, see lib/L298N.
 
 // Global variables and object declarations
 #define enA1     A3 // DC Motor controller enable pin.
 #define inA1     A4 // DC Motor controller direction pin 1.
 #define inA2     A5 // DC Motor controller direction pin 1.
+#define BRAKE_MS 300 // Time stop() brakes before letting the motor coast.
+L298NChannel<enA1, inA1, inA2> motorA; // Motor A of the L298N.
 
 // Forward function declarations (not reqiured for Arduino IDE) but is required 
 // for PlatformIO IDE.
@@ -28,9 +31,10 @@ void setup()
    Serial.begin(115200);
    Serial.println("<setup> Start of setup.");
    Serial.println("<setup> Set up DC motor control pins.");
-   pinMode(enA1, OUTPUT);
-   pinMode(inA1, OUTPUT);
-   pinMode(inA2, OUTPUT);
+   if(!motorA.begin())
+   {
+      Serial.println("<setup> Motor pins do not match this board.");
+   } // if
    Serial.println("<setup> End of setup.");
 } // setup()
 
@@ -54,16 +58,18 @@ void loop()
 } // loop()
 
 /**
- * @brief Spins motor clockwise (from motor's perspecive).
- * 
+ * @brief Stops the motor quickly, then lets it go.
+ * @details Braking shorts the motor, so it stops in a fraction of the time
+ * it takes to coast. The current is at most what the motor draws when it
+ * starts, which the motor controller already handles.
  */
 void stop() 
 {
   // LM298N Motor Controller.
   Serial.println("<stop> Stop motor.");
-  digitalWrite(enA1, LOW);
-  digitalWrite(inA1, LOW);
-  digitalWrite(inA2, LOW);
+  motorA.brake();
+  delay(BRAKE_MS);
+  motorA.coast();
 } // stop()
 
 /**
@@ -74,9 +80,7 @@ void goForward()
 {
   // LM298N Motor Controller.
   Serial.println("<goForward> Spin motor forward.");
-  digitalWrite(enA1, HIGH);
-  digitalWrite(inA1, LOW);
-  digitalWrite(inA2, HIGH);
+  motorA.forward();
 } // goForward()
 
 /**
@@ -87,7 +91,5 @@ void goBackward()
 {
   // LM298N Motor Controller.
   Serial.println("<goBackward> Spin motor backward.");
-  digitalWrite(enA1, HIGH);
-  digitalWrite(inA1, LOW);
-  digitalWrite(inA2, HIGH);
+  motorA.reverse();
 } // goBackward()
\ No newline at end of file
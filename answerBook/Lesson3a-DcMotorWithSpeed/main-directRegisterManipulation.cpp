@@ -8,6 +8,9 @@
  */
 #include <Arduino.h>
 #include <FspTimer.h>
+#include <BootSerial.h> // Output that never waits for a host, see lib/BootSerial.
+
+BootSerial console(Serial); // Use instead of Serial, it never blocks.
 
 #define PWM_PIN 9   // D9, P303, likely GPT0_GTIOCA (ENA for L298N)
 #define IN1_PIN 7   // D7, controls motor direction
@@ -48,8 +51,10 @@ void setupPWM(uint32_t frequency_hz, uint8_t resolution_bits, uint16_t duty_valu
   uint32_t pulse_counts = (duty_value * period_counts) / (max_counts - 1);
 
   if (!pwm_timer.begin(TIMER_MODE_PWM, timer_type, channel, period_counts, pulse_counts, source_div, nullptr, nullptr)) {
-    Serial.println("PWM initialization failed!");
-    while (1);
+    console.println("PWM initialization failed!");
+    while (1) {
+      console.poll(); // Halt, but still send the message once a host listens.
+    }
   }
 
   pwm_timer.open();
@@ -58,8 +63,7 @@ void setupPWM(uint32_t frequency_hz, uint8_t resolution_bits, uint16_t duty_valu
 }
 
 void setup() {
-  Serial.begin(115200);
-  while (!Serial) delay(10); // Wait for Serial
+  console.begin(115200);
 
   // Initialize pins
   pinMode(PWM_PIN, OUTPUT);
@@ -73,32 +77,34 @@ void setup() {
   // Setup PWM: 5 kHz, 8-bit, 78.431% duty cycle (200/255)
   setupPWM(5000, 8, 200);
   analogWrite(PWM_PIN, 200); // 78.431% duty cycle
+  console.mark("motor running");
 
   // Test 20 kHz, 10-bit later (uncomment to try)
   // setupPWM(20000, 10, 800);
   // analogWrite(PWM_PIN, 800);
 
-  Serial.println("PWM initialized: 5 kHz, 8-bit, 78.431% duty cycle");
+  console.println("PWM initialized: 5 kHz, 8-bit, 78.431% duty cycle");
 }
 
 void loop() {
+  console.poll(); // Send output that is waiting for the port.
   // Test different duty cycles
-  Serial.println("Duty cycle: 50%");
+  console.println("Duty cycle: 50%");
   analogWrite(PWM_PIN, 128); // 50%
   delay(2000);
 
-  Serial.println("Duty cycle: 78.431%");
+  console.println("Duty cycle: 78.431%");
   analogWrite(PWM_PIN, 200); // 78.431%
   delay(2000);
 
   // Test direction change (reverse)
-  Serial.println("Reversing motor");
+  console.println("Reversing motor");
   digitalWrite(IN1_PIN, LOW);
   digitalWrite(IN2_PIN, HIGH);
   delay(2000);
 
   // Back to forward
-  Serial.println("Forward motor");
+  console.println("Forward motor");
   digitalWrite(IN1_PIN, HIGH);
   digitalWrite(IN2_PIN, LOW);
   delay(2000);
@@ -8,6 +8,9 @@
  * @copyright Copyright (c) 2025
  */
 #include <Arduino.h> // Arduino Core for ESP32. Comes with PlatformIO.
+#include <BootSerial.h> // Output that never waits for a host, see lib/BootSerial.
+
+BootSerial console(Serial); // Use instead of Serial, it never blocks.
 
 // Pin definitions
 const int ENA = 9;   // PWM pin for Motor A speed
@@ -21,15 +24,10 @@ const int IN2 = 7;   // Motor A direction
 void setupSerial() 
 {
   // Initialize Serial communication at 115200 baud rate
-  Serial.begin(115200);
-  
-  // Wait for Serial Monitor to connect
-  while (!Serial) 
-  {
-  } // while()
+  console.begin(115200);
   
   // Print prompt for user
-  Serial.println("Enter a number between 0 and 255 for Motor A speed:");
+  console.println("Enter a number between 0 and 255 for Motor A speed:");
 } // setupSerial()
 
 /**
@@ -39,13 +37,13 @@ void setupSerial()
 void checkUserInput() 
 {
   // Wait until data is available (blocks until user sends input)
-  while (Serial.available() == 0) 
+  while (console.available() == 0) 
   {
-    ; // Do nothing, wait for input
+    console.poll(); // Send the prompt once a host is listening.
   }
   
   // Read the incoming string until newline (Enter key)
-  String userInput = Serial.readStringUntil('\n');
+  String userInput = console.readStringUntil('\n');
   
   // Remove any whitespace or newline characters
   userInput.trim();
@@ -66,18 +64,18 @@ void checkUserInput()
       } // if
       // Set user-specified speed
       analogWrite(ENA, number);
-      Serial.print("Valid input received: ");
-      Serial.print(number);
-      Serial.println(" (Motor A speed set with kick-start)");
+      console.print("Valid input received: ");
+      console.print(number);
+      console.println(" (Motor A speed set with kick-start)");
     } // if 
     else 
     {
-      Serial.println("Error: Number must be between 0 and 255!");
+      console.println("Error: Number must be between 0 and 255!");
     } // else
   } // if
   else 
   {
-    Serial.println("Error: Invalid input! Please enter a number.");
+    console.println("Error: Invalid input! Please enter a number.");
   } // else
 } // checkUserInput()
 
@@ -106,6 +104,7 @@ void setup()
  */
 void loop() 
 {
+  console.poll(); // Send output that is waiting for the port.
   // Check for user input
   checkUserInput();
 } // loop()
\ No newline at end of file
@@ -0,0 +1,198 @@
+/**
+ * @file main-linearSpeed.cpp
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Set the ER20's speed in percent, evenly from stop to full, with the
+ * full resolution of the PWM timer.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details
+ * main-kick.cpp takes an analogWrite() value from 0 to 255. At 20 V and
+ * 100 Hz the ER20 does not turn below 70, so most small numbers do nothing
+ * and the steps above 70 are uneven. This sketch takes a speed from 0 to
+ * 100 (decimals allowed) instead:
+ * 1. setup() loads the calibration saved for SUPPLY_DECIVOLTS by
+ *    main-testPwmSettings.cpp (lib/MotorCalibration), or the ER20 defaults.
+ * 2. It runs the PWM timer of pin 9 at the calibrated frequency with the
+ *    smallest divider whose period fits in 16 bits: 30000 counts at 100 Hz,
+ *    instead of 255 steps.
+ * 3. It builds a SpeedTable (lib/MotorCalibration) for that supply and
+ *    frequency: 0 % is stop, anything above starts at the threshold and
+ *    100 % is the full period.
+ * 4. Each speed typed in goes through the table to timer counts. A start
+ *    from standstill kicks first if the calibration has a kick.
+ * The sketch prints the counts and how many CPU cycles the table lookup
+ * took (lib/CycleProfiler). Wiring is the same as main-kick.cpp.
+ */
+#include <Arduino.h>
+#include <pwm.h>
+#include <MotorCalibration.h>
+#include <SpeedTable.h>
+#include <CycleProfiler.h> // CycleCounter, see lib/CycleProfiler.
+#include <BootSerial.h>    // Output that never waits for a host, see lib/BootSerial.
+
+BootSerial console(Serial); // Use instead of Serial, it never blocks.
+
+// Pin definitions
+const int ENA = 9;   // PWM pin for Motor A speed
+const int IN1 = 8;   // Motor A direction
+const int IN2 = 7;   // Motor A direction
+
+// Supply voltage in tenths of a volt. Picks the calibration and so the
+// table, change it when you change the supply.
+#define SUPPLY_DECIVOLTS 200
+
+// Clock the GPT timers count.
+#define GPT_CLOCK_HZ 48000000UL
+
+// Longest period in counts. Only GPT0 and GPT1 count further, and pin 9's
+// timer may not be one of them.
+#define PWM_MAX_PERIOD 0xFFFF
+
+PwmOut pwm(ENA);
+CalibrationStore calibration;
+MotorCalibration motorCal = ER20_20V_CALIBRATION; // Replaced by the saved one, if any.
+SpeedTable speedTable;
+uint16_t currentSpeed = 0; // Last speed set, 0 is stopped.
+
+// Forward function declarations (not reqiured for Arduino IDE) but is required
+// for PlatformIO IDE.
+bool setupPwm(uint16_t frequencyHz);
+void setSpeed(uint16_t speed);
+void checkUserInput();
+
+/**
+ * @brief Start PWM on ENA at a frequency with as many counts per period as
+ * fit, and build the speed table for it.
+ * @return false if the frequency cannot be made.
+ */
+bool setupPwm(uint16_t frequencyHz)
+{
+  if (frequencyHz == 0)
+  {
+    return false;
+  } // if
+  // The GPT dividers are 1, 4, 16, 64, 256 and 1024, every second step of
+  // timer_source_div_t.
+  uint8_t sourceDiv = TIMER_SOURCE_DIV_1;
+  uint32_t period = GPT_CLOCK_HZ / frequencyHz;
+  while (period > PWM_MAX_PERIOD)
+  {
+    if (sourceDiv >= TIMER_SOURCE_DIV_1024)
+    {
+      return false;
+    } // if
+    sourceDiv += 2;
+    period = GPT_CLOCK_HZ / ((uint32_t)frequencyHz << sourceDiv);
+  } // while
+  if (!pwm.begin(period, 0, true, (timer_source_div_t)sourceDiv))
+  {
+    return false;
+  } // if
+  return speedTable.fromCalibration(motorCal, SUPPLY_DECIVOLTS, period);
+} // setupPwm()
+
+/**
+ * @brief Run the motor at a speed, 0 to SPEED_FULL.
+ */
+void setSpeed(uint16_t speed)
+{
+  uint32_t start = CycleCounter::now();
+  uint32_t counts = speedTable.counts(speed);
+  uint32_t cycles = CycleCounter::now() - start;
+
+  if (currentSpeed == 0 && speed > 0 && motorCal.kickMs > 0)
+  {
+    pwm.pulseWidth_raw((uint64_t)motorCal.kickDuty * speedTable.period() / 255);
+    delay(motorCal.kickMs); // Brief pulse to start motor
+  } // if
+  pwm.pulseWidth_raw(counts);
+  currentSpeed = speed;
+
+  console.print("Speed set: ");
+  console.print(counts);
+  console.print(" of ");
+  console.print(speedTable.period());
+  console.print(" counts (table lookup ");
+  console.print(cycles);
+  console.println(" cycles)");
+} // setSpeed()
+
+/**
+ * @brief Checks for user input from Serial Monitor and sets motor speed.
+ */
+void checkUserInput()
+{
+  // Wait until data is available (blocks until user sends input)
+  while (console.available() == 0)
+  {
+    console.poll(); // Send the prompt once a host is listening.
+  } // while
+
+  String userInput = console.readStringUntil('\n');
+  userInput.trim();
+  float percent = userInput.toFloat();
+  if (percent == 0 && userInput != "0")
+  {
+    console.println("Error: Invalid input! Please enter a number.");
+  } // if
+  else if (percent < 0 || percent > 100)
+  {
+    console.println("Error: Speed must be between 0 and 100!");
+  } // else if
+  else
+  {
+    setSpeed(SpeedTable::fromPercent(percent));
+  } // else
+  console.println("Enter a speed between 0 and 100 %:");
+} // checkUserInput()
+
+/**
+ * @brief Load the calibration, start the PWM timer and build the table
+ * before the first speed is asked for.
+ */
+void setup()
+{
+  // Set motor direction (forward: IN1 HIGH, IN2 LOW)
+  pinMode(IN1, OUTPUT);
+  pinMode(IN2, OUTPUT);
+  digitalWrite(IN1, HIGH);
+  digitalWrite(IN2, LOW);
+
+  console.begin(115200);
+  CycleCounter::begin();
+  calibration.begin();
+  if (!calibration.load(MOTOR_PROFILE_ER20, SUPPLY_DECIVOLTS, motorCal))
+  {
+    console.println("No saved calibration for this supply, using the ER20 defaults.");
+  } // if
+  if (!setupPwm(motorCal.pwmHz))
+  {
+    console.println("PWM initialization failed!");
+    while (1)
+    {
+      console.poll(); // Halt, but still send the message once a host listens.
+    } // while
+  } // if
+  console.mark("speed table ready");
+
+  console.print("PWM at ");
+  console.print(speedTable.pwmHz());
+  console.print(" Hz, ");
+  console.print(speedTable.period());
+  console.print(" counts per period, the motor starts at ");
+  console.print(speedTable.at(0));
+  console.println(" counts");
+  console.println("Enter a speed between 0 and 100 %:");
+} // setup()
+
+/**
+ * @brief Main loop function to continuously check for user input.
+ */
+void loop()
+{
+  console.poll(); // Send output that is waiting for the port.
+  checkUserInput();
+} // loop()
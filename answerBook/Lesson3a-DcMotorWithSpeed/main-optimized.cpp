@@ -23,7 +23,13 @@
  *    control over frequency, resolution, and duty cycle.
  * 2. Sets motor direction (forward/reverse) using L298N IN1 and IN2 pins.
  * 3. Sweeps duty cycle from 27.45% to 100% and back, allowing speed adjustment.
- * 4. Outputs status to Serial Monitor for debugging (115200 baud).
+ * 4. Brakes the motor before each change of direction (lib/L298N, L298NMotor),
+ *    under the L298N's 2 A limit, instead of coasting for 3 seconds.
+ * 5. Outputs status to Serial Monitor for debugging (115200 baud).
+ * 6. Takes the PWM frequency, the starting duty and the kick from the
+ *    calibration that main-testPwmSettings.cpp saved in the data flash for
+ *    this supply voltage (lib/MotorCalibration), or the values below if none
+ *    was saved.
  * 
  * ### Hardware Setup:
  * - **Arduino Uno R4 WiFi**:
@@ -56,15 +62,32 @@
 
 #include <Arduino.h>
 #include <FspTimer.h>
+#include <L298NMotor.h>
+#include <MotorCalibration.h>
+#include <BootSerial.h> // Output that never waits for a host, see lib/BootSerial.
+
+BootSerial console(Serial); // Use instead of Serial, it never blocks.
 
 // Pin definitions for L298N motor driver
 #define PWM_PIN 9   // D9, P303, likely GPT0_GTIOCA (ENA for L298N speed control)
 #define IN1_PIN 7   // D7, controls motor direction (HIGH/LOW for forward)
 #define IN2_PIN 8   // D8, controls motor direction (LOW/HIGH for reverse)
 
+// Supply voltage in tenths of a volt. Calibrations are kept per voltage, so
+// change this when you change the supply.
+#define SUPPLY_DECIVOLTS 200
+
 // Global FspTimer object for PWM control
 FspTimer pwm_timer;
 
+// Speed, braking and direction. IN1 HIGH is forward in this sketch, which is
+// L298N_FORWARD with IN1 and IN2 swapped.
+L298NMotor<PWM_PIN, IN2_PIN, IN1_PIN> motor(L298N_ER20_CONFIG);
+
+// Saved motor settings. motorCal is replaced by the saved ones, if any.
+CalibrationStore calibration;
+MotorCalibration motorCal = ER20_20V_CALIBRATION;
+
 /**
  * @brief Configures PWM on a specified pin using the FspTimer library for precise control.
  * 
@@ -171,8 +194,11 @@ void setupPWM(uint32_t frequency_hz, uint8_t resolution_bits, uint16_t duty_valu
   // Initialize the GPT timer in PWM mode with the calculated settings
   if (!pwm_timer.begin(TIMER_MODE_PWM, timer_type, channel, period_counts, pulse_counts, source_div, nullptr, nullptr)) 
   {
-    Serial.println("PWM initialization failed!");
-    while (1); // Halt if initialization fails
+    console.println("PWM initialization failed!");
+    while (1) // Halt if initialization fails
+    {
+      console.poll(); // But still send the message once a host listens.
+    } // while
   } // if
 
   // Open and start the timer to generate PWM
@@ -182,46 +208,105 @@ void setupPWM(uint32_t frequency_hz, uint8_t resolution_bits, uint16_t duty_valu
   analogWriteResolution(resolution_bits);
 
   // Debug output to Serial Monitor
-  Serial.print("PWM set: ");
-  Serial.print(frequency_hz);
-  Serial.print(" Hz, ");
-  Serial.print(resolution_bits);
-  Serial.print("-bit, Duty: ");
-  Serial.print((duty_value * 100.0) / (max_counts - 1));
-  Serial.println("%");
+  console.print("PWM set: ");
+  console.print(frequency_hz);
+  console.print(" Hz, ");
+  console.print(resolution_bits);
+  console.print("-bit, Duty: ");
+  console.print((duty_value * 100.0) / (max_counts - 1));
+  console.println("%");
 } // setupPWM()
 
+/**
+ * @brief Wait while the motor object keeps its outputs up to date.
+ * @param ms Time to wait in milliseconds.
+ */
+void waitMs(unsigned long ms)
+{
+  unsigned long start = millis();
+  while (millis() - start < ms)
+  {
+    motor.update();
+    console.poll();
+    delay(1); // Often enough for the brake and the current limit.
+  } // while
+} // waitMs()
+
+/**
+ * @brief Brake the motor down and run it the other way.
+ * @param duty New duty cycle, below 0 for reverse.
+ */
+void changeDirection(int16_t duty)
+{
+  motor.drive(duty);
+  while (motor.reversing())
+  {
+    motor.update();
+    console.poll();
+    delay(1); // Often enough for the brake and the current limit.
+  } // while
+  console.print("Direction changed after braking for ");
+  console.print(motor.lastReversalMs());
+  console.println(" ms");
+} // changeDirection()
+
 /**
  * @brief Initializes the Arduino, pins, and PWM for the ER20 motor.
  * 
  * @details
  * - Initializes Serial communication at 115200 baud for debugging.
- * - Configures PWM_PIN (9), IN1_PIN (7), and IN2_PIN (8) as outputs.
- * - Sets initial motor direction to forward (IN1 HIGH, IN2 LOW).
+ * - Configures PWM_PIN (9), IN1_PIN (7), and IN2_PIN (8) as outputs, motor
+ *   coasting.
+ * - Loads the calibration saved for SUPPLY_DECIVOLTS, in microseconds, so the
+ *   motor never starts on guessed settings.
  * - Configures PWM with optimal settings: 100 Hz, 8-bit resolution, 27.45% duty cycle
- *   (analogWrite(9, 70)), the minimum threshold for the ER20 to spin at 20V.
+ *   (analogWrite(9, 70)), the minimum threshold for the ER20 to spin at 20V,
+ *   unless the calibration says otherwise.
  */
 void setup() 
 {
   // Initialize Serial communication for debugging
-  Serial.begin(115200);
-  while (!Serial) delay(10); // Wait for Serial to connect
+  console.begin(115200);
 
-  // Configure pins as outputs
-  pinMode(PWM_PIN, OUTPUT);
-  pinMode(IN1_PIN, OUTPUT);
-  pinMode(IN2_PIN, OUTPUT);
+  // Settings for this motor and supply, before the motor first moves
+  calibration.begin();
+  if (calibration.load(MOTOR_PROFILE_ER20, SUPPLY_DECIVOLTS, motorCal))
+  {
+    console.mark("calibration loaded");
+  } // if
+  else
+  {
+    console.println("No saved calibration for this supply, using the ER20 defaults.");
+  } // else
 
-  // Set initial motor direction: forward (IN1 HIGH, IN2 LOW)
-  digitalWrite(IN1_PIN, HIGH);
-  digitalWrite(IN2_PIN, LOW);
+  // Configure pins as outputs, motor coasting
+  if (!motor.begin())
+  {
+    console.println("Motor pins do not match this board!");
+    while (1) // Halt, the port writes would go to the wrong pins
+    {
+      console.poll(); // But still send the message once a host listens.
+    } // while
+  } // if
 
-  // Set optimal PWM settings: 100 Hz, 8-bit, 27.45% duty cycle (minimum for ER20 spin)
-  setupPWM(100, 8, 70);
-  analogWrite(PWM_PIN, 70);
+  // Set the calibrated PWM frequency (100 Hz for the ER20 at 20 V), 8-bit.
+  // Kick if the motor needs it, then start forward at the lowest duty cycle
+  // it turns at (70, 27.45% for the ER20).
+  setupPWM(motorCal.pwmHz, 8, 0);
+  if (motorCal.kickMs > 0)
+  {
+    motor.drive(motorCal.kickDuty);
+    waitMs(motorCal.kickMs);
+  } // if
+  motor.drive(motorCal.startDuty);
+  console.mark("motor running");
 
   // Debug output to confirm setup
-  Serial.println("Setup complete. ER20 motor running at 100 Hz, 8-bit, starting at 27.45% duty cycle (forward).");
+  console.print("Setup complete. ER20 motor running at ");
+  console.print(motorCal.pwmHz);
+  console.print(" Hz, 8-bit, starting at ");
+  console.print((motorCal.startDuty * 100.0) / 255);
+  console.println("% duty cycle (forward).");
 } // setup()
 
 /**
@@ -230,71 +315,61 @@ void setup()
  * @details
  * - **Forward Direction**: Sweeps duty cycle from 27.45% (analogWrite(9, 70)) to 100%
  *   (analogWrite(9, 255)) and back, with 2-second steps to observe speed changes.
- * - **Pause**: Stops the motor for 3 seconds between direction changes.
- * - **Reverse Direction**: Switches direction (IN1 LOW, IN2 HIGH) and repeats the sweep.
+ * - **Direction change**: Brakes the motor down (short brake, current limited)
+ *   and reverses, a few hundred milliseconds instead of a 3 second pause.
+ * - **Reverse Direction**: IN1 LOW, IN2 HIGH, repeats the sweep.
  * - **Debugging**: Outputs duty cycle and direction to Serial Monitor.
  * - **Cycle**: Repeats forward and reverse sweeps indefinitely.
  */
 void loop() 
 {
+  console.poll(); // Send output that is waiting for the port.
   // Forward direction: Sweep duty cycle up from 27.45% to 100%
-  Serial.println("Forward direction: Increasing speed...");
-  for (int duty = 70; duty <= 255; duty += 10) 
+  console.println("Forward direction: Increasing speed...");
+  for (int duty = motorCal.startDuty; duty <= 255; duty += 10) 
   {
-    analogWrite(PWM_PIN, duty);
-    Serial.print("Duty cycle: ");
-    Serial.print((duty * 100.0) / 255);
-    Serial.println("%");
-    delay(2000); // 2-second delay to observe speed
+    motor.drive(duty);
+    console.print("Duty cycle: ");
+    console.print((duty * 100.0) / 255);
+    console.println("%");
+    waitMs(2000); // 2-second delay to observe speed
   } // for
 
   // Sweep duty cycle down from 100% to 27.45%
-  Serial.println("Forward direction: Decreasing speed...");
-  for (int duty = 255; duty >= 70; duty -= 10) 
+  console.println("Forward direction: Decreasing speed...");
+  for (int duty = 255; duty >= motorCal.startDuty; duty -= 10) 
   {
-    analogWrite(PWM_PIN, duty);
-    Serial.print("Duty cycle: ");
-    Serial.print((duty * 100.0) / 255);
-    Serial.println("%");
-    delay(2000);
+    motor.drive(duty);
+    console.print("Duty cycle: ");
+    console.print((duty * 100.0) / 255);
+    console.println("%");
+    waitMs(2000);
   } // for
 
-  // Stop the motor before changing direction
-  analogWrite(PWM_PIN, 0);
-  Serial.println("Motor off");
-  delay(3000); // 3-second pause
-
-  // Reverse direction: Set IN1 LOW, IN2 HIGH
-  digitalWrite(IN1_PIN, LOW);
-  digitalWrite(IN2_PIN, HIGH);
-  Serial.println("Reverse direction: Increasing speed...");
+  // Brake and reverse direction: IN1 LOW, IN2 HIGH
+  changeDirection(-motorCal.startDuty);
+  console.println("Reverse direction: Increasing speed...");
   // Sweep duty cycle up
-  for (int duty = 70; duty <= 255; duty += 10) 
+  for (int duty = motorCal.startDuty; duty <= 255; duty += 10) 
   {
-    analogWrite(PWM_PIN, duty);
-    Serial.print("Duty cycle: ");
-    Serial.print((duty * 100.0) / 255);
-    Serial.println("%");
-    delay(2000);
+    motor.drive(-duty);
+    console.print("Duty cycle: ");
+    console.print((duty * 100.0) / 255);
+    console.println("%");
+    waitMs(2000);
   } // for
 
   // Sweep duty cycle down
-  Serial.println("Reverse direction: Decreasing speed...");
-  for (int duty = 255; duty >= 70; duty -= 10) 
+  console.println("Reverse direction: Decreasing speed...");
+  for (int duty = 255; duty >= motorCal.startDuty; duty -= 10) 
   {
-    analogWrite(PWM_PIN, duty);
-    Serial.print("Duty cycle: ");
-    Serial.print((duty * 100.0) / 255);
-    Serial.println("%");
-    delay(2000);
+    motor.drive(-duty);
+    console.print("Duty cycle: ");
+    console.print((duty * 100.0) / 255);
+    console.println("%");
+    waitMs(2000);
   } // for
 
-  // Stop the motor before changing direction again
-  analogWrite(PWM_PIN, 0);
-  Serial.println("Motor off");
-  delay(3000);
-
-  // Reset to forward direction for the next cycle
-  digitalWrite(IN1_PIN, HIGH);
-  digitalWrite(IN2_PIN, LOW);
+  // Brake and go forward again for the next cycle
+  changeDirection(motorCal.startDuty);
 } // loop()
\ No newline at end of file
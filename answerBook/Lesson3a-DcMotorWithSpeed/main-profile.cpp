@@ -0,0 +1,213 @@
+/**
+ * @file main-profile.cpp
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Count the CPU cycles the motor code takes on the Arduino Uno R4 WiFi,
+ * and measure how late and how unevenly a timer interrupt runs.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details
+ * Same wiring and PWM settings as main-optimized.cpp. The sketch ramps the
+ * motor up and down without delay(), timing each piece with CycleProfiler
+ * (lib/CycleProfiler):
+ * - setupPWM(): rebuilding the GPT timer, done once in setup() and once
+ *   every ramp.
+ * - analogWrite() and digitalWrite() on the motor pins.
+ * - One Serial.print() of a status line.
+ * A second GPT timer interrupts 1000 times a second. The handler reads that
+ * timer's counter, which started again from 0 at the interrupt event, so the
+ * count is the latency. The time between handler runs gives the jitter. The
+ * Serial.print() and setupPWM() zones are where to look if the jitter grows.
+ *
+ * Send p in the Serial Monitor (115200 baud) for a report and r to clear it.
+ */
+#define CYCLE_PROFILER 1 // This sketch is all about profiling.
+
+#include <Arduino.h>
+#include <FspTimer.h>
+#include <CycleProfiler.h>
+
+#define PWM_PIN 9   // D9, P303, likely GPT0_GTIOCA (ENA for L298N speed control)
+#define IN1_PIN 7   // D7, controls motor direction (HIGH/LOW for forward)
+#define IN2_PIN 8   // D8, controls motor direction (LOW/HIGH for reverse)
+
+#define TICK_HZ 1000      // Interrupt rate of the measured timer.
+#define STEP_MS 50        // Time between duty cycle steps.
+#define STATUS_MS 1000    // Time between status lines.
+
+FspTimer pwm_timer;  // Motor PWM, as in main-optimized.cpp.
+FspTimer tickTimer;  // Periodic interrupt being measured.
+
+float tickCyclesPerCount = 1.0f; // CPU cycles per tickTimer count.
+volatile uint32_t ticks = 0;
+
+int duty = 70;
+int dutyStep = 5;
+
+PROFILE_ZONE(setupPwmZone, "setupPWM");
+PROFILE_ZONE(analogWriteZone, "analogWrite");
+PROFILE_ZONE(digitalWriteZone, "digitalWrite x2");
+PROFILE_ZONE(printZone, "Serial status line");
+PROFILE_ISR_PROBE(tickProbe, "1 kHz timer", 1000000UL / TICK_HZ);
+
+// Forward function declarations (not reqiured for Arduino IDE) but is required
+// for PlatformIO IDE.
+bool setupPWM(uint32_t frequency_hz, uint8_t resolution_bits, uint16_t duty_value);
+bool setupTickTimer();
+void onTick(timer_callback_args_t *args);
+
+/**
+ * @brief Same PWM set up as main-optimized.cpp, without the Serial output so
+ * only the timer work is timed.
+ * @return false if the timer could not be started.
+ */
+bool setupPWM(uint32_t frequency_hz, uint8_t resolution_bits, uint16_t duty_value)
+{
+  PROFILE_SCOPE(setupPwmZone);
+  pwm_timer.stop();
+  pwm_timer.close();
+
+  uint8_t timer_type = GPT_TIMER;
+  uint8_t channel = GET_CHANNEL(getPinCfgs(PWM_PIN, PIN_CFG_REQ_PWM)[0]);
+  uint32_t max_counts = (1UL << resolution_bits);
+  uint32_t target_counts = 48000000UL / frequency_hz;
+
+  // Smallest prescaler that fits the period in max_counts.
+  timer_source_div_t source_div = TIMER_SOURCE_DIV_256;
+  uint32_t period_counts = target_counts / 256;
+  const timer_source_div_t dividers[] = {TIMER_SOURCE_DIV_1, TIMER_SOURCE_DIV_4,
+                                         TIMER_SOURCE_DIV_16, TIMER_SOURCE_DIV_64};
+  const uint32_t divisors[] = {1, 4, 16, 64};
+  for (uint8_t i = 0; i < 4; i++)
+  {
+    if (target_counts / divisors[i] <= max_counts)
+    {
+      source_div = dividers[i];
+      period_counts = target_counts / divisors[i];
+      break;
+    } // if
+  } // for
+
+  uint32_t pulse_counts = (duty_value * period_counts) / (max_counts - 1);
+  if (!pwm_timer.begin(TIMER_MODE_PWM, timer_type, channel, period_counts,
+                       pulse_counts, source_div, nullptr, nullptr))
+  {
+    return false;
+  } // if
+  pwm_timer.open();
+  pwm_timer.start();
+  analogWriteResolution(resolution_bits);
+  return true;
+} // setupPWM()
+
+/**
+ * @brief Interrupt handler of the measured timer. The probe goes first so
+ * nothing else adds to the latency.
+ */
+void onTick(timer_callback_args_t *args)
+{
+  (void)args;
+  PROFILE_ISR(tickProbe, (uint32_t)(tickTimer.get_counter() * tickCyclesPerCount));
+  ticks++;
+} // onTick()
+
+/**
+ * @brief Start a free GPT timer that interrupts TICK_HZ times a second.
+ * @return false if no timer was free.
+ */
+bool setupTickTimer()
+{
+  uint8_t timer_type = GPT_TIMER;
+  int8_t channel = FspTimer::get_available_timer(timer_type);
+  if (channel < 0)
+  {
+    return false;
+  } // if
+  if (!tickTimer.begin(TIMER_MODE_PERIODIC, timer_type, channel, (float)TICK_HZ,
+                       0.0f, onTick))
+  {
+    return false;
+  } // if
+  tickTimer.setup_overflow_irq();
+  tickTimer.open();
+  tickTimer.start();
+  // The timer counts get_period_raw() times per interrupt.
+  tickCyclesPerCount = (float)(SystemCoreClock / TICK_HZ) / tickTimer.get_period_raw();
+  return true;
+} // setupTickTimer()
+
+/**
+ * @brief Standard Arduino setup function.
+ */
+void setup()
+{
+  Serial.begin(115200);
+  while (!Serial)
+  {
+    delay(10);
+  } // while
+  PROFILE_BEGIN();
+
+  pinMode(PWM_PIN, OUTPUT);
+  pinMode(IN1_PIN, OUTPUT);
+  pinMode(IN2_PIN, OUTPUT);
+  digitalWrite(IN1_PIN, HIGH);
+  digitalWrite(IN2_PIN, LOW);
+
+  if (!setupPWM(100, 8, duty))
+  {
+    Serial.println("PWM initialization failed!");
+  } // if
+  if (!setupTickTimer())
+  {
+    Serial.println("No free timer for the 1 kHz interrupt, no ISR numbers.");
+  } // if
+  Serial.println("Profiling. Send p for a report, r to clear it.");
+} // setup()
+
+/**
+ * @brief Standard Arduino loop function. Ramps the duty cycle up and down
+ * and changes direction at the bottom of each ramp.
+ */
+void loop()
+{
+  static unsigned long lastStepMs = 0;
+  static unsigned long lastStatusMs = 0;
+  unsigned long now = millis();
+
+  if (now - lastStepMs >= STEP_MS)
+  {
+    lastStepMs = now;
+    duty += dutyStep;
+    if (duty >= 255 || duty <= 70)
+    {
+      dutyStep = -dutyStep;
+    } // if
+    if (duty <= 70)
+    {
+      {
+        PROFILE_SCOPE(digitalWriteZone);
+        bool forward = digitalRead(IN1_PIN) == LOW;
+        digitalWrite(IN1_PIN, forward ? HIGH : LOW);
+        digitalWrite(IN2_PIN, forward ? LOW : HIGH);
+      }
+      setupPWM(100, 8, duty); // Once a ramp, to see what it costs.
+    } // if
+    PROFILE_SCOPE(analogWriteZone);
+    analogWrite(PWM_PIN, duty);
+  } // if
+
+  if (now - lastStatusMs >= STATUS_MS)
+  {
+    lastStatusMs = now;
+    PROFILE_SCOPE(printZone);
+    Serial.print("Duty: ");
+    Serial.print(duty);
+    Serial.print(" ticks: ");
+    Serial.println(ticks);
+  } // if
+
+  PROFILE_POLL(Serial);
+} // loop()
@@ -8,13 +8,27 @@
  */
 #include <Arduino.h>
 #include <FspTimer.h>
+#include <MotorCalibration.h>
+#include <BootSerial.h> // Output that never waits for a host, see lib/BootSerial.
+
+BootSerial console(Serial); // Use instead of Serial, it never blocks.
 
 #define PWM_PIN 9   // D9, P303, likely GPT0_GTIOCA (ENA for L298N)
 #define IN1_PIN 7   // D7, motor direction
 #define IN2_PIN 8   // D8, motor direction
 
+// Supply voltage in tenths of a volt. The saved calibration is for this
+// supply, so change it when you change the supply.
+#define SUPPLY_DECIVOLTS 200
+
+// How long each duty cycle step runs.
+#define STEP_MS 2000
+
 FspTimer pwm_timer;
 
+// Keeps what you find for main-optimized.cpp, see lib/MotorCalibration.
+CalibrationStore calibration;
+
 /**
  * @brief Configures PWM on a specified pin using the FspTimer library for precise control.
  * 
@@ -115,23 +129,65 @@ void setupPWM(uint32_t frequency_hz, uint8_t resolution_bits, uint16_t duty_valu
 
   if (!pwm_timer.begin(TIMER_MODE_PWM, timer_type, channel, period_counts, pulse_counts, source_div, nullptr, nullptr)) 
   {
-    Serial.println("PWM initialization failed!");
-    while (1);
+    console.println("PWM initialization failed!");
+    while (1)
+    {
+      console.poll(); // Halt, but still send the message once a host listens.
+    }
   }
 
   pwm_timer.open();
   pwm_timer.start();
   analogWriteResolution(resolution_bits);
 
-  Serial.print("PWM set: ");
-  Serial.print(frequency_hz);
-  Serial.print(" Hz, ");
-  Serial.print(resolution_bits);
-  Serial.print("-bit, Duty: ");
-  Serial.print((duty_value * 100.0) / (max_counts - 1));
-  Serial.println("%");
+  console.print("PWM set: ");
+  console.print(frequency_hz);
+  console.print(" Hz, ");
+  console.print(resolution_bits);
+  console.print("-bit, Duty: ");
+  console.print((duty_value * 100.0) / (max_counts - 1));
+  console.println("%");
 }
 
+/**
+ * @brief Save a frequency and duty cycle as the ER20's calibration for
+ * SUPPLY_DECIVOLTS. The kick settings stay at the defaults.
+ */
+void saveCalibration(uint32_t frequency_hz, int duty)
+{
+  MotorCalibration found = ER20_20V_CALIBRATION;
+  found.pwmHz = frequency_hz;
+  found.startDuty = duty;
+  if (calibration.save(MOTOR_PROFILE_ER20, SUPPLY_DECIVOLTS, found))
+  {
+    console.print("Saved: ");
+    console.print(frequency_hz);
+    console.print(" Hz, starts at duty ");
+    console.println(duty);
+  } // if
+  else
+  {
+    console.println("Saving the calibration failed!");
+  } // else
+} // saveCalibration()
+
+/**
+ * @brief Run one step for STEP_MS. Sending 's' saves the step as the
+ * calibration: send it at the first step where the motor turns.
+ */
+void runStep(uint32_t frequency_hz, int duty)
+{
+  unsigned long start = millis();
+  while (millis() - start < STEP_MS)
+  {
+    console.poll();
+    if (console.available() > 0 && console.read() == 's')
+    {
+      saveCalibration(frequency_hz, duty);
+    } // if
+  } // while
+} // runStep()
+
 /**
  * @brief Setup function for the Arduino Uno R4 WiFi.
  * 
@@ -140,8 +196,7 @@ void setupPWM(uint32_t frequency_hz, uint8_t resolution_bits, uint16_t duty_valu
  */
 void setup() 
 {
-  Serial.begin(115200);
-  while (!Serial) delay(10);
+  console.begin(115200);
 
   pinMode(PWM_PIN, OUTPUT);
   pinMode(IN1_PIN, OUTPUT);
@@ -154,8 +209,11 @@ void setup()
   // Initial PWM: 1 kHz, 8-bit, 78.431% duty cycle
   setupPWM(1000, 8, 200);
   analogWrite(PWM_PIN, 200);
+  console.mark("motor running");
 
-  Serial.println("Setup complete. Testing Meccano ER20 motor.");
+  console.println("Setup complete. Testing Meccano ER20 motor.");
+  calibration.begin();
+  console.println("Send 's' at the first duty cycle the motor turns at to save it for main-optimized.cpp.");
 } // setup()
 
 /**
@@ -163,30 +221,31 @@ void setup()
  */
 void loop() 
 {
+  console.poll(); // Send output that is waiting for the port.
   // Test frequencies
   uint32_t frequencies[] = {5000, 1000, 500, 100};
   const int freq_count = 4;
 
   for (int f = 0; f < freq_count; f++) 
   {
-    Serial.print("Testing frequency: ");
-    Serial.print(frequencies[f]);
-    Serial.println(" Hz");
+    console.print("Testing frequency: ");
+    console.print(frequencies[f]);
+    console.println(" Hz");
 
     // Sweep duty cycle from 50 to 255 (19.6% to 100%)
     for (int duty = 50; duty <= 255; duty += 10) 
     {
       setupPWM(frequencies[f], 8, duty);
       analogWrite(PWM_PIN, duty);
-      Serial.print("Duty cycle: ");
-      Serial.print((duty * 100.0) / 255);
-      Serial.println("%");
-      delay(2000); // Allow motor to respond
+      console.print("Duty cycle: ");
+      console.print((duty * 100.0) / 255);
+      console.println("%");
+      runStep(frequencies[f], duty); // Allow motor to respond
     } // for
 
     // Pause between frequencies
     analogWrite(PWM_PIN, 0);
-    Serial.println("Motor off");
+    console.println("Motor off");
     delay(3000);
   } // for
 } // loop()
\ No newline at end of file
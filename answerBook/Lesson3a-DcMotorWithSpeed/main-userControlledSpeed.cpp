@@ -7,6 +7,9 @@
  * @copyright Copyright (c) 2025
  */
 #include <Arduino.h>
+#include <BootSerial.h> // Output that never waits for a host, see lib/BootSerial.
+
+BootSerial console(Serial); // Use instead of Serial, it never blocks.
 
 // Pin definitions
 const int ENA = 9;   // PWM pin for Motor A speed
@@ -53,7 +56,7 @@ void setupPwm() {
   
   // Start timer
   GPT0_GTCR |= (1 << 24);
-  Serial.println("GPT PWM initialized: ~4 kHz on pin 9");
+  console.println("GPT PWM initialized: ~4 kHz on pin 9");
 }
 
 /**
@@ -70,7 +73,7 @@ void setPwmDuty(uint8_t duty) {
 void setupPwm() {
   pinMode(ENA, OUTPUT);
   analogWriteResolution(8); // 8-bit (0-255)
-  Serial.println("Default PWM initialized: ~490 Hz on pin 9");
+  console.println("Default PWM initialized: ~490 Hz on pin 9");
 }
 
 /**
@@ -85,21 +88,18 @@ void setPwmDuty(uint8_t duty) {
  * @brief Initializes serial communication.
  */
 void setupSerial() {
-  Serial.begin(115200);
-  while (!Serial) {
-    ; // Wait for Serial Monitor
-  }
-  Serial.println("Enter a number between 0 and 255 for Motor A speed:");
+  console.begin(115200);
+  console.println("Enter a number between 0 and 255 for Motor A speed:");
 }
 
 /**
  * @brief Checks user input and sets motor speed.
  */
 void checkUserInput() {
-  while (Serial.available() == 0) {
-    ; // Wait for input
+  while (console.available() == 0) {
+    console.poll(); // Send the prompt once a host is listening.
   }
-  String userInput = Serial.readStringUntil('\n');
+  String userInput = console.readStringUntil('\n');
   userInput.trim();
   if (userInput.toInt() > 0 || userInput == "0") {
     int number = userInput.toInt();
@@ -111,10 +111,10 @@ void checkUserInput() {
           delay(200);
           setPwmDuty(number); // User speed
           delay(100);
-          Serial.print("Kick-start attempt ");
-          Serial.print(attempt);
-          Serial.print(" at PWM ");
-          Serial.println(number);
+          console.print("Kick-start attempt ");
+          console.print(attempt);
+          console.print(" at PWM ");
+          console.println(number);
           if (attempt < 3) {
             delay(100);
           }
@@ -122,16 +122,16 @@ void checkUserInput() {
       } else {
         setPwmDuty(0); // Stop motor
       }
-      Serial.print("Valid input received: ");
-      Serial.print(number);
-      Serial.println(" (Motor A speed set with enhanced kick-start)");
+      console.print("Valid input received: ");
+      console.print(number);
+      console.println(" (Motor A speed set with enhanced kick-start)");
     } else {
-      Serial.println("Error: Number must be between 0 and 255!");
+      console.println("Error: Number must be between 0 and 255!");
     }
   } else {
-    Serial.println("Error: Invalid input! Please enter a number.");
+    console.println("Error: Invalid input! Please enter a number.");
   }
-  Serial.println("Enter a number between 0 and 255 for Motor A speed:");
+  console.println("Enter a number between 0 and 255 for Motor A speed:");
 }
 
 /**
@@ -150,5 +150,6 @@ void setup() {
  * @brief Main loop.
  */
 void loop() {
+  console.poll(); // Send output that is waiting for the port.
   checkUserInput();
 }
\ No newline at end of file
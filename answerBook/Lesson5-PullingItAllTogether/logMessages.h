@@ -0,0 +1,41 @@
+/**
+ * @file logMessages.h
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Every message the Lesson 5 sketch logs with BinLog.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details
+ * Copy this file into src/ next to main.cpp. The sketch only uses the ids. The
+ * text is compiled into the binLogDecode host program (or into the sketch
+ * when LOG_AS_TEXT is 1). Add new messages at the end, so the ids of the old
+ * ones stay the same and logs captured earlier still decode.
+ */
+#ifndef LOG_MESSAGES_H
+#define LOG_MESSAGES_H
+
+#include <BinLog.h>
+
+#define LOG_MESSAGES(X)                                              \
+  X(LOG_SETUP_START, "<setup> Start of setup.")                      \
+  X(LOG_SETUP_MATRIX, "<setup> Initialize LED display.")             \
+  X(LOG_SETUP_MOTOR, "<setup> Set up DC motor control pins.")        \
+  X(LOG_SETUP_SERVO, "<setup> Set up Servo motor control pin.")      \
+  X(LOG_SETUP_END, "<setup> End of setup.")                          \
+  X(LOG_JOYSTICK, "<checkJoystick> x = %d, y = %d, b = %d")          \
+  X(LOG_BUTTON, "<checkJoystick> Button pressed.")                   \
+  X(LOG_GO_FORWARD, "<goForward> Forward.")                          \
+  X(LOG_GO_BACKWARD, "<goBackward> Backward.")
+
+enum LogMessage : uint8_t
+{
+  LOG_MESSAGES(BINLOG_ENUM)
+  LOG_MESSAGE_COUNT
+};
+
+static_assert(LOG_MESSAGE_COUNT <= BINLOG_ID_DROPPED,
+              "Too many log messages, BinLog ids are one byte");
+
+#endif // LOG_MESSAGES_H
@@ -0,0 +1,202 @@
+/**
+ * @file main-binLogBench.cpp
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Measure what one log call costs the control code: BinLog versus
+ * Serial.println().
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details
+ * Times the messages the Lesson 5 sketch logs, one way and then the other:
+ * 1. BinLog::log() with no arguments and with the three joystick readings.
+ * 2. Serial.println() of the same text with an empty transmit buffer, the
+ *    best case.
+ * 3. Serial.println() of the joystick line 100 times in a row, so the
+ *    transmit buffer fills and every call has to wait for the port, which
+ *    is what a burst of messages does to the control loop.
+ * 4. BinLog::drain() per frame, the cost that moved to idle time.
+ * Each result is the average time per call in microseconds. The results are
+ * printed once, as text, after setup(). Needs logMessages.h next to it in src/.
+ */
+#include <Arduino.h>
+#include <BinLog.h>
+#include "logMessages.h"
+
+// Calls per timed batch. Less than BINLOG_SLOTS so no message is dropped.
+#define BATCH 16
+
+// Batches per measurement.
+#define BATCHES 64
+
+// Lines sent back to back in the sustained Serial.println() test.
+#define BURST 100
+
+BinLog binLog;
+
+int xValue = 509; // Typical joystick readings.
+int yValue = 511;
+int bValue = 500;
+
+// Forward function declarations (not reqiured for Arduino IDE) but is required
+// for PlatformIO IDE.
+float timeBinLog(bool withArgs);
+float timeSerial(bool withArgs);
+float timeSerialBurst();
+float timeDrain();
+void printResult(const char *name, float us);
+
+/**
+ * @brief Standard Arduino setup function, runs the benchmark once.
+ */
+void setup()
+{
+  Serial.begin(115200);
+  while (!Serial)
+  {
+    delay(10);
+  } // while
+  delay(1000); // Let the Serial Monitor connect.
+  Serial.println("\nBinLog benchmark, average us per call");
+
+  float logNoArgs = timeBinLog(false);
+  float logArgs = timeBinLog(true);
+  float printNoArgs = timeSerial(false);
+  float printArgs = timeSerial(true);
+  float printBurst = timeSerialBurst();
+  float drainFrame = timeDrain();
+
+  Serial.println();
+  printResult("BinLog::log(), no arguments", logNoArgs);
+  printResult("BinLog::log(), joystick x, y, b", logArgs);
+  printResult("Serial.println(), empty buffer", printNoArgs);
+  printResult("Serial print x, y, b, empty buffer", printArgs);
+  printResult("Serial print x, y, b, 100 in a row", printBurst);
+  printResult("BinLog::drain() per frame (idle time)", drainFrame);
+  Serial.print("BinLog dropped: ");
+  Serial.println(binLog.dropped());
+} // setup()
+
+/**
+ * @brief Standard Arduino loop function. Nothing to do.
+ */
+void loop()
+{
+} // loop()
+
+/**
+ * @brief Average time of one BinLog::log() call. The ring is emptied between
+ * batches, outside the timed part.
+ */
+float timeBinLog(bool withArgs)
+{
+  unsigned long totalUs = 0;
+  for (int batch = 0; batch < BATCHES; batch++)
+  {
+    binLog.clear();
+    unsigned long start = micros();
+    for (int i = 0; i < BATCH; i++)
+    {
+      if (withArgs)
+      {
+        binLog.log(LOG_JOYSTICK, xValue, yValue, bValue);
+      }
+      else
+      {
+        binLog.log(LOG_GO_FORWARD);
+      } // else
+    } // for
+    totalUs += micros() - start;
+  } // for
+  binLog.clear();
+  return (float)totalUs / (BATCHES * BATCH);
+} // timeBinLog()
+
+/**
+ * @brief Average time of one Serial.println() with room in the transmit
+ * buffer. One line per batch, then wait until it has been sent.
+ */
+float timeSerial(bool withArgs)
+{
+  unsigned long totalUs = 0;
+  for (int batch = 0; batch < BATCHES; batch++)
+  {
+    Serial.flush();
+    unsigned long start = micros();
+    if (withArgs)
+    {
+      Serial.print("<checkJoystick> x = ");
+      Serial.print(xValue);
+      Serial.print(", y = ");
+      Serial.print(yValue);
+      Serial.print(", b = ");
+      Serial.println(bValue);
+    }
+    else
+    {
+      Serial.println("<goForward> Forward.");
+    } // else
+    totalUs += micros() - start;
+  } // for
+  Serial.flush();
+  return (float)totalUs / BATCHES;
+} // timeSerial()
+
+/**
+ * @brief Average time of a joystick line when many are sent back to back.
+ */
+float timeSerialBurst()
+{
+  Serial.flush();
+  unsigned long start = micros();
+  for (int i = 0; i < BURST; i++)
+  {
+    Serial.print("<checkJoystick> x = ");
+    Serial.print(xValue);
+    Serial.print(", y = ");
+    Serial.print(yValue);
+    Serial.print(", b = ");
+    Serial.println(bValue);
+  } // for
+  unsigned long totalUs = micros() - start;
+  Serial.flush();
+  return (float)totalUs / BURST;
+} // timeSerialBurst()
+
+/**
+ * @brief Average time to send one joystick frame with BinLog::drain(). The
+ * frames are real, so they show up as a few bytes of binary in the monitor.
+ */
+float timeDrain()
+{
+  unsigned long totalUs = 0;
+  unsigned long frames = 0;
+  for (int batch = 0; batch < BATCHES; batch++)
+  {
+    for (int i = 0; i < BATCH; i++)
+    {
+      binLog.log(LOG_JOYSTICK, xValue, yValue, bValue);
+    } // for
+    Serial.flush();
+    unsigned long start = micros();
+    size_t sent = binLog.drain(Serial, Serial.availableForWrite());
+    totalUs += micros() - start;
+    frames += sent / (BINLOG_FRAME_HEADER + 3 * 4);
+    binLog.clear(); // Whatever did not fit.
+  } // for
+  Serial.flush();
+  if (frames == 0)
+  {
+    return 0; // This port reports no buffer space, nothing would drain.
+  } // if
+  return (float)totalUs / frames;
+} // timeDrain()
+
+void printResult(const char *name, float us)
+{
+  Serial.print(name);
+  Serial.print(": ");
+  Serial.print(us, 2);
+  Serial.println(" us");
+} // printResult()
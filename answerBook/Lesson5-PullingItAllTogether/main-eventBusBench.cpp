@@ -0,0 +1,241 @@
+/**
+ * @file main-eventBusBench.cpp
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Measure the EventBus library: what publish() and poll() cost and how
+ * many events a timer interrupt can hand to loop().
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details
+ * No wiring needed. The sketch times, with the CPU cycle counter
+ * (lib/CycleProfiler):
+ * 1. publish() and poll() of a JoystickSample with one subscriber.
+ * 2. The same with three subscribers. publish() copies the event three
+ *    times and each subscriber polls its own copy. Both figures are per
+ *    event, so poll is three polls.
+ * 3. A timer interrupt that publishes ISR_HZ events a second while loop()
+ *    polls them for ISR_SECONDS. Every event carries a number, so loop()
+ *    checks that none went missing or came twice, apart from the ones the
+ *    topic counted as overruns.
+ * The results are printed once, after setup(). Step 3 needs the UNO R4's
+ * timer interrupt, on the host it reports that no interrupt ran.
+ */
+#include <Arduino.h>
+#include <FspTimer.h>
+#include <CycleProfiler.h> // CycleCounter, see lib/CycleProfiler.
+#include <EventBus.h>      // See lib/EventBus.
+
+// Events per measurement in steps 1 and 2.
+#define EVENTS 10000
+
+// Events published before they are polled, at most the queue size - 1.
+#define BATCH 15
+
+// Interrupt rate and length of step 3.
+#define ISR_HZ 20000
+#define ISR_SECONDS 2
+
+EVENT_TOPIC(oneTopic, JoystickSample, BATCH + 1, 1);   // Steps 1 and 3.
+EVENT_TOPIC(threeTopic, JoystickSample, BATCH + 1, 3); // Step 2.
+uint8_t oneReader;
+uint8_t threeReaders[3];
+
+FspTimer isrTimer;
+volatile uint16_t isrCount = 0; // Numbers the interrupt's events.
+
+// Forward function declarations (not reqiured for Arduino IDE) but is required
+// for PlatformIO IDE.
+void timeTopic(const char *name, uint8_t subscribers);
+void timeInterrupt();
+void onIsrTimer(timer_callback_args_t *args);
+bool setupIsrTimer();
+
+/**
+ * @brief Standard Arduino setup function, runs the benchmark once.
+ */
+void setup()
+{
+  Serial.begin(115200);
+  while (!Serial)
+  {
+    delay(10);
+  } // while
+  delay(1000); // Let the Serial Monitor connect.
+  CycleCounter::begin();
+  oneReader = oneTopic.subscribe();
+  for (uint8_t i = 0; i < 3; i++)
+  {
+    threeReaders[i] = threeTopic.subscribe();
+  } // for
+
+  Serial.println("\nEventBus benchmark, JoystickSample events");
+  timeTopic("1 subscriber", 1);
+  timeTopic("3 subscribers", 3);
+  timeInterrupt();
+} // setup()
+
+/**
+ * @brief Standard Arduino loop function. Nothing to do.
+ */
+void loop()
+{
+} // loop()
+
+/**
+ * @brief Publish EVENTS events in batches and poll each batch back from
+ * every subscriber, timing the two separately.
+ */
+void timeTopic(const char *name, uint8_t subscribers)
+{
+  JoystickSample sample = {0, 512, 512, 500};
+  uint32_t publishCycles = 0;
+  uint32_t pollCycles = 0;
+  uint32_t received = 0;
+  for (uint16_t round = 0; round < EVENTS / BATCH; round++)
+  {
+    uint32_t start = CycleCounter::now();
+    for (uint8_t i = 0; i < BATCH; i++)
+    {
+      sample.sampledUs = i;
+      if (subscribers == 1)
+      {
+        oneTopic.publish(sample);
+      }
+      else
+      {
+        threeTopic.publish(sample);
+      } // else
+    } // for
+    uint32_t published = CycleCounter::now();
+    for (uint8_t i = 0; i < BATCH; i++)
+    {
+      if (subscribers == 1)
+      {
+        received += oneTopic.poll(oneReader, sample);
+      }
+      else
+      {
+        for (uint8_t reader = 0; reader < 3; reader++)
+        {
+          received += threeTopic.poll(threeReaders[reader], sample);
+        } // for
+      } // else
+    } // for
+    uint32_t polled = CycleCounter::now();
+    publishCycles += published - start;
+    pollCycles += polled - published;
+  } // for
+
+  uint32_t events = (EVENTS / BATCH) * BATCH;
+  float publishUs = (float)publishCycles / events / CycleCounter::perUs();
+  float pollUs = (float)pollCycles / events / CycleCounter::perUs();
+  Serial.print(name);
+  Serial.print(": publish ");
+  Serial.print(publishCycles / events);
+  Serial.print(" cycles (");
+  Serial.print(publishUs, 3);
+  Serial.print(" us), poll ");
+  Serial.print(pollCycles / events);
+  Serial.print(" cycles (");
+  Serial.print(pollUs, 3);
+  Serial.print(" us), ");
+  Serial.print(1.0f / (publishUs + pollUs), 2);
+  Serial.print(" M events/s, polled ");
+  Serial.print(received);
+  Serial.print("/");
+  Serial.println(events * subscribers);
+} // timeTopic()
+
+/**
+ * @brief Interrupt handler: publish one numbered event.
+ */
+void onIsrTimer(timer_callback_args_t *args)
+{
+  (void)args;
+  JoystickSample sample = {(uint32_t)micros(), (int16_t)isrCount, 0, 0};
+  isrCount++;
+  oneTopic.publish(sample);
+} // onIsrTimer()
+
+/**
+ * @brief Start a free GPT timer that interrupts ISR_HZ times a second.
+ * @return false if no timer was free.
+ */
+bool setupIsrTimer()
+{
+  uint8_t timer_type = GPT_TIMER;
+  int8_t channel = FspTimer::get_available_timer(timer_type);
+  if (channel < 0)
+  {
+    return false;
+  } // if
+  if (!isrTimer.begin(TIMER_MODE_PERIODIC, timer_type, channel, (float)ISR_HZ,
+                      0.0f, onIsrTimer))
+  {
+    return false;
+  } // if
+  isrTimer.setup_overflow_irq();
+  isrTimer.open();
+  isrTimer.start();
+  return true;
+} // setupIsrTimer()
+
+/**
+ * @brief Poll the interrupt's events for ISR_SECONDS and check their numbers.
+ */
+void timeInterrupt()
+{
+  if (!setupIsrTimer())
+  {
+    Serial.println("Interrupt: no free timer.");
+    return;
+  } // if
+  uint32_t overrunsBefore = oneTopic.overruns(oneReader);
+  uint32_t received = 0;
+  uint32_t missing = 0;
+  uint32_t maxDelayUs = 0;
+  uint16_t expected = 0;
+  bool first = true;
+  JoystickSample sample;
+  unsigned long start = millis();
+  while (millis() - start < ISR_SECONDS * 1000UL)
+  {
+    while (oneTopic.poll(oneReader, sample))
+    {
+      uint16_t number = (uint16_t)sample.x;
+      if (!first && number != expected)
+      {
+        missing += (uint16_t)(number - expected);
+      } // if
+      first = false;
+      expected = number + 1;
+      received++;
+      uint32_t delayUs = micros() - sample.sampledUs;
+      if (delayUs > maxDelayUs)
+      {
+        maxDelayUs = delayUs;
+      } // if
+    } // while
+  } // while
+  isrTimer.stop();
+  uint32_t overruns = oneTopic.overruns(oneReader) - overrunsBefore;
+
+  if (received == 0)
+  {
+    Serial.println("Interrupt: no events, the timer interrupt did not run (host build?).");
+    return;
+  } // if
+  Serial.print("Interrupt at ");
+  Serial.print(ISR_HZ);
+  Serial.print(" Hz: received ");
+  Serial.print(received / ISR_SECONDS);
+  Serial.print("/s, overruns ");
+  Serial.print(overruns);
+  Serial.print(", missing ");
+  Serial.print(missing);
+  Serial.print(" (should equal overruns), longest publish to poll ");
+  Serial.print(maxDelayUs);
+  Serial.println(" us");
+} // timeInterrupt()
@@ -0,0 +1,515 @@
+/**
+ * @file main-freertos.cpp
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Lesson 5 split into FreeRTOS tasks: input, motor and servo, display
+ * and telemetry each run on their own schedule.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details
+ * main.cpp reads the joystick, drives the motor and the servo, draws the LED
+ * matrix and logs, one after the other, every 200 ms. Whatever is slowest
+ * sets the pace for all of it. Here each job is a task of the FreeRTOS port
+ * that comes with the UNO R4 core (Arduino_FreeRTOS), highest priority
+ * first:
+ *
+ *   task       priority  runs
+ *   input      4         every INPUT_MS, reads the joystick
+ *   actuation  3         when a reading arrives, sets the motor and servo
+ *   display    2         when a reading arrives, draws the LED matrix
+ *   telemetry  1         prints direction changes and the report
+ *   idleMeter  0         measures the time nothing else needs the CPU
+ *
+ * The input task hands each reading to the actuation and display tasks
+ * through one-slot queues that it overwrites (xQueueOverwrite()), so a slow
+ * task always gets the newest reading and never a backlog. Direction changes
+ * go to the telemetry task through a longer queue. When that queue is full
+ * the change is dropped and counted instead of holding up the input task.
+ *
+ * Every REPORT_MS the telemetry task prints, per task:
+ * - runs and response latency (average and longest). For the actuation,
+ *   display and telemetry tasks this is the time from reading the joystick
+ *   until the task has acted on it. For the input task it is how far each
+ *   wake-up was from INPUT_MS after the one before.
+ * - stack use: the most the task ever used (from its high-water mark)
+ *   against what it was given.
+ * And the share of the CPU left idle, counted by the idleMeter task. It
+ * spins on the cycle counter and adds up every short step between two
+ * readings. A long step means another task or an interrupt ran. This is
+ * needed because the core's FreeRTOS is built without run time statistics.
+ *
+ * Same wiring as main.cpp. Copy this file into src/ instead of main.cpp.
+ */
+#include <Arduino.h>
+#include <Arduino_FreeRTOS.h> // Part of the Renesas core.
+#include <Arduino_LED_Matrix.h>
+#include <Servo.h>
+#include <L298N.h>        // Motor controller driver, see lib/L298N.
+#include <CycleProfiler.h> // CycleCounter, see lib/CycleProfiler.
+
+// Time between joystick readings in milliseconds (200 in main.cpp).
+#define INPUT_MS 20
+
+// How often the telemetry task prints the report (milliseconds).
+#define REPORT_MS 5000
+
+// Direction changes waiting to be printed.
+#define TELEMETRY_QUEUE 8
+
+// Task priorities, higher runs first. The FreeRTOS idle task is 0.
+#define INPUT_PRIORITY 4
+#define ACTUATION_PRIORITY 3
+#define DISPLAY_PRIORITY 2
+#define TELEMETRY_PRIORITY 1
+#define IDLE_METER_PRIORITY 0
+
+// Task stacks in words (4 bytes each). Unmeasured starting values: the
+// report's stack column shows the most each task has used, so trim each
+// stack to that plus about a quarter, and check again after adding code to a
+// task.
+#define INPUT_STACK 160
+#define ACTUATION_STACK 160
+#define DISPLAY_STACK 192
+#define TELEMETRY_STACK 320
+#define IDLE_METER_STACK 96
+
+// Steps of the idleMeter task longer than this (CPU cycles) were spent in
+// another task or an interrupt, so they are not idle time.
+#define IDLE_GAP_CYCLES 100
+
+#define SW_PIN   A2 // Arduino pin connected to Joystick SW pin
+#define VRX_PIN  A1 // Arduino pin connected to Joystick VRX pin
+#define VRY_PIN  A0 // Arduino pin connected to Joystick VRY pin
+#define enA1     A3 // DC Motor controller enable pin.
+#define inA1     A4 // DC Motor controller direction pin 1.
+#define inA2     A5 // DC Motor controller direction pin 2.
+#define servoPin D11 // Servo motor control pin.
+
+ArduinoLEDMatrix matrix; // Create LED matrix object.
+L298NChannel<enA1, inA1, inA2> motorA; // Motor A of the L298N.
+Servo servo;
+
+int servoForward = 115; // PWM rate for servo motor to go forward.
+int servoBackward = 55; // PWM rate for servo motor to go backward.
+int servoStop = 90; // PWM rate for servo motor to stop.
+
+/**
+ * @brief What the joystick asks for, see readJoystick().
+ */
+enum Direction : uint8_t
+{
+  DIR_NEUTRAL = 0,
+  DIR_FORWARD,
+  DIR_BACKWARD,
+  DIR_PRESSED
+};
+
+/**
+ * @brief One joystick reading, passed from the input task to the others.
+ */
+struct JoystickReading
+{
+  uint32_t sampledUs; // micros() when it was read.
+  int16_t x;
+  int16_t y;
+  int16_t b;
+  Direction direction;
+};
+
+/**
+ * @brief What one task measured. Only the task itself writes it, the
+ * telemetry task copies it with the scheduler stopped.
+ */
+struct TaskStats
+{
+  const char *name;
+  uint16_t stackWords;  // Stack given to the task.
+  TaskHandle_t handle;
+  uint32_t runs;
+  uint32_t latencySumUs;
+  uint32_t latencyMaxUs;
+};
+
+TaskStats inputStats = {"input", INPUT_STACK, nullptr, 0, 0, 0};
+TaskStats actuationStats = {"actuation", ACTUATION_STACK, nullptr, 0, 0, 0};
+TaskStats displayStats = {"display", DISPLAY_STACK, nullptr, 0, 0, 0};
+TaskStats telemetryStats = {"telemetry", TELEMETRY_STACK, nullptr, 0, 0, 0};
+TaskStats idleMeterStats = {"idleMeter", IDLE_METER_STACK, nullptr, 0, 0, 0};
+TaskStats *const allStats[] = {&inputStats, &actuationStats, &displayStats,
+                               &telemetryStats, &idleMeterStats};
+
+QueueHandle_t actuationQueue; // Newest reading for the actuation task.
+QueueHandle_t displayQueue;   // Newest reading for the display task.
+QueueHandle_t telemetryQueue; // Direction changes for the telemetry task.
+volatile uint32_t telemetryDropped = 0; // Changes the full queue turned away.
+volatile uint32_t idleCycles = 0; // Only goes up, wraps after 89 s of idle.
+
+// Forward function declarations (not reqiured for Arduino IDE) but is required
+// for PlatformIO IDE.
+void inputTask(void *parameter);
+void actuationTask(void *parameter);
+void displayTask(void *parameter);
+void telemetryTask(void *parameter);
+void idleMeterTask(void *parameter);
+bool startTask(TaskFunction_t function, TaskStats &stats, UBaseType_t priority);
+void noteRun(TaskStats &stats, uint32_t latencyUs);
+JoystickReading readJoystick();
+void printReading(const JoystickReading &reading);
+void printReport(uint32_t elapsedCycles, uint32_t idle);
+
+// Pre-defined 2D array of an arrow pointing Forward.
+byte forward[8][12] =
+{
+  { 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0 },
+  { 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0 },
+  { 0, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0 },
+  { 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1 },
+  { 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1 },
+  { 0, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0 },
+  { 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0 },
+  { 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0 }
+};
+
+// Pre-defined 2D array of an arrow pointing Backward.
+byte backward[8][12] =
+{
+  { 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0 },
+  { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0 },
+  { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 0 },
+  { 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1 },
+  { 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1 },
+  { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 0 },
+  { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 0 },
+  { 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0 }
+};
+
+// Pre-defined 2D array of a hollow box.
+byte Neutral[8][12] =
+{
+  { 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1 },
+  { 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1 },
+  { 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1 },
+  { 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1 },
+  { 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1 },
+  { 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1 },
+  { 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1 },
+  { 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1 }
+};
+
+// Pre-defined 2D array of a solid box.
+byte Pressed[8][12] =
+{
+  { 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1 },
+  { 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1 },
+  { 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1 },
+  { 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1 },
+  { 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1 },
+  { 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1 },
+  { 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1 },
+  { 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1 }
+};
+
+/**
+ * @brief Standard Arduino setup function. Sets up the hardware, creates the
+ * queues and tasks and hands the CPU to the scheduler.
+ */
+void setup()
+{
+  Serial.begin(115200);
+  CycleCounter::begin();
+  matrix.begin(); // Initialize LED matrix.
+  matrix.clear(); // Clear LED matrix.
+  motorA.begin();
+  servo.attach(servoPin);
+  servo.write(servoStop);
+
+  actuationQueue = xQueueCreate(1, sizeof(JoystickReading));
+  displayQueue = xQueueCreate(1, sizeof(JoystickReading));
+  telemetryQueue = xQueueCreate(TELEMETRY_QUEUE, sizeof(JoystickReading));
+  bool ok = actuationQueue != nullptr && displayQueue != nullptr &&
+            telemetryQueue != nullptr;
+  ok = ok && startTask(inputTask, inputStats, INPUT_PRIORITY);
+  ok = ok && startTask(actuationTask, actuationStats, ACTUATION_PRIORITY);
+  ok = ok && startTask(displayTask, displayStats, DISPLAY_PRIORITY);
+  ok = ok && startTask(telemetryTask, telemetryStats, TELEMETRY_PRIORITY);
+  ok = ok && startTask(idleMeterTask, idleMeterStats, IDLE_METER_PRIORITY);
+  if (!ok)
+  {
+    Serial.println("<setup> Not enough memory for the queues and tasks.");
+    return;
+  } // if
+  Serial.println("<setup> Starting the tasks.");
+  vTaskStartScheduler(); // Does not return.
+} // setup()
+
+/**
+ * @brief Standard Arduino loop function. Only runs if setup() failed, the
+ * tasks do the work.
+ */
+void loop()
+{
+} // loop()
+
+/**
+ * @brief Create a task with the stack and name in its stats.
+ * @return false if there was not enough memory.
+ */
+bool startTask(TaskFunction_t function, TaskStats &stats, UBaseType_t priority)
+{
+  return xTaskCreate(function, stats.name, stats.stackWords, nullptr, priority,
+                     &stats.handle) == pdPASS;
+} // startTask()
+
+/**
+ * @brief Count one run of a task and how long its response took.
+ */
+void noteRun(TaskStats &stats, uint32_t latencyUs)
+{
+  stats.runs++;
+  stats.latencySumUs += latencyUs;
+  if (latencyUs > stats.latencyMaxUs)
+  {
+    stats.latencyMaxUs = latencyUs;
+  } // if
+} // noteRun()
+
+/**
+ * @brief Read the joystick every INPUT_MS and pass the reading on.
+ * @details vTaskDelayUntil() wakes the task on a fixed schedule, however long
+ * the reading took.
+ */
+void inputTask(void *parameter)
+{
+  const uint32_t periodUs = INPUT_MS * 1000UL;
+  TickType_t lastWake = xTaskGetTickCount();
+  uint32_t lastUs = micros();
+  Direction last = DIR_NEUTRAL;
+  for (;;)
+  {
+    vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(INPUT_MS));
+    JoystickReading reading = readJoystick();
+    uint32_t intervalUs = reading.sampledUs - lastUs;
+    lastUs = reading.sampledUs;
+    xQueueOverwrite(actuationQueue, &reading);
+    xQueueOverwrite(displayQueue, &reading);
+    if (reading.direction != last)
+    {
+      last = reading.direction;
+      if (xQueueSend(telemetryQueue, &reading, 0) != pdPASS)
+      {
+        telemetryDropped++;
+      } // if
+    } // if
+    noteRun(inputStats, intervalUs > periodUs ? intervalUs - periodUs
+                                              : periodUs - intervalUs);
+  } // for
+} // inputTask()
+
+/**
+ * @brief Set the motor and the servo for the newest reading. A pressed
+ * button leaves them as they are, as in main.cpp.
+ */
+void actuationTask(void *parameter)
+{
+  JoystickReading reading;
+  Direction applied = DIR_NEUTRAL;
+  for (;;)
+  {
+    xQueueReceive(actuationQueue, &reading, portMAX_DELAY);
+    if (reading.direction != applied && reading.direction != DIR_PRESSED)
+    {
+      applied = reading.direction;
+      if (applied == DIR_FORWARD)
+      {
+        motorA.forward();
+        servo.write(servoForward);
+      }
+      else if (applied == DIR_BACKWARD)
+      {
+        motorA.reverse();
+        servo.write(servoBackward);
+      }
+      else
+      {
+        motorA.coast();
+        servo.write(servoStop);
+      } // else
+    } // if
+    noteRun(actuationStats, micros() - reading.sampledUs);
+  } // for
+} // actuationTask()
+
+/**
+ * @brief Draw the pattern for the newest reading. Redraws only on a change.
+ */
+void displayTask(void *parameter)
+{
+  JoystickReading reading;
+  bool drawn = false;
+  Direction shown = DIR_NEUTRAL;
+  for (;;)
+  {
+    xQueueReceive(displayQueue, &reading, portMAX_DELAY);
+    if (!drawn || reading.direction != shown)
+    {
+      drawn = true;
+      shown = reading.direction;
+      if (shown == DIR_PRESSED)
+      {
+        matrix.renderBitmap(Pressed, 8, 12);
+      }
+      else if (shown == DIR_FORWARD)
+      {
+        matrix.renderBitmap(forward, 8, 12);
+      }
+      else if (shown == DIR_BACKWARD)
+      {
+        matrix.renderBitmap(backward, 8, 12);
+      }
+      else
+      {
+        matrix.renderBitmap(Neutral, 8, 12);
+      } // else
+    } // if
+    noteRun(displayStats, micros() - reading.sampledUs);
+  } // for
+} // displayTask()
+
+/**
+ * @brief Print each direction change as it arrives and the report every
+ * REPORT_MS. The only task that writes to Serial.
+ */
+void telemetryTask(void *parameter)
+{
+  JoystickReading reading;
+  uint32_t windowStart = CycleCounter::now();
+  uint32_t idleAtStart = idleCycles;
+  TickType_t lastReport = xTaskGetTickCount();
+  for (;;)
+  {
+    if (xQueueReceive(telemetryQueue, &reading, pdMS_TO_TICKS(100)) == pdPASS)
+    {
+      printReading(reading);
+      noteRun(telemetryStats, micros() - reading.sampledUs);
+    } // if
+    if (xTaskGetTickCount() - lastReport >= pdMS_TO_TICKS(REPORT_MS))
+    {
+      lastReport = xTaskGetTickCount();
+      uint32_t now = CycleCounter::now();
+      uint32_t idle = idleCycles;
+      printReport(now - windowStart, idle - idleAtStart);
+      windowStart = now;
+      idleAtStart = idle;
+    } // if
+  } // for
+} // telemetryTask()
+
+/**
+ * @brief Runs whenever no other task wants the CPU and counts that time.
+ * @details The FreeRTOS idle task also has priority 0, but it yields to this
+ * one at once, so this task gets all of the idle time.
+ */
+void idleMeterTask(void *parameter)
+{
+  uint32_t last = CycleCounter::now();
+  for (;;)
+  {
+    uint32_t now = CycleCounter::now();
+    if (now - last < IDLE_GAP_CYCLES)
+    {
+      idleCycles += now - last;
+    } // if
+    last = now;
+  } // for
+} // idleMeterTask()
+
+/**
+ * @brief Read input values of the joystick and work out the direction.
+ * @details The Joystick returns 3 analog values: X, Y and button.
+ * X equals ~509 in the neutral position.
+ * X equals 1023 in the left position.
+ * X equals 0 in the right position.
+ * B equals ~500 in the neutral position.
+ * B equals 0 in the pressed position.
+ * The Y value is only passed on for the telemetry.
+ */
+JoystickReading readJoystick()
+{
+  JoystickReading reading;
+  reading.sampledUs = micros();
+  reading.b = analogRead(SW_PIN);
+  reading.x = analogRead(VRX_PIN);
+  reading.y = analogRead(VRY_PIN);
+  if (reading.b < 50)
+  {
+    reading.direction = DIR_PRESSED;
+  }
+  else if (reading.x < 50)
+  {
+    reading.direction = DIR_FORWARD;
+  }
+  else if (reading.x > 950)
+  {
+    reading.direction = DIR_BACKWARD;
+  }
+  else
+  {
+    reading.direction = DIR_NEUTRAL;
+  } // else
+  return reading;
+} // readJoystick()
+
+/**
+ * @brief Print one direction change.
+ */
+void printReading(const JoystickReading &reading)
+{
+  static const char *const names[] = {"Neutral", "Forward", "Backward", "Pressed"};
+  Serial.print("<telemetry> ");
+  Serial.print(names[reading.direction]);
+  Serial.print(": x = ");
+  Serial.print(reading.x);
+  Serial.print(", y = ");
+  Serial.print(reading.y);
+  Serial.print(", b = ");
+  Serial.println(reading.b);
+} // printReading()
+
+/**
+ * @brief Print runs, latency and stack use per task and the idle share of
+ * the CPU, then start a new window.
+ * @param elapsedCycles CPU cycles since the last report.
+ * @param idle Idle cycles counted in that time.
+ */
+void printReport(uint32_t elapsedCycles, uint32_t idle)
+{
+  TaskStats copies[sizeof(allStats) / sizeof(allStats[0])];
+  vTaskSuspendAll(); // No task changes its stats while they are copied.
+  for (uint8_t i = 0; i < sizeof(allStats) / sizeof(allStats[0]); i++)
+  {
+    copies[i] = *allStats[i];
+    allStats[i]->runs = 0;
+    allStats[i]->latencySumUs = 0;
+    allStats[i]->latencyMaxUs = 0;
+  } // for
+  xTaskResumeAll();
+
+  Serial.println("<report> task       runs  latency avg/max us  stack used/size words");
+  for (uint8_t i = 0; i < sizeof(allStats) / sizeof(allStats[0]); i++)
+  {
+    const TaskStats &stats = copies[i];
+    uint16_t used = stats.stackWords - uxTaskGetStackHighWaterMark(stats.handle);
+    char line[80];
+    snprintf(line, sizeof(line), "<report> %-9s %6lu  %8lu/%-8lu  %6u/%u", stats.name,
+             (unsigned long)stats.runs,
+             (unsigned long)(stats.runs ? stats.latencySumUs / stats.runs : 0),
+             (unsigned long)stats.latencyMaxUs, used, stats.stackWords);
+    Serial.println(line);
+  } // for
+  Serial.print("<report> CPU idle ");
+  Serial.print(100.0f * idle / elapsedCycles, 1);
+  Serial.print(" %, telemetry dropped ");
+  Serial.println(telemetryDropped);
+} // printReport()
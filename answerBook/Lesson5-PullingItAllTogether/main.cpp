@@ -11,6 +11,26 @@
 #include <Arduino_LED_Matrix.h> // Part of the Renesas core. Library manager 
                                 // not required.
 #include <Servo.h> // 
+#include <BinLog.h> // Deferred logging, see lib/BinLog.
+#include <L298N.h> // Motor controller driver, see lib/L298N.
+#include "logMessages.h" // The messages this sketch logs.
+
+// 1 = count the CPU cycles of the zones below. Send p in the Serial Monitor
+// for a report, r to clear it. 0 = the profiling code is left out.
+#define CYCLE_PROFILER 0
+#include <CycleProfiler.h> // See lib/CycleProfiler.
+
+// 1 = send the log as text for the Serial Monitor. 0 = send binary frames and
+// read them with the binLogDecode program (see the README).
+#define LOG_AS_TEXT 0
+
+// Time between joystick readings in milliseconds. The log is sent while the
+// sketch waits.
+#define LOOP_MS 200
+
+// Bytes sent per drainLog() to a port whose availableForWrite() is 0, so
+// it says nothing about its free space. One text line, or several frames.
+#define LOG_BLIND_BUDGET BINLOG_TEXT_MAX
 
 // Global variables and object declarations
 ArduinoLEDMatrix matrix; // Create LED matrix object.
@@ -21,7 +41,20 @@ ArduinoLEDMatrix matrix; // Create LED matrix object.
 #define inA1     A4 // DC Motor controller direction pin 1.
 #define inA2     A5 // DC Motor controller direction pin 1.
 #define servoPin D11 // Servo motor control pin.
+L298NChannel<enA1, inA1, inA2> motorA; // Motor A of the L298N.
 Servo servo;
+BinLog binLog; // Log messages waiting to be sent.
+
+#if LOG_AS_TEXT
+const char *const logFormats[] = { LOG_MESSAGES(BINLOG_FORMAT) };
+#endif
+
+PROFILE_ZONE(joystickZone, "checkJoystick");
+PROFILE_ZONE(analogReadZone, "analogRead x3");
+PROFILE_ZONE(renderZone, "matrix.renderBitmap");
+PROFILE_ZONE(stopZone, "stop");
+PROFILE_ZONE(forwardZone, "goForward");
+PROFILE_ZONE(backwardZone, "goBackward");
 
 int bValue = 0; // To store value of the button (push down on joystick).
 int xValue = 0; // To store value of the X axis.
@@ -37,6 +70,8 @@ void checkJoystick();
 void stop();
 void goForward();
 void goBackward();
+void drainLog();
+void showBitmap(byte bitmap[8][12]);
 
 // Pre-defined 2D array of an arrow pointing Forward.
 byte forward[8][12] = 
@@ -96,18 +131,17 @@ byte Pressed[8][12] =
 void setup() 
 {
    Serial.begin(115200);
-   Serial.println("<setup> Start of setup.");
-   Serial.println("<setup> Initialize LED diplay.");
+   PROFILE_BEGIN();
+   binLog.log(LOG_SETUP_START);
+   binLog.log(LOG_SETUP_MATRIX);
    matrix.begin(); // Initialize LED matrix.
    matrix.clear(); // Clear LED matrix.
-   Serial.println("<setup> Set up DC motor control pins.");
-   pinMode(enA1, OUTPUT);
-   pinMode(inA1, OUTPUT);
-   pinMode(inA2, OUTPUT);
-   Serial.println("<setup> Set up Servo motor control pin.");
+   binLog.log(LOG_SETUP_MOTOR);
+   motorA.begin();
+   binLog.log(LOG_SETUP_SERVO);
    servo.attach(servoPin);
    servo.write(servoStop);
-   Serial.println("<setup> End of setup.");
+   binLog.log(LOG_SETUP_END);
 } // setup()
 
 /**
@@ -115,10 +149,34 @@ void setup()
  */
 void loop() 
 {
+   unsigned long start = millis();
    checkJoystick();
-   delay(200);
+   while(millis() - start < LOOP_MS) // Idle time, send the log.
+   {
+      drainLog();
+      PROFILE_POLL(Serial);
+   } // while
 } // loop()
 
+/**
+ * @brief Send as much of the log as the serial port can take without waiting.
+ * A port that does not report its free space gets LOG_BLIND_BUDGET bytes and
+ * may wait while it sends them.
+ */
+void drainLog()
+{
+   size_t budget = Serial.availableForWrite();
+   if (budget == 0)
+   {
+      budget = LOG_BLIND_BUDGET;
+   } // if
+#if LOG_AS_TEXT
+   binLog.drainText(Serial, logFormats, LOG_MESSAGE_COUNT, budget);
+#else
+   binLog.drain(Serial, budget);
+#endif
+} // drainLog()
+
 /**
  * @brief Read input values of the joystick and act accordingly.
  * @details The Joystick returns 3 analog values: X, Y and button. 
@@ -136,30 +194,29 @@ void loop()
  */
 void checkJoystick()
 {
+  PROFILE_SCOPE(joystickZone);
   // Read joystick X, Y and button analog values.
-  bValue = analogRead(SW_PIN);
-  xValue = analogRead(VRX_PIN);
-  yValue = analogRead(VRY_PIN);
-
-  // Print joystick input reading to Serial Monitor.
-//   Serial.print("<checkJoystick> x = ");
-//   Serial.print(xValue);
-//   Serial.print(", y = ");
-//   Serial.print(yValue);
-//   Serial.print(", b = ");
-//   Serial.println(bValue);
+  {
+    PROFILE_SCOPE(analogReadZone);
+    bValue = analogRead(SW_PIN);
+    xValue = analogRead(VRX_PIN);
+    yValue = analogRead(VRY_PIN);
+  }
+
+  // Log joystick input reading. Cheap enough to do every pass.
+  binLog.log(LOG_JOYSTICK, xValue, yValue, bValue);
 
   // Display pattern on the LED matrix based on joystick input.
   if(bValue < 50)
   {
-    matrix.renderBitmap(Pressed, 8, 12);
-    Serial.println("<checkJoystick> Button pressed.");
+    showBitmap(Pressed);
+    binLog.log(LOG_BUTTON);
   return;
   } // if 
   
   if(xValue < 50)
   {
-    matrix.renderBitmap(forward, 8, 12);
+    showBitmap(forward);
 //    Serial.println("<checkJoystick> Forward.");
     goForward();
     return;
@@ -167,27 +224,34 @@ void checkJoystick()
 
   if(xValue > 950)
   {
-    matrix.renderBitmap(backward, 8, 12);
+    showBitmap(backward);
 //    Serial.println("<checkJoystick> Backward.");
     goBackward();
     return;
   } // else if
 
-  matrix.renderBitmap(Neutral, 8, 12);
+  showBitmap(Neutral);
   stop();
   return;
 } // checkJoyStick()
 
+/**
+ * @brief Show a pattern on the LED matrix.
+ */
+void showBitmap(byte bitmap[8][12])
+{
+  PROFILE_SCOPE(renderZone);
+  matrix.renderBitmap(bitmap, 8, 12);
+} // showBitmap()
+
 /**
  * @brief Spins motor clockwise (from motor's perspecive).
  * 
  */
 void stop() 
 {
-  // LM298N Motor Controller.
-  digitalWrite(enA1, LOW);
-  digitalWrite(inA1, LOW);
-  digitalWrite(inA2, LOW);
+  PROFILE_SCOPE(stopZone);
+  motorA.coast(); // LM298N Motor Controller.
   servo.write(servoStop);
 } // stop()
 
@@ -197,12 +261,10 @@ void stop()
  */
 void goForward() 
 {
-  // LM298N Motor Controller.
-  digitalWrite(enA1, HIGH);
-  digitalWrite(inA1, LOW);
-  digitalWrite(inA2, HIGH);
+  PROFILE_SCOPE(forwardZone);
+  motorA.forward(); // LM298N Motor Controller.
   servo.write(servoForward);
-  Serial.println("<goForward> Forward.");
+  binLog.log(LOG_GO_FORWARD);
 } // goForward()
 
 /**
@@ -211,9 +273,8 @@ void goForward()
  */
 void goBackward() 
 {
-  digitalWrite(enA1, HIGH);
-  digitalWrite(inA1, LOW);
-  digitalWrite(inA2, HIGH);
+  PROFILE_SCOPE(backwardZone);
+  motorA.reverse(); // LM298N Motor Controller.
   servo.write(servoBackward);
-  Serial.println("<checkJoystick> Backward.");
+  binLog.log(LOG_GO_BACKWARD);
 } // goBackward()
\ No newline at end of file
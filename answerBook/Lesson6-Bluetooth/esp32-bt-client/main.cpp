@@ -1,189 +1,1604 @@
 #include <Arduino.h>
 #include <BLEDevice.h>
-#include <BLEScan.h>
-#include <BLEAdvertisedDevice.h>
+#include <Preferences.h>
+#include <MemoryProbe.h>
+#include <RobotLink.h>
+#include <RobotClient.h>
+#include <atomic>
+#include <BootSerial.h> // Output that never waits for a host, see lib/BootSerial.
+
+BootSerial console(Serial); // Use instead of Serial, it never blocks.
 
 // Define the service and characteristic UUIDs (lowercase for consistency)
 #define SERVICE_UUID "19b10000-e8f2-537e-4f6c-d104768a1214"
 #define CHARACTERISTIC_UUID "19b10001-e8f2-537e-4f6c-d104768a1214"
 
-// Global variables
-BLEClient* pClient = nullptr;
-BLERemoteCharacteristic* pRemoteCharacteristic = nullptr;
-bool deviceConnected = false;
-bool doScan = false;
-bool ledState = false;
-bool connecting = false;
-unsigned long connectStartTime = 0;
-BLEAddress* serverAddress = nullptr;
+// Most servers (nodes) the client holds at once. The prebuilt Arduino ESP32
+// core lets the controller keep 3 BLE connections. More need a core built
+// with a higher CONFIG_BTDM_CTRL_BLE_MAX_CONN (9 at most).
+#define FLEET_MAX_NODES 3
+
+// Radio time one node needs in each connection event: a setpoint write, its
+// acknowledgement and a telemetry notification (microseconds). All nodes use
+// the same connection interval, long enough for every node to get one event.
+#define FLEET_EVENT_US 2500
+
+// Set to 1 to stream joystick setpoints as fast as the link allows instead
+// of toggling the LED every 2 seconds.
+#define STREAM_MODE 1
+
+// Setpoints produced per second in STREAM_MODE, for every node.
+#define STREAM_RATE_HZ 200
+
+// MTU we ask for. Bigger MTUs let more frames share one write.
+#define STREAM_MTU 247
+
+// Shortest connection interval, in 1.25 ms units (6 = 7.5 ms). Used while
+// few enough nodes are connected for all of them to fit in it.
+#define STREAM_MIN_CONN_INTERVAL 6
+
+// Connection parameters for a parked robot (see LinkActivity in RobotLink):
+// a 100 ms interval (1.25 ms units) and a slave latency of 2, so the server's
+// radio only has to wake every 300 ms. The first setpoint after parking can
+// take that long to arrive, every one after it goes at full speed again.
+#define IDLE_CONN_INTERVAL 80
+#define IDLE_SLAVE_LATENCY 2
+
+// How often the stream report is printed (milliseconds).
+#define STREAM_REPORT_MS 5000
+
+// Set to 1 to split the work between the two cores. The link task (scan,
+// connect, discovery, sending, reports) runs on core 0 next to the BLE
+// stack. The sampler task reads the joystick and makes the setpoints on core
+// 1 and hands them over through an SpscRing, so a blocking connect() no
+// longer holds them up. 0 = everything runs in loop().
+#define DUAL_CORE 1
+
+// Where the two tasks run. The sampler outranks everything else on core 1.
+// The link task stays below the BLE stack's own tasks on core 0.
+#define LINK_TASK_CORE 0
+#define LINK_TASK_PRIORITY 1
+#define LINK_TASK_STACK 8192
+#define SAMPLER_TASK_CORE 1
+#define SAMPLER_TASK_PRIORITY 5
+#define SAMPLER_TASK_STACK 3072
+
+// Setpoints waiting for the link task, 75 ms worth at 200 Hz.
+#define SETPOINT_RING 16
+
+// Resolution of the setpoint jitter histograms. 10 us x 128 buckets covers
+// 1.28 ms, a percentile beyond that shows the largest jitter seen.
+#define JITTER_BUCKET_US 10
+
+// Set to 1 if a joystick is wired to JOY_X_PIN / JOY_Y_PIN. Otherwise a
+// slow sweep is sent for 10 s out of every 30, so the link can be tested
+// (driving and parked) without one.
+#define JOYSTICK_CONNECTED 0
+#define JOY_X_PIN A2
+#define JOY_Y_PIN A3
+
+// Telemetry asked of the server. ROBOT_TELEMETRY_MODE_PACKED sends whole
+// samples, several per notification. ROBOT_TELEMETRY_MODE_FIELDS sends every
+// field on its own characteristic, only useful to compare the two.
+#define TELEMETRY_MODE ROBOT_TELEMETRY_MODE_PACKED
+
+// Telemetry samples per second, 0 = no telemetry.
+#define TELEMETRY_RATE_HZ 50
+
+// Longest the server may hold a sample while it fills a batch (milliseconds).
+#define TELEMETRY_HOLD_MS 100
+
+// How often the telemetry report is printed (milliseconds).
+#define TELEMETRY_REPORT_MS 5000
+
+// Telemetry while the link is idle. A parked robot changes slowly.
+#define TELEMETRY_IDLE_RATE_HZ 5
+#define TELEMETRY_IDLE_HOLD_MS 1000
+
+// How often each server's clock is pinged (milliseconds). The clock estimate
+// needs ROBOT_SYNC_WINDOW pings per point, so the first one-way times appear
+// after about a second.
+#define TIME_SYNC_MS 100
+#define TIME_SYNC_IDLE_MS 1000 // While the link is idle.
+
+// Set to 1 to remember the servers in flash (NVS) and reconnect to them
+// directly at boot and after a link loss, without scanning or service
+// discovery.
+#define FAST_RECONNECT 1
+
+// How long a direct connect to a remembered server may take before we give
+// up and scan instead (milliseconds).
+#define FAST_CONNECT_TIMEOUT_MS 1500
+
+// Bump when the server's GATT table changes so old cached handles are ignored.
+#define PEER_CACHE_VERSION 3
+
+// Seconds per scan before trying again.
+#define SCAN_SECONDS 30
+
+// Scan duty cycle: listen for SCAN_WINDOW_MS out of every SCAN_INTERVAL_MS.
+// The server advertises every 100 ms, so a 30 ms window still hears it within
+// a few advertisements while the radio is idle 70% of the time.
+#define SCAN_INTERVAL_MS 100
+#define SCAN_WINDOW_MS 30
+
+// Set to 1 to ask every device for its scan response. The server puts the
+// service UUID in its advertisement, so a passive scan finds it without the
+// extra request and response on air.
+#define SCAN_ACTIVE 0
+
+// Wait between failed connection attempts and between scans (milliseconds).
+#define RETRY_DELAY_MS 500
+
+// Time between two LED commands when not streaming (milliseconds).
+#define TOGGLE_INTERVAL_MS 2000
+
+// How often the heap low-water marks are sampled (milliseconds).
+#define MEMORY_SAMPLE_MS 1000
+
+// Per-node link states. loop() is the only code that changes a state.
+// BLE callbacks run in the BLE task and only raise flags.
+enum LinkState {
+  LINK_IDLE,           // Slot not in use.
+  LINK_CONNECT_CACHED, // Connect straight to the remembered server.
+  LINK_SEARCH,         // Wait for a scan to hear the server.
+  LINK_CONNECT_FOUND,  // Connect to the server a scan heard.
+  LINK_READY,          // Connected, commands flowing.
+  LINK_RETRY_WAIT      // Pause before searching again.
+};
+
+// The scan is shared by all nodes.
+enum ScanState {
+  SCAN_IDLE,
+  SCAN_RUNNING,
+  SCAN_STOPPING        // Stop asked for, waiting for the radio.
+};
+
+// Everything needed to talk to a server without scanning or discovery.
+// Saved in NVS so it survives a reset.
+struct PeerCache {
+  uint8_t version;             // PEER_CACHE_VERSION when written.
+  uint8_t address[6];          // Server Bluetooth address.
+  uint8_t addressType;         // esp_ble_addr_type_t.
+  bool handlesValid;           // The handles below came from a discovery.
+  uint16_t commandHandle;      // Value handle of the LED command characteristic.
+  uint16_t setpointHandle;     // Value handle of the setpoint stream (0 = none).
+  uint16_t setpointCccdHandle; // Its Client Characteristic Configuration descriptor.
+  uint16_t timeSyncHandle;     // Time sync ping/reply (0 = none).
+  uint16_t timeSyncCccdHandle;
+  uint16_t telemetryHandle;    // Packed telemetry (0 = none).
+  uint16_t telemetryCccdHandle;
+  uint16_t telemetryConfigHandle;
+  uint16_t fieldHandles[ROBOT_TELEMETRY_FIELDS];     // One per telemetry field.
+  uint16_t fieldCccdHandles[ROBOT_TELEMETRY_FIELDS];
+};
+
+struct Node;
+
+// A node's RobotClient sends through this. Each channel is one of the cached
+// handles of that node's server.
+class NodeTransport : public RobotLinkTransport {
+public:
+  explicit NodeTransport(Node* node) : node(node) {}
+  bool send(uint8_t channel, const uint8_t* data, size_t length) override;
+  uint16_t mtu() const override;
+
+private:
+  Node* node;
+};
+
+// One connected (or wanted) server. Every node has its own BLE client, cache
+// and RobotClient, so nodes never share sequence numbers or queues.
+struct Node {
+  uint8_t index;
+  PeerCache peer;
+  BLEClient* client;               // Created once, reused for every connection.
+  LinkState state;
+  unsigned long stateSinceMs;      // millis() when state last changed.
+  uint32_t readyCount;             // Times LINK_READY was reached.
+  bool ledState;
+  unsigned long lastToggleMs;
+
+  // Raised in the BLE task, handled in loop().
+  std::atomic<bool> linkLost;      // The server disconnected.
+  std::atomic<bool> cacheRejected; // Server refused a cached handle.
+  std::atomic<bool> telemetryConfigDirty; // MTU changed, send the config again.
+
+  // Time to first command, after boot or after a link loss.
+  std::atomic<uint32_t> linkDownUs; // When we started (re)connecting.
+  bool awaitingFirstCommand;
+  bool firstCommandFast;           // The path used for this measurement.
+  std::atomic<uint32_t> firstCommandUs; // Set in the BLE task, 0 = not yet.
+
+  // Setpoint stream and telemetry. RobotClient does the protocol, the
+  // transport maps its channels to this node's handles.
+  bool streamReady;
+  NodeTransport transport{this};
+  RobotClient robot{transport};
+  unsigned long lastTelemetryReportMs;
+  unsigned long lastTimeSyncMs;
+
+  // Connection parameters. A streaming link goes idle while the robot is
+  // parked and wakes on the first setpoint that changes.
+  LinkActivity activity;
+  unsigned long paramsAskedMs;        // When the last update was asked for.
+  std::atomic<uint16_t> linkInterval; // In effect (1.25 ms units), 0 = not known yet.
+  std::atomic<uint16_t> linkLatency;
+  std::atomic<bool> paramsUpdated;    // Set in the BLE task, reported by loop().
+};
+
+// A setpoint on its way to the nodes, with what is needed to time it.
+struct SampledSetpoint {
+  RobotSetpoint sp;
+  uint32_t intervalUs; // Since the setpoint before, 0 for the first one.
+  bool duringConnect;  // A connect (with its discovery) ran while it was made.
+};
+
+// Global variables. Everything the connection manager needs is allocated
+// here, once, so reconnecting never touches the heap.
+Node nodes[FLEET_MAX_NODES];
 const unsigned long CONNECT_TIMEOUT = 10000; // 10 seconds
+MemoryProbe memoryProbe;
+Preferences prefs;
+unsigned long lastProduceUs = 0;
+uint16_t connInterval = 0;         // Interval asked of every node (1.25 ms units).
+
+// Scanning. The BLE task appends matching servers to foundServers, loop()
+// hands them to nodes.
+struct FoundServer {
+  uint8_t address[6];
+  uint8_t addressType;
+} foundServers[FLEET_MAX_NODES];
+std::atomic<uint8_t> foundCount(0);   // Entries written (before the count is raised).
+uint8_t foundHandled = 0;             // Entries loop() has already looked at.
+std::atomic<bool> scanDone(false);    // The scan stopped or ran out of time.
+std::atomic<bool> scanRequested(false); // Start scanning once the parameters are set.
+std::atomic<uint32_t> advertisementsSeen(0); // Checked by the scan filter this scan.
+ScanState scanState = SCAN_IDLE;
+unsigned long scanStartMs = 0;
+unsigned long scanEndMs = 0;
+bool discoverMore = false;            // Scan for servers we do not know yet.
+uint8_t serviceUuid[16];              // SERVICE_UUID as sent on air (little-endian).
 
-// Static callback instance
+// Setpoint timing. connectEpoch goes up when a connect starts and again when
+// it ends, so it is odd while one runs. The histograms hold how far each
+// interval between two setpoints was from the period.
+std::atomic<uint32_t> connectEpoch(0);
+LatencyHistogram jitterQuiet(JITTER_BUCKET_US);
+LatencyHistogram jitterConnect(JITTER_BUCKET_US);
+#if DUAL_CORE
+SpscRing<SampledSetpoint, SETPOINT_RING> setpointRing; // Sampler to link task.
+#endif
+
+// Forward function declarations (not reqiured for Arduino IDE) but is required
+// for PlatformIO IDE.
+void runLink();
+void linkTask(void* parameter);
+void samplerTask(void* parameter);
+void enterState(Node& node, LinkState state);
+void runNode(Node& node);
+void runScanner();
+void assignFoundServer(const FoundServer& found);
+void handleSerialCommands();
+uint8_t countNodes(LinkState state);
+Node* nodeForClient(BLEClient* client);
+Node* nodeForGattcIf(esp_gatt_if_t gattcIf);
+Node* nodeForAddress(const uint8_t* address);
+void startScan();
+bool advertisesService(const uint8_t* data, size_t length);
+void onGapEvent(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t* param);
+bool loadPeerCache(Node& node);
+void savePeerCache(Node& node);
+void clearPeerCache(Node& node);
+void forgetPeerHandles(Node& node);
+bool connectToServer(Node& node, bool cached);
+bool discoverHandles(Node& node);
+bool findNotifyHandles(BLERemoteService* service, const char* uuid, uint16_t& valueHandle, uint16_t& cccdHandle);
+void subscribe(Node& node, uint16_t valueHandle, uint16_t cccdHandle);
+void subscribeNotifications(Node& node);
+bool writeHandle(Node& node, uint16_t handle, const uint8_t* data, uint16_t length, bool response);
+uint8_t channelForHandle(const Node& node, uint16_t handle);
+void printNodeName(const Node& node);
+void reportFirstCommand(Node& node);
+void markFirstCommand(Node& node);
+void onGattcEvent(esp_gattc_cb_event_t event, esp_gatt_if_t gattcIf, esp_ble_gattc_cb_param_t* param);
+uint16_t fleetConnInterval();
+void updateConnInterval();
+void requestConnInterval(Node& node);
+void setLinkPower(Node& node);
+void reportConnParams(Node& node);
+bool setUpStream(Node& node);
+void streamSetpoints();
+RobotSetpoint sampleSetpoint();
+SampledSetpoint makeSample(uint32_t& lastUs, uint32_t& lastEpoch);
+void distributeSetpoint(const RobotSetpoint& sp);
+void recordJitter(const SampledSetpoint& sample);
+void printJitterReport();
+void printStreamReport();
+void sendTelemetryConfig(Node& node);
+void processTelemetry(Node& node);
+void printTelemetryReport(Node& node);
+void syncClock(Node& node);
+
+// Static callback instance, shared by every node's client.
 class MyClientCallback : public BLEClientCallbacks {
   void onConnect(BLEClient* pclient) {
-    deviceConnected = true;
-    connecting = false;
-    Serial.println("Connected to server!");
   }
 
   void onDisconnect(BLEClient* pclient) {
-    deviceConnected = false;
-    doScan = true;
-    connecting = false;
-    Serial.println("Disconnected from server. Restarting scan...");
-  }
-} clientCallback;
-
-// Advertised device callbacks
-class MyAdvertisedDeviceCallbacks : public BLEAdvertisedDeviceCallbacks {
-  void onResult(BLEAdvertisedDevice advertisedDevice) {
-    Serial.print("Found device: ");
-    Serial.println(advertisedDevice.toString().c_str());
-
-    if (advertisedDevice.haveServiceUUID() && advertisedDevice.isAdvertisingService(BLEUUID(SERVICE_UUID))) {
-      Serial.println("Found UNO R4 Server!");
-      BLEDevice::getScan()->stop();
-      Serial.println("Scan stopped");
-
-      // Store the device address
-      serverAddress = new BLEAddress(advertisedDevice.getAddress());
-      Serial.print("Server address: ");
-      Serial.println(serverAddress->toString().c_str());
-
-      // Start connection process
-      connecting = true;
-      connectStartTime = millis();
-      Serial.println("Attempting to connect...");
+    Node* node = nodeForClient(pclient);
+    if (node != nullptr) {
+      node->linkDownUs = micros();
+      node->linkLost = true;
     }
   }
-};
+} clientCallback;
 
 void setup() {
-  Serial.begin(115200);
-  while (!Serial);
-  Serial.println("Starting BLE Client...");
-  Serial.print("Free heap: ");
-  Serial.println(ESP.getFreeHeap());
+  console.begin(115200);
+  console.println("Starting BLE Client...");
+
+  // Stacks worth watching: ours and the Bluedroid tasks.
+#if DUAL_CORE
+  memoryProbe.watchTask("link");
+  memoryProbe.watchTask("sampler");
+#else
+  memoryProbe.watchTask("loopTask");
+#endif
+  memoryProbe.watchTask("BTC_TASK");
+  memoryProbe.watchTask("BTU_TASK");
+  memoryProbe.watchTask("btController");
 
   // Initialize BLE with minimal connections
   BLEDevice::init("ESP32_Client");
+  console.mark("BLE radio on");
+#if STREAM_MODE
+  BLEDevice::setMTU(STREAM_MTU); // Asked for on every connection.
+#endif
   BLEDevice::setPower(ESP_PWR_LVL_N0); // Reduce power to minimize interference
+  BLEDevice::setCustomGattcHandler(onGattcEvent); // Handle-based writes and notifications.
+  BLEDevice::setCustomGapHandler(onGapEvent);     // Filtered scanning.
 
   // Enable BLE debug logging
   esp_log_level_set("BLE", ESP_LOG_VERBOSE);
 
-  // Start scanning
-  BLEScan* pBLEScan = BLEDevice::getScan();
-  pBLEScan->setAdvertisedDeviceCallbacks(new MyAdvertisedDeviceCallbacks());
-  pBLEScan->setInterval(100); // Match server advertising interval
-  pBLEScan->setWindow(80);    // Scanning window
-  pBLEScan->setActiveScan(true); // Active scan for faster discovery
-  pBLEScan->start(30, false);
-  doScan = true;
-  Serial.println("Scanning started");
+  // The scan filter compares raw advertisement bytes with our service UUID.
+  memcpy(serviceUuid, BLEUUID(SERVICE_UUID).getNative()->uuid.uuid128, sizeof(serviceUuid));
+
+  // Remembered servers are connected straight away. Only scan at boot if no
+  // server is remembered, send 's' to look for more.
+  uint8_t remembered = 0;
+  for (uint8_t i = 0; i < FLEET_MAX_NODES; i++) {
+    Node& node = nodes[i];
+    node.index = i;
+    node.linkDownUs = micros(); // Time to first command is measured from here.
+    node.awaitingFirstCommand = true;
+    if (loadPeerCache(node)) {
+      remembered++;
+      enterState(node, LINK_CONNECT_CACHED);
+    } else {
+      enterState(node, LINK_IDLE);
+    }
+  }
+  if (remembered > 0) {
+    console.print("Connecting to ");
+    console.print(remembered);
+    console.println(" remembered server(s), no scan");
+  } else {
+    discoverMore = true;
+  }
+  memoryProbe.report(console);
+  console.println("Send 'm' for a memory report, 's' to scan for more servers, 'f' to forget all servers");
+
+#if DUAL_CORE
+  xTaskCreatePinnedToCore(linkTask, "link", LINK_TASK_STACK, nullptr,
+                          LINK_TASK_PRIORITY, nullptr, LINK_TASK_CORE);
+#if STREAM_MODE
+  xTaskCreatePinnedToCore(samplerTask, "sampler", SAMPLER_TASK_STACK, nullptr,
+                          SAMPLER_TASK_PRIORITY, nullptr, SAMPLER_TASK_CORE);
+#endif
+#endif
 }
 
 void loop() {
-  Serial.print("Free heap: ");
-  Serial.println(ESP.getFreeHeap());
-
-  if (deviceConnected && pRemoteCharacteristic != nullptr) {
-    if (pRemoteCharacteristic->canWrite()) {
-      uint8_t message = ledState ? 1 : 0;
-      Serial.print("Attempting to send: ");
-      Serial.println(ledState ? "ON" : "OFF");
-      pRemoteCharacteristic->writeValue(message, true);
-      Serial.println("Write completed");
-      ledState = !ledState;
-    } else {
-      Serial.println("Characteristic cannot be written!");
-    }
-    delay(2000);
-  }
-
-  if (connecting && serverAddress != nullptr) {
-    unsigned long currentTime = millis();
-    if (currentTime - connectStartTime >= CONNECT_TIMEOUT) {
-      Serial.println("Connection timed out!");
-      connecting = false;
-      doScan = true;
-      if (pClient != nullptr) {
-        pClient->disconnect();
-      }
-      delete serverAddress;
-      serverAddress = nullptr;
-      return;
-    }
-
-    if (pClient == nullptr) {
-      Serial.println("Creating new BLE client...");
-      pClient = BLEDevice::createClient();
-      if (pClient == nullptr) {
-        Serial.println("Failed to create BLE client!");
-        connecting = false;
-        doScan = true;
-        delete serverAddress;
-        serverAddress = nullptr;
-        return;
-      }
-      pClient->setClientCallbacks(&clientCallback);
-    }
-
-    // Attempt connection
-    bool connectResult = false;
-    try {
-      Serial.println("Calling connect...");
-      connectResult = pClient->connect(*serverAddress);
-    } catch (...) {
-      Serial.println("Exception caught during connect!");
-    }
-    Serial.print("Connection attempt result: ");
-    Serial.println(connectResult ? "Success" : "Failed");
-    Serial.print("Connection time: ");
-    Serial.println(millis() - connectStartTime);
-
-    connecting = false;
-    if (!connectResult) {
-      Serial.println("Connection failed. Restarting scan...");
-      doScan = true;
-      pClient->disconnect();
-      delete serverAddress;
-      serverAddress = nullptr;
-      return;
-    }
-
-    // Discover service
-    Serial.println("Discovering service...");
-    BLERemoteService* pRemoteService = pClient->getService(BLEUUID(SERVICE_UUID));
-    if (pRemoteService == nullptr) {
-      Serial.println("Failed to find service UUID!");
-      pClient->disconnect();
-      doScan = true;
-      delete serverAddress;
-      serverAddress = nullptr;
-      return;
-    }
-    Serial.println("Service found");
-
-    // Discover characteristic
-    Serial.println("Discovering characteristic...");
-    pRemoteCharacteristic = pRemoteService->getCharacteristic(BLEUUID(CHARACTERISTIC_UUID));
-    if (pRemoteCharacteristic == nullptr) {
-      Serial.println("Failed to find characteristic UUID!");
-      pClient->disconnect();
-      doScan = true;
-      delete serverAddress;
-      serverAddress = nullptr;
-      return;
-    }
-    Serial.println("Characteristic found");
-    delete serverAddress;
-    serverAddress = nullptr;
-  }
-
-  if (!deviceConnected && doScan) {
-    Serial.println("Scanning for server...");
-    BLEDevice::getScan()->start(30, false);
-  }
-  delay(500);
-}
\ No newline at end of file
+#if DUAL_CORE
+  vTaskDelete(nullptr); // The link and sampler tasks do the work.
+#else
+  runLink();
+#endif
+}
+
+/**
+ * @brief The link task: runLink() over and over on LINK_TASK_CORE. It waits
+ * a tick between passes so the core's idle task (and its watchdog) still
+ * gets to run.
+ */
+void linkTask(void* parameter) {
+  for (;;) {
+    runLink();
+    vTaskDelay(1);
+  }
+}
+
+/**
+ * @brief The sampler task: makes a setpoint every period on
+ * SAMPLER_TASK_CORE, whatever the link task is doing, and hands it over.
+ * @details vTaskDelayUntil() keeps the period from drifting. A full ring
+ * (the link task stuck for 75 ms) drops the newest setpoint and counts it.
+ */
+void samplerTask(void* parameter) {
+  TickType_t lastWake = xTaskGetTickCount();
+  uint32_t lastUs = 0;
+  uint32_t lastEpoch = connectEpoch;
+  for (;;) {
+    vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(1000 / STREAM_RATE_HZ));
+    setpointRing.push(makeSample(lastUs, lastEpoch));
+  }
+}
+
+/**
+ * @brief One pass of the connection manager and the stream. Called by loop(),
+ * or by the link task with DUAL_CORE. Everything below that says loop() means
+ * whichever of the two runs this.
+ */
+void runLink() {
+  console.poll(); // Send output that is waiting for the port.
+  handleSerialCommands();
+
+  static unsigned long lastSample = 0;
+  if (millis() - lastSample >= MEMORY_SAMPLE_MS) {
+    lastSample = millis();
+    memoryProbe.sample();
+  }
+
+  runScanner();
+  for (uint8_t i = 0; i < FLEET_MAX_NODES; i++) {
+    reportFirstCommand(nodes[i]);
+    runNode(nodes[i]);
+  }
+#if STREAM_MODE
+  updateConnInterval();
+  streamSetpoints(); // No delay: loop() must keep up with the stream.
+#endif
+}
+
+/**
+ * @brief Change a node's state and note when it happened.
+ */
+void enterState(Node& node, LinkState state) {
+  node.state = state;
+  node.stateSinceMs = millis();
+}
+
+/**
+ * @brief One step of a node's connection manager. Only connect() blocks (for
+ * at most its timeout), every other state returns at once. While one node
+ * connects, the other nodes' streams pause. With DUAL_CORE the setpoints are
+ * still made on the other core and wait in the ring.
+ */
+void runNode(Node& node) {
+  bool connected;
+  switch (node.state) {
+    case LINK_IDLE:
+    case LINK_SEARCH:
+      break; // runScanner() moves these on.
+
+    case LINK_CONNECT_CACHED:
+    case LINK_CONNECT_FOUND:
+      // The radio cannot scan and connect at the same time.
+      if (scanState != SCAN_IDLE) {
+        break;
+      }
+      connectEpoch++; // Odd while connecting.
+      connected = connectToServer(node, node.state == LINK_CONNECT_CACHED);
+      connectEpoch++;
+      if (connected) {
+        enterState(node, LINK_READY);
+      } else if (node.state == LINK_CONNECT_CACHED) {
+        printNodeName(node);
+        console.println(": remembered server not answering, searching");
+        enterState(node, LINK_SEARCH);
+      } else {
+        enterState(node, LINK_RETRY_WAIT);
+      }
+      break;
+
+    case LINK_READY:
+      if (node.linkLost.exchange(false)) {
+        printNodeName(node);
+        console.println(": disconnected from server, reconnecting");
+        node.streamReady = false;
+        node.awaitingFirstCommand = true;
+        node.firstCommandUs = 0;
+        enterState(node, LINK_CONNECT_CACHED);
+        break;
+      }
+      // The server refused a cached handle (its GATT table changed). Forget
+      // the handles and drop the link, the reconnect runs a full discovery.
+      if (node.cacheRejected.exchange(false)) {
+        printNodeName(node);
+        console.println(": cached handles rejected, rediscovering");
+        forgetPeerHandles(node);
+        node.client->disconnect();
+        break;
+      }
+      if (node.telemetryConfigDirty.exchange(false)) {
+        sendTelemetryConfig(node); // Batch size follows the MTU.
+      }
+      if (node.paramsUpdated.exchange(false)) {
+        reportConnParams(node);
+      }
+      processTelemetry(node);
+      syncClock(node);
+      if (node.streamReady) {
+        break; // streamSetpoints() serves every streaming node.
+      }
+      if (millis() - node.lastToggleMs >= TOGGLE_INTERVAL_MS) {
+        node.lastToggleMs = millis();
+        uint8_t message = node.ledState ? 1 : 0;
+        printNodeName(node);
+        console.print(": sending ");
+        console.println(node.ledState ? "ON" : "OFF");
+        node.robot.sendCommand(message);
+        node.ledState = !node.ledState;
+      }
+      break;
+
+    case LINK_RETRY_WAIT:
+      if (millis() - node.stateSinceMs >= RETRY_DELAY_MS) {
+        enterState(node, LINK_SEARCH);
+      }
+      break;
+  }
+}
+
+/**
+ * @brief Run the shared scan. It runs while a node is searching for its
+ * server or while looking for more servers, and stops as soon as a node is
+ * waiting to connect or nothing is left to look for.
+ */
+void runScanner() {
+  bool connectPending = countNodes(LINK_CONNECT_CACHED) + countNodes(LINK_CONNECT_FOUND) > 0;
+  bool wanted = countNodes(LINK_SEARCH) > 0 || (discoverMore && countNodes(LINK_IDLE) > 0);
+
+  switch (scanState) {
+    case SCAN_IDLE:
+      if (wanted && !connectPending && millis() - scanEndMs >= RETRY_DELAY_MS) {
+        startScan();
+        scanState = SCAN_RUNNING;
+      }
+      break;
+
+    case SCAN_RUNNING:
+      while (foundHandled < foundCount.load(std::memory_order_acquire)) {
+        assignFoundServer(foundServers[foundHandled]);
+        foundHandled++;
+      }
+      if (scanDone) {
+        discoverMore = false; // Ran SCAN_SECONDS without filling the fleet.
+        scanState = SCAN_STOPPING;
+      } else if (connectPending || !wanted) {
+        esp_ble_gap_stop_scanning();
+        scanState = SCAN_STOPPING;
+      }
+      break;
+
+    case SCAN_STOPPING:
+      if (!scanDone) {
+        break;
+      }
+      scanEndMs = millis();
+      console.print("Scan stopped after ");
+      console.print(scanEndMs - scanStartMs);
+      console.print(" ms, servers found=");
+      console.print(foundHandled);
+      console.print(", advertisements checked=");
+      console.println(advertisementsSeen.load());
+      scanState = SCAN_IDLE;
+      break;
+  }
+}
+
+/**
+ * @brief Give a server the scan heard to the node that was searching for it,
+ * or to a free slot if it is new.
+ */
+void assignFoundServer(const FoundServer& found) {
+  Node* freeSlot = nullptr;
+  for (uint8_t i = 0; i < FLEET_MAX_NODES; i++) {
+    Node& node = nodes[i];
+    if (node.state == LINK_IDLE) {
+      if (freeSlot == nullptr) {
+        freeSlot = &node;
+      }
+      continue;
+    }
+    if (memcmp(node.peer.address, found.address, sizeof(found.address)) == 0) {
+      if (node.state == LINK_SEARCH) {
+        node.peer.addressType = found.addressType;
+        enterState(node, LINK_CONNECT_FOUND);
+      }
+      return; // Already ours.
+    }
+  }
+  if (freeSlot == nullptr) {
+    return; // Fleet is full.
+  }
+  memset(&freeSlot->peer, 0, sizeof(freeSlot->peer));
+  memcpy(freeSlot->peer.address, found.address, sizeof(found.address));
+  freeSlot->peer.addressType = found.addressType;
+  freeSlot->linkDownUs = micros();
+  freeSlot->awaitingFirstCommand = true;
+  freeSlot->firstCommandUs = 0;
+  printNodeName(*freeSlot);
+  console.println(": found UNO R4 Server");
+  enterState(*freeSlot, LINK_CONNECT_FOUND);
+}
+
+/**
+ * @brief Single letter commands from the Serial Monitor.
+ */
+void handleSerialCommands() {
+  if (!console.available()) {
+    return;
+  }
+  switch (console.read()) {
+    case 'm':
+      for (uint8_t i = 0; i < FLEET_MAX_NODES; i++) {
+        if (nodes[i].state == LINK_IDLE) {
+          continue;
+        }
+        printNodeName(nodes[i]);
+        console.print(": link ready count=");
+        console.println(nodes[i].readyCount);
+      }
+      memoryProbe.report(console);
+      break;
+    case 's':
+      console.println("Scanning for more servers");
+      discoverMore = true;
+      break;
+    case 'f':
+      console.println("Forgetting all servers");
+      for (uint8_t i = 0; i < FLEET_MAX_NODES; i++) {
+        Node& node = nodes[i];
+        if (node.state == LINK_READY) {
+          node.client->disconnect();
+        }
+        node.streamReady = false;
+        clearPeerCache(node);
+        enterState(node, LINK_IDLE);
+      }
+      discoverMore = true;
+      break;
+    default:
+      break;
+  }
+}
+
+/**
+ * @brief Number of nodes in a state.
+ */
+uint8_t countNodes(LinkState state) {
+  uint8_t count = 0;
+  for (uint8_t i = 0; i < FLEET_MAX_NODES; i++) {
+    if (nodes[i].state == state) {
+      count++;
+    }
+  }
+  return count;
+}
+
+/**
+ * @brief The node that owns a BLE client. Called in the BLE task.
+ */
+Node* nodeForClient(BLEClient* client) {
+  for (uint8_t i = 0; i < FLEET_MAX_NODES; i++) {
+    if (nodes[i].client == client) {
+      return &nodes[i];
+    }
+  }
+  return nullptr;
+}
+
+/**
+ * @brief The node connected to a server address. Called in the BLE task.
+ */
+Node* nodeForAddress(const uint8_t* address) {
+  for (uint8_t i = 0; i < FLEET_MAX_NODES; i++) {
+    if (nodes[i].client != nullptr && memcmp(nodes[i].peer.address, address, sizeof(nodes[i].peer.address)) == 0) {
+      return &nodes[i];
+    }
+  }
+  return nullptr;
+}
+
+/**
+ * @brief The node a GATT client event belongs to. Every BLE client registers
+ * its own GATT interface, so the interface tells the nodes apart.
+ */
+Node* nodeForGattcIf(esp_gatt_if_t gattcIf) {
+  for (uint8_t i = 0; i < FLEET_MAX_NODES; i++) {
+    if (nodes[i].client != nullptr && nodes[i].client->getGattcIf() == gattcIf) {
+      return &nodes[i];
+    }
+  }
+  return nullptr;
+}
+
+/**
+ * @brief Start a duty-cycled scan. The scan itself starts in onGapEvent() once
+ * the controller has taken the parameters.
+ *
+ * @details The scan is driven through the ESP-IDF GAP calls instead of
+ * BLEScan. BLEScan builds a BLEAdvertisedDevice (strings, UUID objects, a
+ * std::map) for every advertisement before our callback can look at it. In a
+ * room full of BLE devices that is most of the scan's CPU time, spent on
+ * devices we ignore.
+ */
+void startScan() {
+  console.println("Scanning for servers...");
+  foundCount = 0;
+  foundHandled = 0;
+  scanDone = false;
+  advertisementsSeen = 0;
+  scanStartMs = millis();
+
+  esp_ble_scan_params_t params = {};
+  params.scan_type = SCAN_ACTIVE ? BLE_SCAN_TYPE_ACTIVE : BLE_SCAN_TYPE_PASSIVE;
+  params.own_addr_type = BLE_ADDR_TYPE_PUBLIC;
+  params.scan_filter_policy = BLE_SCAN_FILTER_ALLOW_ALL;
+  params.scan_interval = SCAN_INTERVAL_MS * 8 / 5; // 0.625 ms units.
+  params.scan_window = SCAN_WINDOW_MS * 8 / 5;
+  params.scan_duplicate = BLE_SCAN_DUPLICATE_ENABLE; // The controller reports each device once.
+  scanRequested = true;
+  esp_ble_gap_set_scan_params(&params);
+}
+
+/**
+ * @brief Look for our service UUID in raw advertising data (advertisement
+ * followed by scan response). Only the 128-bit UUID lists are checked, every
+ * other field is skipped by its length byte.
+ */
+bool advertisesService(const uint8_t* data, size_t length) {
+  size_t i = 0;
+  while (i + 1 < length) {
+    size_t fieldLength = data[i]; // Type byte plus payload.
+    if (fieldLength == 0 || i + 1 + fieldLength > length) {
+      return false; // Padding or a malformed field.
+    }
+    uint8_t type = data[i + 1];
+    if (type == 0x06 || type == 0x07) { // Incomplete / complete 128-bit UUID list.
+      for (size_t j = i + 2; j + 16 <= i + 1 + fieldLength; j += 16) {
+        if (memcmp(data + j, serviceUuid, sizeof(serviceUuid)) == 0) {
+          return true;
+        }
+      }
+    }
+    i += 1 + fieldLength;
+  }
+  return false;
+}
+
+/**
+ * @brief GAP events, called in the BLE task. Runs for every advertisement
+ * heard, so it only compares bytes: nothing is printed, formatted or allocated.
+ */
+void onGapEvent(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t* param) {
+  switch (event) {
+    case ESP_GAP_BLE_SCAN_PARAM_SET_COMPLETE_EVT:
+      if (scanRequested.exchange(false)) {
+        esp_ble_gap_start_scanning(SCAN_SECONDS);
+      }
+      break;
+    case ESP_GAP_BLE_SCAN_RESULT_EVT: {
+      if (param->scan_rst.search_evt == ESP_GAP_SEARCH_INQ_CMPL_EVT) {
+        scanDone = true; // Ran for SCAN_SECONDS.
+        break;
+      }
+      if (param->scan_rst.search_evt != ESP_GAP_SEARCH_INQ_RES_EVT) {
+        break;
+      }
+      advertisementsSeen++;
+      uint8_t count = foundCount.load(std::memory_order_relaxed);
+      if (count >= FLEET_MAX_NODES ||
+          !advertisesService(param->scan_rst.ble_adv,
+                             param->scan_rst.adv_data_len + param->scan_rst.scan_rsp_len)) {
+        break;
+      }
+      for (uint8_t i = 0; i < count; i++) {
+        if (memcmp(foundServers[i].address, param->scan_rst.bda, sizeof(foundServers[i].address)) == 0) {
+          return; // Heard again.
+        }
+      }
+      memcpy(foundServers[count].address, param->scan_rst.bda, sizeof(foundServers[count].address));
+      foundServers[count].addressType = param->scan_rst.ble_addr_type;
+      foundCount.store(count + 1, std::memory_order_release);
+      break;
+    }
+    case ESP_GAP_BLE_SCAN_STOP_COMPLETE_EVT:
+      scanDone = true;
+      break;
+    case ESP_GAP_BLE_UPDATE_CONN_PARAMS_EVT: {
+      // Either side asked and the new parameters reached their instant.
+      Node* node = nodeForAddress(param->update_conn_params.bda);
+      if (node == nullptr || param->update_conn_params.status != ESP_BT_STATUS_SUCCESS) {
+        break;
+      }
+      node->linkInterval = param->update_conn_params.conn_int;
+      node->linkLatency = param->update_conn_params.latency;
+      node->paramsUpdated = true;
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+/**
+ * @brief Read a remembered server from NVS. Each node has its own key.
+ * @return true if there is a server worth connecting to directly.
+ */
+bool loadPeerCache(Node& node) {
+  memset(&node.peer, 0, sizeof(node.peer));
+#if FAST_RECONNECT
+  char key[] = "peer0";
+  key[4] = '0' + node.index;
+  prefs.begin("robotlink", true);
+  size_t length = prefs.getBytes(key, &node.peer, sizeof(node.peer));
+  prefs.end();
+  if (length != sizeof(node.peer) || node.peer.version != PEER_CACHE_VERSION) {
+    memset(&node.peer, 0, sizeof(node.peer));
+    return false;
+  }
+  // A zero address is no server. Older builds saved one to forget a server.
+  static const uint8_t noAddress[6] = {0};
+  if (memcmp(node.peer.address, noAddress, sizeof(noAddress)) == 0) {
+    memset(&node.peer, 0, sizeof(node.peer));
+    return false;
+  }
+  return true;
+#else
+  return false;
+#endif
+}
+
+/**
+ * @brief Write a node's server address and handles to NVS.
+ */
+void savePeerCache(Node& node) {
+#if FAST_RECONNECT
+  char key[] = "peer0";
+  key[4] = '0' + node.index;
+  node.peer.version = PEER_CACHE_VERSION;
+  prefs.begin("robotlink", false);
+  prefs.putBytes(key, &node.peer, sizeof(node.peer));
+  prefs.end();
+#endif
+}
+
+/**
+ * @brief Forget a node's server: clear it in RAM and delete its NVS key, so
+ * the next boot scans for a server instead of dialling a blank address.
+ */
+void clearPeerCache(Node& node) {
+  memset(&node.peer, 0, sizeof(node.peer));
+#if FAST_RECONNECT
+  char key[] = "peer0";
+  key[4] = '0' + node.index;
+  prefs.begin("robotlink", false);
+  prefs.remove(key);
+  prefs.end();
+#endif
+}
+
+/**
+ * @brief Keep the address but force a service discovery next time.
+ */
+void forgetPeerHandles(Node& node) {
+  node.peer.handlesValid = false;
+  savePeerCache(node);
+}
+
+/**
+ * @brief Connect a node to its server. Uses the cached handles when we have
+ * them, otherwise discovers them and saves them for next time.
+ * @param cached true if the address came from NVS or an earlier link rather
+ * than a scan.
+ * @return true when the link is ready for commands.
+ */
+bool connectToServer(Node& node, bool cached) {
+  if (node.client == nullptr) {
+    printNodeName(node);
+    console.println(": creating BLE client");
+    node.client = BLEDevice::createClient();
+    if (node.client == nullptr) {
+      console.println("Failed to create BLE client!");
+      return false;
+    }
+    node.client->setClientCallbacks(&clientCallback);
+  }
+
+  // A disconnect event left over from an earlier attempt must not end the
+  // link we are about to make.
+  node.linkLost = false;
+
+  // Attempt connection. A direct connect to a server that is switched off
+  // would wait for the whole timeout, so the cached path gets a short one.
+  unsigned long connectStartTime = millis();
+  BLEAddress address(node.peer.address);
+  uint32_t timeout = cached ? FAST_CONNECT_TIMEOUT_MS : CONNECT_TIMEOUT;
+  bool connectResult = node.client->connect(address, (esp_ble_addr_type_t)node.peer.addressType, timeout);
+  printNodeName(node);
+  console.print(": connection attempt ");
+  console.print(connectResult ? "Success" : "Failed");
+  console.print(" after ");
+  console.print(millis() - connectStartTime);
+  console.println(" ms");
+  if (!connectResult) {
+    return false;
+  }
+
+  node.firstCommandFast = cached && node.peer.handlesValid;
+  if (node.firstCommandFast) {
+    console.println("Using cached handles, skipping discovery");
+  } else if (!discoverHandles(node)) {
+    node.client->disconnect();
+    return false;
+  }
+
+  node.robot.resetTelemetry(); // Before subscribing, so no notification is running yet.
+  node.robot.resetTimeSync();  // The server may have reset, its clock with it.
+  node.linkInterval = 0;
+  node.telemetryConfigDirty = false;
+  subscribeNotifications(node);
+  sendTelemetryConfig(node);
+  node.readyCount++;
+  printNodeName(node);
+  console.print(": link ready #");
+  console.print(node.readyCount);
+  console.print(", free heap=");
+  console.print(memoryProbe.freeHeap());
+  console.print(" largest block=");
+  console.println(memoryProbe.largestFreeBlock());
+  node.lastToggleMs = millis() - TOGGLE_INTERVAL_MS; // First command right away.
+#if STREAM_MODE
+  if (!setUpStream(node)) {
+    console.println("Server has no setpoint stream, falling back to LED toggling");
+  }
+#endif
+  return true;
+}
+
+/**
+ * @brief Find the service and characteristics by UUID and remember their
+ * handles.
+ * @return false if the server does not have our service.
+ */
+bool discoverHandles(Node& node) {
+  PeerCache& peer = node.peer;
+
+  // Discover service
+  console.println("Discovering service...");
+  BLERemoteService* pRemoteService = node.client->getService(BLEUUID(SERVICE_UUID));
+  if (pRemoteService == nullptr) {
+    console.println("Failed to find service UUID!");
+    return false;
+  }
+  console.println("Service found");
+
+  // Discover characteristic
+  console.println("Discovering characteristic...");
+  BLERemoteCharacteristic* pCommand = pRemoteService->getCharacteristic(BLEUUID(CHARACTERISTIC_UUID));
+  if (pCommand == nullptr || !pCommand->canWrite()) {
+    console.println("Failed to find characteristic UUID!");
+    return false;
+  }
+  console.println("Characteristic found");
+  peer.commandHandle = pCommand->getHandle();
+
+  // The setpoint stream is optional, older servers do not have it.
+  findNotifyHandles(pRemoteService, ROBOT_LINK_SETPOINT_UUID, peer.setpointHandle, peer.setpointCccdHandle);
+  findNotifyHandles(pRemoteService, ROBOT_LINK_TIME_SYNC_UUID, peer.timeSyncHandle, peer.timeSyncCccdHandle);
+
+  // So is the telemetry service.
+  static const char* const fieldUuids[ROBOT_TELEMETRY_FIELDS] = {
+    ROBOT_TELEMETRY_FIELD_UUID_0, ROBOT_TELEMETRY_FIELD_UUID_1,
+    ROBOT_TELEMETRY_FIELD_UUID_2, ROBOT_TELEMETRY_FIELD_UUID_3,
+    ROBOT_TELEMETRY_FIELD_UUID_4, ROBOT_TELEMETRY_FIELD_UUID_5,
+    ROBOT_TELEMETRY_FIELD_UUID_6, ROBOT_TELEMETRY_FIELD_UUID_7
+  };
+  peer.telemetryHandle = 0;
+  peer.telemetryCccdHandle = 0;
+  peer.telemetryConfigHandle = 0;
+  memset(peer.fieldHandles, 0, sizeof(peer.fieldHandles));
+  memset(peer.fieldCccdHandles, 0, sizeof(peer.fieldCccdHandles));
+  BLERemoteService* pTelemetry = node.client->getService(BLEUUID(ROBOT_TELEMETRY_SERVICE_UUID));
+  if (pTelemetry != nullptr) {
+    BLERemoteCharacteristic* pConfig = pTelemetry->getCharacteristic(BLEUUID(ROBOT_TELEMETRY_CONFIG_UUID));
+    if (pConfig != nullptr) {
+      peer.telemetryConfigHandle = pConfig->getHandle();
+    }
+    findNotifyHandles(pTelemetry, ROBOT_TELEMETRY_UUID, peer.telemetryHandle, peer.telemetryCccdHandle);
+    for (uint8_t i = 0; i < ROBOT_TELEMETRY_FIELDS; i++) {
+      findNotifyHandles(pTelemetry, fieldUuids[i], peer.fieldHandles[i], peer.fieldCccdHandles[i]);
+    }
+    console.println("Telemetry service found");
+  }
+
+  peer.handlesValid = true;
+  savePeerCache(node);
+  return true;
+}
+
+/**
+ * @brief Look up a notifying characteristic and its CCCD.
+ * @return false (and both handles 0) if the server does not have it.
+ */
+bool findNotifyHandles(BLERemoteService* service, const char* uuid, uint16_t& valueHandle, uint16_t& cccdHandle) {
+  valueHandle = 0;
+  cccdHandle = 0;
+  BLERemoteCharacteristic* pCharacteristic = service->getCharacteristic(BLEUUID(uuid));
+  if (pCharacteristic == nullptr) {
+    return false;
+  }
+  BLERemoteDescriptor* pCccd = pCharacteristic->getDescriptor(BLEUUID((uint16_t)0x2902));
+  if (pCccd == nullptr) {
+    return false;
+  }
+  valueHandle = pCharacteristic->getHandle();
+  cccdHandle = pCccd->getHandle();
+  return true;
+}
+
+/**
+ * @brief Turn on notifications for one characteristic by handle.
+ */
+void subscribe(Node& node, uint16_t valueHandle, uint16_t cccdHandle) {
+  if (valueHandle == 0) {
+    return;
+  }
+  esp_ble_gattc_register_for_notify(node.client->getGattcIf(), node.peer.address, valueHandle);
+  uint8_t enable[2] = {0x01, 0x00};
+  esp_ble_gattc_write_char_descr(node.client->getGattcIf(), node.client->getConnId(),
+                                 cccdHandle, sizeof(enable), enable,
+                                 ESP_GATT_WRITE_TYPE_RSP, ESP_GATT_AUTH_REQ_NONE);
+}
+
+/**
+ * @brief Turn on setpoint acknowledgements, time sync replies and the
+ * telemetry we asked for. Only the characteristics of the chosen telemetry
+ * mode are subscribed.
+ */
+void subscribeNotifications(Node& node) {
+  subscribe(node, node.peer.setpointHandle, node.peer.setpointCccdHandle);
+  subscribe(node, node.peer.timeSyncHandle, node.peer.timeSyncCccdHandle);
+  if (TELEMETRY_RATE_HZ == 0) {
+    return;
+  }
+#if TELEMETRY_MODE == ROBOT_TELEMETRY_MODE_FIELDS
+  for (uint8_t i = 0; i < ROBOT_TELEMETRY_FIELDS; i++) {
+    subscribe(node, node.peer.fieldHandles[i], node.peer.fieldCccdHandles[i]);
+  }
+#else
+  subscribe(node, node.peer.telemetryHandle, node.peer.telemetryCccdHandle);
+#endif
+}
+
+/**
+ * @brief Write a characteristic value by handle. Returns at once, a write
+ * with response completes in onGattcEvent().
+ * @return false if the write could not be queued.
+ */
+bool writeHandle(Node& node, uint16_t handle, const uint8_t* data, uint16_t length, bool response) {
+  return esp_ble_gattc_write_char(node.client->getGattcIf(), node.client->getConnId(), handle,
+                                  length, const_cast<uint8_t*>(data),
+                                  response ? ESP_GATT_WRITE_TYPE_RSP : ESP_GATT_WRITE_TYPE_NO_RSP,
+                                  ESP_GATT_AUTH_REQ_NONE) == ESP_OK;
+}
+
+/**
+ * @brief Send a RobotClient message on the handle its channel stands for.
+ * The command and the telemetry config are written with response, so a
+ * stale cached handle is reported. Setpoints and time sync pings are written
+ * without.
+ */
+bool NodeTransport::send(uint8_t channel, const uint8_t* data, size_t length) {
+  uint16_t handle = 0;
+  bool response = true;
+  switch (channel) {
+    case ROBOT_CHANNEL_COMMAND:
+      handle = node->peer.commandHandle;
+      break;
+    case ROBOT_CHANNEL_SETPOINT:
+      handle = node->peer.setpointHandle;
+      response = false;
+      break;
+    case ROBOT_CHANNEL_TELEMETRY_CONFIG:
+      handle = node->peer.telemetryConfigHandle;
+      break;
+    case ROBOT_CHANNEL_TIME_SYNC:
+      handle = node->peer.timeSyncHandle;
+      response = false; // A response would hold the ping back an interval.
+      break;
+    default:
+      break; // Server to client channels.
+  }
+  if (handle == 0 || node->client == nullptr) {
+    return false;
+  }
+  return writeHandle(*node, handle, data, length, response);
+}
+
+/**
+ * @brief The MTU exchange may finish after connect() returns, so this is
+ * asked every time.
+ */
+uint16_t NodeTransport::mtu() const {
+  return node->client != nullptr ? node->client->getMTU() : 23;
+}
+
+/**
+ * @brief The RobotClient channel a notification handle belongs to.
+ * @return ROBOT_CHANNELS if it is none of ours.
+ */
+uint8_t channelForHandle(const Node& node, uint16_t handle) {
+  if (handle == node.peer.setpointHandle) {
+    return ROBOT_CHANNEL_SETPOINT;
+  }
+  if (handle == node.peer.telemetryHandle) {
+    return ROBOT_CHANNEL_TELEMETRY;
+  }
+  if (handle == node.peer.timeSyncHandle) {
+    return ROBOT_CHANNEL_TIME_SYNC;
+  }
+  for (uint8_t field = 0; field < ROBOT_TELEMETRY_FIELDS; field++) {
+    if (handle == node.peer.fieldHandles[field]) {
+      return ROBOT_CHANNEL_FIELD_0 + field;
+    }
+  }
+  return ROBOT_CHANNELS;
+}
+
+/**
+ * @brief Print "Node <n>" to start a line about one node.
+ */
+void printNodeName(const Node& node) {
+  console.print("Node ");
+  console.print(node.index);
+}
+
+/**
+ * @brief Print how long it took from boot or link loss to the server
+ * confirming the first command.
+ */
+void reportFirstCommand(Node& node) {
+  uint32_t doneUs = node.firstCommandUs;
+  if (!node.awaitingFirstCommand || doneUs == 0) {
+    return;
+  }
+  node.awaitingFirstCommand = false;
+  printNodeName(node);
+  console.print(": time to first command ");
+  console.print((doneUs - node.linkDownUs) / 1000.0, 1);
+  console.println(node.firstCommandFast ? " ms (cached server and handles)" : " ms (scan and discovery)");
+}
+
+/**
+ * @brief Record the first confirmed command after (re)connecting.
+ */
+void markFirstCommand(Node& node) {
+  if (node.firstCommandUs == 0) {
+    uint32_t now = micros();
+    node.firstCommandUs = now != 0 ? now : 1;
+  }
+}
+
+/**
+ * @brief GATT client events, called in the BLE task. Notifications and write
+ * results for our cached handles are handled here, since no
+ * BLERemoteCharacteristic exists when discovery was skipped.
+ */
+void onGattcEvent(esp_gattc_cb_event_t event, esp_gatt_if_t gattcIf, esp_ble_gattc_cb_param_t* param) {
+  Node* node = nodeForGattcIf(gattcIf);
+  if (node == nullptr) {
+    return;
+  }
+  PeerCache& peer = node->peer;
+  switch (event) {
+    case ESP_GATTC_NOTIFY_EVT: {
+      if (param->notify.handle == 0) {
+        break;
+      }
+      uint8_t channel = channelForHandle(*node, param->notify.handle);
+      if (channel == ROBOT_CHANNELS) {
+        break;
+      }
+      node->robot.onMessage(channel, param->notify.value, param->notify.value_len);
+      if (channel == ROBOT_CHANNEL_SETPOINT && param->notify.value_len >= ROBOT_ACK_SIZE) {
+        markFirstCommand(*node); // A setpoint was applied.
+      }
+      break;
+    }
+    case ESP_GATTC_WRITE_CHAR_EVT:
+      if (param->write.status == ESP_GATT_INVALID_HANDLE) {
+        node->cacheRejected = true;
+      } else if (param->write.handle == peer.commandHandle && param->write.status == ESP_GATT_OK) {
+        markFirstCommand(*node);
+      }
+      break;
+    case ESP_GATTC_WRITE_DESCR_EVT:
+      // Every descriptor we write is a cached CCCD handle.
+      if (param->write.status != ESP_GATT_OK) {
+        node->cacheRejected = true;
+      }
+      break;
+    case ESP_GATTC_CFG_MTU_EVT:
+      node->telemetryConfigDirty = true;
+      break;
+    default:
+      break;
+  }
+}
+
+/**
+ * @brief Connection interval that gives every streaming node one connection
+ * event of FLEET_EVENT_US per interval, in 1.25 ms units.
+ *
+ * @details The controller runs one connection event at a time. With the same
+ * interval on every link it places the nodes' events one after another inside
+ * each interval instead of letting them collide. Each node gets one write per
+ * interval, and the frames produced in between share that write. Every node
+ * still receives STREAM_RATE_HZ frames per second, so the total command rate
+ * grows with the number of nodes until the batches no longer fit the MTU.
+ */
+uint16_t fleetConnInterval() {
+  uint32_t streaming = 0;
+  for (uint8_t i = 0; i < FLEET_MAX_NODES; i++) {
+    if (nodes[i].streamReady) {
+      streaming++;
+    }
+  }
+  uint16_t interval = (streaming * FLEET_EVENT_US + 1249) / 1250;
+  return interval < STREAM_MIN_CONN_INTERVAL ? STREAM_MIN_CONN_INTERVAL : interval;
+}
+
+/**
+ * @brief Ask every streaming node for a new interval when the fleet changes.
+ */
+void updateConnInterval() {
+  uint16_t interval = fleetConnInterval();
+  if (interval == connInterval) {
+    return;
+  }
+  connInterval = interval;
+  console.print("Fleet connection interval ");
+  console.print(connInterval * 1.25, 2);
+  console.println(" ms");
+  for (uint8_t i = 0; i < FLEET_MAX_NODES; i++) {
+    if (nodes[i].streamReady && !nodes[i].activity.idle()) {
+      requestConnInterval(nodes[i]); // Idle nodes get it when they wake.
+    }
+  }
+}
+
+/**
+ * @brief Ask one server for the fleet's connection interval, or for the idle
+ * parameters while its link is idle. The server may pick anything within its
+ * own limits. reportConnParams() prints what it picked.
+ */
+void requestConnInterval(Node& node) {
+  bool idle = node.activity.idle();
+  esp_ble_conn_update_params_t params = {};
+  memcpy(params.bda, node.peer.address, sizeof(esp_bd_addr_t));
+  params.min_int = idle ? IDLE_CONN_INTERVAL : connInterval;
+  params.max_int = params.min_int;
+  params.latency = idle ? IDLE_SLAVE_LATENCY : 0;
+  params.timeout = 400; // 4 s supervision timeout, 10 ms units.
+  esp_ble_gap_update_conn_params(&params);
+  node.paramsAskedMs = millis();
+}
+
+/**
+ * @brief A node's link went idle or woke up: ask for the matching connection
+ * parameters and telemetry rate.
+ *
+ * @details The central decides the connection parameters, so this is done
+ * here and not on the server. The new parameters only take effect at the
+ * update's instant, several connection events later. When waking from idle
+ * that is several 100 ms events, which is why the first setpoint does not
+ * wait for it.
+ */
+void setLinkPower(Node& node) {
+  printNodeName(node);
+  console.println(node.activity.idle() ? ": parked, link going idle" : ": moving, link waking up");
+  requestConnInterval(node);
+  sendTelemetryConfig(node);
+}
+
+/**
+ * @brief Print the connection parameters the link now uses and how long
+ * they took to arrive.
+ */
+void reportConnParams(Node& node) {
+  printNodeName(node);
+  console.print(": interval now ");
+  console.print(node.linkInterval * 1.25, 2);
+  console.print(" ms, slave latency ");
+  console.print(node.linkLatency);
+  console.print(", ");
+  console.print(millis() - node.paramsAskedMs);
+  console.println(" ms after asking");
+}
+
+/**
+ * @brief Get a node ready to stream setpoints. Its connection interval is
+ * asked for by the next updateConnInterval().
+ * @return false if the server does not support streaming.
+ */
+bool setUpStream(Node& node) {
+  if (node.peer.setpointHandle == 0) {
+    return false;
+  }
+
+  printNodeName(node);
+  console.println(": streaming setpoints");
+
+  node.robot.startStream();
+  node.activity.reset(millis());
+  node.streamReady = true;
+  connInterval = 0; // Ask this node too, even if the interval is unchanged.
+  return true;
+}
+
+/**
+ * @brief One pass of the stream: produce, send and time acknowledgements for
+ * every streaming node, and report.
+ */
+void streamSetpoints() {
+#if DUAL_CORE
+  SampledSetpoint sample;
+  while (setpointRing.pop(sample)) {
+    recordJitter(sample);
+    distributeSetpoint(sample.sp);
+  }
+#else
+  static uint32_t lastUs = 0;
+  static uint32_t lastEpoch = 0;
+  unsigned long now = micros();
+  if (now - lastProduceUs >= 1000000UL / STREAM_RATE_HZ) {
+    lastProduceUs += 1000000UL / STREAM_RATE_HZ;
+    if (now - lastProduceUs >= 1000000UL / STREAM_RATE_HZ) {
+      lastProduceUs = now; // Fell behind (a blocking connect), do not catch up.
+    }
+    SampledSetpoint sample = makeSample(lastUs, lastEpoch);
+    recordJitter(sample);
+    distributeSetpoint(sample.sp);
+  }
+#endif
+  for (uint8_t i = 0; i < FLEET_MAX_NODES; i++) {
+    if (nodes[i].state == LINK_READY && nodes[i].streamReady) {
+      if (nodes[i].activity.poll(millis())) {
+        setLinkPower(nodes[i]);
+      }
+      // At most one write per connection interval, the frames produced in
+      // between share it.
+      nodes[i].robot.sendSetpoints((uint32_t)connInterval * 1250);
+      nodes[i].robot.processAcks();
+    }
+  }
+
+  static unsigned long lastReport = 0;
+  if (millis() - lastReport >= STREAM_REPORT_MS) {
+    lastReport = millis();
+    printStreamReport();
+    printJitterReport();
+  }
+}
+
+/**
+ * @brief Read the joystick (or the test sweep) into a new setpoint. Touches
+ * no node, so the sampler task can call it.
+ */
+RobotSetpoint sampleSetpoint() {
+  RobotSetpoint sp;
+  sp.sentUs = micros();
+#if JOYSTICK_CONNECTED
+  // ESP32 ADC is 12 bit, scale to the -512..511 range of the UNO joystick.
+  sp.joyX = (analogRead(JOY_X_PIN) >> 2) - 512;
+  sp.joyY = (analogRead(JOY_Y_PIN) >> 2) - 512;
+#else
+  if (millis() % 30000 < 10000) {
+    sp.joyX = (int16_t)((millis() / 4) % 1024) - 512;
+  } else {
+    sp.joyX = -512; // Parked.
+  }
+  sp.joyY = 0;
+#endif
+  int16_t speed = abs(sp.joyY) / 2;
+  sp.dutyLeft = speed > 255 ? 255 : speed;
+  sp.dutyRight = sp.dutyLeft;
+  sp.flags = (sp.joyX > 0 ? ROBOT_FLAG_LED : 0) | (sp.joyY < 0 ? ROBOT_FLAG_REVERSE : 0);
+  return sp;
+}
+
+/**
+ * @brief Make a setpoint and note how long since the last one and whether a
+ * connect ran in between.
+ * @param lastUs When the caller's last setpoint was made, 0 at first.
+ * @param lastEpoch connectEpoch at the caller's last setpoint.
+ */
+SampledSetpoint makeSample(uint32_t& lastUs, uint32_t& lastEpoch) {
+  SampledSetpoint sample;
+  sample.sp = sampleSetpoint();
+  sample.intervalUs = lastUs == 0 ? 0 : sample.sp.sentUs - lastUs;
+  lastUs = sample.sp.sentUs;
+  uint32_t epoch = connectEpoch;
+  sample.duringConnect = (epoch & 1) != 0 || epoch != lastEpoch;
+  lastEpoch = epoch;
+  return sample;
+}
+
+/**
+ * @brief Queue a copy of a setpoint for every streaming node, numbered in
+ * that node's own sequence.
+ */
+void distributeSetpoint(const RobotSetpoint& sp) {
+  for (uint8_t i = 0; i < FLEET_MAX_NODES; i++) {
+    Node& node = nodes[i];
+    if (node.state == LINK_READY && node.streamReady) {
+      if (node.activity.noteSetpoint(sp, millis())) {
+        setLinkPower(node);
+      }
+      if (!node.activity.idle()) {
+        node.robot.queueSetpoint(sp); // Drops the oldest frame if the link is behind.
+      }
+    }
+  }
+}
+
+/**
+ * @brief Add how far a setpoint's interval was from the period to the quiet
+ * or the connecting histogram.
+ */
+void recordJitter(const SampledSetpoint& sample) {
+  const uint32_t periodUs = 1000000UL / STREAM_RATE_HZ;
+  if (sample.intervalUs == 0) {
+    return;
+  }
+  uint32_t jitterUs = sample.intervalUs > periodUs ? sample.intervalUs - periodUs
+                                                   : periodUs - sample.intervalUs;
+  if (sample.duringConnect) {
+    jitterConnect.add(jitterUs);
+  } else {
+    jitterQuiet.add(jitterUs);
+  }
+}
+
+/**
+ * @brief Print how evenly the setpoints were made, with no connect running
+ * and while one ran, then start a new window.
+ */
+void printJitterReport() {
+  console.print(DUAL_CORE ? "Setpoint jitter (sampler task)" : "Setpoint jitter (loop)");
+  console.print(" us p50/p99/max: quiet n=");
+  console.print(jitterQuiet.count());
+  console.print(" ");
+  console.print(jitterQuiet.percentileUs(50));
+  console.print("/");
+  console.print(jitterQuiet.percentileUs(99));
+  console.print("/");
+  console.print(jitterQuiet.maxUs());
+  console.print(" connecting n=");
+  console.print(jitterConnect.count());
+  console.print(" ");
+  console.print(jitterConnect.percentileUs(50));
+  console.print("/");
+  console.print(jitterConnect.percentileUs(99));
+  console.print("/");
+  console.print(jitterConnect.maxUs());
+#if DUAL_CORE
+  console.print(" ring overruns=");
+  console.print(setpointRing.overruns.exchange(0));
+#endif
+  console.println();
+  jitterQuiet.reset();
+  jitterConnect.reset();
+}
+
+/**
+ * @brief Print achieved rate and latency for every streaming node and the
+ * fleet total, then start a new window.
+ *
+ * @details Latency is from producing a frame to receiving the server's
+ * acknowledgement, so it includes queueing, one trip each way and the time the
+ * server takes to apply it. Once the server's clock is in sync the report
+ * splits it into the trip up and the trip down, and a clock line follows.
+ */
+void printStreamReport() {
+  float seconds = STREAM_REPORT_MS / 1000.0;
+  uint8_t streaming = 0;
+  uint32_t totalFrames = 0;
+  uint32_t totalWrites = 0;
+  for (uint8_t i = 0; i < FLEET_MAX_NODES; i++) {
+    Node& node = nodes[i];
+    if (!node.streamReady) {
+      continue;
+    }
+    streaming++;
+    totalFrames += node.robot.framesSent;
+    totalWrites += node.robot.writesSent;
+    printNodeName(node);
+    node.robot.printStreamReport(console, seconds);
+    printNodeName(node);
+    node.robot.printClockReport(console);
+  }
+  if (streaming == 0) {
+    return;
+  }
+  console.print("Fleet: nodes=");
+  console.print(streaming);
+  console.print(" interval=");
+  console.print(connInterval * 1.25, 2);
+  console.print(" ms total msgs/s=");
+  console.print(totalFrames / seconds, 1);
+  console.print(" writes/s=");
+  console.println(totalWrites / seconds, 1);
+}
+
+/**
+ * @brief Tell a server what telemetry to send. The MTU is included so the
+ * server can fill each notification.
+ */
+void sendTelemetryConfig(Node& node) {
+  if (node.peer.telemetryConfigHandle == 0) {
+    return;
+  }
+  if (node.activity.idle() && TELEMETRY_RATE_HZ > 0) {
+    node.robot.sendTelemetryConfig(TELEMETRY_IDLE_RATE_HZ, TELEMETRY_IDLE_HOLD_MS, TELEMETRY_MODE);
+  } else {
+    node.robot.sendTelemetryConfig(TELEMETRY_RATE_HZ, TELEMETRY_HOLD_MS, TELEMETRY_MODE);
+  }
+}
+
+/**
+ * @brief Take the samples the BLE task decoded and print a report now and then.
+ */
+void processTelemetry(Node& node) {
+  node.robot.processTelemetry();
+
+  if (millis() - node.lastTelemetryReportMs >= TELEMETRY_REPORT_MS) {
+    node.lastTelemetryReportMs = millis();
+    if (node.robot.telemetrySamples > 0) {
+      printTelemetryReport(node);
+    }
+  }
+}
+
+/**
+ * @brief Print the received telemetry rate and the newest sample, then start
+ * a new window.
+ */
+void printTelemetryReport(Node& node) {
+  printNodeName(node);
+  node.robot.printTelemetryReport(console, TELEMETRY_REPORT_MS / 1000.0);
+}
+
+/**
+ * @brief Ping the server's clock every TIME_SYNC_MS (TIME_SYNC_IDLE_MS while
+ * the link is idle) and feed the replies to the node's clock estimate.
+ *
+ * @details A reply can only leave the server at the next connection event,
+ * so the round trip is at least one interval longer than the trips
+ * themselves. Telling the estimate the interval in effect removes that bias.
+ * Until the first parameter update reports it, 0 makes the estimate fall
+ * back to the plain midpoint.
+ */
+void syncClock(Node& node) {
+  node.robot.processTimeSync((uint32_t)node.linkInterval * 1250);
+  unsigned long periodMs = node.activity.idle() ? TIME_SYNC_IDLE_MS : TIME_SYNC_MS;
+  if (node.peer.timeSyncHandle != 0 && millis() - node.lastTimeSyncMs >= periodMs) {
+    node.lastTimeSyncMs = millis();
+    node.robot.sendTimeSync();
+  }
+}
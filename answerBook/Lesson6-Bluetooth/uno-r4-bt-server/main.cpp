@@ -1,5 +1,10 @@
 #include <Arduino.h>
 #include <ArduinoBLE.h>
+#include <RobotLink.h>
+#include <RobotServer.h>
+#include <BootSerial.h> // Output that never waits for a host, see lib/BootSerial.
+
+BootSerial console(Serial); // Use instead of Serial, it never blocks.
 
 // Define the BLE service and characteristic UUIDs (lowercase for consistency)
 #define SERVICE_UUID "19b10000-e8f2-537e-4f6c-d104768a1214"
@@ -8,26 +13,154 @@
 // Pin for the LED
 #define LED_PIN 13
 
+// Set to 1 to measure how long it takes from a command reaching the sketch to
+// the LED changing. Per-command Serial output is turned off in this mode
+// because printing takes longer than the thing being measured.
+#define LATENCY_MODE 0
+
+// How often the latency report is printed (milliseconds).
+#define LATENCY_REPORT_MS 5000
+
+// How often the setpoint stream report is printed (milliseconds).
+#define STREAM_REPORT_MS 5000
+
+// How often the telemetry report is printed (milliseconds).
+#define TELEMETRY_REPORT_MS 5000
+
+// Advertising interval in 0.625 ms units: fast for ADVERTISE_FAST_MS after
+// boot or a disconnect, so the client finds us again quickly, then slow to
+// keep the radio quiet while nobody is looking for us.
+#define ADVERTISE_FAST_INTERVAL 160  // 100 ms
+#define ADVERTISE_SLOW_INTERVAL 1636 // 1022.5 ms
+#define ADVERTISE_FAST_MS 30000
+
+// Motor PWM frequency reported in telemetry (the ER20 motor runs at 100 Hz).
+#define MOTOR_PWM_HZ 100
+
+// Set to 1 if the motor supply is wired to SUPPLY_SENSE_PIN through a
+// divider. 100k / 10k divides by 11, so 5 V at the pin is a 55 V supply.
+#define SUPPLY_SENSE_CONNECTED 0
+#define SUPPLY_SENSE_PIN A0
+#define SUPPLY_DIVIDER 11
+#define SUPPLY_MIN_MV 18000 // Below this the motor stalls.
+
 BLEService customService(SERVICE_UUID); // Create a BLE service
 BLEByteCharacteristic customCharacteristic(CHARACTERISTIC_UUID, BLERead | BLEWrite); // Byte characteristic
 
+// Setpoint stream: the client writes batches of RobotSetpoint frames without
+// waiting for a response, and we notify back the last sequence number applied.
+BLECharacteristic setpointCharacteristic(ROBOT_LINK_SETPOINT_UUID,
+    BLEWriteWithoutResponse | BLENotify,
+    ROBOT_SETPOINT_SIZE * ROBOT_SETPOINT_MAX_BATCH);
+
+// Time sync: the client writes a ping, we notify it straight back with our
+// receive and send times so the client can follow our clock.
+BLECharacteristic timeSyncCharacteristic(ROBOT_LINK_TIME_SYNC_UUID,
+    BLEWriteWithoutResponse | BLENotify, ROBOT_TIME_PONG_SIZE);
+
+// Telemetry: a packed sample notified in batches, a config the client writes,
+// and one characteristic per field for comparison.
+BLEService telemetryService(ROBOT_TELEMETRY_SERVICE_UUID);
+BLECharacteristic telemetryCharacteristic(ROBOT_TELEMETRY_UUID, BLERead | BLENotify,
+    ROBOT_TELEMETRY_SIZE * ROBOT_TELEMETRY_MAX_BATCH);
+BLECharacteristic telemetryConfigCharacteristic(ROBOT_TELEMETRY_CONFIG_UUID, BLEWrite,
+    ROBOT_TELEMETRY_CONFIG_SIZE, true);
+BLECharacteristic telemetryFields[ROBOT_TELEMETRY_FIELDS] = {
+  BLECharacteristic(ROBOT_TELEMETRY_FIELD_UUID_0, BLERead | BLENotify, 2),
+  BLECharacteristic(ROBOT_TELEMETRY_FIELD_UUID_1, BLERead | BLENotify, 2),
+  BLECharacteristic(ROBOT_TELEMETRY_FIELD_UUID_2, BLERead | BLENotify, 2),
+  BLECharacteristic(ROBOT_TELEMETRY_FIELD_UUID_3, BLERead | BLENotify, 1),
+  BLECharacteristic(ROBOT_TELEMETRY_FIELD_UUID_4, BLERead | BLENotify, 2),
+  BLECharacteristic(ROBOT_TELEMETRY_FIELD_UUID_5, BLERead | BLENotify, 2),
+  BLECharacteristic(ROBOT_TELEMETRY_FIELD_UUID_6, BLERead | BLENotify, 2),
+  BLECharacteristic(ROBOT_TELEMETRY_FIELD_UUID_7, BLERead | BLENotify, 1)
+};
+
+// RobotServer sends through this. Each channel is one characteristic, and
+// writeValue() on a notifying characteristic notifies the central.
+class BleServerTransport : public RobotLinkTransport {
+public:
+  bool send(uint8_t channel, const uint8_t* data, size_t length) override {
+    BLECharacteristic* characteristic = characteristicFor(channel);
+    return characteristic != nullptr && characteristic->writeValue(data, length);
+  }
+
+  // ArduinoBLE does not tell the peripheral the negotiated MTU. RobotServer
+  // uses the one the client puts in its telemetry config instead.
+  uint16_t mtu() const override {
+    return 23;
+  }
+
+private:
+  BLECharacteristic* characteristicFor(uint8_t channel) {
+    if (channel == ROBOT_CHANNEL_SETPOINT) {
+      return &setpointCharacteristic;
+    }
+    if (channel == ROBOT_CHANNEL_TELEMETRY) {
+      return &telemetryCharacteristic;
+    }
+    if (channel == ROBOT_CHANNEL_TIME_SYNC) {
+      return &timeSyncCharacteristic;
+    }
+    if (channel >= ROBOT_CHANNEL_FIELD_0 && channel < ROBOT_CHANNELS) {
+      return &telemetryFields[channel - ROBOT_CHANNEL_FIELD_0];
+    }
+    return nullptr; // Client to server channels.
+  }
+} bleTransport;
+
+// Setpoints, acknowledgements and telemetry. The sketch only moves bytes
+// between it and the characteristics, and drives the hardware.
+RobotServer robotServer(bleTransport, MOTOR_PWM_HZ);
+
+// Latency statistics (LATENCY_MODE only). All times in microseconds.
+struct LatencyStats {
+  uint32_t count;       // Commands applied
+  uint32_t minUs;       // Fastest receipt-to-actuation
+  uint32_t maxUs;       // Slowest receipt-to-actuation
+  uint64_t totalUs;     // For the average
+  uint32_t maxPollGapUs; // Longest time between two BLE.poll() calls
+} latency = {0, UINT32_MAX, 0, 0, 0};
+
+unsigned long lastPollUs = 0;
+
+// Advertising state, see ADVERTISE_FAST_MS.
+bool advertisingFast = false;
+unsigned long advertisingSinceMs = 0;
+
+// Forward function declarations (not reqiured for Arduino IDE) but is required
+// for PlatformIO IDE.
+void onCentralConnected(BLEDevice central);
+void onCentralDisconnected(BLEDevice central);
+void onCommandWritten(BLEDevice central, BLECharacteristic characteristic);
+void onSetpointWritten(BLEDevice central, BLECharacteristic characteristic);
+void onTelemetryConfigWritten(BLEDevice central, BLECharacteristic characteristic);
+void onTimeSyncWritten(BLEDevice central, BLECharacteristic characteristic);
+void applyCommand(uint8_t value);
+void applySetpoint(const RobotSetpoint &sp);
+void addSupplySample(RobotTelemetry &t);
+void printLatencyReport();
+void startAdvertising(uint16_t interval);
+void updateAdvertising();
+
 void setup() {
   // Initialize serial communication
-  Serial.begin(115200);
-  while (!Serial);
-  Serial.println("Starting BLE Server...");
+  console.begin(115200);
+  console.println("Starting BLE Server...");
 
   // Initialize LED pin
   pinMode(LED_PIN, OUTPUT);
   digitalWrite(LED_PIN, LOW);
-  Serial.println("LED pin initialized");
+  console.mark("LED ready");
 
   // Initialize BLE
   if (!BLE.begin()) {
-    Serial.println("Starting BLE failed!");
-    while (1);
+    console.println("Starting BLE failed!");
+    while (1) {
+      console.poll(); // Halt, but still send the message once a host listens.
+    }
   }
-  Serial.println("BLE initialized successfully");
+  console.println("BLE initialized successfully");
 
   // Set local name and advertised service
   BLE.setLocalName("UNO_R4_Server");
@@ -35,51 +168,246 @@ void setup() {
 
   // Add characteristic to service
   customService.addCharacteristic(customCharacteristic);
+  customService.addCharacteristic(setpointCharacteristic);
+  customService.addCharacteristic(timeSyncCharacteristic);
   BLE.addService(customService);
 
+  telemetryService.addCharacteristic(telemetryCharacteristic);
+  telemetryService.addCharacteristic(telemetryConfigCharacteristic);
+  for (uint8_t i = 0; i < ROBOT_TELEMETRY_FIELDS; i++) {
+    telemetryService.addCharacteristic(telemetryFields[i]);
+  }
+  BLE.addService(telemetryService);
+
   // Set initial value
   customCharacteristic.writeValue(0);
-  Serial.println("Characteristic initialized with value: 0");
+  console.println("Characteristic initialized with value: 0");
+
+  // React to events as BLE.poll() delivers them instead of checking flags in
+  // a loop with delays. The write handler applies the command directly.
+  BLE.setEventHandler(BLEConnected, onCentralConnected);
+  BLE.setEventHandler(BLEDisconnected, onCentralDisconnected);
+  customCharacteristic.setEventHandler(BLEWritten, onCommandWritten);
+  setpointCharacteristic.setEventHandler(BLEWritten, onSetpointWritten);
+  telemetryConfigCharacteristic.setEventHandler(BLEWritten, onTelemetryConfigWritten);
+  timeSyncCharacteristic.setEventHandler(BLEWritten, onTimeSyncWritten);
+
+  // The hardware RobotServer drives.
+  robotServer.setCommandHandler(applyCommand);
+  robotServer.setSetpointHandler(applySetpoint);
+  robotServer.setSampleHandler(addSupplySample);
 
-  // Set advertising parameters
-  BLE.setAdvertisingInterval(100); // 100ms interval
+  // Connection interval we ask for when a client connects. The client (the
+  // central) has the last word: it relaxes the link while the robot is
+  // parked and tightens it again when it moves.
   BLE.setConnectionInterval(6, 12); // Min 7.5ms, Max 15ms
   BLE.setConnectable(true);
-  BLE.advertise();
-  Serial.println("BLE Server started. Advertising with UUID: " + String(SERVICE_UUID));
+  startAdvertising(ADVERTISE_FAST_INTERVAL);
+  console.mark("advertising");
+  console.println("BLE Server started. Advertising with UUID: " + String(SERVICE_UUID));
+  lastPollUs = micros();
 }
 
 void loop() {
-  // Poll for central device
-  BLEDevice central = BLE.central();
-
-  if (central) {
-    Serial.print("Connected to client: ");
-    Serial.println(central.address());
-
-    while (central.connected()) {
-      if (customCharacteristic.written()) {
-        uint8_t value = customCharacteristic.value();
-        Serial.print("Received byte: ");
-        Serial.println(value);
-        if (value == 1) { // 1 for ON
-          digitalWrite(LED_PIN, HIGH);
-          Serial.println("LED turned ON");
-        } else if (value == 0) { // 0 for OFF
-          digitalWrite(LED_PIN, LOW);
-          Serial.println("LED turned OFF");
-        } else {
-          Serial.println("Unknown command received");
-        }
-      }
-      delay(100);
+  console.poll(); // Send output that is waiting for the port.
+  // Process everything the BLE module has sent us. Event handlers run from
+  // inside this call. There is no delay() anywhere in loop(), so a write is
+  // handled within one pass of loop() (tens of microseconds) instead of up
+  // to 600 ms later.
+  BLE.poll();
+  robotServer.poll(); // Telemetry samples and batches.
+  updateAdvertising();
+
+#if LATENCY_MODE
+  unsigned long now = micros();
+  uint32_t gap = now - lastPollUs;
+  if (gap > latency.maxPollGapUs) {
+    latency.maxPollGapUs = gap;
+  }
+  lastPollUs = now;
+
+  static unsigned long lastReport = 0;
+  if (millis() - lastReport >= LATENCY_REPORT_MS) {
+    lastReport = millis();
+    printLatencyReport();
+  }
+#endif
+
+  static unsigned long lastStreamReport = 0;
+  if (millis() - lastStreamReport >= STREAM_REPORT_MS) {
+    lastStreamReport = millis();
+    if (robotServer.streamSeq.received > 0) {
+      robotServer.printStreamReport(console, STREAM_REPORT_MS / 1000.0);
     }
+  }
+
+  static unsigned long lastTelemetryReport = 0;
+  if (millis() - lastTelemetryReport >= TELEMETRY_REPORT_MS) {
+    lastTelemetryReport = millis();
+    if (robotServer.telemetryStats.samples > 0) {
+      robotServer.printTelemetryReport(console, TELEMETRY_REPORT_MS / 1000.0);
+    }
+  }
+}
+
+/**
+ * @brief Called from BLE.poll() when a central connects.
+ */
+void onCentralConnected(BLEDevice central) {
+  console.print("Connected to client: ");
+  console.println(central.address());
+  robotServer.onConnect();
+}
+
+/**
+ * @brief Called from BLE.poll() when the central goes away.
+ */
+void onCentralDisconnected(BLEDevice central) {
+  console.print("Disconnected from client: ");
+  console.println(central.address());
+  digitalWrite(LED_PIN, LOW);
+  robotServer.onDisconnect(); // Setpoint back to zero, telemetry off.
+  startAdvertising(ADVERTISE_FAST_INTERVAL); // Make sure we can be found again, quickly.
+}
+
+/**
+ * @brief (Re)start advertising at the given interval (0.625 ms units).
+ */
+void startAdvertising(uint16_t interval) {
+  BLE.stopAdvertise();
+  BLE.setAdvertisingInterval(interval);
+  BLE.advertise();
+  advertisingFast = interval == ADVERTISE_FAST_INTERVAL;
+  advertisingSinceMs = millis();
+}
+
+/**
+ * @brief Slow advertising down once nobody has connected for
+ * ADVERTISE_FAST_MS.
+ */
+void updateAdvertising() {
+  if (!advertisingFast || BLE.connected() || millis() - advertisingSinceMs < ADVERTISE_FAST_MS) {
+    return;
+  }
+  startAdvertising(ADVERTISE_SLOW_INTERVAL);
+  console.print("No client for ");
+  console.print(ADVERTISE_FAST_MS / 1000);
+  console.print(" s, advertising every ");
+  console.print(ADVERTISE_SLOW_INTERVAL * 0.625, 1);
+  console.println(" ms");
+}
+
+/**
+ * @brief Called from BLE.poll() as soon as the central writes a command.
+ */
+void onCommandWritten(BLEDevice central, BLECharacteristic characteristic) {
+  unsigned long receivedUs = micros();
+  uint8_t value = customCharacteristic.value();
+  robotServer.onMessage(ROBOT_CHANNEL_COMMAND, &value, 1); // Calls applyCommand().
+
+#if LATENCY_MODE
+  uint32_t elapsed = micros() - receivedUs;
+  latency.count++;
+  latency.totalUs += elapsed;
+  if (elapsed < latency.minUs) {
+    latency.minUs = elapsed;
+  }
+  if (elapsed > latency.maxUs) {
+    latency.maxUs = elapsed;
+  }
+#else
+  (void)receivedUs;
+  console.print("Received byte: ");
+  console.println(value);
+#endif
+}
+
+/**
+ * @brief Called from BLE.poll() when a batch of setpoint frames arrives.
+ * RobotServer applies them in order and notifies the acknowledgement.
+ */
+void onSetpointWritten(BLEDevice central, BLECharacteristic characteristic) {
+  robotServer.onMessage(ROBOT_CHANNEL_SETPOINT, setpointCharacteristic.value(),
+                        setpointCharacteristic.valueLength());
+}
+
+/**
+ * @brief Called from BLE.poll() when the client configures telemetry.
+ */
+void onTelemetryConfigWritten(BLEDevice central, BLECharacteristic characteristic) {
+  robotServer.onMessage(ROBOT_CHANNEL_TELEMETRY_CONFIG, telemetryConfigCharacteristic.value(),
+                        telemetryConfigCharacteristic.valueLength());
+  robotServer.printTelemetryConfig(console);
+}
+
+/**
+ * @brief Called from BLE.poll() when a time sync ping arrives. RobotServer
+ * timestamps it and notifies the reply; keep anything slow out of here.
+ */
+void onTimeSyncWritten(BLEDevice central, BLECharacteristic characteristic) {
+  robotServer.onMessage(ROBOT_CHANNEL_TIME_SYNC, timeSyncCharacteristic.value(),
+                        timeSyncCharacteristic.valueLength());
+}
 
-    Serial.print("Disconnected from client: ");
-    Serial.println(central.address());
+/**
+ * @brief Act on one setpoint. The LED stands in for the motor for now.
+ */
+void applySetpoint(const RobotSetpoint &sp) {
+  digitalWrite(LED_PIN, (sp.flags & ROBOT_FLAG_LED) ? HIGH : LOW);
+}
+
+/**
+ * @brief Add the motor supply voltage to a telemetry sample.
+ */
+void addSupplySample(RobotTelemetry &t) {
+#if SUPPLY_SENSE_CONNECTED
+  t.supplyMv = (uint32_t)analogRead(SUPPLY_SENSE_PIN) * 5000UL * SUPPLY_DIVIDER / 1023;
+  if (t.supplyMv < SUPPLY_MIN_MV) {
+    t.errors |= ROBOT_ERR_SUPPLY_LOW;
+  }
+#else
+  (void)t;
+#endif
+}
+
+/**
+ * @brief Drive the LED from a command byte.
+ */
+void applyCommand(uint8_t value) {
+  if (value == 1) { // 1 for ON
+    digitalWrite(LED_PIN, HIGH);
+#if !LATENCY_MODE
+    console.println("LED turned ON");
+#endif
+  } else if (value == 0) { // 0 for OFF
     digitalWrite(LED_PIN, LOW);
+#if !LATENCY_MODE
+    console.println("LED turned OFF");
+#endif
   } else {
-    Serial.println("Polling for central...");
+    console.println("Unknown command received");
   }
-  delay(500);
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Print receipt-to-actuation latency and the worst BLE.poll() gap.
+ *
+ * @details The worst poll gap is how long a write can sit in the BLE module
+ * before the sketch sees it. Add it to the receipt-to-actuation time to get
+ * the worst case from the packet arriving to the LED changing.
+ */
+void printLatencyReport() {
+  console.print("Latency: commands=");
+  console.print(latency.count);
+  if (latency.count > 0) {
+    console.print(" receipt->actuation us min/avg/max=");
+    console.print(latency.minUs);
+    console.print("/");
+    console.print((uint32_t)(latency.totalUs / latency.count));
+    console.print("/");
+    console.print(latency.maxUs);
+  }
+  console.print(" max poll gap us=");
+  console.println(latency.maxPollGapUs);
+  latency = {0, UINT32_MAX, 0, 0, 0};
+}
@@ -7,16 +7,16 @@
  * @copyright Copyright (c) 2025
  */
 #include <Arduino.h>
+#include <BootSerial.h> // Output that never waits for a host, see lib/BootSerial.
+
+BootSerial console(Serial); // Use instead of Serial, it never blocks.
 
 /**
  * @brief Initializes serial communication.
  */
 void setupSerial() 
 {
-  Serial.begin(115200);
-  while (!Serial) {
-    ; // Wait for Serial Monitor
-  }
+  console.begin(115200);
 } // setupSerial()
 
 
@@ -26,7 +26,7 @@ void setupSerial()
 void setup() 
 {
   setupSerial();
-  Serial.println("<setup> End of setup.");
+  console.println("<setup> End of setup.");
 } // setup()
 
 /**
@@ -34,5 +34,5 @@ void setup()
  */
 void loop() 
 {
-
+  console.poll(); // Send output that is waiting for the port.
 } // loop()
\ No newline at end of file
@@ -0,0 +1,369 @@
+/**
+ * @file BinLog.cpp
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Deferred binary logging. See BinLog.h.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ */
+#include "BinLog.h"
+
+static_assert((BINLOG_SLOTS & (BINLOG_SLOTS - 1)) == 0,
+              "BINLOG_SLOTS must be a power of two");
+
+/**
+ * @brief Collects one text line for drainText(), so it is only sent if all
+ * of it fits.
+ */
+class BinLogLine : public Print
+{
+public:
+  BinLogLine() : length(0) {}
+
+  size_t write(uint8_t value) override
+  {
+    if (length >= BINLOG_TEXT_MAX)
+    {
+      return 0;
+    } // if
+    text[length++] = value;
+    return 1;
+  } // write()
+
+  using Print::write;
+
+  uint8_t text[BINLOG_TEXT_MAX];
+  size_t length;
+};
+
+static void putWord(uint8_t *data, uint32_t value)
+{
+  data[0] = (uint8_t)(value & 0xFF);
+  data[1] = (uint8_t)((value >> 8) & 0xFF);
+  data[2] = (uint8_t)((value >> 16) & 0xFF);
+  data[3] = (uint8_t)(value >> 24);
+} // putWord()
+
+static uint32_t getWord(const uint8_t *data)
+{
+  return (uint32_t)data[0] | ((uint32_t)data[1] << 8) |
+         ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+} // getWord()
+
+/**
+ * @brief Format for a message id, including the ones BinLog makes itself.
+ */
+static const char *formatFor(uint8_t id, const char *const *formats,
+                             uint8_t formatCount)
+{
+  if (id == BINLOG_ID_DROPPED)
+  {
+    return "<BinLog> %u messages dropped, the ring was full.";
+  } // if
+  if (id >= formatCount)
+  {
+    return "<BinLog> Unknown message id. Is the decoder built with this sketch's logMessages.h?";
+  } // if
+  return formats[id];
+} // formatFor()
+
+BinLog::BinLog()
+    : head(0), tail(0), loggedCount(0), droppedCount(0), droppedReported(0)
+{
+  for (uint8_t i = 0; i < BINLOG_SLOTS; i++)
+  {
+    slots[i].seq.store(0, std::memory_order_relaxed);
+  } // for
+} // BinLog()
+
+/**
+ * @details A slot is claimed by moving head on with compare-and-swap, so two
+ * callers (say loop() and an interrupt) never get the same one. The record is
+ * filled in after the claim and published by setting the slot's sequence
+ * number last. drain() waits at a claimed slot until it is published, which
+ * keeps the messages in order.
+ */
+bool BinLog::put(uint8_t id, const uint32_t *args, uint8_t count)
+{
+  uint32_t timeUs = micros();
+  uint32_t pos = head.load(std::memory_order_relaxed);
+  do
+  {
+    // Signed, because pos may be stale and already behind tail.
+    if ((int32_t)(pos - tail.load(std::memory_order_acquire)) >= BINLOG_SLOTS)
+    {
+      droppedCount.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    } // if
+  } while (!head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed));
+
+  Slot &slot = slots[pos & (BINLOG_SLOTS - 1)];
+  slot.record.timeUs = timeUs;
+  slot.record.id = id;
+  slot.record.argCount = count;
+  memcpy(slot.record.args, args, count * sizeof(uint32_t));
+  slot.seq.store(pos + 1, std::memory_order_release);
+  loggedCount.fetch_add(1, std::memory_order_relaxed);
+  return true;
+} // put()
+
+/**
+ * @brief Copy the oldest published message without taking it. Drops are
+ * reported once the ring has been emptied, which puts the report after the
+ * messages that filled it.
+ */
+bool BinLog::peek(BinLogRecord &record)
+{
+  uint32_t pos = tail.load(std::memory_order_relaxed);
+  Slot &slot = slots[pos & (BINLOG_SLOTS - 1)];
+  if (slot.seq.load(std::memory_order_acquire) == pos + 1)
+  {
+    record = slot.record;
+    return true;
+  } // if
+
+  uint32_t lost = droppedCount.load(std::memory_order_relaxed) - droppedReported;
+  if (lost > 0)
+  {
+    record.timeUs = micros();
+    record.id = BINLOG_ID_DROPPED;
+    record.argCount = 1;
+    record.args[0] = lost;
+    return true;
+  } // if
+  return false;
+} // peek()
+
+/**
+ * @brief Take the message peek() returned.
+ */
+void BinLog::consume(const BinLogRecord &record)
+{
+  if (record.id == BINLOG_ID_DROPPED)
+  {
+    droppedReported += record.args[0];
+    return;
+  } // if
+  tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+} // consume()
+
+size_t BinLog::drain(Print &out, size_t budget)
+{
+  size_t sent = 0;
+  uint8_t frame[BINLOG_FRAME_MAX];
+  BinLogRecord record;
+  while (peek(record))
+  {
+    size_t length = encodeFrame(record, frame);
+    if (sent + length > budget)
+    {
+      break; // The rest waits for the next call.
+    } // if
+    out.write(frame, length);
+    sent += length;
+    consume(record);
+  } // while
+  return sent;
+} // drain()
+
+/**
+ * @details The serial transmit buffer must hold BINLOG_TEXT_MAX bytes, or a
+ * line of that length never fits the budget.
+ */
+size_t BinLog::drainText(Print &out, const char *const *formats,
+                         uint8_t formatCount, size_t budget)
+{
+  size_t sent = 0;
+  BinLogRecord record;
+  while (peek(record))
+  {
+    BinLogLine line;
+    printRecord(line, formatFor(record.id, formats, formatCount), record);
+    if (sent + line.length > budget)
+    {
+      break;
+    } // if
+    out.write(line.text, line.length);
+    sent += line.length;
+    consume(record);
+  } // while
+  return sent;
+} // drainText()
+
+/**
+ * @details Only while nothing is calling log(), a half written message would
+ * land in a slot the ring has already given out again.
+ */
+void BinLog::clear()
+{
+  tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+  droppedReported = droppedCount.load(std::memory_order_relaxed);
+} // clear()
+
+size_t BinLog::encodeFrame(const BinLogRecord &record, uint8_t *frame)
+{
+  uint8_t count = record.argCount > BINLOG_MAX_ARGS ? BINLOG_MAX_ARGS : record.argCount;
+  size_t length = 0;
+  frame[length++] = BINLOG_FRAME_START;
+  frame[length++] = record.id;
+  frame[length++] = count;
+  putWord(frame + length, record.timeUs);
+  length += 4;
+  for (uint8_t i = 0; i < count; i++)
+  {
+    putWord(frame + length, record.args[i]);
+    length += 4;
+  } // for
+  uint8_t sum = 0;
+  for (size_t i = 1; i < length; i++)
+  {
+    sum += frame[i];
+  } // for
+  frame[length++] = sum;
+  return length;
+} // encodeFrame()
+
+void BinLog::printRecord(Print &out, const char *format,
+                         const BinLogRecord &record)
+{
+  // Timestamp in seconds with all 6 decimals, as "12.000345".
+  out.print(record.timeUs / 1000000UL);
+  out.print('.');
+  unsigned long fraction = record.timeUs % 1000000UL;
+  for (unsigned long digit = 100000UL; digit > 1 && fraction < digit; digit /= 10)
+  {
+    out.print('0');
+  } // for
+  out.print(fraction);
+  out.print(' ');
+
+  uint8_t next = 0;
+  for (const char *p = format; *p != '\0'; p++)
+  {
+    if (*p != '%')
+    {
+      out.print(*p);
+      continue;
+    } // if
+    p++;
+    int precision = 2;
+    if (*p == '.')
+    {
+      precision = 0;
+      for (p++; *p >= '0' && *p <= '9'; p++)
+      {
+        precision = precision * 10 + (*p - '0');
+      } // for
+    } // if
+    if (*p == '\0')
+    {
+      break;
+    } // if
+    if (*p == '%')
+    {
+      out.print('%');
+      continue;
+    } // if
+    if (next >= record.argCount)
+    {
+      out.print('?'); // The call passed fewer arguments than the format.
+      continue;
+    } // if
+    uint32_t word = record.args[next++];
+    switch (*p)
+    {
+    case 'd':
+    case 'i':
+      out.print((long)(int32_t)word);
+      break;
+    case 'u':
+      out.print((unsigned long)word);
+      break;
+    case 'x':
+    case 'X':
+      out.print((unsigned long)word, HEX);
+      break;
+    case 'c':
+      out.print((char)word);
+      break;
+    case 'f':
+    {
+      float value;
+      memcpy(&value, &word, sizeof(value));
+      out.print(value, precision);
+      break;
+    }
+    default:
+      out.print('%');
+      out.print(*p);
+      break;
+    } // switch
+  } // for
+  out.println();
+} // printRecord()
+
+BinLogDecoder::BinLogDecoder(const char *const *formats, uint8_t formatCount)
+    : frames(0), badFrames(0), dropped(0), formats(formats),
+      formatCount(formatCount), length(0)
+{
+} // BinLogDecoder()
+
+void BinLogDecoder::feed(uint8_t value, Print &out)
+{
+  if (length == 0)
+  {
+    if (value == BINLOG_FRAME_START)
+    {
+      frame[length++] = value;
+    }
+    else
+    {
+      out.write(value); // Ordinary text.
+    } // else
+    return;
+  } // if
+
+  frame[length++] = value;
+  if (length == 3 && frame[2] > BINLOG_MAX_ARGS)
+  {
+    badFrames++; // Not a frame, or bytes were lost.
+    length = 0;
+    return;
+  } // if
+  if (length >= 3 && length == BINLOG_FRAME_HEADER + 4 * frame[2])
+  {
+    finishFrame(out);
+  } // if
+} // feed()
+
+void BinLogDecoder::finishFrame(Print &out)
+{
+  uint8_t sum = 0;
+  for (uint8_t i = 1; i < length - 1; i++)
+  {
+    sum += frame[i];
+  } // for
+  if (sum != frame[length - 1])
+  {
+    badFrames++;
+    length = 0;
+    return;
+  } // if
+
+  BinLogRecord record;
+  record.id = frame[1];
+  record.argCount = frame[2];
+  record.timeUs = getWord(frame + 3);
+  for (uint8_t i = 0; i < record.argCount; i++)
+  {
+    record.args[i] = getWord(frame + 7 + 4 * i);
+  } // for
+  if (record.id == BINLOG_ID_DROPPED)
+  {
+    dropped += record.args[0];
+  } // if
+  BinLog::printRecord(out, formatFor(record.id, formats, formatCount), record);
+  frames++;
+  length = 0;
+} // finishFrame()
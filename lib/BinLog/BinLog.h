@@ -0,0 +1,218 @@
+/**
+ * @file BinLog.h
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Deferred binary logging: log calls store a message id and raw
+ * arguments in a RAM ring, and the text is rebuilt later.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details
+ * Serial.println() in a control function formats the text right there and
+ * waits whenever the serial transmit buffer is full. At 115200 baud one
+ * character takes 87 us, so a burst of messages can hold up the motors for
+ * milliseconds. BinLog moves that work out of the control function:
+ *
+ * 1. log(id, args...) copies a one byte message id, a micros() timestamp and
+ *    up to BINLOG_MAX_ARGS numbers into a fixed ring and returns. There is no
+ *    formatting, no waiting and nothing is allocated. If the ring is full the
+ *    message is dropped and counted.
+ * 2. drain() runs when the sketch has nothing else to do, usually from
+ *    loop() while it waits for the next pass. It sends as many whole frames
+ *    as the serial port can take without waiting.
+ * 3. BinLogDecoder turns the frames back into text on the computer (see the
+ *    binLogDecode host program). The format strings only exist there, so
+ *    they take no flash on the board either.
+ *
+ * Messages are listed once, in a logMessages.h next to the sketch, with an
+ * X-macro. The same list makes the ids for the board and the string table for
+ * the decoder, so the two cannot drift apart:
+ *
+ *   #define LOG_MESSAGES(X) \
+ *     X(LOG_GO_FORWARD, "<goForward> Forward.") \
+ *     X(LOG_JOYSTICK, "<checkJoystick> x = %d, y = %d, b = %d")
+ *   enum LogMessage : uint8_t { LOG_MESSAGES(BINLOG_ENUM) LOG_MESSAGE_COUNT };
+ *
+ *   binLog.log(LOG_JOYSTICK, xValue, yValue, bValue);
+ *
+ * Formats understand %d %i %u %x %X %c %f (with an optional precision such
+ * as %.2f) and %%. Every argument is stored as 4 bytes: integers as 32 bits,
+ * float and double as a 32 bit float.
+ *
+ * Frame on the wire (little endian):
+ *   0x1E, id, argument count, timestamp (4), arguments (4 each), checksum
+ * The checksum is the low byte of the sum of every byte after 0x1E. 0x1E is
+ * an ASCII control code that text never contains, so ordinary Serial.print()
+ * output can share the port and the decoder passes it through unchanged.
+ *
+ * Threads: log() may be called from any task or interrupt at the same time
+ * (the ring is lock-free, slots are claimed with compare-and-swap). drain(),
+ * drainText() and clear() must only be called from one place.
+ */
+#ifndef BIN_LOG_H
+#define BIN_LOG_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <string.h>
+
+// Messages the ring can hold. Must be a power of two.
+#ifndef BINLOG_SLOTS
+#define BINLOG_SLOTS 32
+#endif
+
+// Most arguments one message can carry.
+#define BINLOG_MAX_ARGS 4
+
+// First byte of every frame.
+#define BINLOG_FRAME_START 0x1E
+
+// Frame without arguments: start, id, count, timestamp and checksum.
+#define BINLOG_FRAME_HEADER 8
+
+// Longest frame.
+#define BINLOG_FRAME_MAX (BINLOG_FRAME_HEADER + 4 * BINLOG_MAX_ARGS)
+
+// Id of the frame that reports dropped messages. Sketches may use 0 to 254.
+#define BINLOG_ID_DROPPED 255
+
+// Longest line drainText() sends. Longer lines are cut short.
+#define BINLOG_TEXT_MAX 96
+
+// X-macro helpers for a sketch's LOG_MESSAGES list.
+#define BINLOG_ENUM(id, format) id,
+#define BINLOG_FORMAT(id, format) format,
+
+/**
+ * @brief One logged message.
+ */
+struct BinLogRecord
+{
+  uint32_t timeUs;
+  uint8_t id;
+  uint8_t argCount;
+  uint32_t args[BINLOG_MAX_ARGS];
+};
+
+class BinLog
+{
+public:
+  BinLog();
+
+  /**
+   * @brief Store a message. Safe from any task or interrupt.
+   * @return false if the ring was full and the message was dropped.
+   */
+  template <typename... Args>
+  bool log(uint8_t id, Args... args)
+  {
+    static_assert(sizeof...(Args) <= BINLOG_MAX_ARGS,
+                  "Too many arguments for one BinLog message");
+    const uint32_t words[] = {toWord(args)..., 0}; // The 0 avoids an empty array.
+    return put(id, words, sizeof...(Args));
+  }
+
+  /**
+   * @brief Send waiting messages as binary frames, oldest first.
+   * @param budget Bytes that can be written without waiting, usually
+   * Serial.availableForWrite(). Only whole frames are sent.
+   * @return Bytes sent.
+   */
+  size_t drain(Print &out, size_t budget);
+
+  /**
+   * @brief Send waiting messages as text lines instead, for a plain serial
+   * monitor. Formatting happens here, still outside the log() call.
+   * @param formats The sketch's LOG_MESSAGES(BINLOG_FORMAT) table.
+   * @return Bytes sent.
+   */
+  size_t drainText(Print &out, const char *const *formats,
+                   uint8_t formatCount, size_t budget);
+
+  /**
+   * @brief Throw away every waiting message.
+   */
+  void clear();
+
+  uint32_t logged() const { return loggedCount.load(std::memory_order_relaxed); }
+  uint32_t dropped() const { return droppedCount.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief Build the frame for one record.
+   * @param frame At least BINLOG_FRAME_MAX bytes.
+   * @return Frame length.
+   */
+  static size_t encodeFrame(const BinLogRecord &record, uint8_t *frame);
+
+  /**
+   * @brief Print one record as a line: the timestamp in seconds, then the
+   * formatted message.
+   */
+  static void printRecord(Print &out, const char *format,
+                          const BinLogRecord &record);
+
+private:
+  struct Slot
+  {
+    std::atomic<uint32_t> seq; // Position + 1 once the record is complete.
+    BinLogRecord record;
+  };
+
+  static uint32_t toWord(int value) { return (uint32_t)value; }
+  static uint32_t toWord(unsigned int value) { return value; }
+  static uint32_t toWord(long value) { return (uint32_t)value; }
+  static uint32_t toWord(unsigned long value) { return (uint32_t)value; }
+  static uint32_t toWord(char value) { return (uint32_t)(uint8_t)value; }
+  static uint32_t toWord(bool value) { return value ? 1 : 0; }
+  static uint32_t toWord(float value)
+  {
+    uint32_t word;
+    memcpy(&word, &value, sizeof(word));
+    return word;
+  } // toWord()
+  static uint32_t toWord(double value) { return toWord((float)value); }
+
+  bool put(uint8_t id, const uint32_t *args, uint8_t count);
+  bool peek(BinLogRecord &record);
+  void consume(const BinLogRecord &record);
+
+  Slot slots[BINLOG_SLOTS];
+  std::atomic<uint32_t> head;    // Next position to claim.
+  std::atomic<uint32_t> tail;    // Next position to drain.
+  std::atomic<uint32_t> loggedCount;
+  std::atomic<uint32_t> droppedCount;
+  uint32_t droppedReported;      // Drain side only.
+};
+
+/**
+ * @brief Rebuilds text from a stream of frames and ordinary text.
+ */
+class BinLogDecoder
+{
+public:
+  /**
+   * @param formats The sketch's LOG_MESSAGES(BINLOG_FORMAT) table.
+   */
+  BinLogDecoder(const char *const *formats, uint8_t formatCount);
+
+  /**
+   * @brief Take the next byte from the serial port. Text bytes are written
+   * straight to out, finished frames as a line each.
+   */
+  void feed(uint8_t value, Print &out);
+
+  uint32_t frames;      // Frames decoded.
+  uint32_t badFrames;   // Frames with a bad length or checksum.
+  uint32_t dropped;     // Messages the board reported dropped.
+
+private:
+  void finishFrame(Print &out);
+
+  const char *const *formats;
+  uint8_t formatCount;
+  uint8_t frame[BINLOG_FRAME_MAX];
+  uint8_t length;       // Bytes of the current frame so far, 0 = text.
+};
+
+#endif // BIN_LOG_H
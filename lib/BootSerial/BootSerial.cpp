@@ -0,0 +1,119 @@
+/**
+ * @file BootSerial.cpp
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Serial output that never holds up the sketch. See BootSerial.h.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ */
+#include "BootSerial.h"
+
+BootSerial::BootSerial(HardwareSerial &port)
+    : port(port), head(0), tail(0), lost(0), lostReported(0), reportsRoom(true)
+{
+} // BootSerial()
+
+void BootSerial::begin(unsigned long baud)
+{
+  port.begin(baud);
+  reportsRoom = port.availableForWrite() > 0;
+} // begin()
+
+uint16_t BootSerial::queued() const
+{
+  return (head + BOOT_SERIAL_BUFFER - tail) % BOOT_SERIAL_BUFFER;
+} // queued()
+
+/**
+ * @brief Bytes the port takes now without waiting.
+ */
+int BootSerial::room()
+{
+  return reportsRoom ? port.availableForWrite() : BOOT_SERIAL_BLIND_WRITE;
+} // room()
+
+int BootSerial::availableForWrite()
+{
+  return BOOT_SERIAL_BUFFER - 1 - queued();
+} // availableForWrite()
+
+/**
+ * @details Goes straight to the port when nothing is waiting and the port
+ * has room, so the order of the output never changes.
+ */
+size_t BootSerial::write(const uint8_t *buffer, size_t size)
+{
+  if (queued() == 0 && port && room() >= (int)size)
+  {
+    return port.write(buffer, size);
+  } // if
+  for (size_t i = 0; i < size; i++)
+  {
+    uint16_t next = (head + 1) % BOOT_SERIAL_BUFFER;
+    if (next == tail)
+    {
+      lost += size - i;
+      break;
+    } // if
+    ring[head] = buffer[i];
+    head = next;
+  } // for
+  poll();
+  return size;
+} // write()
+
+size_t BootSerial::write(uint8_t value)
+{
+  return write(&value, 1);
+} // write()
+
+/**
+ * @details Sends up to the end of the ring in one write and the wrapped part
+ * on the next pass. A port that does not report its room gets one
+ * BOOT_SERIAL_BLIND_WRITE chunk per call, so a poll() never waits for more
+ * than that.
+ */
+void BootSerial::poll()
+{
+  if (!port)
+  {
+    return;
+  } // if
+  while (queued() > 0)
+  {
+    int free = room();
+    if (free <= 0)
+    {
+      return;
+    } // if
+    uint16_t run = head > tail ? head - tail : BOOT_SERIAL_BUFFER - tail;
+    if (run > free)
+    {
+      run = free;
+    } // if
+    port.write(ring + tail, run);
+    tail = (tail + run) % BOOT_SERIAL_BUFFER;
+    if (!reportsRoom)
+    {
+      break;
+    } // if
+  } // while
+  if (queued() == 0 && lost != lostReported)
+  {
+    lostReported = lost;
+    port.print("<BootSerial> dropped ");
+    port.print(lost);
+    port.println(" bytes while no host was listening");
+  } // if
+} // poll()
+
+void BootSerial::mark(const char *what)
+{
+  unsigned long us = micros();
+  print("<boot> ");
+  print(what);
+  print(" at ");
+  print(us);
+  println(" us");
+} // mark()
@@ -0,0 +1,103 @@
+/**
+ * @file BootSerial.h
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Serial output that never holds up the sketch: kept in RAM until a
+ * host is listening and the port has room, then sent from loop().
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details
+ * `while (!Serial)` in setup() stops the sketch until the Serial Monitor is
+ * open. Powered from a battery, the robot never starts its motor or radio.
+ * BootSerial stands in for Serial instead:
+ *
+ *   BootSerial console(Serial);
+ *   setup(): console.begin(115200); ... console.println("Starting");
+ *   loop():  console.poll(); ...
+ *
+ * - While no host is attached, or the port's transmit buffer is full, what
+ *   is printed goes into a BOOT_SERIAL_BUFFER byte ring. When the ring is
+ *   full the rest is dropped and counted, never waited for. Once the ring
+ *   has been sent, a line says how much was dropped.
+ * - poll() sends what is in the ring, as much as the port takes without
+ *   waiting. Call it from loop() and from any loop that waits.
+ * - Input (available(), read(), peek()) comes straight from the port.
+ * - mark() prints how long after start the sketch got somewhere, such as
+ *   first driving the motor, the radio or a display. The time is micros(),
+ *   which starts when the core starts its clock just before setup(). What
+ *   runs before that (the bootloader, the core's own start-up) is not
+ *   included.
+ *
+ * Use one BootSerial per port, from one task only (loop() on the UNO R4).
+ * Whether a host is attached comes from the port's operator bool: true once
+ * the USB port is opened on a native USB board, always true on a UART (the
+ * UNO R4 WiFi's USB bridge, the ESP32), where nothing blocks anyway.
+ */
+#ifndef BOOT_SERIAL_H
+#define BOOT_SERIAL_H
+
+#include <Arduino.h>
+
+// Bytes of output kept while no host is listening.
+#define BOOT_SERIAL_BUFFER 1024
+
+// Bytes sent per poll() to a port that does not report its free transmit
+// space (availableForWrite() is 0 with an empty buffer). Such a port may
+// wait while it sends them, as Serial always did.
+#define BOOT_SERIAL_BLIND_WRITE 64
+
+class BootSerial : public Stream
+{
+public:
+  explicit BootSerial(HardwareSerial &port);
+
+  /**
+   * @brief Start the port. Does not wait for a host.
+   */
+  void begin(unsigned long baud);
+
+  /**
+   * @brief Send what is waiting, as much as the port takes without waiting.
+   */
+  void poll();
+
+  /**
+   * @brief Print "<boot> what at N us", the time since start.
+   * @param what Such as "motor running".
+   */
+  void mark(const char *what);
+
+  size_t write(uint8_t value) override;
+  size_t write(const uint8_t *buffer, size_t size) override;
+  using Print::write;
+
+  /**
+   * @brief Bytes that can be printed before the ring is full.
+   */
+  int availableForWrite() override;
+
+  int available() override { return port.available(); }
+  int read() override { return port.read(); }
+  int peek() override { return port.peek(); }
+
+  /**
+   * @brief Bytes dropped because the ring was full.
+   */
+  uint32_t dropped() const { return lost; }
+
+private:
+  uint16_t queued() const;
+  int room();
+
+  HardwareSerial &port;
+  uint8_t ring[BOOT_SERIAL_BUFFER];
+  uint16_t head;           // Next byte to store.
+  uint16_t tail;           // Next byte to send.
+  uint32_t lost;
+  uint32_t lostReported;   // lost when the last drop line was printed.
+  bool reportsRoom;        // availableForWrite() of the port can be trusted.
+};
+
+#endif // BOOT_SERIAL_H
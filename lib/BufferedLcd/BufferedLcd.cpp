@@ -0,0 +1,252 @@
+/**
+ * @file BufferedLcd.cpp
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Framebuffer-diffed HD44780 driver. See BufferedLcd.h.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ */
+#include "BufferedLcd.h"
+
+// PCF8574 to HD44780 wiring on the common LCD backpacks.
+#define LCD_RS 0x01        // P0: register select (1 = data)
+#define LCD_EN 0x04        // P2: enable strobe, data latched on falling edge
+#define LCD_BACKLIGHT 0x08 // P3: backlight
+                           // P4-P7: D4-D7
+
+// HD44780 commands.
+#define LCD_CLEAR 0x01
+#define LCD_ENTRY_MODE 0x06   // Increment cursor, no display shift.
+#define LCD_DISPLAY_ON 0x0C   // Display on, cursor off, blink off.
+#define LCD_FUNCTION_SET 0x28 // 4-bit bus, 2 lines, 5x8 font.
+#define LCD_SET_DDRAM 0x80
+
+// DDRAM address of the first cell of each row.
+static const uint8_t rowOffsets[BUFFERED_LCD_MAX_ROWS] = {0x00, 0x40, 0x14, 0x54};
+
+/**
+ * @brief Construct a driver. Nothing is sent until begin().
+ */
+BufferedLcd::BufferedLcd(uint8_t address, uint8_t cols, uint8_t rows,
+                         TwoWire &wire)
+    : wire(wire), address(address),
+      cols(cols > BUFFERED_LCD_MAX_COLS ? BUFFERED_LCD_MAX_COLS : cols),
+      rows(rows > BUFFERED_LCD_MAX_ROWS ? BUFFERED_LCD_MAX_ROWS : rows),
+      backlightOn(true), writeCol(0), writeRow(0), lcdCursor(-1),
+      burstLength(0), refreshTxns(0), writer(wireWriter), writerContext(this),
+      txnCount(0), byteCount(0)
+{
+  memset(frame, ' ', sizeof(frame));
+  memset(shown, ' ', sizeof(shown));
+} // BufferedLcd()
+
+/**
+ * @brief HD44780 4-bit initialization by instruction (datasheet figure 24).
+ */
+void BufferedLcd::begin()
+{
+  delay(50); // LCD power-on time.
+  writeNibble(0x30);
+  delayMicroseconds(4500);
+  writeNibble(0x30);
+  delayMicroseconds(150);
+  writeNibble(0x30);
+  delayMicroseconds(150);
+  writeNibble(0x20); // Switch to 4-bit mode.
+  delayMicroseconds(150);
+
+  queueByte(LCD_FUNCTION_SET, false);
+  queueByte(LCD_DISPLAY_ON, false);
+  queueByte(LCD_ENTRY_MODE, false);
+  queueByte(LCD_CLEAR, false);
+  flush();
+  delay(2); // Clear takes 1.52 ms.
+
+  memset(frame, ' ', sizeof(frame));
+  memset(shown, ' ', sizeof(shown));
+  writeCol = 0;
+  writeRow = 0;
+  lcdCursor = 0; // Clear homes the cursor.
+  txnCount = 0;
+  byteCount = 0;
+} // begin()
+
+/**
+ * @brief Route bursts through a custom writer (nullptr restores Wire).
+ */
+void BufferedLcd::setWriter(LcdBurstWriter newWriter, void *context)
+{
+  writer = newWriter != nullptr ? newWriter : wireWriter;
+  writerContext = newWriter != nullptr ? context : this;
+} // setWriter()
+
+/**
+ * @brief Move the framebuffer write position.
+ */
+void BufferedLcd::setCursor(uint8_t col, uint8_t row)
+{
+  writeCol = col < cols ? col : cols - 1;
+  writeRow = row < rows ? row : rows - 1;
+} // setCursor()
+
+/**
+ * @brief Blank the framebuffer. The LCD changes on the next refresh().
+ */
+void BufferedLcd::clear()
+{
+  memset(frame, ' ', sizeof(frame));
+  writeCol = 0;
+  writeRow = 0;
+} // clear()
+
+/**
+ * @brief Switch the backlight. Sent at once because it is a port bit, not text.
+ */
+void BufferedLcd::backlight(bool on)
+{
+  backlightOn = on;
+  uint8_t port = on ? LCD_BACKLIGHT : 0;
+  if (writer(address, &port, 1, writerContext))
+  {
+    txnCount++;
+    byteCount++;
+  } // if
+} // backlight()
+
+/**
+ * @brief Store one character. Characters past the end of a row are dropped,
+ * like on the real display.
+ */
+size_t BufferedLcd::write(uint8_t value)
+{
+  if (value == '\n')
+  {
+    setCursor(0, writeRow + 1);
+    return 1;
+  } // if
+  if (value == '\r')
+  {
+    writeCol = 0;
+    return 1;
+  } // if
+  if (writeCol >= cols)
+  {
+    return 0;
+  } // if
+  frame[writeRow * BUFFERED_LCD_MAX_COLS + writeCol] = (char)value;
+  writeCol++;
+  return 1;
+} // write()
+
+/**
+ * @brief Send only the cells that changed since the last refresh.
+ */
+uint8_t BufferedLcd::refresh()
+{
+  refreshTxns = 0;
+  for (uint8_t row = 0; row < rows; row++)
+  {
+    for (uint8_t col = 0; col < cols; col++)
+    {
+      int16_t cell = row * BUFFERED_LCD_MAX_COLS + col;
+      if (frame[cell] == shown[cell])
+      {
+        continue;
+      } // if
+
+      // A single unchanged cell between two changes costs the same 4 bytes
+      // to resend as a cursor move, so only move when the gap is bigger.
+      bool onePastCursor = (lcdCursor == cell - 1) && col > 0;
+      if (onePastCursor)
+      {
+        queueByte(shown[cell - 1], true);
+        lcdCursor = cell;
+      } // if
+      else if (lcdCursor != cell)
+      {
+        queueByte(LCD_SET_DDRAM | (rowOffsets[row] + col), false);
+        lcdCursor = cell;
+      } // else if
+
+      queueByte(frame[cell], true);
+      shown[cell] = frame[cell];
+      lcdCursor = (col + 1 < cols) ? cell + 1 : -1; // DDRAM rows are not contiguous.
+    } // for
+  } // for
+  flush();
+  return refreshTxns;
+} // refresh()
+
+/**
+ * @brief Pack one HD44780 byte as high nibble + strobe, low nibble + strobe.
+ */
+uint8_t BufferedLcd::packByte(uint8_t value, bool isData, bool backlightOn,
+                              uint8_t *out)
+{
+  uint8_t control = (backlightOn ? LCD_BACKLIGHT : 0) | (isData ? LCD_RS : 0);
+  uint8_t high = (value & 0xF0) | control;
+  uint8_t low = ((value << 4) & 0xF0) | control;
+  out[0] = high | LCD_EN;
+  out[1] = high;
+  out[2] = low | LCD_EN;
+  out[3] = low;
+  return 4;
+} // packByte()
+
+/**
+ * @brief Append one HD44780 byte to the burst, flushing first if it is full.
+ */
+void BufferedLcd::queueByte(uint8_t value, bool isData)
+{
+  if (burstLength + 4 > BUFFERED_LCD_MAX_BURST)
+  {
+    flush();
+  } // if
+  burstLength += packByte(value, isData, backlightOn, burst + burstLength);
+} // queueByte()
+
+/**
+ * @brief Send the pending burst as one I2C transaction.
+ */
+void BufferedLcd::flush()
+{
+  if (burstLength == 0)
+  {
+    return;
+  } // if
+  if (!writer(address, burst, burstLength, writerContext))
+  {
+    // We no longer know what the LCD shows or where its cursor is, so
+    // redraw everything on the next refresh.
+    memset(shown, 0, sizeof(shown));
+    lcdCursor = -1;
+  } // if
+  txnCount++;
+  byteCount += burstLength;
+  refreshTxns++;
+  burstLength = 0;
+} // flush()
+
+/**
+ * @brief Send one 4-bit value during initialization (before 4-bit mode).
+ */
+void BufferedLcd::writeNibble(uint8_t nibble)
+{
+  uint8_t control = backlightOn ? LCD_BACKLIGHT : 0;
+  uint8_t bytes[2] = {(uint8_t)((nibble & 0xF0) | control | LCD_EN),
+                      (uint8_t)((nibble & 0xF0) | control)};
+  writer(address, bytes, 2, writerContext);
+} // writeNibble()
+
+/**
+ * @brief Default writer: one Wire transaction per burst.
+ */
+bool BufferedLcd::wireWriter(uint8_t address, const uint8_t *data,
+                             uint8_t length, void *context)
+{
+  BufferedLcd *self = static_cast<BufferedLcd *>(context);
+  self->wire.beginTransmission(address);
+  self->wire.write(data, length);
+  return self->wire.endTransmission() == 0;
+} // wireWriter()
@@ -0,0 +1,149 @@
+/**
+ * @file BufferedLcd.h
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Framebuffer-diffed HD44780 driver for PCF8574 I2C LCD backpacks.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details
+ * LiquidCrystal_I2C sends every character as its own set of single byte I2C
+ * transactions (high nibble, EN strobe, low nibble, EN strobe), so redrawing a
+ * 16x2 screen costs dozens of transactions even when only one digit changed.
+ *
+ * BufferedLcd works differently:
+ * - print(), write(), setCursor() and clear() only change a framebuffer in RAM.
+ * - refresh() compares the framebuffer with a copy of what the LCD is already
+ *   showing and sends only the cells that changed.
+ * - A "set DDRAM address" command is only sent when the next changed cell is
+ *   not where the LCD's own cursor already is.
+ * - All the PCF8574 port bytes for a run of characters (4 per character) are
+ *   packed into a single I2C burst of up to BUFFERED_LCD_MAX_BURST bytes.
+ *
+ * A status line that changes a couple of digits several times a second costs
+ * one short transaction per refresh, and nothing at all when the text is the
+ * same.
+ *
+ * Bursts go to Wire by default. setWriter() can route them somewhere else, for
+ * example to an I2cScheduler queue.
+ *
+ * Timing note: the HD44780 needs 37 us after each character. There are always
+ * 2 burst bytes between one character being latched and the next, about
+ * 180 us at 100 kHz, so the LCD has plenty of time. Run the bus at 100 kHz:
+ * the PCF8574 backpack is not rated for more.
+ */
+#ifndef BUFFERED_LCD_H
+#define BUFFERED_LCD_H
+
+#include <Arduino.h>
+#include <Wire.h>
+
+// Largest I2C write sent in one transaction. Must be a multiple of 4 and fit
+// the Wire buffer (32 bytes is the smallest of the cores we use).
+#ifndef BUFFERED_LCD_MAX_BURST
+#define BUFFERED_LCD_MAX_BURST 32
+#endif
+
+// Largest supported display (20x4).
+#define BUFFERED_LCD_MAX_COLS 20
+#define BUFFERED_LCD_MAX_ROWS 4
+
+/**
+ * @brief Sends one burst of PCF8574 port bytes to the LCD.
+ * @return true if the device acknowledged.
+ */
+typedef bool (*LcdBurstWriter)(uint8_t address, const uint8_t *data,
+                               uint8_t length, void *context);
+
+class BufferedLcd : public Print
+{
+public:
+  BufferedLcd(uint8_t address, uint8_t cols, uint8_t rows, TwoWire &wire = Wire);
+
+  /**
+   * @brief Initialize the LCD in 4-bit mode. Blocks for ~60 ms, setup() only.
+   */
+  void begin();
+
+  /**
+   * @brief Send bursts through a custom writer instead of Wire.
+   * @details Call after begin(): initialization needs exact delays between
+   * writes and always goes straight to the writer in use at the time.
+   */
+  void setWriter(LcdBurstWriter writer, void *context);
+
+  /**
+   * @brief Move the framebuffer write position.
+   */
+  void setCursor(uint8_t col, uint8_t row);
+
+  /**
+   * @brief Fill the framebuffer with spaces and move to 0,0.
+   */
+  void clear();
+
+  /**
+   * @brief Turn the backlight on or off (sent immediately).
+   */
+  void backlight(bool on);
+
+  /**
+   * @brief Put one character into the framebuffer (Print interface).
+   */
+  size_t write(uint8_t value) override;
+  using Print::write;
+
+  /**
+   * @brief Send the changed cells to the LCD.
+   * @return Number of I2C transactions used (0 if nothing changed).
+   */
+  uint8_t refresh();
+
+  /**
+   * @brief Total I2C transactions sent since begin().
+   */
+  uint32_t transactions() const { return txnCount; }
+
+  /**
+   * @brief Total PCF8574 port bytes sent since begin().
+   */
+  uint32_t bytesSent() const { return byteCount; }
+
+  /**
+   * @brief Pack one HD44780 command or data byte as 4 PCF8574 port bytes.
+   * @return Number of bytes written to out (always 4).
+   */
+  static uint8_t packByte(uint8_t value, bool isData, bool backlightOn,
+                          uint8_t *out);
+
+private:
+  void queueByte(uint8_t value, bool isData);
+  void flush();
+  void writeNibble(uint8_t nibble);
+  static bool wireWriter(uint8_t address, const uint8_t *data, uint8_t length,
+                         void *context);
+
+  TwoWire &wire;
+  uint8_t address;
+  uint8_t cols;
+  uint8_t rows;
+  bool backlightOn;
+
+  char frame[BUFFERED_LCD_MAX_ROWS * BUFFERED_LCD_MAX_COLS]; // What we want.
+  char shown[BUFFERED_LCD_MAX_ROWS * BUFFERED_LCD_MAX_COLS]; // What the LCD has.
+  uint8_t writeCol;  // Framebuffer write position.
+  uint8_t writeRow;
+  int16_t lcdCursor; // Cell index the LCD's cursor is on, -1 if unknown.
+
+  uint8_t burst[BUFFERED_LCD_MAX_BURST];
+  uint8_t burstLength;
+  uint8_t refreshTxns;
+
+  LcdBurstWriter writer;
+  void *writerContext;
+  uint32_t txnCount;
+  uint32_t byteCount;
+};
+
+#endif // BUFFERED_LCD_H
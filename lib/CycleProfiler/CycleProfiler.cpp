@@ -0,0 +1,257 @@
+/**
+ * @file CycleProfiler.cpp
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Cycle counting per named zone. See CycleProfiler.h.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details Nothing here is referenced when CYCLE_PROFILER is 0, so the linker
+ * leaves all of it out.
+ */
+#include "CycleProfiler.h"
+
+// Scopes timed back to back by begin() to find the cost of one.
+#define CYCLE_PROFILER_CALIBRATION_RUNS 16
+
+ProfileZone *CycleProfiler::zones = nullptr;
+uint32_t CycleProfiler::scopeOverhead = 0;
+
+void CycleCounter::begin()
+{
+#if defined(ARDUINO_ARCH_RENESAS)
+  CYCLE_DEMCR |= CYCLE_DEMCR_TRCENA; // Power the DWT unit.
+  CYCLE_DWT_CYCCNT = 0;
+  CYCLE_DWT_CTRL |= CYCLE_DWT_CTRL_CYCCNTENA;
+#endif
+} // begin()
+
+uint32_t CycleCounter::perUs()
+{
+#if defined(ARDUINO_ARCH_RENESAS)
+  return SystemCoreClock / 1000000UL;
+#elif defined(ESP32)
+  return ESP.getCpuFreqMHz();
+#else
+  return 1; // micros() stands in for the counter.
+#endif
+} // perUs()
+
+/**
+ * @brief Histogram bucket for a measurement, one per power of two.
+ */
+static uint8_t bucketFor(uint32_t cycles)
+{
+  if (cycles < 16)
+  {
+    return 0;
+  } // if
+  uint8_t bucket = (31 - __builtin_clz(cycles)) - 3; // CLZ is one instruction.
+  return bucket < CYCLE_PROFILER_BUCKETS ? bucket : CYCLE_PROFILER_BUCKETS - 1;
+} // bucketFor()
+
+/**
+ * @brief Print a cycle count with its time in microseconds.
+ */
+static void printCycles(Print &out, const char *label, uint32_t cycles)
+{
+  out.print(label);
+  out.print(cycles);
+  out.print(" (");
+  out.print((float)cycles / CycleCounter::perUs(), 2);
+  out.print(" us)");
+} // printCycles()
+
+/**
+ * @details Zones go on the end of the list, so the report lists them in the
+ * order they were declared.
+ */
+ProfileZone::ProfileZone(const char *name, const char *kind)
+    : name(name), kind(kind), next(nullptr)
+{
+  reset();
+  ProfileZone **link = &CycleProfiler::zones;
+  while (*link != nullptr)
+  {
+    link = &(*link)->next;
+  } // while
+  *link = this;
+} // ProfileZone()
+
+void ProfileZone::add(uint32_t cycles)
+{
+  count++;
+  totalCycles += cycles;
+  if (cycles < minCycles)
+  {
+    minCycles = cycles;
+  } // if
+  if (cycles > maxCycles)
+  {
+    maxCycles = cycles;
+  } // if
+  buckets[bucketFor(cycles)]++;
+} // add()
+
+void ProfileZone::reset()
+{
+  count = 0;
+  minCycles = UINT32_MAX;
+  maxCycles = 0;
+  totalCycles = 0;
+  for (uint8_t i = 0; i < CYCLE_PROFILER_BUCKETS; i++)
+  {
+    buckets[i] = 0;
+  } // for
+} // reset()
+
+/**
+ * @details Only buckets with something in them are printed, as
+ * "low-high:count". The last bucket has no upper end.
+ */
+void ProfileZone::print(Print &out) const
+{
+  out.print(name);
+  if (kind[0] != '\0')
+  {
+    out.print(' ');
+    out.print(kind);
+  } // if
+  out.print(": n=");
+  out.print(count);
+  if (count == 0)
+  {
+    out.println();
+    return;
+  } // if
+  printCycles(out, " min=", minCycles);
+  printCycles(out, " avg=", (uint32_t)(totalCycles / count));
+  printCycles(out, " max=", maxCycles);
+  out.println(" cycles");
+
+  out.print("  ");
+  for (uint8_t i = 0; i < CYCLE_PROFILER_BUCKETS; i++)
+  {
+    if (buckets[i] == 0)
+    {
+      continue;
+    } // if
+    uint32_t low = i == 0 ? 0 : 1UL << (i + 3);
+    out.print(low);
+    if (i < CYCLE_PROFILER_BUCKETS - 1)
+    {
+      out.print('-');
+      out.print((1UL << (i + 4)) - 1);
+    }
+    else
+    {
+      out.print('+');
+    } // else
+    out.print(':');
+    out.print(buckets[i]);
+    out.print(' ');
+  } // for
+  out.println();
+} // print()
+
+ProfileScope::~ProfileScope()
+{
+  uint32_t cycles = CycleCounter::now() - start;
+  zone.add(cycles > CycleProfiler::scopeOverhead ? cycles - CycleProfiler::scopeOverhead : 0);
+} // ~ProfileScope()
+
+IsrProbe::IsrProbe(const char *name, uint32_t periodUs)
+    : latency(name, "latency"), jitter(name, "jitter"), periodUs(periodUs),
+      periodCycles(0), lastCycles(0), started(false)
+{
+} // IsrProbe()
+
+/**
+ * @details Jitter is the distance of each interval from the period, early or
+ * late. An interrupt that was missed shows up as a full period of jitter.
+ */
+void IsrProbe::enter(uint32_t latencyCycles)
+{
+  uint32_t nowCycles = CycleCounter::now();
+  if (latencyCycles > 0)
+  {
+    latency.add(latencyCycles);
+  } // if
+  if (started)
+  {
+    uint32_t interval = nowCycles - lastCycles;
+    jitter.add(interval > periodCycles ? interval - periodCycles : periodCycles - interval);
+  }
+  else
+  {
+    periodCycles = periodUs * CycleCounter::perUs();
+    started = true;
+  } // else
+  lastCycles = nowCycles;
+} // enter()
+
+/**
+ * @details The scope cost is the least of a few empty scopes, so an
+ * interrupt during calibration does not inflate it.
+ */
+void CycleProfiler::begin()
+{
+  CycleCounter::begin();
+  scopeOverhead = 0;
+  ProfileZone calibration("calibration");
+  for (uint8_t i = 0; i < CYCLE_PROFILER_CALIBRATION_RUNS; i++)
+  {
+    ProfileScope scope(calibration);
+  } // for
+  scopeOverhead = calibration.minCycles;
+  ProfileZone **link = &zones; // Take it off the list again.
+  while (*link != &calibration)
+  {
+    link = &(*link)->next;
+  } // while
+  *link = calibration.next;
+} // begin()
+
+void CycleProfiler::report(Print &out)
+{
+  out.print("Profile, ");
+  out.print(CycleCounter::perUs());
+  out.print(" cycles/us, ");
+  out.print(scopeOverhead);
+  out.println(" cycles of scope overhead removed");
+  for (ProfileZone *zone = zones; zone != nullptr; zone = zone->next)
+  {
+    noInterrupts(); // An interrupt may be updating the zone.
+    ProfileZone copy(*zone);
+    interrupts();
+    copy.print(out);
+  } // for
+} // report()
+
+void CycleProfiler::reset()
+{
+  for (ProfileZone *zone = zones; zone != nullptr; zone = zone->next)
+  {
+    noInterrupts();
+    zone->reset();
+    interrupts();
+  } // for
+} // reset()
+
+void CycleProfiler::poll(Stream &port)
+{
+  while (port.available() > 0)
+  {
+    int command = port.read();
+    if (command == 'p')
+    {
+      report(port);
+    }
+    else if (command == 'r')
+    {
+      reset();
+      port.println("Profile cleared");
+    } // else if
+  } // while
+} // poll()
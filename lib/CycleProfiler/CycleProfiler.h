@@ -0,0 +1,224 @@
+/**
+ * @file CycleProfiler.h
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Count the CPU cycles code takes, per named zone, and print the
+ * results on demand.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details
+ * micros() is too coarse for a digitalWrite() that takes a fraction of a
+ * microsecond. Both lesson boards have a cycle counter that goes up by one
+ * every CPU clock:
+ * - UNO R4 (RA4M1, Cortex-M4, 48 MHz): the DWT CYCCNT register. begin()
+ *   turns it on.
+ * - ESP32 (240 MHz): the Xtensa CCOUNT register, ESP.getCycleCount(). Each
+ *   core has its own, so only time code that stays on one core.
+ * On any other build (such as the host) micros() stands in, one "cycle" per
+ * microsecond.
+ *
+ * A zone is a global ProfileZone. PROFILE_SCOPE(zone) at the top of a block
+ * times the block. Each zone keeps, in static storage, the count, min, max,
+ * total and a histogram with one bucket per power of two (0-15 cycles,
+ * 16-31, 32-63 ... and the last bucket for everything longer). The
+ * histogram shows the slow outliers that an average hides. Timing one scope
+ * costs a few cycles, which begin() measures and subtracts.
+ *
+ * IsrProbe measures a periodic interrupt: latency (event to the first line
+ * of the handler, read from the timer's own counter) and jitter (how far
+ * each interval between handler runs is from the period).
+ *
+ * Everything is behind the macros below. With CYCLE_PROFILER 0 (the
+ * default) they expand to nothing, so the zones, the timing and the report
+ * code are not in the program at all. Define CYCLE_PROFILER as 1 before
+ * including this header, or with -D CYCLE_PROFILER=1 in build_flags.
+ *
+ * Threads: a zone is updated without locks, so use each zone from one task
+ * or one interrupt only. report() copies each zone with interrupts off.
+ */
+#ifndef CYCLE_PROFILER_H
+#define CYCLE_PROFILER_H
+
+#include <Arduino.h>
+
+#ifndef CYCLE_PROFILER
+#define CYCLE_PROFILER 0
+#endif
+
+// Histogram buckets per zone. Bucket 0 is 0-15 cycles, bucket n is 2^(n+3)
+// to 2^(n+4)-1 and the last bucket is everything from 2^22 up (87 ms on the
+// UNO R4, 17 ms on the ESP32).
+#define CYCLE_PROFILER_BUCKETS 20
+
+#define CYCLE_PROFILER_CONCAT2(a, b) a##b
+#define CYCLE_PROFILER_CONCAT(a, b) CYCLE_PROFILER_CONCAT2(a, b)
+
+#if CYCLE_PROFILER
+#define PROFILE_BEGIN() CycleProfiler::begin()
+#define PROFILE_ZONE(var, name) ProfileZone var(name)
+#define PROFILE_SCOPE(zone) \
+  ProfileScope CYCLE_PROFILER_CONCAT(profileScope, __LINE__)(zone)
+#define PROFILE_ISR_PROBE(var, name, periodUs) IsrProbe var(name, periodUs)
+#define PROFILE_ISR(probe, latencyCycles) (probe).enter(latencyCycles)
+#define PROFILE_POLL(port) CycleProfiler::poll(port)
+#define PROFILE_REPORT(out) CycleProfiler::report(out)
+#else
+#define PROFILE_BEGIN() ((void)0)
+#define PROFILE_ZONE(var, name)
+#define PROFILE_SCOPE(zone)
+#define PROFILE_ISR_PROBE(var, name, periodUs)
+#define PROFILE_ISR(probe, latencyCycles) ((void)0)
+#define PROFILE_POLL(port) ((void)0)
+#define PROFILE_REPORT(out) ((void)0)
+#endif
+
+#if defined(ARDUINO_ARCH_RENESAS)
+// Cortex-M debug registers (ARMv7-M architecture manual).
+#define CYCLE_DEMCR (*(volatile uint32_t *)0xE000EDFC)
+#define CYCLE_DEMCR_TRCENA (1UL << 24)
+#define CYCLE_DWT_CTRL (*(volatile uint32_t *)0xE0001000)
+#define CYCLE_DWT_CTRL_CYCCNTENA (1UL << 0)
+#define CYCLE_DWT_CYCCNT (*(volatile uint32_t *)0xE0001004)
+#endif
+
+/**
+ * @brief The CPU cycle counter. Wraps every 2^32 cycles (89 s on the UNO R4,
+ * 18 s on the ESP32), so only time things shorter than that.
+ */
+class CycleCounter
+{
+public:
+  /**
+   * @brief Start the counter. Needed on the UNO R4, harmless elsewhere.
+   */
+  static void begin();
+
+  static inline uint32_t now()
+  {
+#if defined(ARDUINO_ARCH_RENESAS)
+    return CYCLE_DWT_CYCCNT;
+#elif defined(ESP32)
+    return ESP.getCycleCount();
+#else
+    return micros();
+#endif
+  } // now()
+
+  /**
+   * @brief Counter ticks per microsecond (the CPU clock in MHz).
+   */
+  static uint32_t perUs();
+};
+
+/**
+ * @brief Timing statistics for one named piece of code.
+ */
+class ProfileZone
+{
+public:
+  /**
+   * @param name Printed in the report. Must stay valid (use a literal).
+   * @param kind Printed after the name, such as "latency".
+   */
+  explicit ProfileZone(const char *name, const char *kind = "");
+
+  /**
+   * @brief Record one measurement.
+   */
+  void add(uint32_t cycles);
+
+  void reset();
+
+  /**
+   * @brief Print one line of statistics and one line of histogram.
+   */
+  void print(Print &out) const;
+
+  const char *name;
+  const char *kind;
+  uint32_t count;
+  uint32_t minCycles;
+  uint32_t maxCycles;
+  uint64_t totalCycles;
+  uint32_t buckets[CYCLE_PROFILER_BUCKETS];
+  ProfileZone *next;   // Every zone is on one list, for the report.
+};
+
+/**
+ * @brief Times the block it is declared in. Use through PROFILE_SCOPE().
+ */
+class ProfileScope
+{
+public:
+  explicit ProfileScope(ProfileZone &zone)
+      : zone(zone), start(CycleCounter::now())
+  {
+  } // ProfileScope()
+
+  ~ProfileScope();
+
+private:
+  ProfileZone &zone;
+  uint32_t start;
+};
+
+/**
+ * @brief Latency and jitter of a periodic interrupt.
+ */
+class IsrProbe
+{
+public:
+  /**
+   * @param name Printed in the report. Must stay valid (use a literal).
+   * @param periodUs Time between interrupts.
+   */
+  IsrProbe(const char *name, uint32_t periodUs);
+
+  /**
+   * @brief Call first thing in the handler.
+   * @param latencyCycles Cycles since the interrupt event, from the timer's
+   * counter. Pass 0 if the timer cannot tell, then only jitter is measured.
+   */
+  void enter(uint32_t latencyCycles);
+
+  ProfileZone latency;
+  ProfileZone jitter;  // Distance of each interval from the period.
+
+private:
+  uint32_t periodUs;
+  uint32_t periodCycles; // Set on the first interrupt.
+  uint32_t lastCycles;
+  bool started;
+};
+
+class CycleProfiler
+{
+public:
+  /**
+   * @brief Start the cycle counter and measure the cost of a scope.
+   */
+  static void begin();
+
+  /**
+   * @brief Print every zone.
+   */
+  static void report(Print &out);
+
+  /**
+   * @brief Clear every zone.
+   */
+  static void reset();
+
+  /**
+   * @brief Answer commands from the serial port: 'p' prints the report, 'r'
+   * clears it. Call from loop().
+   */
+  static void poll(Stream &port);
+
+  static ProfileZone *zones;      // First zone of the list.
+  static uint32_t scopeOverhead;  // Cycles a scope adds, subtracted from each.
+};
+
+#endif // CYCLE_PROFILER_H
@@ -0,0 +1,190 @@
+/**
+ * @file EventBus.h
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Publish/subscribe between interrupt handlers, callbacks, tasks and
+ * loop(), on lock-free queues.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details
+ * A global that a callback or an interrupt writes and loop() reads has two
+ * problems: loop() can read it half-written (a struct, or a value and the
+ * flag that says it is new), and nothing tells the compiler or the other
+ * core in what order the writes happen. A topic replaces such a global:
+ *
+ *   EVENT_TOPIC(joystickTopic, JoystickSample, 8, 2); // 7 queued, 2 readers
+ *   uint8_t motorReader = joystickTopic.subscribe();   // in setup()
+ *   joystickTopic.publish(sample);                     // in the ISR
+ *   while (joystickTopic.poll(motorReader, sample))    // in loop()
+ *
+ * Every subscriber has its own SpscRing (SpscRing.h), so subscribers never
+ * see each other's reads and a slow one only loses its own events. The rules
+ * that keep it lock-free:
+ * - Topics are global objects with a fixed size, declared with EVENT_TOPIC.
+ *   Nothing is allocated.
+ * - subscribe() in setup(), before anything publishes.
+ * - One publisher per topic: one interrupt handler, one task or loop(). Two
+ *   sources of the same kind of event (such as faults) get a topic each.
+ * - One reader per subscription.
+ * publish() copies the event into each subscriber's queue. That takes the
+ * same time every call (at most SUBSCRIBERS copies), never waits and is
+ * safe in an interrupt handler on the UNO R4 and the ESP32. When a queue is
+ * full the event is dropped for that subscriber and counted in
+ * overruns(subscriber).
+ *
+ * The event types below are the ones the lessons pass around. Events are
+ * plain structs, copied in and out, so keep them small.
+ */
+#ifndef EVENT_BUS_H
+#define EVENT_BUS_H
+
+#include <stdint.h>
+#include <atomic>
+#include <type_traits>
+#include "SpscRing.h"
+
+// Returned by subscribe() when a topic has no free subscriber queue.
+#define EVENT_NO_SUBSCRIBER 0xFF
+
+// Declare a topic: a global named var carrying events of type, each
+// subscriber queue holding size - 1 of them.
+#define EVENT_TOPIC(var, type, size, subscribers) \
+  EventTopic<type, size, subscribers> var(#var)
+
+/**
+ * @brief One joystick reading.
+ */
+struct JoystickSample
+{
+  uint32_t sampledUs; // micros() when it was read.
+  int16_t x;
+  int16_t y;
+  int16_t button;
+};
+
+/**
+ * @brief What a motor should do.
+ */
+struct MotorCommand
+{
+  uint32_t issuedUs;
+  int16_t duty; // Above 0 forward, below 0 reverse, 0 coast.
+  bool brake;   // Brake instead, duty is ignored.
+};
+
+/**
+ * @brief A command byte written by the BLE central.
+ */
+struct BleCommand
+{
+  uint32_t receivedUs;
+  uint8_t value;
+};
+
+/**
+ * @brief Why a fault was raised.
+ */
+enum FaultCode : uint8_t
+{
+  FAULT_OVERCURRENT = 1,
+  FAULT_STALL,
+  FAULT_LINK_LOST,
+  FAULT_EVENTS_LOST
+};
+
+/**
+ * @brief Something went wrong.
+ */
+struct FaultEvent
+{
+  uint32_t raisedUs;
+  FaultCode code;
+  uint16_t detail; // Depends on code, such as the current in mA.
+};
+
+/**
+ * @brief A topic: events of one type from one publisher to a fixed number
+ * of subscribers.
+ * @tparam T Event type, a plain struct.
+ * @tparam SIZE Slots per subscriber queue, holding SIZE - 1 events.
+ * @tparam SUBSCRIBERS Subscriber queues.
+ */
+template <typename T, uint8_t SIZE, uint8_t SUBSCRIBERS = 1>
+class EventTopic
+{
+  static_assert(std::is_trivially_copyable<T>::value,
+                "Events are copied between contexts, use a plain struct");
+  static_assert(SUBSCRIBERS >= 1 && SUBSCRIBERS < EVENT_NO_SUBSCRIBER,
+                "A topic needs 1 to 254 subscribers");
+
+public:
+  /**
+   * @param name Printed in reports. Must stay valid (use a literal).
+   */
+  explicit EventTopic(const char *name) : name(name), subscribers(0), sent(0) {}
+
+  /**
+   * @brief Take a subscriber queue. Call in setup(), before anything
+   * publishes.
+   * @return The subscriber id for poll(), or EVENT_NO_SUBSCRIBER if all
+   * SUBSCRIBERS are taken.
+   */
+  uint8_t subscribe()
+  {
+    if (subscribers >= SUBSCRIBERS)
+    {
+      return EVENT_NO_SUBSCRIBER;
+    } // if
+    return subscribers++;
+  } // subscribe()
+
+  /**
+   * @brief Copy an event to every subscriber. Publisher only.
+   * @return false if any subscriber's queue was full and missed it.
+   */
+  bool publish(const T &event)
+  {
+    bool delivered = true;
+    for (uint8_t i = 0; i < subscribers; i++)
+    {
+      delivered = queues[i].push(event) && delivered;
+    } // for
+    sent.store(sent.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    return delivered;
+  } // publish()
+
+  /**
+   * @brief Take a subscriber's oldest event. That subscriber's reader only.
+   * @return false if there is none.
+   */
+  bool poll(uint8_t subscriber, T &event)
+  {
+    return queues[subscriber].pop(event);
+  } // poll()
+
+  /**
+   * @brief Events waiting for a subscriber.
+   */
+  uint8_t pending(uint8_t subscriber) const { return queues[subscriber].count(); }
+
+  /**
+   * @brief Events a subscriber missed because its queue was full.
+   */
+  uint32_t overruns(uint8_t subscriber) const { return queues[subscriber].overruns.load(); }
+
+  /**
+   * @brief Events published since boot.
+   */
+  uint32_t published() const { return sent.load(std::memory_order_relaxed); }
+
+  const char *const name;
+
+private:
+  SpscRing<T, SIZE> queues[SUBSCRIBERS];
+  uint8_t subscribers;         // Taken queues, fixed once publishing starts.
+  std::atomic<uint32_t> sent;  // Written by the publisher only.
+};
+
+#endif // EVENT_BUS_H
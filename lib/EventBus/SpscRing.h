@@ -0,0 +1,94 @@
+/**
+ * @file SpscRing.h
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Lock-free queue from one producer to one consumer.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details
+ * The producer and the consumer can each be a task, loop() or an interrupt
+ * handler, on the same core or (ESP32) on different cores. Neither side
+ * ever waits for the other, takes a lock or turns interrupts off, so push()
+ * is safe in an interrupt handler and always takes the same short time.
+ *
+ * The head is written by the producer only and the tail by the consumer
+ * only. An item is copied in before the head moves on (release) and the
+ * consumer reads it after seeing the new head (acquire). On the UNO R4
+ * (Cortex-M4) the one-byte atomics are plain loads and stores with a memory
+ * barrier. On the ESP32 the barrier also orders them between the two cores.
+ */
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stdint.h>
+#include <atomic>
+
+/**
+ * @brief Lock-free queue from one producer to one consumer. Holds SIZE - 1
+ * items. A push() to a full queue is dropped and counted.
+ * @tparam T A plain struct, copied in and out.
+ * @tparam SIZE Slots, 2 to 255.
+ */
+template <typename T, uint8_t SIZE>
+class SpscRing
+{
+  static_assert(SIZE >= 2, "An SpscRing needs at least 2 slots");
+
+public:
+  SpscRing() : overruns(0), head(0), tail(0) {}
+
+  /**
+   * @brief Add an item. Producer only.
+   * @return false if the queue was full and the item was dropped.
+   */
+  bool push(const T &item)
+  {
+    uint8_t h = head.load(std::memory_order_relaxed);
+    uint8_t next = (h + 1) % SIZE;
+    if (next == tail.load(std::memory_order_acquire))
+    {
+      overruns++;
+      return false;
+    } // if
+    slots[h] = item;
+    head.store(next, std::memory_order_release);
+    return true;
+  } // push()
+
+  /**
+   * @brief Take the oldest item. Consumer only.
+   * @return false if the queue is empty.
+   */
+  bool pop(T &item)
+  {
+    uint8_t t = tail.load(std::memory_order_relaxed);
+    if (t == head.load(std::memory_order_acquire))
+    {
+      return false;
+    } // if
+    item = slots[t];
+    tail.store((t + 1) % SIZE, std::memory_order_release);
+    return true;
+  } // pop()
+
+  /**
+   * @brief Items waiting. Exact for the consumer, a snapshot for anyone else.
+   */
+  uint8_t count() const
+  {
+    uint8_t h = head.load(std::memory_order_acquire);
+    uint8_t t = tail.load(std::memory_order_acquire);
+    return (h + SIZE - t) % SIZE;
+  } // count()
+
+  std::atomic<uint32_t> overruns; // Items dropped because the queue was full.
+
+private:
+  T slots[SIZE];
+  std::atomic<uint8_t> head; // Next slot to write.
+  std::atomic<uint8_t> tail; // Next slot to read.
+};
+
+#endif // SPSC_RING_H
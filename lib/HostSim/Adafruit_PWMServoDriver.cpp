@@ -0,0 +1,110 @@
+/**
+ * @file Adafruit_PWMServoDriver.cpp
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Host-side PCA9685 driver stand-in. See Adafruit_PWMServoDriver.h.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ */
+#include "Adafruit_PWMServoDriver.h"
+
+// PCA9685 registers and MODE1 bits.
+#define PCA9685_MODE1 0x00
+#define PCA9685_LED0_ON_L 0x06
+#define MODE1_RESTART 0x80
+#define MODE1_AI 0x20
+#define MODE1_SLEEP 0x10
+
+Adafruit_PWMServoDriver::Adafruit_PWMServoDriver(uint8_t address, TwoWire &wire)
+    : address(address), wire(wire), oscillatorHz(FREQUENCY_OSCILLATOR)
+{
+} // Adafruit_PWMServoDriver()
+
+bool Adafruit_PWMServoDriver::begin(uint8_t prescale)
+{
+  (void)prescale;
+  reset();
+  setPWMFreq(1000);
+  oscillatorHz = FREQUENCY_OSCILLATOR;
+  return true;
+} // begin()
+
+void Adafruit_PWMServoDriver::reset()
+{
+  write8(PCA9685_MODE1, MODE1_RESTART);
+  delay(10);
+} // reset()
+
+/**
+ * @details The prescaler can only be written while the oscillator sleeps,
+ * so MODE1 is written three times around it. The last write also turns on
+ * register auto-increment.
+ */
+void Adafruit_PWMServoDriver::setPWMFreq(float frequency)
+{
+  if (frequency < 1)
+  {
+    frequency = 1;
+  } // if
+  if (frequency > 3500)
+  {
+    frequency = 3500;
+  } // if
+  float prescaleValue = ((oscillatorHz / (frequency * 4096.0f)) + 0.5f) - 1;
+  if (prescaleValue < 3)
+  {
+    prescaleValue = 3;
+  } // if
+  if (prescaleValue > 255)
+  {
+    prescaleValue = 255;
+  } // if
+  uint8_t oldMode = read8(PCA9685_MODE1);
+  write8(PCA9685_MODE1, (oldMode & ~MODE1_RESTART) | MODE1_SLEEP);
+  write8(PRESCALE_REGISTER, (uint8_t)prescaleValue);
+  write8(PCA9685_MODE1, oldMode);
+  delay(5);
+  write8(PCA9685_MODE1, oldMode | MODE1_RESTART | MODE1_AI);
+} // setPWMFreq()
+
+void Adafruit_PWMServoDriver::setPWM(uint8_t channel, uint16_t on, uint16_t off)
+{
+  wire.beginTransmission(address);
+  wire.write(PCA9685_LED0_ON_L + 4 * channel);
+  wire.write(on & 0xFF);
+  wire.write(on >> 8);
+  wire.write(off & 0xFF);
+  wire.write(off >> 8);
+  wire.endTransmission();
+} // setPWM()
+
+/**
+ * @details Reads the prescaler back from the chip every call, as the
+ * library does.
+ */
+void Adafruit_PWMServoDriver::writeMicroseconds(uint8_t channel, uint16_t microseconds)
+{
+  double pulseLengthUs = 1000000.0 * (readPrescale() + 1) / oscillatorHz;
+  setPWM(channel, 0, (uint16_t)(microseconds / pulseLengthUs));
+} // writeMicroseconds()
+
+uint8_t Adafruit_PWMServoDriver::read8(uint8_t reg)
+{
+  wire.beginTransmission(address);
+  wire.write(reg);
+  wire.endTransmission();
+  if (wire.requestFrom(address, (uint8_t)1) != 1)
+  {
+    return 0;
+  } // if
+  return (uint8_t)wire.read();
+} // read8()
+
+void Adafruit_PWMServoDriver::write8(uint8_t reg, uint8_t value)
+{
+  wire.beginTransmission(address);
+  wire.write(reg);
+  wire.write(value);
+  wire.endTransmission();
+} // write8()
@@ -0,0 +1,53 @@
+/**
+ * @file Adafruit_PWMServoDriver.h
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Host-side stand-in for the Adafruit PCA9685 library.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details Sends the same register reads and writes as the Adafruit
+ * library, one I2C transaction each, so a SimPca9685 on the bus ends up with
+ * the same registers as the real chip and Wire.stats() shows the same
+ * traffic.
+ */
+#ifndef HOST_SIM_ADAFRUIT_PWM_SERVO_DRIVER_H
+#define HOST_SIM_ADAFRUIT_PWM_SERVO_DRIVER_H
+
+#include "Arduino.h"
+#include "Wire.h"
+
+// Internal oscillator the library assumes until told otherwise.
+#define FREQUENCY_OSCILLATOR 25000000
+
+class Adafruit_PWMServoDriver
+{
+public:
+  explicit Adafruit_PWMServoDriver(uint8_t address = 0x40, TwoWire &wire = Wire);
+
+  /**
+   * @brief Reset the chip and set 1 kHz, as the library does.
+   * @param prescale Ignored: the host has no external clock input.
+   */
+  bool begin(uint8_t prescale = 0);
+  void reset();
+  void setPWMFreq(float frequency);
+  void setPWM(uint8_t channel, uint16_t on, uint16_t off);
+  void writeMicroseconds(uint8_t channel, uint16_t microseconds);
+  void setOscillatorFrequency(uint32_t frequency) { oscillatorHz = frequency; }
+  uint32_t getOscillatorFrequency() const { return oscillatorHz; }
+  uint8_t readPrescale() { return read8(PRESCALE_REGISTER); }
+
+private:
+  static const uint8_t PRESCALE_REGISTER = 0xFE;
+
+  uint8_t read8(uint8_t reg);
+  void write8(uint8_t reg, uint8_t value);
+
+  uint8_t address;
+  TwoWire &wire;
+  uint32_t oscillatorHz;
+};
+
+#endif // HOST_SIM_ADAFRUIT_PWM_SERVO_DRIVER_H
@@ -0,0 +1,406 @@
+/**
+ * @file Arduino.cpp
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Host-side Arduino core stand-in. See Arduino.h.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ */
+#include "Arduino.h"
+#include <ctype.h>
+
+HardwareSerial Serial;
+
+static uint64_t clockNs = 0;
+static uint32_t readCostNs = 0;
+
+uint64_t SimClock::nowNs()
+{
+  return clockNs;
+} // nowNs()
+
+void SimClock::advanceNs(uint64_t ns)
+{
+  clockNs += ns;
+} // advanceNs()
+
+void SimClock::reset()
+{
+  clockNs = 0;
+} // reset()
+
+void SimClock::setReadCostNs(uint32_t ns)
+{
+  readCostNs = ns;
+} // setReadCostNs()
+
+unsigned long millis()
+{
+  clockNs += readCostNs;
+  return (unsigned long)(clockNs / 1000000ULL);
+} // millis()
+
+unsigned long micros()
+{
+  clockNs += readCostNs;
+  return (unsigned long)(clockNs / 1000ULL);
+} // micros()
+
+void delay(unsigned long ms)
+{
+  SimHal::count(SIM_HAL_DELAY);
+  SimClock::advanceNs((uint64_t)ms * 1000000ULL);
+} // delay()
+
+void delayMicroseconds(unsigned int us)
+{
+  SimHal::count(SIM_HAL_DELAY);
+  SimClock::advanceNs((uint64_t)us * 1000ULL);
+} // delayMicroseconds()
+
+long map(long x, long inMin, long inMax, long outMin, long outMax)
+{
+  return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+} // map()
+
+String::String(const char *text)
+{
+  *this += text;
+} // String()
+
+String::String(String &&other) noexcept
+    : buffer(other.buffer), len(other.len), capacity(other.capacity)
+{
+  other.buffer = nullptr;
+  other.len = 0;
+  other.capacity = 0;
+} // String()
+
+String::String(char value)
+{
+  append(&value, 1);
+} // String()
+
+String::String(int value, int base) : String((long)value, base)
+{
+} // String()
+
+String::String(unsigned int value, int base) : String((unsigned long)value, base)
+{
+} // String()
+
+String::String(long value, int base)
+{
+  if (base == DEC)
+  {
+    char digits[24];
+    snprintf(digits, sizeof(digits), "%ld", value);
+    *this += digits;
+  }
+  else
+  {
+    *this = String((unsigned long)value, base);
+  } // else
+} // String()
+
+String::String(unsigned long value, int base)
+{
+  if (base < 2)
+  {
+    base = DEC;
+  } // if
+  char digits[70];
+  char *p = &digits[sizeof(digits) - 1];
+  *p = '\0';
+  do
+  {
+    int digit = (int)(value % base);
+    *--p = (char)(digit < 10 ? '0' + digit : 'A' + digit - 10);
+    value /= base;
+  } while (value);
+  *this += p;
+} // String()
+
+String::String(double value, int digits)
+{
+  char number[48];
+  snprintf(number, sizeof(number), "%.*f", digits, value);
+  *this += number;
+} // String()
+
+String &String::operator=(const String &other)
+{
+  if (this != &other)
+  {
+    len = 0;
+    append(other.c_str(), other.len);
+  } // if
+  return *this;
+} // operator=()
+
+String &String::operator=(String &&other) noexcept
+{
+  if (this != &other)
+  {
+    delete[] buffer;
+    buffer = other.buffer;
+    len = other.len;
+    capacity = other.capacity;
+    other.buffer = nullptr;
+    other.len = 0;
+    other.capacity = 0;
+  } // if
+  return *this;
+} // operator=()
+
+/**
+ * @details Grows to the exact size needed, as the board's String does, so a
+ * String built a character at a time reallocates for every character.
+ */
+String &String::append(const char *text, size_t count)
+{
+  if (count == 0)
+  {
+    if (buffer != nullptr)
+    {
+      buffer[len] = '\0';
+    } // if
+    return *this;
+  } // if
+  if (len + count > capacity)
+  {
+    char *grown = new char[len + count + 1];
+    if (len > 0)
+    {
+      memcpy(grown, buffer, len);
+    } // if
+    memcpy(grown + len, text, count); // text may be in the old buffer.
+    delete[] buffer;
+    buffer = grown;
+    capacity = len + count;
+  }
+  else
+  {
+    memmove(buffer + len, text, count);
+  } // else
+  len += count;
+  buffer[len] = '\0';
+  return *this;
+} // append()
+
+void String::trim()
+{
+  if (len == 0)
+  {
+    return;
+  } // if
+  unsigned int first = 0;
+  while (first < len && isspace((unsigned char)buffer[first]))
+  {
+    first++;
+  } // while
+  unsigned int last = len;
+  while (last > first && isspace((unsigned char)buffer[last - 1]))
+  {
+    last--;
+  } // while
+  len = last - first;
+  memmove(buffer, buffer + first, len);
+  buffer[len] = '\0';
+} // trim()
+
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+  size_t n = 0;
+  while (size--)
+  {
+    n += write(*buffer++);
+  } // while
+  return n;
+} // write()
+
+size_t Print::print(const char text[])
+{
+  return write(text);
+} // print()
+
+size_t Print::print(char value)
+{
+  return write((uint8_t)value);
+} // print()
+
+size_t Print::print(unsigned char value, int base)
+{
+  return printNumber(value, base, false);
+} // print()
+
+size_t Print::print(int value, int base)
+{
+  return print((long long)value, base);
+} // print()
+
+size_t Print::print(unsigned int value, int base)
+{
+  return printNumber(value, base, false);
+} // print()
+
+size_t Print::print(long value, int base)
+{
+  return print((long long)value, base);
+} // print()
+
+size_t Print::print(unsigned long value, int base)
+{
+  return printNumber(value, base, false);
+} // print()
+
+size_t Print::print(long long value, int base)
+{
+  if (base == DEC && value < 0)
+  {
+    return printNumber((unsigned long long)(-value), base, true);
+  } // if
+  return printNumber((unsigned long long)value, base, false);
+} // print()
+
+size_t Print::print(unsigned long long value, int base)
+{
+  return printNumber(value, base, false);
+} // print()
+
+size_t Print::print(double value, int digits)
+{
+  char text[48];
+  snprintf(text, sizeof(text), "%.*f", digits, value);
+  return write(text);
+} // print()
+
+size_t Print::println()
+{
+  return write("\r\n");
+} // println()
+
+size_t Print::printNumber(unsigned long long value, int base, bool negative)
+{
+  char text[70];
+  char *p = &text[sizeof(text) - 1];
+  *p = '\0';
+  if (base < 2)
+  {
+    base = DEC;
+  } // if
+  do
+  {
+    int digit = (int)(value % base);
+    *--p = (char)(digit < 10 ? '0' + digit : 'A' + digit - 10);
+    value /= base;
+  } while (value);
+  if (negative)
+  {
+    *--p = '-';
+  } // if
+  return write(p);
+} // printNumber()
+
+/**
+ * @details With no input the wait ends at once, after the timeout has been
+ * added to the virtual clock.
+ */
+String Stream::readStringUntil(char terminator)
+{
+  String line;
+  uint64_t deadlineNs = SimClock::nowNs() + (uint64_t)streamTimeoutMs * 1000000ULL;
+  while (true)
+  {
+    if (available() == 0)
+    {
+      uint64_t now = SimClock::nowNs();
+      if (now < deadlineNs)
+      {
+        SimClock::advanceNs(deadlineNs - now);
+      } // if
+      return line;
+    } // if
+    int value = read();
+    if (value == terminator)
+    {
+      return line;
+    } // if
+    line += (char)value;
+  } // while
+} // readStringUntil()
+
+size_t HardwareSerial::write(uint8_t value)
+{
+  SimHal::count(SIM_HAL_SERIAL_WRITE);
+  put(value);
+  return 1;
+} // write()
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size)
+{
+  SimHal::count(SIM_HAL_SERIAL_WRITE);
+  for (size_t i = 0; i < size; i++)
+  {
+    put(buffer[i]);
+  } // for
+  return size;
+} // write()
+
+/**
+ * @details A sketch waiting with while (Serial.available() == 0) {} does
+ * nothing else, so the clock stands still between polls. After many polls
+ * like that with no input left, the stall handler is called.
+ */
+int HardwareSerial::available()
+{
+  int count = (int)(input.length() - inputIndex);
+  if (count > 0)
+  {
+    emptyPolls = 0;
+    return count;
+  } // if
+  uint64_t now = SimClock::nowNs();
+  emptyPolls = now == lastEmptyPollNs ? emptyPolls + 1 : 0;
+  lastEmptyPollNs = now;
+  if (emptyPolls >= SIM_SERIAL_STALL_POLLS && stallHandler != nullptr)
+  {
+    emptyPolls = 0;
+    stallHandler();
+  } // if
+  return 0;
+} // available()
+
+int HardwareSerial::read()
+{
+  SimHal::count(SIM_HAL_SERIAL_READ);
+  if (inputIndex >= input.length())
+  {
+    return -1;
+  } // if
+  return (uint8_t)input[inputIndex++];
+} // read()
+
+int HardwareSerial::peek()
+{
+  return inputIndex < input.length() ? (uint8_t)input[inputIndex] : -1;
+} // peek()
+
+void HardwareSerial::simInput(const char *text)
+{
+  input += text;
+} // simInput()
+
+/**
+ * @details Carriage returns are left out so println() gives plain Linux
+ * lines.
+ */
+void HardwareSerial::put(uint8_t value)
+{
+  writtenCount++;
+  if (echo && value != '\r')
+  {
+    fputc(value, stdout);
+  } // if
+} // put()
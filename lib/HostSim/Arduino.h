@@ -0,0 +1,260 @@
+/**
+ * @file Arduino.h
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Minimal host-side stand-in for the Arduino core.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details Only used by the native (Linux) build, see library.json. It covers
+ * what the lib/ drivers and the answerBook sketches need: fixed width types,
+ * the Print/Stream classes, a small String, Serial (written to stdout, input
+ * fed in by the program), pin I/O recorded in SimHal.h and timing functions
+ * backed by the virtual clock in SimClock.h.
+ */
+#ifndef HOST_SIM_ARDUINO_H
+#define HOST_SIM_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "SimClock.h"
+#include "SimHal.h"
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+#define OUTPUT_OPEN_DRAIN 0x3
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+// UNO R4 pin numbers. ESP32 sketches use plain GPIO numbers.
+#define D0 0
+#define D1 1
+#define D2 2
+#define D3 3
+#define D4 4
+#define D5 5
+#define D6 6
+#define D7 7
+#define D8 8
+#define D9 9
+#define D10 10
+#define D11 11
+#define D12 12
+#define D13 13
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+#define A5 19
+#define LED_BUILTIN 13
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+// Pin I/O, recorded by SimHal.
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+void analogWrite(uint8_t pin, int value);
+void analogReadResolution(int bits);
+void analogWriteResolution(int bits);
+
+// Timing, all driven by the virtual clock.
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+long map(long x, long inMin, long inMax, long outMin, long outMax);
+
+// There are no interrupts on the host.
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+/**
+ * @brief Host version of the Arduino String. Like the board's, it keeps its
+ * text on the heap, so the sketch runner counts what a String costs.
+ */
+class String
+{
+public:
+  String(const char *text = "");
+  String(const String &other) : String(other.c_str()) {}
+  String(String &&other) noexcept;
+  explicit String(char value);
+  explicit String(int value, int base = DEC);
+  explicit String(unsigned int value, int base = DEC);
+  explicit String(long value, int base = DEC);
+  explicit String(unsigned long value, int base = DEC);
+  explicit String(double value, int digits = 2);
+  ~String() { delete[] buffer; }
+
+  String &operator=(const String &other);
+  String &operator=(String &&other) noexcept;
+
+  const char *c_str() const { return buffer ? buffer : ""; }
+  unsigned int length() const { return len; }
+  char operator[](unsigned int index) const { return index < len ? buffer[index] : 0; }
+  long toInt() const { return atol(c_str()); }
+  float toFloat() const { return (float)atof(c_str()); }
+  void trim();
+
+  bool operator==(const String &other) const { return strcmp(c_str(), other.c_str()) == 0; }
+  bool operator==(const char *other) const { return strcmp(c_str(), other ? other : "") == 0; }
+  bool operator!=(const String &other) const { return !(*this == other); }
+  String &operator+=(const String &other) { return append(other.c_str(), other.len); }
+  String &operator+=(const char *other) { return other ? append(other, strlen(other)) : *this; }
+  String &operator+=(char value) { return append(&value, 1); }
+
+  friend String operator+(const String &a, const String &b) { String s(a); s += b; return s; }
+  friend String operator+(const String &a, const char *b) { String s(a); s += b; return s; }
+  friend String operator+(const char *a, const String &b) { String s(a); s += b; return s; }
+
+private:
+  String &append(const char *text, size_t count);
+
+  char *buffer = nullptr; // NUL terminated, nullptr while empty.
+  unsigned int len = 0;
+  unsigned int capacity = 0;
+};
+
+/**
+ * @brief Host version of the Arduino Print class.
+ */
+class Print
+{
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t value) = 0;
+  virtual size_t write(const uint8_t *buffer, size_t size);
+  size_t write(const char *text) { return text ? write((const uint8_t *)text, strlen(text)) : 0; }
+
+  size_t print(const char text[]);
+  size_t print(const String &text) { return write((const uint8_t *)text.c_str(), text.length()); }
+  size_t print(char value);
+  size_t print(unsigned char value, int base = DEC);
+  size_t print(int value, int base = DEC);
+  size_t print(unsigned int value, int base = DEC);
+  size_t print(long value, int base = DEC);
+  size_t print(unsigned long value, int base = DEC);
+  size_t print(long long value, int base = DEC);
+  size_t print(unsigned long long value, int base = DEC);
+  size_t print(double value, int digits = 2);
+
+  size_t println();
+  size_t println(const String &text) { size_t n = print(text); return n + println(); }
+  template <typename T>
+  size_t println(T value) { size_t n = print(value); return n + println(); }
+  template <typename T>
+  size_t println(T value, int format) { size_t n = print(value, format); return n + println(); }
+
+  /**
+   * @brief Bytes that can be written without waiting. 0 means unknown.
+   */
+  virtual int availableForWrite() { return 0; }
+
+private:
+  size_t printNumber(unsigned long long value, int base, bool negative);
+};
+
+/**
+ * @brief Host version of the Arduino Stream class (no input by default).
+ */
+class Stream : public Print
+{
+public:
+  virtual int available() { return 0; }
+  virtual int read() { return -1; }
+  virtual int peek() { return -1; }
+  void setTimeout(unsigned long timeoutMs) { streamTimeoutMs = timeoutMs; }
+
+  /**
+   * @brief Characters up to the terminator (not included), or whatever came
+   * before the timeout. Waiting moves the virtual clock, it does not spin.
+   */
+  String readStringUntil(char terminator);
+
+protected:
+  unsigned long streamTimeoutMs = 1000;
+};
+
+// Transmit buffer the host Serial reports as free, the UNO R4 USB size.
+#define SIM_SERIAL_TX_BUFFER 512
+
+// Empty available() polls in a row, with the clock standing still, before
+// Serial decides the sketch is stuck waiting for input.
+#define SIM_SERIAL_STALL_POLLS 1000
+
+/**
+ * @brief Serial port stand-in. Output goes to stdout, input comes from
+ * simInput().
+ */
+class HardwareSerial : public Stream
+{
+public:
+  void begin(unsigned long baud) { (void)baud; }
+  void end() {}
+  void flush() { fflush(stdout); }
+  operator bool() const { return true; }
+  size_t write(uint8_t value) override;
+  size_t write(const uint8_t *buffer, size_t size) override;
+  using Print::write;
+  int availableForWrite() override { return SIM_SERIAL_TX_BUFFER; }
+  int available() override;
+  int read() override;
+  int peek() override;
+
+  // Simulation control.
+
+  /**
+   * @brief Add text for the sketch to read, as if typed in the Serial
+   * Monitor.
+   */
+  void simInput(const char *text);
+
+  /**
+   * @brief Send output to stdout (the default) or throw it away.
+   */
+  void setEcho(bool on) { echo = on; }
+
+  /**
+   * @brief Called when the sketch spins on available() with no input left
+   * and nothing else happening: it is waiting for a line that will never
+   * come.
+   */
+  void setStallHandler(void (*handler)()) { stallHandler = handler; }
+
+  /**
+   * @brief Bytes the sketch has written.
+   */
+  uint32_t bytesWritten() const { return writtenCount; }
+
+private:
+  void put(uint8_t value);
+
+  String input;
+  unsigned int inputIndex = 0;
+  bool echo = true;
+  void (*stallHandler)() = nullptr;
+  uint64_t lastEmptyPollNs = UINT64_MAX;
+  uint32_t emptyPolls = 0; // In a row, with the clock standing still.
+  uint32_t writtenCount = 0;
+};
+
+extern HardwareSerial Serial;
+
+#endif // HOST_SIM_ARDUINO_H
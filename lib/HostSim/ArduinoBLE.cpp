@@ -0,0 +1,129 @@
+/**
+ * @file ArduinoBLE.cpp
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Host-side ArduinoBLE stand-in. See ArduinoBLE.h.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ */
+#include "ArduinoBLE.h"
+
+BLELocalDevice BLE;
+
+BLECharacteristic::BLECharacteristic(const char *uuid, uint8_t properties, int valueSize,
+                                     bool fixedLength)
+    : uuidText(uuid), props(properties),
+      valueData(std::make_shared<std::vector<uint8_t>>(valueSize > 0 ? valueSize : 1)),
+      valueLen(std::make_shared<int>(fixedLength ? valueSize : 0))
+{
+} // BLECharacteristic()
+
+int BLECharacteristic::writeValue(const uint8_t *data, int size)
+{
+  SimHal::count(SIM_HAL_BLE);
+  if (size < 0 || size > (int)valueData->size())
+  {
+    return 0;
+  } // if
+  memcpy(valueData->data(), data, size);
+  *valueLen = size;
+  return 1;
+} // writeValue()
+
+void BLECharacteristic::setEventHandler(BLECharacteristicEvent event,
+                                        BLECharacteristicEventHandler handler)
+{
+  (void)event;
+  (void)handler;
+} // setEventHandler()
+
+void BLEService::addCharacteristic(BLECharacteristic &characteristic)
+{
+  (void)characteristic;
+  count++;
+} // addCharacteristic()
+
+int BLELocalDevice::begin()
+{
+  SimHal::count(SIM_HAL_BLE);
+  return 1;
+} // begin()
+
+void BLELocalDevice::end()
+{
+  advertisingOn = false;
+} // end()
+
+void BLELocalDevice::poll(unsigned long timeoutMs)
+{
+  SimHal::count(SIM_HAL_BLE);
+  (void)timeoutMs; // Nothing can arrive, so there is nothing to wait for.
+} // poll()
+
+bool BLELocalDevice::setLocalName(const char *name)
+{
+  (void)name;
+  return true;
+} // setLocalName()
+
+bool BLELocalDevice::setAdvertisedService(const BLEService &service)
+{
+  (void)service;
+  return true;
+} // setAdvertisedService()
+
+void BLELocalDevice::addService(BLEService &service)
+{
+  (void)service;
+} // addService()
+
+int BLELocalDevice::advertise()
+{
+  SimHal::count(SIM_HAL_BLE);
+  advertisingOn = true;
+  return 1;
+} // advertise()
+
+void BLELocalDevice::stopAdvertise()
+{
+  SimHal::count(SIM_HAL_BLE);
+  advertisingOn = false;
+} // stopAdvertise()
+
+void BLELocalDevice::setAdvertisingInterval(uint16_t interval)
+{
+  (void)interval;
+} // setAdvertisingInterval()
+
+void BLELocalDevice::setConnectionInterval(uint16_t minimum, uint16_t maximum)
+{
+  (void)minimum;
+  (void)maximum;
+} // setConnectionInterval()
+
+void BLELocalDevice::setConnectable(bool connectable)
+{
+  (void)connectable;
+} // setConnectable()
+
+bool BLELocalDevice::connected() const
+{
+  return false;
+} // connected()
+
+BLEDevice BLELocalDevice::central()
+{
+  return BLEDevice();
+} // central()
+
+String BLELocalDevice::address() const
+{
+  return String("00:00:00:00:00:00");
+} // address()
+
+void BLELocalDevice::setEventHandler(BLEDeviceEvent event, BLEDeviceEventHandler handler)
+{
+  (void)event;
+  (void)handler;
+} // setEventHandler()
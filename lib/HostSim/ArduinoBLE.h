@@ -0,0 +1,148 @@
+/**
+ * @file ArduinoBLE.h
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Host-side stand-in for the ArduinoBLE peripheral API.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details Enough of ArduinoBLE for the Lesson 6 server sketch to build and
+ * run on the host. Services and characteristics keep their values, and
+ * every BLE call is counted in SimHal. No central ever connects, so the
+ * event handlers are never called: this measures what the sketch costs
+ * while it advertises and waits. The protocol itself is exercised over a
+ * simulated link by the ble_bench program (SimBleLink.h).
+ */
+#ifndef HOST_SIM_ARDUINO_BLE_H
+#define HOST_SIM_ARDUINO_BLE_H
+
+#include <memory>
+#include <vector>
+#include "Arduino.h"
+
+// Characteristic properties.
+#define BLEBroadcast 0x01
+#define BLERead 0x02
+#define BLEWriteWithoutResponse 0x04
+#define BLEWrite 0x08
+#define BLENotify 0x10
+#define BLEIndicate 0x20
+
+enum BLEDeviceEvent
+{
+  BLEConnected = 0,
+  BLEDisconnected = 1
+};
+
+enum BLECharacteristicEvent
+{
+  BLESubscribed = 0,
+  BLEUnsubscribed = 1,
+  BLEWritten = 3
+};
+
+class BLEDevice
+{
+public:
+  String address() const { return String("00:00:00:00:00:00"); }
+  bool connected() const { return false; }
+  operator bool() const { return false; }
+};
+
+class BLECharacteristic;
+
+typedef void (*BLEDeviceEventHandler)(BLEDevice device);
+typedef void (*BLECharacteristicEventHandler)(BLEDevice device, BLECharacteristic characteristic);
+
+/**
+ * @brief A characteristic. Copies share the value, as in ArduinoBLE.
+ */
+class BLECharacteristic
+{
+public:
+  BLECharacteristic(const char *uuid, uint8_t properties, int valueSize,
+                    bool fixedLength = false);
+
+  const char *uuid() const { return uuidText; }
+  uint8_t properties() const { return props; }
+  int valueSize() const { return (int)valueData->size(); }
+  const uint8_t *value() const { return valueData->data(); }
+  int valueLength() const { return *valueLen; }
+
+  /**
+   * @brief Store a new value. On a notifying characteristic this would also
+   * notify the central, but none is connected.
+   */
+  int writeValue(const uint8_t *data, int size);
+  void setEventHandler(BLECharacteristicEvent event, BLECharacteristicEventHandler handler);
+  bool subscribed() const { return false; }
+  bool written() const { return false; }
+
+private:
+  const char *uuidText;
+  uint8_t props;
+  std::shared_ptr<std::vector<uint8_t>> valueData;
+  std::shared_ptr<int> valueLen;
+};
+
+class BLEByteCharacteristic : public BLECharacteristic
+{
+public:
+  BLEByteCharacteristic(const char *uuid, uint8_t properties)
+      : BLECharacteristic(uuid, properties, 1, true)
+  {
+  } // BLEByteCharacteristic()
+
+  int writeValue(uint8_t value) { return BLECharacteristic::writeValue(&value, 1); }
+  uint8_t value() const { return BLECharacteristic::value()[0]; }
+};
+
+class BLEService
+{
+public:
+  explicit BLEService(const char *uuid) : uuidText(uuid), count(0) {}
+
+  const char *uuid() const { return uuidText; }
+  void addCharacteristic(BLECharacteristic &characteristic);
+  int characteristicCount() const { return count; }
+
+private:
+  const char *uuidText;
+  int count;
+};
+
+/**
+ * @brief The radio, used through the global BLE.
+ */
+class BLELocalDevice
+{
+public:
+  int begin();
+  void end();
+  void poll(unsigned long timeoutMs = 0);
+  bool setLocalName(const char *name);
+  bool setAdvertisedService(const BLEService &service);
+  void addService(BLEService &service);
+  int advertise();
+  void stopAdvertise();
+  void setAdvertisingInterval(uint16_t interval);
+  void setConnectionInterval(uint16_t minimum, uint16_t maximum);
+  void setConnectable(bool connectable);
+  bool connected() const;
+  BLEDevice central();
+  String address() const;
+  void setEventHandler(BLEDeviceEvent event, BLEDeviceEventHandler handler);
+
+  /**
+   * @brief True between advertise() and stopAdvertise().
+   */
+  bool advertising() const { return advertisingOn; }
+
+private:
+  bool advertisingOn = false;
+};
+
+extern BLELocalDevice BLE;
+
+#endif // HOST_SIM_ARDUINO_BLE_H
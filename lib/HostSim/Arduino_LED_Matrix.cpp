@@ -0,0 +1,47 @@
+/**
+ * @file Arduino_LED_Matrix.cpp
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Host-side LED matrix stand-in. See Arduino_LED_Matrix.h.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ */
+#include "Arduino_LED_Matrix.h"
+
+void ArduinoLEDMatrix::clear()
+{
+  const uint32_t blank[3] = {0, 0, 0};
+  loadFrame(blank);
+} // clear()
+
+void ArduinoLEDMatrix::loadFrame(const uint32_t buffer[3])
+{
+  SimHal::count(SIM_HAL_MATRIX_FRAME);
+  for (uint8_t i = 0; i < 3; i++)
+  {
+    frame[i] = buffer[i];
+  } // for
+} // loadFrame()
+
+/**
+ * @details Pixel 0 is the top bit of the first word, as on the board.
+ */
+void ArduinoLEDMatrix::loadPixels(const uint8_t *pixels, uint32_t size)
+{
+  uint32_t packed[3] = {0, 0, 0};
+  for (uint32_t i = 0; i < size && i < MATRIX_ROWS * MATRIX_COLS; i++)
+  {
+    if (pixels[i] != 0)
+    {
+      packed[i / 32] |= 1UL << (31 - i % 32);
+    } // if
+  } // for
+  loadFrame(packed);
+} // loadPixels()
+
+bool ArduinoLEDMatrix::pixel(uint8_t row, uint8_t col) const
+{
+  uint32_t i = row * MATRIX_COLS + col;
+  return i < MATRIX_ROWS * MATRIX_COLS && (frame[i / 32] & (1UL << (31 - i % 32))) != 0;
+} // pixel()
@@ -0,0 +1,45 @@
+/**
+ * @file Arduino_LED_Matrix.h
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Host-side stand-in for the UNO R4 WiFi LED matrix library.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details Keeps the 8 x 12 frame that is showing, packed three words the
+ * way loadFrame() takes it, and counts each new frame in SimHal.
+ */
+#ifndef HOST_SIM_ARDUINO_LED_MATRIX_H
+#define HOST_SIM_ARDUINO_LED_MATRIX_H
+
+#include "Arduino.h"
+
+#define MATRIX_ROWS 8
+#define MATRIX_COLS 12
+
+// Same as the board library: a bitmap is handed over as a flat pixel array.
+#define renderBitmap(bitmap, rows, columns) loadPixels(&bitmap[0][0], rows * columns)
+
+class ArduinoLEDMatrix
+{
+public:
+  bool begin() { return true; }
+  void clear();
+  void loadFrame(const uint32_t buffer[3]);
+
+  /**
+   * @brief One byte per LED, row by row, non-zero for on.
+   */
+  void loadPixels(const uint8_t *pixels, uint32_t size);
+
+  /**
+   * @brief State of one LED in the frame showing now.
+   */
+  bool pixel(uint8_t row, uint8_t col) const;
+
+private:
+  uint32_t frame[3] = {0, 0, 0};
+};
+
+#endif // HOST_SIM_ARDUINO_LED_MATRIX_H
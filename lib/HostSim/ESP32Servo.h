@@ -0,0 +1,18 @@
+/**
+ * @file ESP32Servo.h
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Host-side stand-in for the ESP32Servo library.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details ESP32Servo has the same Servo class as the Arduino library, so
+ * this is the host Servo.h.
+ */
+#ifndef HOST_SIM_ESP32_SERVO_H
+#define HOST_SIM_ESP32_SERVO_H
+
+#include "Servo.h"
+
+#endif // HOST_SIM_ESP32_SERVO_H
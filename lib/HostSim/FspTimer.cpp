@@ -0,0 +1,157 @@
+/**
+ * @file FspTimer.cpp
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Host-side FspTimer stand-in. See FspTimer.h.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ */
+#include "FspTimer.h"
+
+uint32_t SystemCoreClock = 48000000UL;
+
+// Channels taken by begin(), one bit each.
+static uint8_t gptInUse = 0;
+static uint8_t agtInUse = 0;
+
+/**
+ * @details Every pin reports GPT0, the channel of D9 that the Lesson 3a
+ * sketches drive.
+ */
+const uint16_t *getPinCfgs(int pin, PinCfgReq_t request)
+{
+  (void)pin;
+  (void)request;
+  static const uint16_t config[3] = {0, 0, 0};
+  return config;
+} // getPinCfgs()
+
+bool FspTimer::claim(uint8_t type, uint8_t channel)
+{
+  uint8_t &inUse = type == GPT_TIMER ? gptInUse : agtInUse;
+  uint8_t channels = type == GPT_TIMER ? SIM_GPT_CHANNELS : SIM_AGT_CHANNELS;
+  if (channel >= channels)
+  {
+    return false;
+  } // if
+  inUse |= 1 << channel;
+  timerType = type;
+  timerChannel = channel;
+  begun = true;
+  return true;
+} // claim()
+
+bool FspTimer::begin(timer_mode_t mode, uint8_t type, uint8_t channel, uint32_t period,
+                     uint32_t pulse, timer_source_div_t sourceDiv,
+                     GPTimerCbk_f callback, void *context)
+{
+  (void)mode;
+  (void)callback;
+  (void)context;
+  SimHal::count(SIM_HAL_TIMER_CONFIG);
+  // GPT0 and GPT1 count to 2^32, the rest and the AGTs to 2^16.
+  uint32_t limit = type == GPT_TIMER && channel < 2 ? UINT32_MAX : 0xFFFF;
+  if (period == 0 || period > limit || pulse > period)
+  {
+    return false;
+  } // if
+  this->period = period;
+  this->pulse = pulse;
+  divider = 1UL << sourceDiv;
+  return claim(type, channel);
+} // begin()
+
+bool FspTimer::begin(timer_mode_t mode, uint8_t type, uint8_t channel, float frequencyHz,
+                     float dutyPercent, GPTimerCbk_f callback, void *context)
+{
+  if (frequencyHz <= 0)
+  {
+    return false;
+  } // if
+  uint32_t counts = (uint32_t)(SystemCoreClock / frequencyHz);
+  timer_source_div_t sourceDiv = TIMER_SOURCE_DIV_1;
+  uint32_t limit = type == GPT_TIMER && channel < 2 ? UINT32_MAX : 0xFFFF;
+  while (counts > limit && sourceDiv < TIMER_SOURCE_DIV_1024)
+  {
+    sourceDiv = (timer_source_div_t)(sourceDiv + 1);
+    counts /= 2;
+  } // while
+  return begin(mode, type, channel, counts, (uint32_t)(counts * dutyPercent / 100.0f),
+               sourceDiv, callback, context);
+} // begin()
+
+bool FspTimer::open()
+{
+  SimHal::count(SIM_HAL_TIMER_CONFIG);
+  return begun;
+} // open()
+
+bool FspTimer::start()
+{
+  SimHal::count(SIM_HAL_TIMER_CONFIG);
+  startNs = SimClock::nowNs();
+  running = begun;
+  return running;
+} // start()
+
+bool FspTimer::stop()
+{
+  SimHal::count(SIM_HAL_TIMER_CONFIG);
+  running = false;
+  return true;
+} // stop()
+
+void FspTimer::close()
+{
+  SimHal::count(SIM_HAL_TIMER_CONFIG);
+  if (begun)
+  {
+    uint8_t &inUse = timerType == GPT_TIMER ? gptInUse : agtInUse;
+    inUse &= ~(1 << timerChannel);
+  } // if
+  begun = false;
+  running = false;
+} // close()
+
+bool FspTimer::setup_overflow_irq(uint8_t priority, void (*isr)())
+{
+  (void)priority;
+  (void)isr;
+  return begun;
+} // setup_overflow_irq()
+
+uint32_t FspTimer::get_counter()
+{
+  if (!running || period == 0)
+  {
+    return 0;
+  } // if
+  uint64_t counts = (SimClock::nowNs() - startNs) * (SystemCoreClock / divider) / 1000000000ULL;
+  return (uint32_t)(counts % period);
+} // get_counter()
+
+/**
+ * @details Channels 0 and 1 are left for the PWM pins, like the board's
+ * core does unless reserved is true.
+ */
+int8_t FspTimer::get_available_timer(uint8_t &type, bool reserved)
+{
+  for (uint8_t channel = reserved ? 0 : 2; channel < SIM_GPT_CHANNELS; channel++)
+  {
+    if ((gptInUse & (1 << channel)) == 0)
+    {
+      type = GPT_TIMER;
+      return channel;
+    } // if
+  } // for
+  for (uint8_t channel = 0; channel < SIM_AGT_CHANNELS; channel++)
+  {
+    if ((agtInUse & (1 << channel)) == 0)
+    {
+      type = AGT_TIMER;
+      return channel;
+    } // if
+  } // for
+  return -1;
+} // get_available_timer()
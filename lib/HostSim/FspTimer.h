@@ -0,0 +1,121 @@
+/**
+ * @file FspTimer.h
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Host-side stand-in for the UNO R4 FspTimer library.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details Takes the same calls as the Renesas core's FspTimer, checks the
+ * settings and counts the set up calls in SimHal. The counter runs from the
+ * virtual clock, so get_counter() moves between calls. There are no
+ * interrupts on the host: the callback given to begin() is never called.
+ */
+#ifndef HOST_SIM_FSP_TIMER_H
+#define HOST_SIM_FSP_TIMER_H
+
+#include "Arduino.h"
+
+// Timer channels of the RA4M1: GPT0-7 and AGT0-1.
+#define SIM_GPT_CHANNELS 8
+#define SIM_AGT_CHANNELS 2
+
+#define GPT_TIMER 0
+#define AGT_TIMER 1
+
+// Channel of a pin's timer output, from a getPinCfgs() entry.
+#define GET_CHANNEL(cfg) (((cfg) >> 8) & 0xFF)
+
+// Core clock of the UNO R4. The board gets this from the CMSIS headers.
+extern uint32_t SystemCoreClock;
+
+enum PinCfgReq_t
+{
+  PIN_CFG_REQ_PWM = 0
+};
+
+enum timer_mode_t
+{
+  TIMER_MODE_PERIODIC = 0,
+  TIMER_MODE_ONE_SHOT = 1,
+  TIMER_MODE_PWM = 2
+};
+
+enum timer_source_div_t
+{
+  TIMER_SOURCE_DIV_1 = 0,
+  TIMER_SOURCE_DIV_2 = 1,
+  TIMER_SOURCE_DIV_4 = 2,
+  TIMER_SOURCE_DIV_8 = 3,
+  TIMER_SOURCE_DIV_16 = 4,
+  TIMER_SOURCE_DIV_32 = 5,
+  TIMER_SOURCE_DIV_64 = 6,
+  TIMER_SOURCE_DIV_128 = 7,
+  TIMER_SOURCE_DIV_256 = 8,
+  TIMER_SOURCE_DIV_512 = 9,
+  TIMER_SOURCE_DIV_1024 = 10
+};
+
+struct timer_callback_args_t
+{
+  void const *p_context;
+  uint32_t event;
+};
+
+typedef void (*GPTimerCbk_f)(timer_callback_args_t *);
+
+/**
+ * @brief Timer configurations of a pin. Entry 0 has the GPT channel in bits
+ * 8-15.
+ */
+const uint16_t *getPinCfgs(int pin, PinCfgReq_t request);
+
+class FspTimer
+{
+public:
+  /**
+   * @brief Set up with raw counts, as main-optimized.cpp does.
+   */
+  bool begin(timer_mode_t mode, uint8_t type, uint8_t channel, uint32_t period,
+             uint32_t pulse, timer_source_div_t sourceDiv,
+             GPTimerCbk_f callback = nullptr, void *context = nullptr);
+
+  /**
+   * @brief Set up with a frequency, the timer picks its counts.
+   */
+  bool begin(timer_mode_t mode, uint8_t type, uint8_t channel, float frequencyHz,
+             float dutyPercent, GPTimerCbk_f callback = nullptr, void *context = nullptr);
+
+  bool open();
+  bool start();
+  bool stop();
+  void close();
+  bool setup_overflow_irq(uint8_t priority = 12, void (*isr)() = nullptr);
+
+  /**
+   * @brief Counts since the last period started, from the virtual clock.
+   */
+  uint32_t get_counter();
+  uint32_t get_period_raw() const { return period; }
+  uint32_t get_duty_raw() const { return pulse; }
+
+  /**
+   * @brief A channel no FspTimer has begun yet, or -1.
+   */
+  static int8_t get_available_timer(uint8_t &type, bool reserved = false);
+
+private:
+  bool claim(uint8_t type, uint8_t channel);
+
+  bool begun = false;
+  bool running = false;
+  uint8_t timerType = GPT_TIMER;
+  uint8_t timerChannel = 0;
+  uint32_t period = 0;
+  uint32_t pulse = 0;
+  uint32_t divider = 1;
+  uint64_t startNs = 0;
+};
+
+#endif // HOST_SIM_FSP_TIMER_H
@@ -0,0 +1,127 @@
+/**
+ * @file LiquidCrystal_I2C.cpp
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Host-side LiquidCrystal_I2C stand-in. See LiquidCrystal_I2C.h.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ */
+#include "LiquidCrystal_I2C.h"
+
+// PCF8574 port bits wired to the LCD.
+#define LCD_RS 0x01
+#define LCD_EN 0x04
+#define LCD_BACKLIGHT 0x08
+
+// HD44780 instructions.
+#define LCD_CLEAR 0x01
+#define LCD_HOME 0x02
+#define LCD_ENTRY_LEFT 0x06
+#define LCD_DISPLAY_CONTROL 0x08
+#define LCD_DISPLAY_ON 0x04
+#define LCD_FUNCTION_4BIT_2LINE 0x28
+#define LCD_SET_DDRAM 0x80
+
+LiquidCrystal_I2C::LiquidCrystal_I2C(uint8_t address, uint8_t cols, uint8_t rows)
+    : address(address), rows(rows), backlightBit(0), displayControl(LCD_DISPLAY_ON)
+{
+  (void)cols; // The controller wraps lines itself.
+} // LiquidCrystal_I2C()
+
+/**
+ * @details The library's power-up sequence: three 8-bit function sets to
+ * get the controller into a known state, then one to switch to 4-bit mode.
+ */
+void LiquidCrystal_I2C::init()
+{
+  delay(50);
+  expanderWrite(backlightBit);
+  delay(1000);
+  write4bits(0x30);
+  delayMicroseconds(4500);
+  write4bits(0x30);
+  delayMicroseconds(4500);
+  write4bits(0x30);
+  delayMicroseconds(150);
+  write4bits(0x20);
+  command(LCD_FUNCTION_4BIT_2LINE);
+  display();
+  clear();
+  command(LCD_ENTRY_LEFT);
+  home();
+} // init()
+
+void LiquidCrystal_I2C::clear()
+{
+  command(LCD_CLEAR);
+  delayMicroseconds(2000);
+} // clear()
+
+void LiquidCrystal_I2C::home()
+{
+  command(LCD_HOME);
+  delayMicroseconds(2000);
+} // home()
+
+void LiquidCrystal_I2C::setCursor(uint8_t col, uint8_t row)
+{
+  static const uint8_t offsets[4] = {0x00, 0x40, 0x14, 0x54};
+  if (row >= rows)
+  {
+    row = rows - 1;
+  } // if
+  command(LCD_SET_DDRAM | (col + offsets[row & 3]));
+} // setCursor()
+
+void LiquidCrystal_I2C::backlight()
+{
+  backlightBit = LCD_BACKLIGHT;
+  expanderWrite(0);
+} // backlight()
+
+void LiquidCrystal_I2C::noBacklight()
+{
+  backlightBit = 0;
+  expanderWrite(0);
+} // noBacklight()
+
+void LiquidCrystal_I2C::display()
+{
+  displayControl |= LCD_DISPLAY_ON;
+  command(LCD_DISPLAY_CONTROL | displayControl);
+} // display()
+
+void LiquidCrystal_I2C::noDisplay()
+{
+  displayControl &= ~LCD_DISPLAY_ON;
+  command(LCD_DISPLAY_CONTROL | displayControl);
+} // noDisplay()
+
+size_t LiquidCrystal_I2C::write(uint8_t value)
+{
+  send(value, LCD_RS);
+  return 1;
+} // write()
+
+void LiquidCrystal_I2C::send(uint8_t value, uint8_t mode)
+{
+  write4bits((value & 0xF0) | mode);
+  write4bits(((value << 4) & 0xF0) | mode);
+} // send()
+
+void LiquidCrystal_I2C::write4bits(uint8_t value)
+{
+  expanderWrite(value);
+  expanderWrite(value | LCD_EN);
+  delayMicroseconds(1);
+  expanderWrite(value & ~LCD_EN);
+  delayMicroseconds(50);
+} // write4bits()
+
+void LiquidCrystal_I2C::expanderWrite(uint8_t value)
+{
+  Wire.beginTransmission(address);
+  Wire.write(value | backlightBit);
+  Wire.endTransmission();
+} // expanderWrite()
@@ -0,0 +1,50 @@
+/**
+ * @file LiquidCrystal_I2C.h
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Host-side stand-in for the LiquidCrystal_I2C library.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details Puts the same traffic on the simulated bus as the real library:
+ * every change of the PCF8574 port is its own I2C transaction, with the
+ * library's delays after each EN pulse and after clear() and home(). A
+ * SimLcd on the bus shows the text, and Wire.stats() shows what it cost.
+ */
+#ifndef HOST_SIM_LIQUID_CRYSTAL_I2C_H
+#define HOST_SIM_LIQUID_CRYSTAL_I2C_H
+
+#include "Arduino.h"
+#include "Wire.h"
+
+class LiquidCrystal_I2C : public Print
+{
+public:
+  LiquidCrystal_I2C(uint8_t address, uint8_t cols, uint8_t rows);
+
+  void init();
+  void begin() { init(); }
+  void clear();
+  void home();
+  void setCursor(uint8_t col, uint8_t row);
+  void backlight();
+  void noBacklight();
+  void display();
+  void noDisplay();
+  size_t write(uint8_t value) override;
+  using Print::write;
+
+private:
+  void command(uint8_t value) { send(value, 0); }
+  void send(uint8_t value, uint8_t mode);
+  void write4bits(uint8_t value);
+  void expanderWrite(uint8_t value);
+
+  uint8_t address;
+  uint8_t rows;
+  uint8_t backlightBit;
+  uint8_t displayControl;
+};
+
+#endif // HOST_SIM_LIQUID_CRYSTAL_I2C_H
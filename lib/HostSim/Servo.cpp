@@ -0,0 +1,40 @@
+/**
+ * @file Servo.cpp
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Host-side Servo stand-in. See Servo.h.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ */
+#include "Servo.h"
+
+uint8_t Servo::attach(int pin, int minUs, int maxUs)
+{
+  SimHal::count(SIM_HAL_PIN_MODE);
+  this->pin = pin;
+  this->minUs = minUs;
+  this->maxUs = maxUs;
+  return 0; // Channel number.
+} // attach()
+
+void Servo::write(int value)
+{
+  if (value < MIN_PULSE_WIDTH)
+  {
+    value = value < 0 ? 0 : value > 180 ? 180 : value;
+    value = (int)map(value, 0, 180, minUs, maxUs);
+  } // if
+  writeMicroseconds(value);
+} // write()
+
+void Servo::writeMicroseconds(int us)
+{
+  SimHal::count(SIM_HAL_SERVO_WRITE);
+  pulseUs = us < minUs ? minUs : us > maxUs ? maxUs : us;
+} // writeMicroseconds()
+
+int Servo::read() const
+{
+  return (int)map(pulseUs, minUs, maxUs, 0, 180);
+} // read()
@@ -0,0 +1,46 @@
+/**
+ * @file Servo.h
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Host-side stand-in for the Arduino Servo library.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details Remembers the pin and the last position so a program can check
+ * what the sketch asked for, and counts each write() in SimHal. ESP32Servo.h
+ * gives ESP32 sketches the same class.
+ */
+#ifndef HOST_SIM_SERVO_H
+#define HOST_SIM_SERVO_H
+
+#include "Arduino.h"
+
+// Pulse widths the Arduino library maps 0 and 180 degrees to.
+#define MIN_PULSE_WIDTH 544
+#define MAX_PULSE_WIDTH 2400
+
+class Servo
+{
+public:
+  uint8_t attach(int pin, int minUs = MIN_PULSE_WIDTH, int maxUs = MAX_PULSE_WIDTH);
+  void detach() { pin = -1; }
+  bool attached() const { return pin >= 0; }
+
+  /**
+   * @brief Values below MIN_PULSE_WIDTH are degrees, others microseconds,
+   * as in the Arduino library.
+   */
+  void write(int value);
+  void writeMicroseconds(int us);
+  int read() const;
+  int readMicroseconds() const { return pulseUs; }
+
+private:
+  int pin = -1;
+  int minUs = MIN_PULSE_WIDTH;
+  int maxUs = MAX_PULSE_WIDTH;
+  int pulseUs = 1500;
+};
+
+#endif // HOST_SIM_SERVO_H
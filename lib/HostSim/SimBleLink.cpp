@@ -0,0 +1,251 @@
+/**
+ * @file SimBleLink.cpp
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief In-process stand-in for a BLE connection. See SimBleLink.h.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ */
+#include "SimBleLink.h"
+#include "SimClock.h"
+
+SimBleLink::SimBleLink(const SimBleSettings &settings)
+    : settings(settings), centralEnd(*this, toPeripheral),
+      peripheralEnd(*this, toCentral), linkHandler(nullptr),
+      linkContext(nullptr), up(false), connectAtUs(0), nextEventUs(0),
+      eventsAsleep(0), eventsToUpdate(0), pendingIntervalUs(0),
+      pendingLatency(0), lossState(12345), counters{0, 0, 0, 0, 0}
+{
+  if (this->settings.mtu > SIM_BLE_MAX_PAYLOAD + 3)
+  {
+    this->settings.mtu = SIM_BLE_MAX_PAYLOAD + 3;
+  } // if
+  if (this->settings.packetsPerEvent == 0)
+  {
+    this->settings.packetsPerEvent = 1;
+  } // if
+  clear(toPeripheral);
+  clear(toCentral);
+  toPeripheral.receiver = nullptr;
+  toPeripheral.context = nullptr;
+  toCentral.receiver = nullptr;
+  toCentral.context = nullptr;
+} // SimBleLink()
+
+void SimBleLink::setCentralReceiver(Receiver receiver, void *context)
+{
+  toCentral.receiver = receiver;
+  toCentral.context = context;
+} // setCentralReceiver()
+
+void SimBleLink::setPeripheralReceiver(Receiver receiver, void *context)
+{
+  toPeripheral.receiver = receiver;
+  toPeripheral.context = context;
+} // setPeripheralReceiver()
+
+void SimBleLink::setLinkHandler(LinkHandler handler, void *context)
+{
+  linkHandler = handler;
+  linkContext = context;
+} // setLinkHandler()
+
+/**
+ * @brief The central connects on the first advertisement it hears after
+ * this, and the first connection event follows one interval later.
+ */
+void SimBleLink::connect()
+{
+  if (up || connectAtUs != 0)
+  {
+    return;
+  } // if
+  uint64_t now = nowUs();
+  uint64_t advertisement = (now / settings.advertisingUs + 1) * settings.advertisingUs;
+  connectAtUs = advertisement + settings.intervalUs;
+} // connect()
+
+void SimBleLink::drop()
+{
+  connectAtUs = 0;
+  eventsToUpdate = 0;
+  eventsAsleep = 0;
+  clear(toPeripheral);
+  clear(toCentral);
+  if (!up)
+  {
+    return;
+  } // if
+  up = false;
+  if (linkHandler != nullptr)
+  {
+    linkHandler(linkContext, false);
+  } // if
+} // drop()
+
+void SimBleLink::poll()
+{
+  uint64_t now = nowUs();
+  if (!up && connectAtUs != 0 && now >= connectAtUs)
+  {
+    up = true;
+    nextEventUs = connectAtUs;
+    connectAtUs = 0;
+    if (linkHandler != nullptr)
+    {
+      linkHandler(linkContext, true);
+    } // if
+  } // if
+  if (!up)
+  {
+    return;
+  } // if
+  while (nextEventUs <= now)
+  {
+    if (peripheralListens(nextEventUs))
+    {
+      runEvent(toPeripheral, nextEventUs); // The central always sends first.
+      runEvent(toCentral, nextEventUs);
+    } // if
+    counters.events++;
+    if (eventsToUpdate > 0 && --eventsToUpdate == 0)
+    {
+      settings.intervalUs = pendingIntervalUs;
+      settings.peripheralLatency = pendingLatency;
+    } // if
+    nextEventUs += settings.intervalUs;
+  } // while
+  deliver(toPeripheral, now);
+  deliver(toCentral, now);
+} // poll()
+
+void SimBleLink::updateParams(uint32_t intervalUs, uint16_t peripheralLatency)
+{
+  pendingIntervalUs = intervalUs;
+  pendingLatency = peripheralLatency;
+  eventsToUpdate = SIM_BLE_UPDATE_EVENTS;
+} // updateParams()
+
+void SimBleLink::resetStats()
+{
+  counters = {0, 0, 0, 0, 0};
+} // resetStats()
+
+bool SimBleLink::End::send(uint8_t channel, const uint8_t *data,
+                           size_t length)
+{
+  if (!link.up || length > (size_t)(link.settings.mtu - 3) ||
+      !link.enqueue(out, channel, data, length))
+  {
+    link.counters.refused++;
+    return false;
+  } // if
+  return true;
+} // send()
+
+bool SimBleLink::enqueue(Direction &out, uint8_t channel, const uint8_t *data,
+                         size_t length)
+{
+  if (out.count == SIM_BLE_QUEUE)
+  {
+    return false; // No transmit buffer free.
+  } // if
+  Message &message = out.queue[(out.head + out.count) % SIM_BLE_QUEUE];
+  message.sentUs = nowUs();
+  message.deliverUs = 0;
+  message.channel = channel;
+  message.length = length;
+  memcpy(message.data, data, length);
+  out.count++;
+  return true;
+} // enqueue()
+
+/**
+ * @brief The peripheral wakes for an event when it has something to send or
+ * has slept through as many events as the slave latency allows.
+ */
+bool SimBleLink::peripheralListens(uint64_t eventUs)
+{
+  bool hasData = toCentral.carried < toCentral.count &&
+                 toCentral.queue[(toCentral.head + toCentral.carried) % SIM_BLE_QUEUE].sentUs <= eventUs;
+  if (!hasData && eventsAsleep < settings.peripheralLatency)
+  {
+    eventsAsleep++;
+    return false;
+  } // if
+  eventsAsleep = 0;
+  counters.peripheralAwake++;
+  return true;
+} // peripheralListens()
+
+/**
+ * @brief Carry up to packetsPerEvent waiting messages in one connection
+ * event. A failed packet ends the event, it and everything behind it wait
+ * for the next one.
+ */
+void SimBleLink::runEvent(Direction &out, uint64_t eventUs)
+{
+  uint8_t sent = 0;
+  while (sent < settings.packetsPerEvent && out.carried < out.count)
+  {
+    Message &message = out.queue[(out.head + out.carried) % SIM_BLE_QUEUE];
+    if (message.sentUs > eventUs)
+    {
+      break; // Queued after this event started.
+    } // if
+    if (packetLost())
+    {
+      counters.retransmitted++;
+      break;
+    } // if
+    message.deliverUs = eventUs + settings.latencyUs;
+    out.carried++;
+    sent++;
+  } // while
+} // runEvent()
+
+/**
+ * @brief Hand every carried message whose time has come to the receiver, in
+ * the order they were sent.
+ */
+void SimBleLink::deliver(Direction &out, uint64_t now)
+{
+  while (out.carried > 0 && out.queue[out.head].deliverUs <= now)
+  {
+    const Message &message = out.queue[out.head];
+    if (out.receiver != nullptr)
+    {
+      out.receiver(out.context, message.channel, message.data, message.length);
+    } // if
+    out.head = (out.head + 1) % SIM_BLE_QUEUE;
+    out.count--;
+    out.carried--;
+    counters.delivered++;
+  } // while
+} // deliver()
+
+void SimBleLink::clear(Direction &out)
+{
+  out.head = 0;
+  out.count = 0;
+  out.carried = 0;
+} // clear()
+
+/**
+ * @brief Linear congruential generator, compared against the loss rate.
+ */
+bool SimBleLink::packetLost()
+{
+  if (settings.lossPerMille == 0)
+  {
+    return false;
+  } // if
+  lossState = lossState * 1103515245UL + 12345UL;
+  return ((lossState >> 16) % 1000) < settings.lossPerMille;
+} // packetLost()
+
+uint64_t SimBleLink::nowUs()
+{
+  return SimClock::nowNs() / 1000;
+} // nowUs()
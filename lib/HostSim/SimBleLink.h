@@ -0,0 +1,192 @@
+/**
+ * @file SimBleLink.h
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief In-process stand-in for a BLE connection between a client and a
+ * server, for running RobotClient and RobotServer on the host.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details
+ * The two ends are RobotLinkTransports. What one end sends is delivered to
+ * the other end's receiver from poll(), at the time a real link would
+ * deliver it, on the virtual clock (SimClock.h):
+ * - Connection interval: a message waits for the next connection event.
+ * - Packets per event: each event carries at most this many messages each
+ *   way. The rest wait for the next event.
+ * - Latency: air time plus the receiving stack, added after the event.
+ * - Loss: a packet that fails its CRC is not gone. The link layer ends the
+ *   event and sends it again at the next one, so loss shows up as delay
+ *   (one connection interval per retry), exactly as on a real link.
+ * - Buffers: each direction holds SIM_BLE_QUEUE messages, like the
+ *   controller's transmit buffers. send() returns false when they are full.
+ * - Reconnect: drop() ends the link, connect() brings it back at the next
+ *   advertising event plus one connection interval.
+ * - Slave latency: the peripheral may sleep through that many events in a
+ *   row when it has nothing to send. Nothing moves either way in an event
+ *   it sleeps through, so what the central writes waits for it to wake.
+ * - Parameter updates: updateParams() takes effect SIM_BLE_UPDATE_EVENTS
+ *   events later, at the update's instant, as the link layer does.
+ *
+ * Loss uses a fixed pseudo-random sequence, so every run gives the same
+ * numbers.
+ */
+#ifndef SIM_BLE_LINK_H
+#define SIM_BLE_LINK_H
+
+#include <Arduino.h>
+#include <RobotLinkTransport.h>
+
+// Messages each direction can hold before send() fails.
+#define SIM_BLE_QUEUE 16
+
+// Largest message (MTU 247 minus the 3 byte ATT header).
+#define SIM_BLE_MAX_PAYLOAD 244
+
+// Events from a parameter update to its instant.
+#define SIM_BLE_UPDATE_EVENTS 6
+
+struct SimBleSettings
+{
+  uint32_t intervalUs;     // Connection interval.
+  uint32_t latencyUs;      // From the connection event to the receiver.
+  uint16_t lossPerMille;   // Packets that fail and go again next event.
+  uint8_t packetsPerEvent; // Most messages each way in one event.
+  uint16_t mtu;            // Negotiated ATT MTU.
+  uint32_t advertisingUs;  // Server advertising interval.
+  uint16_t peripheralLatency; // Events the peripheral may sleep through.
+};
+
+/**
+ * @brief What the link did since construction or resetStats().
+ */
+struct SimBleStats
+{
+  uint32_t delivered;     // Messages handed to a receiver.
+  uint32_t retransmitted; // Packets that failed and went again.
+  uint32_t refused;       // send() calls that returned false.
+  uint32_t events;        // Connection events.
+  uint32_t peripheralAwake; // Events the peripheral's radio was on for.
+};
+
+class SimBleLink
+{
+public:
+  typedef void (*Receiver)(void *context, uint8_t channel,
+                           const uint8_t *data, size_t length);
+  typedef void (*LinkHandler)(void *context, bool connected);
+
+  explicit SimBleLink(const SimBleSettings &settings);
+
+  /**
+   * @brief The ESP32 client's end and the UNO R4 server's end.
+   */
+  RobotLinkTransport &central() { return centralEnd; }
+  RobotLinkTransport &peripheral() { return peripheralEnd; }
+
+  /**
+   * @brief Who gets the messages sent by the other end.
+   */
+  void setCentralReceiver(Receiver receiver, void *context);
+  void setPeripheralReceiver(Receiver receiver, void *context);
+
+  /**
+   * @brief Called from poll() when the link comes up or goes down.
+   */
+  void setLinkHandler(LinkHandler handler, void *context);
+
+  /**
+   * @brief Start advertising. The link comes up at the next advertising
+   * event plus one connection interval.
+   */
+  void connect();
+
+  /**
+   * @brief Lose the link. Everything queued is discarded.
+   */
+  void drop();
+
+  bool connected() const { return up; }
+
+  /**
+   * @brief Ask for a new connection interval and slave latency. Nothing
+   * changes until the instant, SIM_BLE_UPDATE_EVENTS events from now.
+   */
+  void updateParams(uint32_t intervalUs, uint16_t peripheralLatency);
+
+  /**
+   * @brief Parameters in effect now.
+   */
+  uint32_t intervalUs() const { return settings.intervalUs; }
+  uint16_t peripheralLatency() const { return settings.peripheralLatency; }
+
+  /**
+   * @brief Run every connection event up to now and deliver what is due.
+   * Call often: a message is delivered at the first poll() after its time.
+   */
+  void poll();
+
+  const SimBleStats &stats() const { return counters; }
+  void resetStats();
+
+private:
+  struct Message
+  {
+    uint64_t sentUs;    // When send() queued it.
+    uint64_t deliverUs; // 0 until a connection event has carried it.
+    uint8_t channel;
+    uint16_t length;
+    uint8_t data[SIM_BLE_MAX_PAYLOAD];
+  };
+
+  struct Direction
+  {
+    Message queue[SIM_BLE_QUEUE];
+    uint8_t head;      // Oldest message.
+    uint8_t count;
+    uint8_t carried;   // Messages at the head already sent over the air.
+    Receiver receiver; // The other end.
+    void *context;
+  };
+
+  class End : public RobotLinkTransport
+  {
+  public:
+    End(SimBleLink &link, Direction &out) : link(link), out(out) {}
+    bool send(uint8_t channel, const uint8_t *data, size_t length) override;
+    uint16_t mtu() const override { return link.settings.mtu; }
+
+  private:
+    SimBleLink &link;
+    Direction &out;
+  };
+
+  bool enqueue(Direction &out, uint8_t channel, const uint8_t *data,
+               size_t length);
+  bool peripheralListens(uint64_t eventUs);
+  void runEvent(Direction &out, uint64_t eventUs);
+  void deliver(Direction &out, uint64_t now);
+  void clear(Direction &out);
+  bool packetLost();
+  static uint64_t nowUs();
+
+  SimBleSettings settings;
+  Direction toPeripheral; // Written by the central.
+  Direction toCentral;    // Notified by the peripheral.
+  End centralEnd;
+  End peripheralEnd;
+  LinkHandler linkHandler;
+  void *linkContext;
+  bool up;
+  uint64_t connectAtUs;   // 0 = not connecting.
+  uint64_t nextEventUs;
+  uint16_t eventsAsleep;  // Events the peripheral has slept through in a row.
+  uint8_t eventsToUpdate; // Until the pending update's instant, 0 = none.
+  uint32_t pendingIntervalUs;
+  uint16_t pendingLatency;
+  uint32_t lossState;     // Loss generator state.
+  SimBleStats counters;
+};
+
+#endif // SIM_BLE_LINK_H
@@ -0,0 +1,45 @@
+/**
+ * @file SimClock.h
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Virtual clock used by the host-side Arduino stand-ins.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details On the host nothing really waits. delay(), delayMicroseconds() and
+ * simulated bus transfers move this clock forward instead, and millis() and
+ * micros() read it. A benchmark therefore measures the time the code would
+ * spend on the board, not the time the host took to run it.
+ */
+#ifndef SIM_CLOCK_H
+#define SIM_CLOCK_H
+
+#include <stdint.h>
+
+namespace SimClock
+{
+  /**
+   * @brief Current virtual time in nanoseconds since start (or last reset).
+   */
+  uint64_t nowNs();
+
+  /**
+   * @brief Move virtual time forward.
+   */
+  void advanceNs(uint64_t ns);
+
+  /**
+   * @brief Set virtual time back to zero.
+   */
+  void reset();
+
+  /**
+   * @brief Time each millis() or micros() call takes, 0 by default. A loop
+   * that waits by reading the clock, such as
+   * while (millis() - start < 200) {}, only ends if reading it takes time.
+   */
+  void setReadCostNs(uint32_t ns);
+} // namespace SimClock
+
+#endif // SIM_CLOCK_H
@@ -0,0 +1,176 @@
+/**
+ * @file SimHal.cpp
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Host-side pin I/O and hardware call counters. See SimHal.h.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ */
+#include "Arduino.h"
+
+static uint32_t callCounts[SIM_HAL_CALLS];
+
+static const char *const callNames[SIM_HAL_CALLS] = {
+    "pinMode",
+    "digitalWrite",
+    "digitalRead",
+    "port write",
+    "analogRead",
+    "analogWrite",
+    "delay",
+    "Serial write",
+    "Serial read",
+    "Servo::write",
+    "LED matrix frame",
+    "FspTimer setup",
+    "BLE",
+    "flash write",
+    "flash erase"};
+
+static uint8_t modes[SIM_HAL_PINS];
+static uint8_t levels[SIM_HAL_PINS];      // Written by digitalWrite() and port writes.
+static uint8_t inputLevels[SIM_HAL_PINS]; // Returned by digitalRead().
+static int duties[SIM_HAL_PINS];
+static int analogInputs[SIM_HAL_PINS];
+static bool analogInputSet[SIM_HAL_PINS];
+static int readBits = 10;
+static int writeBits = 8;
+
+void SimHal::count(SimHalCall call)
+{
+  callCounts[call]++;
+} // count()
+
+uint32_t SimHal::calls(SimHalCall call)
+{
+  return callCounts[call];
+} // calls()
+
+const char *SimHal::name(SimHalCall call)
+{
+  return call < SIM_HAL_CALLS ? callNames[call] : "?";
+} // name()
+
+void SimHal::resetCalls()
+{
+  for (uint8_t i = 0; i < SIM_HAL_CALLS; i++)
+  {
+    callCounts[i] = 0;
+  } // for
+} // resetCalls()
+
+void SimHal::setAnalogInput(uint8_t pin, int value)
+{
+  if (pin < SIM_HAL_PINS)
+  {
+    analogInputs[pin] = value;
+    analogInputSet[pin] = true;
+  } // if
+} // setAnalogInput()
+
+void SimHal::setDigitalInput(uint8_t pin, uint8_t level)
+{
+  if (pin < SIM_HAL_PINS)
+  {
+    inputLevels[pin] = level;
+  } // if
+} // setDigitalInput()
+
+uint8_t SimHal::pinLevel(uint8_t pin)
+{
+  return pin < SIM_HAL_PINS ? levels[pin] : LOW;
+} // pinLevel()
+
+void SimHal::setPinLevel(uint8_t pin, uint8_t level)
+{
+  if (pin < SIM_HAL_PINS)
+  {
+    levels[pin] = level ? HIGH : LOW;
+  } // if
+} // setPinLevel()
+
+int SimHal::pinDuty(uint8_t pin)
+{
+  return pin < SIM_HAL_PINS ? duties[pin] : 0;
+} // pinDuty()
+
+uint8_t SimHal::modeOf(uint8_t pin)
+{
+  return pin < SIM_HAL_PINS ? modes[pin] : INPUT;
+} // modeOf()
+
+int SimHal::writeResolution()
+{
+  return writeBits;
+} // writeResolution()
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+  SimHal::count(SIM_HAL_PIN_MODE);
+  if (pin < SIM_HAL_PINS)
+  {
+    modes[pin] = mode;
+    if (mode == INPUT_PULLUP)
+    {
+      inputLevels[pin] = HIGH;
+    } // if
+  } // if
+} // pinMode()
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+  SimHal::count(SIM_HAL_DIGITAL_WRITE);
+  if (pin < SIM_HAL_PINS)
+  {
+    levels[pin] = value ? HIGH : LOW;
+  } // if
+} // digitalWrite()
+
+/**
+ * @details An output pin reads back what was written to it, as on the
+ * board. That is how a sketch can toggle a pin with digitalRead().
+ */
+int digitalRead(uint8_t pin)
+{
+  SimHal::count(SIM_HAL_DIGITAL_READ);
+  if (pin >= SIM_HAL_PINS)
+  {
+    return LOW;
+  } // if
+  return modes[pin] == OUTPUT ? levels[pin] : inputLevels[pin];
+} // digitalRead()
+
+/**
+ * @details An input that was never set reads mid-scale at the current
+ * resolution.
+ */
+int analogRead(uint8_t pin)
+{
+  SimHal::count(SIM_HAL_ANALOG_READ);
+  if (pin < SIM_HAL_PINS && analogInputSet[pin])
+  {
+    return analogInputs[pin];
+  } // if
+  int idle = SIM_HAL_ANALOG_IDLE;
+  return readBits >= 10 ? idle << (readBits - 10) : idle >> (10 - readBits);
+} // analogRead()
+
+void analogWrite(uint8_t pin, int value)
+{
+  SimHal::count(SIM_HAL_ANALOG_WRITE);
+  if (pin < SIM_HAL_PINS)
+  {
+    duties[pin] = value;
+  } // if
+} // analogWrite()
+
+void analogReadResolution(int bits)
+{
+  readBits = bits;
+} // analogReadResolution()
+
+void analogWriteResolution(int bits)
+{
+  writeBits = bits;
+} // analogWriteResolution()
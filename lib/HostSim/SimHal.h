@@ -0,0 +1,109 @@
+/**
+ * @file SimHal.h
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Pin state and call counters behind the host-side Arduino functions.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details
+ * Every hardware call a sketch makes on the host (pinMode(), digitalWrite(),
+ * analogRead(), Servo::write(), a frame on the LED matrix ...) is counted
+ * here, so the sketch runner can report how many of each a loop() makes.
+ * Outputs are remembered per pin and analog inputs can be set, so a program
+ * can drive a sketch (centre the joystick, press the button) and check what
+ * it did with the motor pins.
+ */
+#ifndef SIM_HAL_H
+#define SIM_HAL_H
+
+#include <stdint.h>
+
+// Pins tracked. Covers the UNO R4 (0-19) and the ESP32 GPIOs (0-39).
+#define SIM_HAL_PINS 40
+
+// What analogRead() returns until setAnalogInput() says otherwise: a joystick
+// axis at rest on a 10-bit converter.
+#define SIM_HAL_ANALOG_IDLE 512
+
+/**
+ * @brief Hardware calls that are counted.
+ */
+enum SimHalCall : uint8_t
+{
+  SIM_HAL_PIN_MODE = 0,
+  SIM_HAL_DIGITAL_WRITE,
+  SIM_HAL_DIGITAL_READ,
+  SIM_HAL_PORT_WRITE,     // Several pins of one port at once (lib/L298N).
+  SIM_HAL_ANALOG_READ,
+  SIM_HAL_ANALOG_WRITE,
+  SIM_HAL_DELAY,          // delay() and delayMicroseconds().
+  SIM_HAL_SERIAL_WRITE,   // One per write() or print() call, not per byte.
+  SIM_HAL_SERIAL_READ,
+  SIM_HAL_SERVO_WRITE,
+  SIM_HAL_MATRIX_FRAME,
+  SIM_HAL_TIMER_CONFIG,   // FspTimer begin, open, start, stop, close.
+  SIM_HAL_BLE,            // BLE.poll() and the other BLE calls.
+  SIM_HAL_FLASH_WRITE,    // Bytes programmed into the data flash.
+  SIM_HAL_FLASH_ERASE,    // Data flash blocks erased.
+  SIM_HAL_CALLS           // Number of counters.
+};
+
+namespace SimHal
+{
+  /**
+   * @brief Count one call. Used by the stand-ins, not by sketches.
+   */
+  void count(SimHalCall call);
+
+  /**
+   * @brief Calls since the start or the last resetCalls().
+   */
+  uint32_t calls(SimHalCall call);
+
+  /**
+   * @brief Name of a counter for reports, such as "digitalWrite".
+   */
+  const char *name(SimHalCall call);
+
+  void resetCalls();
+
+  /**
+   * @brief Value analogRead() returns for a pin from now on.
+   */
+  void setAnalogInput(uint8_t pin, int value);
+
+  /**
+   * @brief Level digitalRead() returns for an input pin from now on.
+   */
+  void setDigitalInput(uint8_t pin, uint8_t level);
+
+  /**
+   * @brief Last level written to a pin with digitalWrite() or a port write.
+   */
+  uint8_t pinLevel(uint8_t pin);
+
+  /**
+   * @brief Change an output's level without counting a digitalWrite(), for
+   * stand-ins that write a whole port.
+   */
+  void setPinLevel(uint8_t pin, uint8_t level);
+
+  /**
+   * @brief Last value written to a pin with analogWrite().
+   */
+  int pinDuty(uint8_t pin);
+
+  /**
+   * @brief Last mode set with pinMode(), INPUT if never set.
+   */
+  uint8_t modeOf(uint8_t pin);
+
+  /**
+   * @brief Bits analogWrite() values have, from analogWriteResolution().
+   */
+  int writeResolution();
+} // namespace SimHal
+
+#endif // SIM_HAL_H
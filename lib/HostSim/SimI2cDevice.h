@@ -0,0 +1,61 @@
+/**
+ * @file SimI2cDevice.h
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Base class for behavioural models of I2C slave devices.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ */
+#ifndef SIM_I2C_DEVICE_H
+#define SIM_I2C_DEVICE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief A device that can be attached to the simulated bus (see Wire.h).
+ *
+ * @details The bus calls these hooks in the same order the real transfer
+ * happens: start() when the device's address is acknowledged, then either
+ * writeByte() for every byte the master sends or readByte() for every byte
+ * the master clocks in, then stop().
+ */
+class SimI2cDevice
+{
+public:
+  explicit SimI2cDevice(uint8_t address) : address(address) {}
+  virtual ~SimI2cDevice() {}
+
+  /**
+   * @brief 7-bit address the device answers to.
+   */
+  uint8_t getAddress() const { return address; }
+
+  /**
+   * @brief A START (or repeated START) addressed to this device.
+   * @param read true for a read transfer, false for a write.
+   */
+  virtual void start(bool read) { (void)read; }
+
+  /**
+   * @brief One byte written by the master.
+   * @return true to ACK, false to NACK.
+   */
+  virtual bool writeByte(uint8_t value) = 0;
+
+  /**
+   * @brief One byte read by the master.
+   */
+  virtual uint8_t readByte() = 0;
+
+  /**
+   * @brief End of the transfer (STOP).
+   */
+  virtual void stop() {}
+
+protected:
+  uint8_t address;
+};
+
+#endif // SIM_I2C_DEVICE_H
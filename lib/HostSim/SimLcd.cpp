@@ -0,0 +1,141 @@
+/**
+ * @file SimLcd.cpp
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief HD44780 over PCF8574 model. See SimLcd.h.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ */
+#include "SimLcd.h"
+#include "SimClock.h"
+#include <string.h>
+
+#define PORT_RS 0x01
+#define PORT_EN 0x04
+
+#define EXEC_NS 37000ULL    // Most instructions and data writes.
+#define CLEAR_NS 1520000ULL // Clear display and return home.
+
+// DDRAM address of the first cell of each row.
+static const uint8_t rowOffsets[4] = {0x00, 0x40, 0x14, 0x54};
+
+SimLcd::SimLcd(uint8_t address, uint8_t cols, uint8_t rows)
+    : SimI2cDevice(address), cols(cols > 40 ? 40 : cols),
+      rows(rows > 4 ? 4 : rows), port(0), fourBit(false),
+      haveHighNibble(false), highNibble(0), displayEnabled(false),
+      addressCounter(0), busyUntilNs(0), dataCount(0), commandCount(0),
+      violations(0)
+{
+  memset(ddram, ' ', sizeof(ddram));
+} // SimLcd()
+
+/**
+ * @brief New port value. Latch D4-D7 on the falling edge of EN.
+ */
+bool SimLcd::writeByte(uint8_t value)
+{
+  bool fallingEdge = (port & PORT_EN) && !(value & PORT_EN);
+  if (fallingEdge)
+  {
+    // Data and RS are sampled from the value that was on the pins while EN
+    // was high.
+    latchNibble(port >> 4, (port & PORT_RS) != 0);
+  } // if
+  port = value;
+  return true; // The PCF8574 ACKs every byte.
+} // writeByte()
+
+const char *SimLcd::row(uint8_t index)
+{
+  uint8_t base = rowOffsets[index < rows ? index : 0];
+  memcpy(rowText, &ddram[base], cols);
+  rowText[cols] = '\0';
+  return rowText;
+} // row()
+
+/**
+ * @brief Combine nibbles into bytes (4-bit mode) or run them as-is (8-bit).
+ */
+void SimLcd::latchNibble(uint8_t nibble, bool rs)
+{
+  if (!fourBit)
+  {
+    // In 8-bit mode D0-D3 are not wired, so they read as 0.
+    execute(nibble << 4, rs);
+    return;
+  } // if
+  if (!haveHighNibble)
+  {
+    highNibble = nibble;
+    haveHighNibble = true;
+    return;
+  } // if
+  haveHighNibble = false;
+  execute((highNibble << 4) | nibble, rs);
+} // latchNibble()
+
+/**
+ * @brief Run one instruction or data write.
+ */
+void SimLcd::execute(uint8_t value, bool rs)
+{
+  uint64_t now = SimClock::nowNs();
+  if (now < busyUntilNs)
+  {
+    violations++;
+  } // if
+  uint64_t execNs = EXEC_NS;
+
+  if (rs)
+  {
+    ddram[addressCounter & (SIM_LCD_DDRAM_SIZE - 1)] = (char)value;
+    addressCounter = (addressCounter + 1) & 0x7F;
+    dataCount++;
+  } // if
+  else
+  {
+    commandCount++;
+    if (value >= 0x80) // Set DDRAM address.
+    {
+      addressCounter = value & 0x7F;
+    } // if
+    else if (value >= 0x40)
+    {
+      // Set CGRAM address, custom characters are not modelled.
+    } // else if
+    else if (value >= 0x20) // Function set.
+    {
+      bool newFourBit = (value & 0x10) == 0;
+      if (newFourBit && !fourBit)
+      {
+        haveHighNibble = false;
+      } // if
+      fourBit = newFourBit;
+    } // else if
+    else if (value >= 0x10)
+    {
+      // Cursor / display shift, not modelled.
+    } // else if
+    else if (value >= 0x08) // Display on/off control.
+    {
+      displayEnabled = (value & 0x04) != 0;
+    } // else if
+    else if (value >= 0x04)
+    {
+      // Entry mode set, the model always increments.
+    } // else if
+    else if (value >= 0x02) // Return home.
+    {
+      addressCounter = 0;
+      execNs = CLEAR_NS;
+    } // else if
+    else if (value == 0x01) // Clear display.
+    {
+      memset(ddram, ' ', sizeof(ddram));
+      addressCounter = 0;
+      execNs = CLEAR_NS;
+    } // else if
+  } // else
+  busyUntilNs = now + execNs;
+} // execute()
@@ -0,0 +1,80 @@
+/**
+ * @file SimLcd.h
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Behavioural model of an HD44780 LCD behind a PCF8574 I2C backpack.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details Every byte written to the PCF8574 sets its 8 port pins
+ * (P0 = RS, P1 = RW, P2 = EN, P3 = backlight, P4-P7 = D4-D7). The HD44780
+ * latches D4-D7 on the falling edge of EN. The model follows the same rules:
+ * - Starts in 8-bit mode, switches to 4-bit mode on a function set with DL=0
+ *   (the 0x3, 0x3, 0x3, 0x2 initialization sequence).
+ * - Executes clear, home, entry mode, display control, function set and set
+ *   DDRAM address commands, and writes data bytes into DDRAM.
+ * - Counts timing violations: a byte latched while the controller is still
+ *   busy (37 us per instruction, 1.52 ms for clear and home) is a bug that
+ *   real hardware would show as missing or garbled characters.
+ */
+#ifndef SIM_LCD_H
+#define SIM_LCD_H
+
+#include "SimI2cDevice.h"
+
+#define SIM_LCD_DDRAM_SIZE 128
+
+class SimLcd : public SimI2cDevice
+{
+public:
+  SimLcd(uint8_t address = 0x3F, uint8_t cols = 16, uint8_t rows = 2);
+
+  bool writeByte(uint8_t value) override;
+  uint8_t readByte() override { return port; }
+
+  /**
+   * @brief Text currently shown on one row (cols characters, NUL terminated).
+   */
+  const char *row(uint8_t index);
+
+  bool backlight() const { return (port & 0x08) != 0; }
+  bool displayOn() const { return displayEnabled; }
+  bool fourBitMode() const { return fourBit; }
+
+  /**
+   * @brief Characters written into DDRAM.
+   */
+  uint32_t dataWrites() const { return dataCount; }
+
+  /**
+   * @brief Instructions executed.
+   */
+  uint32_t commands() const { return commandCount; }
+
+  /**
+   * @brief Bytes latched before the previous instruction had finished.
+   */
+  uint32_t timingViolations() const { return violations; }
+
+private:
+  void latchNibble(uint8_t nibble, bool rs);
+  void execute(uint8_t value, bool rs);
+
+  uint8_t cols;
+  uint8_t rows;
+  uint8_t port;        // Last value written to the PCF8574.
+  bool fourBit;
+  bool haveHighNibble; // First half of a 4-bit transfer received.
+  uint8_t highNibble;
+  bool displayEnabled;
+  uint8_t addressCounter;
+  char ddram[SIM_LCD_DDRAM_SIZE];
+  char rowText[41];
+  uint64_t busyUntilNs;
+  uint32_t dataCount;
+  uint32_t commandCount;
+  uint32_t violations;
+};
+
+#endif // SIM_LCD_H
@@ -0,0 +1,163 @@
+/**
+ * @file SimPca9685.cpp
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Behavioural model of the PCA9685. See SimPca9685.h.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ */
+#include "SimPca9685.h"
+#include <string.h>
+
+#define PCA9685_MODE1 0x00
+#define PCA9685_MODE2 0x01
+#define PCA9685_SUBADR1 0x02
+#define PCA9685_SUBADR2 0x03
+#define PCA9685_SUBADR3 0x04
+#define PCA9685_ALLCALLADR 0x05
+#define PCA9685_LED0_ON_L 0x06
+#define PCA9685_LED15_OFF_H 0x45
+#define PCA9685_ALL_LED_ON_L 0xFA
+#define PCA9685_ALL_LED_OFF_H 0xFD
+#define PCA9685_PRESCALE 0xFE
+
+#define MODE1_AI 0x20
+#define MODE1_SLEEP 0x10
+#define LED_FULL 0x10 // Bit 4 of ON_H / OFF_H.
+
+SimPca9685::SimPca9685(uint8_t address) : SimI2cDevice(address)
+{
+  reset();
+} // SimPca9685()
+
+/**
+ * @brief Power-on register values (datasheet table 4).
+ */
+void SimPca9685::reset()
+{
+  memset(regs, 0, sizeof(regs));
+  regs[PCA9685_MODE1] = 0x11;
+  regs[PCA9685_MODE2] = 0x04;
+  regs[PCA9685_SUBADR1] = 0xE2;
+  regs[PCA9685_SUBADR2] = 0xE4;
+  regs[PCA9685_SUBADR3] = 0xE8;
+  regs[PCA9685_ALLCALLADR] = 0xE0;
+  for (uint8_t ch = 0; ch < 16; ch++)
+  {
+    regs[PCA9685_LED0_ON_L + 4 * ch + 3] = LED_FULL; // LEDn_OFF_H: full off.
+  } // for
+  regs[PCA9685_ALL_LED_OFF_H] = LED_FULL;
+  regs[PCA9685_PRESCALE] = 0x1E;
+  pointer = 0;
+  expectPointer = false;
+  writes = 0;
+} // reset()
+
+void SimPca9685::start(bool read)
+{
+  // A write starts with the register pointer. A read continues from the
+  // current pointer (set by a previous write, usually with repeated START).
+  expectPointer = !read;
+} // start()
+
+bool SimPca9685::writeByte(uint8_t value)
+{
+  if (expectPointer)
+  {
+    pointer = value;
+    expectPointer = false;
+    return true;
+  } // if
+  store(pointer, value);
+  advance();
+  return true;
+} // writeByte()
+
+uint8_t SimPca9685::readByte()
+{
+  uint8_t value = regs[pointer];
+  advance();
+  return value;
+} // readByte()
+
+uint16_t SimPca9685::onCount(uint8_t channel) const
+{
+  uint8_t base = PCA9685_LED0_ON_L + 4 * (channel & 15);
+  return regs[base] | ((regs[base + 1] & 0x0F) << 8);
+} // onCount()
+
+uint16_t SimPca9685::offCount(uint8_t channel) const
+{
+  uint8_t base = PCA9685_LED0_ON_L + 4 * (channel & 15);
+  return regs[base + 2] | ((regs[base + 3] & 0x0F) << 8);
+} // offCount()
+
+float SimPca9685::frequencyHz(float oscillatorHz) const
+{
+  return oscillatorHz / (4096.0f * (regs[PCA9685_PRESCALE] + 1));
+} // frequencyHz()
+
+float SimPca9685::pulseUs(uint8_t channel, float oscillatorHz) const
+{
+  uint8_t base = PCA9685_LED0_ON_L + 4 * (channel & 15);
+  if (regs[base + 3] & LED_FULL)
+  {
+    return 0.0f; // Full off wins over everything else.
+  } // if
+  float periodUs = 1000000.0f / frequencyHz(oscillatorHz);
+  if (regs[base + 1] & LED_FULL)
+  {
+    return periodUs; // Full on.
+  } // if
+  int ticks = (int)offCount(channel) - (int)onCount(channel);
+  if (ticks < 0)
+  {
+    ticks += 4096;
+  } // if
+  return periodUs * ticks / 4096.0f;
+} // pulseUs()
+
+/**
+ * @brief Write one register, applying the chip's rules.
+ */
+void SimPca9685::store(uint8_t index, uint8_t value)
+{
+  writes++;
+  if (index == PCA9685_PRESCALE && !(regs[PCA9685_MODE1] & MODE1_SLEEP))
+  {
+    return; // Ignored while the oscillator is running.
+  } // if
+  if (index > PCA9685_LED15_OFF_H && index < PCA9685_ALL_LED_ON_L)
+  {
+    return; // Reserved.
+  } // if
+  regs[index] = value;
+  if (index >= PCA9685_ALL_LED_ON_L && index <= PCA9685_ALL_LED_OFF_H)
+  {
+    uint8_t offset = index - PCA9685_ALL_LED_ON_L;
+    for (uint8_t ch = 0; ch < 16; ch++)
+    {
+      regs[PCA9685_LED0_ON_L + 4 * ch + offset] = value;
+    } // for
+  } // if
+} // store()
+
+/**
+ * @brief Move the register pointer after a data byte when AI is on.
+ */
+void SimPca9685::advance()
+{
+  if (!(regs[PCA9685_MODE1] & MODE1_AI))
+  {
+    return;
+  } // if
+  if (pointer == PCA9685_LED15_OFF_H)
+  {
+    pointer = 0x00;
+  } // if
+  else
+  {
+    pointer++;
+  } // else
+} // advance()
@@ -0,0 +1,79 @@
+/**
+ * @file SimPca9685.h
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Behavioural model of the PCA9685 16-channel PWM / servo driver.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details Models what the Lesson 4b and Lesson 12 code relies on:
+ * - The 256 byte register file with the power-on values from the datasheet
+ *   (MODE1 = 0x11 sleeping, sub-addresses E2/E4/E8, all-call E0,
+ *   every LEDn_OFF_H full-off bit set, PRE_SCALE = 0x1E).
+ * - The register pointer: the first byte of a write selects the register.
+ * - Auto-increment (MODE1 bit 5): the pointer advances after each byte and
+ *   rolls over from 0x45 (LED15_OFF_H) to 0x00.
+ * - PRE_SCALE can only be written while MODE1.SLEEP is set.
+ * - ALL_LED_xxx writes go to every channel.
+ */
+#ifndef SIM_PCA9685_H
+#define SIM_PCA9685_H
+
+#include "SimI2cDevice.h"
+
+class SimPca9685 : public SimI2cDevice
+{
+public:
+  explicit SimPca9685(uint8_t address = 0x40);
+
+  bool writeByte(uint8_t value) override;
+  uint8_t readByte() override;
+  void start(bool read) override;
+
+  /**
+   * @brief Put every register back to its power-on value.
+   */
+  void reset();
+
+  /**
+   * @brief Raw register value.
+   */
+  uint8_t reg(uint8_t index) const { return regs[index]; }
+
+  /**
+   * @brief 12-bit ON count of a channel.
+   */
+  uint16_t onCount(uint8_t channel) const;
+
+  /**
+   * @brief 12-bit OFF count of a channel.
+   */
+  uint16_t offCount(uint8_t channel) const;
+
+  /**
+   * @brief PWM output frequency from PRE_SCALE and the oscillator.
+   */
+  float frequencyHz(float oscillatorHz = 25000000.0f) const;
+
+  /**
+   * @brief High time of a channel's pulse in microseconds.
+   */
+  float pulseUs(uint8_t channel, float oscillatorHz = 25000000.0f) const;
+
+  /**
+   * @brief Register bytes written since construction or the last reset().
+   */
+  uint32_t registerWrites() const { return writes; }
+
+private:
+  void store(uint8_t index, uint8_t value);
+  void advance();
+
+  uint8_t regs[256];
+  uint8_t pointer;
+  bool expectPointer; // Next written byte selects the register.
+  uint32_t writes;
+};
+
+#endif // SIM_PCA9685_H
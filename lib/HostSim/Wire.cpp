@@ -0,0 +1,249 @@
+/**
+ * @file Wire.cpp
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Simulated I2C bus. See Wire.h.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ */
+#include "Wire.h"
+
+// Wire.endTransmission() return codes, same as the ESP32 core.
+#define WIRE_OK 0
+#define WIRE_NACK_ADDR 2
+#define WIRE_NACK_DATA 3
+#define WIRE_TIMEOUT 5
+
+TwoWire Wire;
+
+/**
+ * @brief Empty bus at the default 100 kHz.
+ */
+TwoWire::TwoWire()
+    : deviceCount(0), busMode(SIM_BUS_NORMAL), clockHz(100000),
+      timeoutMsSetting(50), txAddress(0), txLength(0), transmitting(false),
+      rxLength(0), rxIndex(0)
+{
+  resetStats();
+} // TwoWire()
+
+void TwoWire::begin()
+{
+  txLength = 0;
+  rxLength = 0;
+  rxIndex = 0;
+} // begin()
+
+bool TwoWire::begin(int sda, int scl, uint32_t frequency)
+{
+  (void)sda;
+  (void)scl;
+  begin();
+  if (frequency != 0)
+  {
+    setClock(frequency);
+  } // if
+  return true;
+} // begin()
+
+void TwoWire::end()
+{
+  transmitting = false;
+} // end()
+
+void TwoWire::setClock(uint32_t frequency)
+{
+  clockHz = frequency > 0 ? frequency : 100000;
+} // setClock()
+
+void TwoWire::beginTransmission(uint8_t address)
+{
+  txAddress = address;
+  txLength = 0;
+  transmitting = true;
+} // beginTransmission()
+
+/**
+ * @brief Put the queued bytes on the bus.
+ */
+uint8_t TwoWire::endTransmission(bool sendStop)
+{
+  transmitting = false;
+  busStats.transactions++;
+  if (busMode == SIM_BUS_STUCK)
+  {
+    return stuckTransfer();
+  } // if
+
+  SimI2cDevice *device = busMode == SIM_BUS_NORMAL ? find(txAddress) : nullptr;
+  if (device == nullptr)
+  {
+    spendBits(1 + 9 + 1); // START, address byte, STOP.
+    busStats.nacks++;
+    return WIRE_NACK_ADDR;
+  } // if
+
+  spendBits(1 + 9); // START + address byte.
+  device->start(false);
+  uint8_t result = WIRE_OK;
+  for (size_t i = 0; i < txLength; i++)
+  {
+    spendBits(9); // The device sees the byte after its 8 bits + ACK slot.
+    if (!device->writeByte(txBuffer[i]))
+    {
+      result = WIRE_NACK_DATA;
+      busStats.nacks++;
+      break;
+    } // if
+  } // for
+  if (sendStop || result != WIRE_OK)
+  {
+    spendBits(1); // STOP.
+    device->stop();
+  } // if
+  return result;
+} // endTransmission()
+
+/**
+ * @brief Read bytes from a device into the receive buffer.
+ * @return Number of bytes received (0 on NACK or timeout).
+ */
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity, bool sendStop)
+{
+  rxLength = 0;
+  rxIndex = 0;
+  busStats.transactions++;
+  if (busMode == SIM_BUS_STUCK)
+  {
+    stuckTransfer();
+    return 0;
+  } // if
+
+  SimI2cDevice *device = busMode == SIM_BUS_NORMAL ? find(address) : nullptr;
+  if (device == nullptr)
+  {
+    spendBits(1 + 9 + 1);
+    busStats.nacks++;
+    return 0;
+  } // if
+
+  if (quantity > I2C_BUFFER_LENGTH)
+  {
+    quantity = I2C_BUFFER_LENGTH;
+  } // if
+  spendBits(1 + 9);
+  device->start(true);
+  for (uint8_t i = 0; i < quantity; i++)
+  {
+    spendBits(9);
+    rxBuffer[rxLength++] = device->readByte();
+  } // for
+  if (sendStop)
+  {
+    spendBits(1);
+    device->stop();
+  } // if
+  return quantity;
+} // requestFrom()
+
+size_t TwoWire::write(uint8_t value)
+{
+  if (!transmitting || txLength >= I2C_BUFFER_LENGTH)
+  {
+    return 0;
+  } // if
+  txBuffer[txLength++] = value;
+  return 1;
+} // write()
+
+size_t TwoWire::write(const uint8_t *data, size_t length)
+{
+  size_t n = 0;
+  while (n < length && write(data[n]))
+  {
+    n++;
+  } // while
+  return n;
+} // write()
+
+int TwoWire::available()
+{
+  return (int)(rxLength - rxIndex);
+} // available()
+
+int TwoWire::read()
+{
+  return rxIndex < rxLength ? rxBuffer[rxIndex++] : -1;
+} // read()
+
+int TwoWire::peek()
+{
+  return rxIndex < rxLength ? rxBuffer[rxIndex] : -1;
+} // peek()
+
+/**
+ * @brief Connect a device model to the bus.
+ */
+void TwoWire::attach(SimI2cDevice &device)
+{
+  if (deviceCount < SIM_I2C_MAX_DEVICES && find(device.getAddress()) == nullptr)
+  {
+    devices[deviceCount++] = &device;
+  } // if
+} // attach()
+
+/**
+ * @brief Disconnect a device model (hot-unplug).
+ */
+void TwoWire::detach(SimI2cDevice &device)
+{
+  for (uint8_t i = 0; i < deviceCount; i++)
+  {
+    if (devices[i] == &device)
+    {
+      devices[i] = devices[--deviceCount];
+      return;
+    } // if
+  } // for
+} // detach()
+
+void TwoWire::resetStats()
+{
+  memset(&busStats, 0, sizeof(busStats));
+} // resetStats()
+
+SimI2cDevice *TwoWire::find(uint8_t address)
+{
+  for (uint8_t i = 0; i < deviceCount; i++)
+  {
+    if (devices[i]->getAddress() == address)
+    {
+      return devices[i];
+    } // if
+  } // for
+  return nullptr;
+} // find()
+
+/**
+ * @brief Account for bus clocks: 1 for START or STOP, 9 per byte (8 + ACK).
+ */
+void TwoWire::spendBits(uint32_t bits)
+{
+  uint64_t ns = (uint64_t)bits * 1000000000ULL / clockHz;
+  busStats.bytes += bits / 9;
+  busStats.busTimeNs += ns;
+  SimClock::advanceNs(ns);
+} // spendBits()
+
+/**
+ * @brief A transfer on a bus with SDA held low waits for the full timeout.
+ */
+uint8_t TwoWire::stuckTransfer()
+{
+  uint64_t ns = (uint64_t)timeoutMsSetting * 1000000ULL;
+  busStats.timeouts++;
+  busStats.busTimeNs += ns;
+  SimClock::advanceNs(ns);
+  return WIRE_TIMEOUT;
+} // stuckTransfer()
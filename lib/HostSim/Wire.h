@@ -0,0 +1,114 @@
+/**
+ * @file Wire.h
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Simulated I2C bus with the same interface as the Arduino Wire library.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details
+ * Drivers written against TwoWire (BufferedLcd, I2cScheduler, the Lesson 12
+ * sketches) compile unchanged against this class on Linux. Instead of driving
+ * pins it hands every byte to the SimI2cDevice models attached to the bus and
+ * keeps statistics:
+ * - transactions: one per endTransmission() or requestFrom().
+ * - bytes: address and data bytes put on the bus.
+ * - bus time: START + 9 clocks per byte (8 bits + ACK) + STOP at the
+ *   configured clock rate. The virtual clock (SimClock.h) is moved forward by
+ *   the same amount, so micros() around a driver call shows the bus time the
+ *   call would take on the board.
+ *
+ * The bus can also be put in EMPTY mode (every address NACKs) or STUCK mode
+ * (SDA held low: every transfer fails with a timeout after the configured
+ * timeout has passed).
+ */
+#ifndef HOST_SIM_WIRE_H
+#define HOST_SIM_WIRE_H
+
+#include "Arduino.h"
+#include "SimI2cDevice.h"
+
+#define I2C_BUFFER_LENGTH 128
+#define SIM_I2C_MAX_DEVICES 16
+
+/**
+ * @brief Fault modes for the simulated bus.
+ */
+enum SimBusMode : uint8_t
+{
+  SIM_BUS_NORMAL = 0, // Attached devices answer.
+  SIM_BUS_EMPTY = 1,  // Nothing answers, as if no device was connected.
+  SIM_BUS_STUCK = 2   // SDA held low, every transfer times out.
+};
+
+/**
+ * @brief Bus usage counters.
+ */
+struct SimBusStats
+{
+  uint32_t transactions; // Transfers started (write or read).
+  uint32_t nacks;        // Transfers that ended with a NACK.
+  uint32_t timeouts;     // Transfers that failed on a stuck bus.
+  uint32_t bytes;        // Address + data bytes on the bus.
+  uint64_t busTimeNs;    // Time the bus was busy.
+};
+
+class TwoWire : public Stream
+{
+public:
+  TwoWire();
+
+  // Arduino Wire interface.
+  void begin();
+  bool begin(int sda, int scl, uint32_t frequency = 0);
+  void end();
+  void setClock(uint32_t frequency);
+  uint32_t getClock() const { return clockHz; }
+  void setTimeOut(uint16_t timeoutMs) { timeoutMsSetting = timeoutMs; }
+  uint16_t getTimeOut() const { return timeoutMsSetting; }
+  void beginTransmission(uint8_t address);
+  void beginTransmission(int address) { beginTransmission((uint8_t)address); }
+  uint8_t endTransmission(bool sendStop = true);
+  uint8_t requestFrom(uint8_t address, uint8_t quantity, bool sendStop = true);
+  uint8_t requestFrom(int address, int quantity) { return requestFrom((uint8_t)address, (uint8_t)quantity); }
+  size_t write(uint8_t value) override;
+  size_t write(const uint8_t *data, size_t length) override;
+  using Print::write;
+  int available() override;
+  int read() override;
+  int peek() override;
+
+  // Simulation control.
+  void attach(SimI2cDevice &device);
+  void detach(SimI2cDevice &device);
+  void setMode(SimBusMode mode) { busMode = mode; }
+  SimBusMode mode() const { return busMode; }
+  const SimBusStats &stats() const { return busStats; }
+  void resetStats();
+
+private:
+  SimI2cDevice *find(uint8_t address);
+  void spendBits(uint32_t bits);
+  uint8_t stuckTransfer();
+
+  SimI2cDevice *devices[SIM_I2C_MAX_DEVICES];
+  uint8_t deviceCount;
+  SimBusMode busMode;
+  uint32_t clockHz;
+  uint16_t timeoutMsSetting;
+  SimBusStats busStats;
+
+  uint8_t txAddress;
+  uint8_t txBuffer[I2C_BUFFER_LENGTH];
+  size_t txLength;
+  bool transmitting;
+
+  uint8_t rxBuffer[I2C_BUFFER_LENGTH];
+  size_t rxLength;
+  size_t rxIndex;
+};
+
+extern TwoWire Wire;
+
+#endif // HOST_SIM_WIRE_H
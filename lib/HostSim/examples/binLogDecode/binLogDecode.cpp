@@ -0,0 +1,57 @@
+/**
+ * @file binLogDecode.cpp
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Turn a captured BinLog serial stream back into text (Linux).
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details Reads the bytes a sketch sent with BinLog::drain() from a file or
+ * standard input and prints them as text. Ordinary Serial.print() output in
+ * the same stream is printed as it is. The string table comes from the
+ * logMessages.h the build finds first on its include path, so build it with
+ * the sketch's folder on that path (see native-reference-platformio.ini).
+ *
+ *   binLogDecode capture.bin
+ *   stty -F /dev/ttyACM0 115200 raw && binLogDecode < /dev/ttyACM0
+ *
+ * A summary goes to standard error at the end. Returns 1 if any frame was
+ * damaged, which usually means the baud rate is wrong or bytes were lost.
+ */
+#include <Arduino.h>
+#include <BinLog.h>
+#include <logMessages.h>
+
+static const char *const logFormats[] = {LOG_MESSAGES(BINLOG_FORMAT)};
+
+int main(int argc, char **argv)
+{
+  FILE *in = stdin;
+  if (argc > 1)
+  {
+    in = fopen(argv[1], "rb");
+    if (in == nullptr)
+    {
+      fprintf(stderr, "Cannot open %s\n", argv[1]);
+      return 1;
+    } // if
+  } // if
+
+  BinLogDecoder decoder(logFormats, LOG_MESSAGE_COUNT);
+  int value;
+  while ((value = fgetc(in)) != EOF)
+  {
+    decoder.feed((uint8_t)value, Serial);
+  } // while
+  Serial.flush();
+
+  fprintf(stderr, "%u frames, %u damaged, %u messages dropped on the board.\n",
+          (unsigned)decoder.frames, (unsigned)decoder.badFrames,
+          (unsigned)decoder.dropped);
+  if (in != stdin)
+  {
+    fclose(in);
+  } // if
+  return decoder.badFrames == 0 ? 0 : 1;
+} // main()
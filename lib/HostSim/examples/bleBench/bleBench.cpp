@@ -0,0 +1,490 @@
+/**
+ * @file bleBench.cpp
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Benchmark and check the RobotLink protocol over a simulated BLE
+ * link (Linux).
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details Runs the Lesson 6 protocol code, RobotClient on one end and
+ * RobotServer on the other, over SimBleLink on the virtual clock:
+ * 1. The setpoint stream and packed telemetry at three connection intervals
+ *    and three loss rates. Prints the achieved message rate, round trip
+ *    percentiles and what the link had to resend.
+ * 2. Packed against per-field telemetry at the shortest interval.
+ * 3. A link loss followed by a reconnect, timed from the loss to the first
+ *    acknowledged setpoint.
+ * 4. Clock sync against a server clock that is offset and drifting, with the
+ *    interval-aware estimate and the plain NTP midpoint, and the one-way
+ *    times the synced clock gives.
+ * 5. A robot that drives, parks and drives again with the client's idle
+ *    policy: how often the server's radio wakes in each phase and how long
+ *    the first setpoint after parking takes.
+ * It also checks what the protocol promises (no frame lost by the link, every
+ * write answered, telemetry keeping up, a clean restart after reconnecting,
+ * the clock within a fraction of a millisecond, an idle link that really
+ * sleeps and wakes within its latency) and returns 1 if anything is wrong,
+ * so it can be used to catch regressions.
+ */
+#include <Arduino.h>
+#include <SimBleLink.h>
+#include <RobotClient.h>
+#include <RobotServer.h>
+
+// What the ESP32 client sketch does by default.
+#define STREAM_RATE_HZ 200
+#define TELEMETRY_RATE_HZ 50
+#define TELEMETRY_HOLD_MS 100
+#define MOTOR_PWM_HZ 100
+
+// Simulated time per scenario and per loop() pass.
+#define RUN_SECONDS 10
+#define STEP_US 50
+
+// Time sync pings, as in the client sketch.
+#define TIME_SYNC_MS 100
+#define TIME_SYNC_IDLE_MS 1000
+
+// The client sketch's idle link: 100 ms interval, slave latency 2, slow
+// telemetry.
+#define IDLE_INTERVAL_US 100000
+#define IDLE_SLAVE_LATENCY 2
+#define TELEMETRY_IDLE_RATE_HZ 5
+#define TELEMETRY_IDLE_HOLD_MS 1000
+
+// The server board's clock: started earlier and running fast.
+#define SERVER_CLOCK_OFFSET_US 12345678UL
+#define SERVER_CLOCK_DRIFT_PPM 150
+
+static int failures = 0;
+
+/**
+ * @brief micros() on the server board.
+ */
+static unsigned long serverMicros()
+{
+  double clientUs = SimClock::nowNs() / 1000.0;
+  return (unsigned long)(uint64_t)(clientUs * (1.0 + SERVER_CLOCK_DRIFT_PPM / 1e6)) +
+         SERVER_CLOCK_OFFSET_US;
+} // serverMicros()
+
+/**
+ * @brief A client and a server joined by one simulated link.
+ */
+struct Bench
+{
+  SimBleLink link;
+  RobotServer server;
+  RobotClient client;
+  uint8_t telemetryMode;
+  unsigned long lastProduceUs;
+  unsigned long linkUpUs;   // When the link last came up, 0 = down.
+  unsigned long lastSyncUs;
+  bool syncWithInterval;    // false: the clock uses the NTP midpoint.
+  RobotSetpoint joystick;   // What the client produces.
+  bool adaptive;            // Follow the client sketch's idle policy.
+  LinkActivity activity;
+  uint32_t activeIntervalUs;
+
+  Bench(const SimBleSettings &settings, uint8_t telemetryMode)
+      : link(settings), server(link.peripheral(), MOTOR_PWM_HZ),
+        client(link.central()), telemetryMode(telemetryMode),
+        lastProduceUs(0), linkUpUs(0), lastSyncUs(0), syncWithInterval(true),
+        joystick{0, 0, 0, 300, 150, 150, ROBOT_FLAG_LED}, adaptive(false),
+        activeIntervalUs(settings.intervalUs)
+  {
+    server.setClock(serverMicros);
+    link.setPeripheralReceiver(toServer, this);
+    link.setCentralReceiver(toClient, this);
+    link.setLinkHandler(onLink, this);
+  } // Bench()
+
+  static void toServer(void *context, uint8_t channel, const uint8_t *data,
+                       size_t length)
+  {
+    static_cast<Bench *>(context)->server.onMessage(channel, data, length);
+  } // toServer()
+
+  static void toClient(void *context, uint8_t channel, const uint8_t *data,
+                       size_t length)
+  {
+    static_cast<Bench *>(context)->client.onMessage(channel, data, length);
+  } // toClient()
+
+  /**
+   * @brief What the two sketches do when the link comes up or goes down.
+   */
+  static void onLink(void *context, bool connected)
+  {
+    Bench &bench = *static_cast<Bench *>(context);
+    if (!connected)
+    {
+      bench.server.onDisconnect();
+      bench.linkUpUs = 0;
+      return;
+    } // if
+    bench.server.onConnect();
+    bench.client.startStream();
+    bench.client.resetTelemetry();
+    bench.client.resetTimeSync();
+    bench.activity.reset(millis());
+    bench.client.sendTelemetryConfig(TELEMETRY_RATE_HZ, TELEMETRY_HOLD_MS,
+                                     bench.telemetryMode);
+    bench.linkUpUs = micros();
+  } // onLink()
+
+  /**
+   * @brief What the client sketch does when a link goes idle or wakes up.
+   */
+  void setIdle(bool idle)
+  {
+    link.updateParams(idle ? IDLE_INTERVAL_US : activeIntervalUs,
+                      idle ? IDLE_SLAVE_LATENCY : 0);
+    client.sendTelemetryConfig(idle ? TELEMETRY_IDLE_RATE_HZ : TELEMETRY_RATE_HZ,
+                               idle ? TELEMETRY_IDLE_HOLD_MS : TELEMETRY_HOLD_MS,
+                               telemetryMode);
+  } // setIdle()
+
+  /**
+   * @brief One pass of both loop()s, then STEP_US of simulated time.
+   */
+  void step()
+  {
+    link.poll();
+    server.poll();
+    if (linkUpUs != 0)
+    {
+      unsigned long now = micros();
+      if (now - lastProduceUs >= 1000000UL / STREAM_RATE_HZ)
+      {
+        lastProduceUs = now;
+        RobotSetpoint sp = joystick;
+        sp.sentUs = now;
+        if (adaptive && activity.noteSetpoint(sp, millis()))
+        {
+          setIdle(false);
+        } // if
+        if (!adaptive || !activity.idle())
+        {
+          client.queueSetpoint(sp);
+        } // if
+      } // if
+      if (adaptive && activity.poll(millis()))
+      {
+        setIdle(true);
+      } // if
+      client.sendSetpoints(link.intervalUs());
+      client.processAcks();
+      client.processTelemetry();
+      client.processTimeSync(syncWithInterval ? link.intervalUs() : 0);
+      uint32_t syncMs = adaptive && activity.idle() ? TIME_SYNC_IDLE_MS : TIME_SYNC_MS;
+      if (now - lastSyncUs >= syncMs * 1000UL)
+      {
+        lastSyncUs = now;
+        client.sendTimeSync();
+      } // if
+    } // if
+    SimClock::advanceNs(STEP_US * 1000ULL);
+  } // step()
+
+  void run(uint32_t seconds)
+  {
+    uint64_t end = SimClock::nowNs() + seconds * 1000000000ULL;
+    while (SimClock::nowNs() < end)
+    {
+      step();
+    } // while
+  } // run()
+};
+
+static SimBleSettings settingsFor(uint32_t intervalUs, uint16_t lossPerMille)
+{
+  SimBleSettings settings;
+  settings.intervalUs = intervalUs;
+  settings.latencyUs = 400;
+  settings.lossPerMille = lossPerMille;
+  settings.packetsPerEvent = 4;
+  settings.mtu = 247;
+  settings.advertisingUs = 100000; // The server advertises every 100 ms.
+  settings.peripheralLatency = 0;
+  return settings;
+} // settingsFor()
+
+/**
+ * @brief Record a failed check.
+ */
+static void check(bool ok, const char *what)
+{
+  if (!ok)
+  {
+    printf("  FAIL: %s\n", what);
+    failures++;
+  } // if
+} // check()
+
+/**
+ * @brief Round trip percentile for a table cell. The histogram stops at
+ * ROBOT_LATENCY_BUCKETS buckets, anything above that only has a maximum.
+ */
+static const char *rttCell(const LatencyHistogram &rtt, uint8_t percent)
+{
+  static char cells[2][12];
+  static uint8_t next = 0;
+  char *cell = cells[next++ % 2];
+  uint32_t us = rtt.percentileUs(percent);
+  if (us >= ROBOT_LATENCY_BUCKETS * ROBOT_LATENCY_BUCKET_US)
+  {
+    snprintf(cell, sizeof(cells[0]), ">%u", ROBOT_LATENCY_BUCKETS * ROBOT_LATENCY_BUCKET_US);
+  }
+  else
+  {
+    snprintf(cell, sizeof(cells[0]), "%u", (unsigned)us);
+  } // else
+  return cell;
+} // rttCell()
+
+/**
+ * @brief Stream and telemetry at one interval and loss rate.
+ */
+static void benchStream(uint32_t intervalUs, uint16_t lossPerMille)
+{
+  Bench bench(settingsFor(intervalUs, lossPerMille), ROBOT_TELEMETRY_MODE_PACKED);
+  bench.link.connect();
+  bench.run(1); // Connect and settle.
+  bench.client.framesSent = 0;
+  bench.client.writesSent = 0;
+  bench.client.streamLatency.reset();
+  bench.client.telemetrySamples = 0;
+  bench.server.streamSeq.received = 0;
+  bench.server.streamSeq.lost = 0;
+  bench.server.streamWrites = 0;
+  bench.server.telemetryStats = {0, 0, 0, 0};
+  bench.link.resetStats();
+
+  bench.run(RUN_SECONDS);
+  const LatencyHistogram &rtt = bench.client.streamLatency;
+  printf("  %5.1f ms %3u%% %8.1f %8.1f %7s %7s %8u %7u %6u %7.1f\n",
+         intervalUs / 1000.0, lossPerMille / 10,
+         bench.client.framesSent / (float)RUN_SECONDS,
+         bench.client.writesSent / (float)RUN_SECONDS,
+         rttCell(rtt, 50), rttCell(rtt, 99), (unsigned)rtt.maxUs(),
+         (unsigned)bench.client.setpointQueue.dropped(),
+         (unsigned)bench.link.stats().retransmitted,
+         bench.client.telemetrySamples / (float)RUN_SECONDS);
+
+  // A write is never lost on a BLE link, only delayed, and only the newest
+  // setpoint is acknowledged. Allow for what is still in flight.
+  uint32_t inFlight = 2 + (ROBOT_SETPOINT_QUEUE_DEPTH + 4) * STREAM_RATE_HZ * intervalUs / 1000000;
+  check(bench.server.streamWrites + 2 >= bench.client.writesSent,
+        "setpoint writes lost by the link");
+  check(bench.server.streamSeq.received + inFlight >= bench.client.framesSent,
+        "setpoint frames lost by the link");
+  check(rtt.count() + 2 >= bench.server.streamWrites, "writes not acknowledged");
+  check(bench.client.telemetrySamples + TELEMETRY_RATE_HZ / 5 >= bench.server.telemetryStats.samples,
+        "telemetry samples lost");
+  if (lossPerMille == 0)
+  {
+    // Produced, wait for the next send slot and connection event, one trip
+    // each way and the stack latency at both ends.
+    uint32_t limit = 3 * intervalUs + 1000000 / STREAM_RATE_HZ + 2 * 400 + 2 * STEP_US;
+    check(rtt.percentileUs(99) <= limit, "round trip above three connection intervals");
+  } // if
+} // benchStream()
+
+/**
+ * @brief Packed against per-field telemetry at the shortest interval.
+ */
+static void benchTelemetryModes()
+{
+  static const uint8_t modes[] = {ROBOT_TELEMETRY_MODE_PACKED, ROBOT_TELEMETRY_MODE_FIELDS};
+  printf("Telemetry at %d samples/s, 7.5 ms interval, no loss:\n", TELEMETRY_RATE_HZ);
+  printf("  mode    samples/s notifs/s  bytes/s refused\n");
+  for (uint8_t mode : modes)
+  {
+    Bench bench(settingsFor(7500, 0), mode);
+    bench.link.connect();
+    bench.run(1);
+    bench.client.telemetrySamples = 0;
+    bench.client.telemetryNotifications = 0;
+    bench.client.telemetryBytes = 0;
+    bench.link.resetStats();
+    bench.run(RUN_SECONDS);
+    printf("  %-7s %9.1f %9.1f %8.1f %7u\n",
+           mode == ROBOT_TELEMETRY_MODE_FIELDS ? "fields" : "packed",
+           bench.client.telemetrySamples / (float)RUN_SECONDS,
+           bench.client.telemetryNotifications.load() / (float)RUN_SECONDS,
+           bench.client.telemetryBytes.load() / (float)RUN_SECONDS,
+           (unsigned)bench.link.stats().refused);
+    check(bench.client.telemetrySamples >= (TELEMETRY_RATE_HZ - 1) * RUN_SECONDS,
+          "telemetry rate not reached");
+  } // for
+} // benchTelemetryModes()
+
+/**
+ * @brief Lose the link mid-stream and time the way back to an acknowledged
+ * setpoint.
+ */
+static void benchReconnect()
+{
+  printf("Reconnect, 7.5 ms interval, 100 ms advertising:\n");
+  Bench bench(settingsFor(7500, 0), ROBOT_TELEMETRY_MODE_PACKED);
+  bench.link.connect();
+  bench.run(2);
+  uint32_t acksBefore = bench.client.streamLatency.count();
+
+  bench.link.drop();
+  unsigned long lostUs = micros();
+  bench.client.streamLatency.reset();
+  bench.link.connect();
+  while (bench.client.streamLatency.count() == 0 && micros() - lostUs < 2000000UL)
+  {
+    bench.step();
+  } // while
+  unsigned long firstAckUs = micros() - lostUs;
+  printf("  link loss to first acknowledged setpoint: %.1f ms\n", firstAckUs / 1000.0);
+
+  bench.run(2);
+  printf("  after reconnect: frames=%u lost=%u late=%u telemetry samples=%u\n",
+         (unsigned)bench.server.streamSeq.received, (unsigned)bench.server.streamSeq.lost,
+         (unsigned)bench.server.streamSeq.late, (unsigned)bench.client.telemetrySamples);
+  check(acksBefore > 0, "no acknowledgements before the link loss");
+  check(bench.client.streamLatency.count() > 0, "no acknowledgement after reconnecting");
+  check(firstAckUs <= 100000UL + 4 * 7500UL + 2 * 1000000UL / STREAM_RATE_HZ,
+        "reconnect slower than one advertising interval and a few events");
+  check(bench.server.streamSeq.lost == 0 && bench.server.streamSeq.late == 0,
+        "sequence not restarted cleanly after reconnecting");
+  check(bench.client.telemetrySamples > 0, "telemetry did not resume");
+} // benchReconnect()
+
+/**
+ * @brief Follow the server's clock with one estimator and print how close it
+ * got.
+ * @param intervalAware false for the plain NTP midpoint.
+ */
+static void benchClockSync(uint32_t intervalUs, uint16_t lossPerMille,
+                           bool intervalAware)
+{
+  Bench bench(settingsFor(intervalUs, lossPerMille), ROBOT_TELEMETRY_MODE_PACKED);
+  bench.syncWithInterval = intervalAware;
+  bench.link.connect();
+  bench.run(RUN_SECONDS);
+  bench.client.uplinkLatency.reset();
+  bench.client.downlinkLatency.reset();
+  bench.client.telemetryAge.reset();
+  bench.run(RUN_SECONDS);
+
+  const ClockSync &clock = bench.client.clock;
+  int32_t errorUs = (int32_t)(clock.toServerUs(micros()) - serverMicros());
+  printf("  %5.1f ms %3u%% %-9s %9ld %9.1f %6u %6u %6u %6u\n",
+         intervalUs / 1000.0, lossPerMille / 10,
+         intervalAware ? "interval" : "midpoint", (long)errorUs,
+         clock.driftPpm(),
+         (unsigned)bench.client.uplinkLatency.percentileUs(50),
+         (unsigned)bench.client.downlinkLatency.percentileUs(50),
+         (unsigned)bench.client.streamLatency.percentileUs(50),
+         (unsigned)bench.client.telemetryAge.percentileUs(50));
+
+  check(clock.valid(), "clock never came into sync");
+  if (intervalAware)
+  {
+    check(errorUs > -200 && errorUs < 200, "clock offset off by 200 us or more");
+    check(clock.driftPpm() > SERVER_CLOCK_DRIFT_PPM - 20 &&
+              clock.driftPpm() < SERVER_CLOCK_DRIFT_PPM + 20,
+          "clock drift off by 20 ppm or more");
+  } // if
+} // benchClockSync()
+
+/**
+ * @brief Drive, park long enough for the link to go idle, then drive again.
+ */
+static void benchIdle()
+{
+  printf("Idle link, %.1f ms interval driving, %.0f ms with slave latency %d parked:\n",
+         7.5, IDLE_INTERVAL_US / 1000.0, IDLE_SLAVE_LATENCY);
+  Bench bench(settingsFor(7500, 0), ROBOT_TELEMETRY_MODE_PACKED);
+  bench.adaptive = true;
+  bench.link.connect();
+  bench.run(1);
+  bench.link.resetStats();
+  bench.run(2);
+  float drivingAwake = bench.link.stats().peripheralAwake / 2.0f;
+
+  bench.joystick = {0, 0, 0, 0, 0, 0, 0}; // Park.
+  unsigned long parkedMs = millis();
+  while (!bench.activity.idle() && millis() - parkedMs < 2 * ROBOT_IDLE_AFTER_MS)
+  {
+    bench.step();
+  } // while
+  unsigned long idleAfterMs = millis() - parkedMs;
+  bench.run(1); // Let the update reach its instant.
+  bench.link.resetStats();
+  bench.client.telemetryNotifications = 0;
+  bench.run(RUN_SECONDS);
+  float parkedAwake = bench.link.stats().peripheralAwake / (float)RUN_SECONDS;
+  bool stale = bench.client.latestTelemetry.errors & ROBOT_ERR_SETPOINT_STALE;
+  printf("  server radio awake events/s: driving %.1f, parked %.1f (idle after %lu ms)\n",
+         drivingAwake, parkedAwake, idleAfterMs);
+  printf("  parked: telemetry notifications/s %.1f, interval %.1f ms latency %u\n",
+         bench.client.telemetryNotifications.load() / (float)RUN_SECONDS,
+         bench.link.intervalUs() / 1000.0, (unsigned)bench.link.peripheralLatency());
+
+  bench.joystick = {0, 0, 0, 300, 150, 150, ROBOT_FLAG_LED}; // Drive again.
+  bench.client.streamLatency.reset();
+  unsigned long wakeUs = micros();
+  while (bench.client.streamLatency.count() == 0 && micros() - wakeUs < 2000000UL)
+  {
+    bench.step();
+  } // while
+  unsigned long firstAckUs = micros() - wakeUs;
+  while (bench.link.intervalUs() != 7500 && micros() - wakeUs < 4000000UL)
+  {
+    bench.step();
+  } // while
+  unsigned long restoredUs = micros() - wakeUs;
+  printf("  first setpoint after parking acknowledged in %.1f ms, 7.5 ms interval back after %.1f ms\n",
+         firstAckUs / 1000.0, restoredUs / 1000.0);
+
+  check(idleAfterMs <= ROBOT_IDLE_AFTER_MS + 10, "link did not go idle after parking");
+  check(parkedAwake * 20 < drivingAwake, "parked server radio not 20 times quieter");
+  check(!stale, "parked robot reported stale setpoints");
+  check(firstAckUs <= (IDLE_SLAVE_LATENCY + 2) * IDLE_INTERVAL_US + 2000,
+        "first setpoint after parking slower than the slave latency allows");
+  check(bench.link.intervalUs() == 7500, "interval not restored after waking");
+} // benchIdle()
+
+int main()
+{
+  static const uint32_t intervals[] = {7500, 15000, 30000};
+  static const uint16_t losses[] = {0, 50, 200};
+  printf("Setpoint stream at %d/s, telemetry at %d/s, MTU 247, %d s each:\n",
+         STREAM_RATE_HZ, TELEMETRY_RATE_HZ, RUN_SECONDS);
+  printf("  interval loss   msgs/s writes/s  round trip us p50/p99/max dropped resent telem/s\n");
+  for (uint32_t interval : intervals)
+  {
+    for (uint16_t loss : losses)
+    {
+      benchStream(interval, loss);
+    } // for
+  } // for
+  benchTelemetryModes();
+  benchReconnect();
+  printf("Clock sync, server %lu us ahead and %d ppm fast, ping every %d ms, %d s:\n",
+         SERVER_CLOCK_OFFSET_US, SERVER_CLOCK_DRIFT_PPM, TIME_SYNC_MS, RUN_SECONDS);
+  printf("  interval loss estimator  error us drift ppm  up p50 down p50 rtt p50 telem age p50\n");
+  static const uint32_t syncIntervals[] = {7500, 30000};
+  static const uint16_t syncLosses[] = {0, 50};
+  for (uint32_t interval : syncIntervals)
+  {
+    for (uint16_t loss : syncLosses)
+    {
+      benchClockSync(interval, loss, true);
+      benchClockSync(interval, loss, false);
+    } // for
+  } // for
+  benchIdle();
+  printf(failures == 0 ? "All checks passed.\n" : "%d check(s) failed.\n",
+         failures);
+  return failures == 0 ? 0 : 1;
+} // main()
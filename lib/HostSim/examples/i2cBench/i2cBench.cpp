@@ -0,0 +1,296 @@
+/**
+ * @file i2cBench.cpp
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Benchmark and check the I2C drivers on the simulated bus (Linux).
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details Runs the same work three ways on the simulated bus and prints the
+ * transactions, bytes and bus time each one needed:
+ * 1. A status display updated 50 times, the LiquidCrystal_I2C way (one I2C
+ *    transaction per PCF8574 port change) and with BufferedLcd.
+ * 2. A 16 channel servo frame, one setPWM() per channel (Adafruit library)
+ *    and as auto-increment bursts.
+ * 3. A full address scan on an empty bus and on a stuck bus, at the old and
+ *    new scanner settings.
+ * It also checks the results against the device models (LCD text, timing
+ * violations, PCA9685 registers) and returns 1 if anything is wrong, so it
+ * can be used to catch regressions.
+ */
+#include <Arduino.h>
+#include <Wire.h>
+#include <SimLcd.h>
+#include <SimPca9685.h>
+#include <BufferedLcd.h>
+
+#define LCD_ADDRESS 0x3F
+#define PCA9685_ADDRESS 0x40
+#define UPDATES 50
+
+#define LCD_RS 0x01
+#define LCD_EN 0x04
+#define LCD_BACKLIGHT 0x08
+
+static int failures = 0;
+
+/**
+ * @brief Same bus traffic as LiquidCrystal_I2C: every port change is its own
+ * transaction, with the library's delays after each EN pulse.
+ */
+class NaiveLcd : public Print
+{
+public:
+  explicit NaiveLcd(uint8_t address) : address(address) {}
+
+  void setCursor(uint8_t col, uint8_t row)
+  {
+    static const uint8_t offsets[2] = {0x00, 0x40};
+    send(0x80 | (offsets[row] + col), 0);
+  } // setCursor()
+
+  size_t write(uint8_t value) override
+  {
+    send(value, LCD_RS);
+    return 1;
+  } // write()
+
+private:
+  void send(uint8_t value, uint8_t mode)
+  {
+    write4bits((value & 0xF0) | mode);
+    write4bits(((value << 4) & 0xF0) | mode);
+  } // send()
+
+  void write4bits(uint8_t value)
+  {
+    expanderWrite(value);
+    expanderWrite(value | LCD_EN);
+    delayMicroseconds(1);
+    expanderWrite(value & ~LCD_EN);
+    delayMicroseconds(50);
+  } // write4bits()
+
+  void expanderWrite(uint8_t value)
+  {
+    Wire.beginTransmission(address);
+    Wire.write(value | LCD_BACKLIGHT);
+    Wire.endTransmission();
+  } // expanderWrite()
+
+  uint8_t address;
+};
+
+/**
+ * @brief Print one result line.
+ */
+static void report(const char *name, unsigned long elapsedUs)
+{
+  const SimBusStats &s = Wire.stats();
+  printf("  %-34s %6u txns %7u bytes %9.1f us bus %9lu us total\n", name,
+         (unsigned)s.transactions, (unsigned)s.bytes, s.busTimeNs / 1000.0,
+         elapsedUs);
+} // report()
+
+/**
+ * @brief Record a failed check.
+ */
+static void check(bool ok, const char *what)
+{
+  if (!ok)
+  {
+    printf("  FAIL: %s\n", what);
+    failures++;
+  } // if
+} // check()
+
+/**
+ * @brief Status display benchmark.
+ */
+static void benchLcd()
+{
+  printf("Status display, %d updates at 100 kHz:\n", UPDATES);
+  Wire.begin(23, 22, 100000); // The PCF8574 backpack's rating.
+
+  // LiquidCrystal_I2C style.
+  {
+    SimLcd model(LCD_ADDRESS);
+    Wire.attach(model);
+    BufferedLcd init(LCD_ADDRESS, 16, 2); // Same init sequence for both.
+    init.begin();
+    NaiveLcd lcd(LCD_ADDRESS);
+    lcd.setCursor(0, 0);
+    lcd.print("Uptime:");
+    lcd.setCursor(0, 1);
+    lcd.print("Loops:");
+    Wire.resetStats();
+    unsigned long start = micros();
+    for (int i = 0; i < UPDATES; i++)
+    {
+      lcd.setCursor(8, 0);
+      lcd.print(i / 10.0, 1);
+      lcd.print("s");
+      lcd.setCursor(7, 1);
+      lcd.print(1000L + i * 37L);
+    } // for
+    report("LiquidCrystal_I2C style", micros() - start);
+    check(model.timingViolations() == 0, "naive LCD timing violations");
+    Wire.detach(model);
+  }
+
+  // BufferedLcd.
+  {
+    SimLcd model(LCD_ADDRESS);
+    Wire.attach(model);
+    BufferedLcd lcd(LCD_ADDRESS, 16, 2);
+    lcd.begin();
+    lcd.setCursor(0, 0);
+    lcd.print("Uptime:");
+    lcd.setCursor(0, 1);
+    lcd.print("Loops:");
+    lcd.refresh();
+    Wire.resetStats();
+    unsigned long start = micros();
+    for (int i = 0; i < UPDATES; i++)
+    {
+      lcd.setCursor(8, 0);
+      lcd.print(i / 10.0, 1);
+      lcd.print("s");
+      lcd.setCursor(7, 1);
+      lcd.print(1000L + i * 37L);
+      lcd.refresh();
+    } // for
+    report("BufferedLcd", micros() - start);
+    check(strcmp(model.row(0), "Uptime: 4.9s    ") == 0, "BufferedLcd row 0 text");
+    check(strcmp(model.row(1), "Loops: 2813     ") == 0, "BufferedLcd row 1 text");
+    check(model.timingViolations() == 0, "BufferedLcd timing violations");
+    Wire.detach(model);
+  }
+} // benchLcd()
+
+/**
+ * @brief Servo frame benchmark.
+ */
+static void benchServo()
+{
+  printf("16 channel servo frame, %d frames at 400 kHz:\n", UPDATES);
+  Wire.setClock(400000); // The PCA9685 alone on the bus.
+  SimPca9685 model(PCA9685_ADDRESS);
+  Wire.attach(model);
+
+  // Wake up with auto-increment, as Adafruit setPWMFreq() leaves it.
+  uint8_t mode1[2] = {0x00, 0x20};
+  Wire.beginTransmission(PCA9685_ADDRESS);
+  Wire.write(mode1, 2);
+  Wire.endTransmission();
+
+  // One transaction per channel, like Adafruit_PWMServoDriver::setPWM().
+  Wire.resetStats();
+  unsigned long start = micros();
+  for (int frame = 0; frame < UPDATES; frame++)
+  {
+    for (uint8_t ch = 0; ch < 16; ch++)
+    {
+      uint16_t off = 150 + frame + ch;
+      uint8_t bytes[5] = {(uint8_t)(0x06 + 4 * ch), 0, 0, (uint8_t)(off & 0xFF),
+                          (uint8_t)(off >> 8)};
+      Wire.beginTransmission(PCA9685_ADDRESS);
+      Wire.write(bytes, 5);
+      Wire.endTransmission();
+    } // for
+  } // for
+  report("setPWM() per channel", micros() - start);
+
+  // Bursts of 7 channels (29 bytes) so each fits a 32 byte Wire buffer.
+  Wire.resetStats();
+  start = micros();
+  for (int frame = 0; frame < UPDATES; frame++)
+  {
+    for (uint8_t first = 0; first < 16; first += 7)
+    {
+      uint8_t count = (16 - first) < 7 ? (16 - first) : 7;
+      uint8_t bytes[1 + 4 * 7];
+      bytes[0] = 0x06 + 4 * first;
+      for (uint8_t i = 0; i < count; i++)
+      {
+        uint16_t off = 150 + frame + first + i;
+        bytes[1 + 4 * i] = 0;
+        bytes[2 + 4 * i] = 0;
+        bytes[3 + 4 * i] = off & 0xFF;
+        bytes[4 + 4 * i] = off >> 8;
+      } // for
+      Wire.beginTransmission(PCA9685_ADDRESS);
+      Wire.write(bytes, 1 + 4 * count);
+      Wire.endTransmission();
+    } // for
+  } // for
+  report("auto-increment bursts", micros() - start);
+
+  bool registersOk = true;
+  for (uint8_t ch = 0; ch < 16; ch++)
+  {
+    registersOk &= model.offCount(ch) == 150 + (UPDATES - 1) + ch;
+  } // for
+  check(registersOk, "PCA9685 OFF counts after bursts");
+  Wire.detach(model);
+} // benchServo()
+
+/**
+ * @brief Probe every address once.
+ */
+static void scan()
+{
+  for (uint8_t address = 1; address < 127; address++)
+  {
+    Wire.beginTransmission(address);
+    Wire.endTransmission();
+  } // for
+} // scan()
+
+/**
+ * @brief Scanner benchmark on an empty and a stuck bus.
+ */
+static void benchScan()
+{
+  printf("Address scan (126 probes):\n");
+  Wire.setMode(SIM_BUS_EMPTY);
+
+  Wire.setClock(100000);
+  Wire.resetStats();
+  unsigned long start = micros();
+  scan();
+  report("empty bus, 100 kHz", micros() - start);
+
+  Wire.setClock(400000);
+  Wire.resetStats();
+  start = micros();
+  scan();
+  report("empty bus, 400 kHz", micros() - start);
+
+  Wire.setMode(SIM_BUS_STUCK);
+  Wire.setTimeOut(50);
+  Wire.resetStats();
+  start = micros();
+  scan();
+  report("stuck bus, 50 ms timeout", micros() - start);
+
+  Wire.setTimeOut(2);
+  Wire.resetStats();
+  start = micros();
+  scan();
+  report("stuck bus, 2 ms timeout", micros() - start);
+  check(Wire.stats().timeouts == 126, "stuck bus timeouts");
+
+  Wire.setMode(SIM_BUS_NORMAL);
+} // benchScan()
+
+int main()
+{
+  benchLcd();
+  benchServo();
+  benchScan();
+  printf(failures == 0 ? "All checks passed.\n" : "%d check(s) failed.\n",
+         failures);
+  return failures == 0 ? 0 : 1;
+} // main()
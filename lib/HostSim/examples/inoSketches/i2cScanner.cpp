@@ -0,0 +1,15 @@
+/**
+ * @file i2cScanner.cpp
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Host build of i2cScanner.ino.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details The Arduino IDE turns a .ino file into C++ itself. The native
+ * PlatformIO build only compiles .cpp files, so this one includes the sketch
+ * as it is.
+ */
+#include <Arduino.h>
+#include "../../../../answerBook/Lesson12-I2C/i2cScanner/i2cScanner.ino"
@@ -0,0 +1,15 @@
+/**
+ * @file i2cServoPca9685.cpp
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Host build of i2cServoPca9685.ino.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details The Arduino IDE turns a .ino file into C++ itself. The native
+ * PlatformIO build only compiles .cpp files, so this one includes the sketch
+ * as it is.
+ */
+#include <Arduino.h>
+#include "../../../../answerBook/Lesson4b-i2CMotorControl/i2cServoPca9685/i2cServoPca9685.ino"
@@ -0,0 +1,252 @@
+/**
+ * @file sketchRunner.cpp
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Run an answerBook sketch on the host and report what each loop()
+ * costs (Linux).
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details Linked with one sketch (see the sketch_ environments in
+ * native-reference-platformio.ini). Calls setup() once and loop() N times on
+ * the virtual clock, with an LCD backpack (0x3F) and a PCA9685 (0x40) on the
+ * simulated I2C bus. Then prints to standard error, per loop():
+ * - virtual time: what the loop would take on the board, delays included.
+ * - host time: what it took here. Only useful to compare two runs.
+ * - calls per hardware function (SimHal.h), Serial bytes and I2C traffic.
+ * - heap allocations (operator new), which a control loop should not make.
+ * The sketch's own Serial output goes to standard output. If the sketch
+ * wrote to the LCD, the report also has the text on the display.
+ *
+ *   sketchRunner [-n loops] [-i input] [-q] [-t max_us] [-a max_allocs]
+ *
+ *   -n  loop() calls, 100 by default.
+ *   -i  text the sketch reads from Serial, such as $'100\n255\n'.
+ *   -q  throw the sketch's Serial output away.
+ *   -t  fail if a loop() takes more than this many virtual microseconds.
+ *   -a  fail if loop() allocates more than this many times per call.
+ *
+ * A sketch that waits for Serial input ends the run when the input runs
+ * out. Returns 1 if a limit given with -t or -a was broken.
+ */
+#include <Arduino.h>
+#include <Wire.h>
+#include <SimLcd.h>
+#include <SimPca9685.h>
+#include <chrono>
+#include <new>
+#include <unistd.h>
+
+// Virtual time one millis() or micros() call takes, an estimate for the
+// UNO R4. Without it a sketch that waits by reading the clock never ends.
+#define CLOCK_READ_NS 1000
+
+// loop() calls when -n is not given.
+#define DEFAULT_LOOPS 100
+
+void setup();
+void loop();
+
+static uint32_t allocations = 0;
+static uint64_t allocatedBytes = 0;
+
+void *operator new(size_t size)
+{
+  allocations++;
+  allocatedBytes += size;
+  void *block = malloc(size ? size : 1);
+  if (block == nullptr)
+  {
+    throw std::bad_alloc();
+  } // if
+  return block;
+} // operator new()
+
+void *operator new[](size_t size)
+{
+  return operator new(size);
+} // operator new[]()
+
+void operator delete(void *block) noexcept
+{
+  free(block);
+} // operator delete()
+
+void operator delete[](void *block) noexcept
+{
+  free(block);
+} // operator delete[]()
+
+void operator delete(void *block, size_t) noexcept
+{
+  free(block);
+} // operator delete()
+
+void operator delete[](void *block, size_t) noexcept
+{
+  free(block);
+} // operator delete[]()
+
+/**
+ * @brief Counters at one moment, to subtract.
+ */
+struct Snapshot
+{
+  uint64_t virtualNs;
+  std::chrono::steady_clock::time_point host;
+  uint32_t calls[SIM_HAL_CALLS];
+  uint32_t serialBytes;
+  SimBusStats bus;
+  uint32_t allocations;
+  uint64_t allocatedBytes;
+};
+
+static SimLcd lcd(0x3F);
+static SimPca9685 pca9685(0x40);
+static Snapshot setupStart;
+static Snapshot loopStart;
+static unsigned long loopsDone = 0;
+static bool inLoop = false;
+static double maxLoopUs = 0;  // 0 = no limit.
+static double maxLoopAllocs = -1; // Below 0 = no limit.
+
+static Snapshot snapshot()
+{
+  Snapshot s;
+  s.virtualNs = SimClock::nowNs();
+  s.host = std::chrono::steady_clock::now();
+  for (uint8_t i = 0; i < SIM_HAL_CALLS; i++)
+  {
+    s.calls[i] = SimHal::calls((SimHalCall)i);
+  } // for
+  s.serialBytes = Serial.bytesWritten();
+  s.bus = Wire.stats();
+  s.allocations = allocations;
+  s.allocatedBytes = allocatedBytes;
+  return s;
+} // snapshot()
+
+/**
+ * @brief Print the report and end the program.
+ */
+[[noreturn]] static void finish()
+{
+  Snapshot end = snapshot();
+  Serial.flush();
+  if (!inLoop)
+  {
+    loopStart = end; // Stopped in setup().
+  } // if
+  double setupMs = (loopStart.virtualNs - setupStart.virtualNs) / 1e6;
+  fprintf(stderr, "\nsetup(): %.3f ms virtual, %u allocations (%llu bytes)\n", setupMs,
+          (unsigned)(loopStart.allocations - setupStart.allocations),
+          (unsigned long long)(loopStart.allocatedBytes - setupStart.allocatedBytes));
+
+  if (lcd.dataWrites() > 0)
+  {
+    fprintf(stderr, "LCD shows: |%s|", lcd.row(0)); // row() reuses one buffer.
+    fprintf(stderr, " |%s|\n", lcd.row(1));
+  } // if
+
+  unsigned long loops = loopsDone;
+  fprintf(stderr, "loop(): %lu calls\n", loops);
+  if (loops == 0)
+  {
+    fprintf(stderr, "Nothing to report per loop.\n");
+    exit(0);
+  } // if
+
+  double virtualUs = (end.virtualNs - loopStart.virtualNs) / 1e3 / loops;
+  double hostUs = std::chrono::duration<double, std::micro>(end.host - loopStart.host).count() / loops;
+  double allocs = (double)(end.allocations - loopStart.allocations) / loops;
+  fprintf(stderr, "Per loop():\n");
+  fprintf(stderr, "  %-20s %12.1f us\n", "virtual time", virtualUs);
+  fprintf(stderr, "  %-20s %12.2f us\n", "host time", hostUs);
+  for (uint8_t i = 0; i < SIM_HAL_CALLS; i++)
+  {
+    uint32_t calls = end.calls[i] - loopStart.calls[i];
+    if (calls > 0)
+    {
+      fprintf(stderr, "  %-20s %12.2f\n", SimHal::name((SimHalCall)i), (double)calls / loops);
+    } // if
+  } // for
+  fprintf(stderr, "  %-20s %12.1f\n", "Serial bytes",
+          (double)(end.serialBytes - loopStart.serialBytes) / loops);
+  fprintf(stderr, "  %-20s %12.2f\n", "I2C transactions",
+          (double)(end.bus.transactions - loopStart.bus.transactions) / loops);
+  fprintf(stderr, "  %-20s %12.1f us\n", "I2C bus time",
+          (end.bus.busTimeNs - loopStart.bus.busTimeNs) / 1e3 / loops);
+  fprintf(stderr, "  %-20s %12.2f (%.1f bytes)\n", "allocations", allocs,
+          (double)(end.allocatedBytes - loopStart.allocatedBytes) / loops);
+
+  int status = 0;
+  if (maxLoopUs > 0 && virtualUs > maxLoopUs)
+  {
+    fprintf(stderr, "FAIL: %.1f us per loop, limit %.1f us\n", virtualUs, maxLoopUs);
+    status = 1;
+  } // if
+  if (maxLoopAllocs >= 0 && allocs > maxLoopAllocs)
+  {
+    fprintf(stderr, "FAIL: %.2f allocations per loop, limit %.2f\n", allocs, maxLoopAllocs);
+    status = 1;
+  } // if
+  exit(status);
+} // finish()
+
+/**
+ * @brief Serial's stall handler: the sketch waits for input that is not
+ * coming, so the run is over.
+ */
+static void inputEnded()
+{
+  Serial.flush();
+  fprintf(stderr, "\nThe sketch is waiting for Serial input, stopping.\n");
+  finish();
+} // inputEnded()
+
+int main(int argc, char **argv)
+{
+  unsigned long loops = DEFAULT_LOOPS;
+  int option;
+  while ((option = getopt(argc, argv, "n:i:qt:a:")) != -1)
+  {
+    switch (option)
+    {
+    case 'n':
+      loops = strtoul(optarg, nullptr, 10);
+      break;
+    case 'i':
+      Serial.simInput(optarg);
+      break;
+    case 'q':
+      Serial.setEcho(false);
+      break;
+    case 't':
+      maxLoopUs = atof(optarg);
+      break;
+    case 'a':
+      maxLoopAllocs = atof(optarg);
+      break;
+    default:
+      fprintf(stderr, "Usage: %s [-n loops] [-i input] [-q] [-t max_us] [-a max_allocs]\n",
+              argv[0]);
+      return 2;
+    } // switch
+  } // while
+
+  Wire.attach(lcd);
+  Wire.attach(pca9685);
+  SimClock::setReadCostNs(CLOCK_READ_NS);
+  Serial.setStallHandler(inputEnded);
+
+  setupStart = snapshot();
+  setup();
+  loopStart = snapshot();
+  inLoop = true;
+  for (loopsDone = 0; loopsDone < loops; loopsDone++)
+  {
+    loop();
+  } // for
+  finish();
+} // main()
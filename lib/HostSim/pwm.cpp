@@ -0,0 +1,54 @@
+/**
+ * @file pwm.cpp
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Host-side PwmOut stand-in. See pwm.h.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ */
+#include "pwm.h"
+
+/**
+ * @details Microsecond widths are turned into counts at 48 MHz, as the core
+ * does.
+ */
+bool PwmOut::begin(uint32_t periodWidth, uint32_t pulseWidth, bool raw,
+                   timer_source_div_t sd)
+{
+  SimHal::count(SIM_HAL_TIMER_CONFIG);
+  uint32_t divider = 1UL << sd;
+  if (!raw)
+  {
+    periodWidth = (uint32_t)((uint64_t)periodWidth * (SystemCoreClock / 1000000UL) / divider);
+    pulseWidth = (uint32_t)((uint64_t)pulseWidth * (SystemCoreClock / 1000000UL) / divider);
+  } // if
+  if (periodWidth == 0 || periodWidth > 0xFFFF || pulseWidth > periodWidth)
+  {
+    return false;
+  } // if
+  period = periodWidth;
+  pulse = pulseWidth;
+  started = true;
+  return true;
+} // begin()
+
+bool PwmOut::pulseWidth_raw(int pulse)
+{
+  if (!started || pulse < 0 || (uint32_t)pulse > period)
+  {
+    return false;
+  } // if
+  SimHal::count(SIM_HAL_ANALOG_WRITE);
+  this->pulse = pulse;
+  return true;
+} // pulseWidth_raw()
+
+bool PwmOut::pulse_perc(float duty)
+{
+  if (duty < 0 || duty > 100)
+  {
+    return false;
+  } // if
+  return pulseWidth_raw((int)(period * duty / 100.0f));
+} // pulse_perc()
@@ -0,0 +1,56 @@
+/**
+ * @file pwm.h
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Host-side stand-in for the UNO R4 core's PwmOut class.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details PwmOut runs a pin's GPT timer as PWM with raw period and pulse
+ * counts, finer than analogWrite(). The stand-in checks the counts against
+ * a 16-bit timer, remembers them so a program can check what the sketch
+ * asked for, and counts begin() as a timer setup and each pulse change as
+ * an analogWrite in SimHal.
+ */
+#ifndef HOST_SIM_PWM_H
+#define HOST_SIM_PWM_H
+
+#include "FspTimer.h"
+
+class PwmOut
+{
+public:
+  explicit PwmOut(int pin) : pin(pin) {}
+
+  /**
+   * @brief Start PWM. With raw, the widths are timer counts at the source
+   * divider, otherwise microseconds.
+   */
+  bool begin(uint32_t periodWidth, uint32_t pulseWidth, bool raw = false,
+             timer_source_div_t sd = TIMER_SOURCE_DIV_1);
+  void end() { started = false; }
+
+  /**
+   * @brief Change the pulse, in timer counts.
+   */
+  bool pulseWidth_raw(int pulse);
+
+  /**
+   * @brief Change the pulse, in percent of the period.
+   */
+  bool pulse_perc(float duty);
+
+  // Simulation control.
+
+  uint32_t simPeriod() const { return period; }
+  uint32_t simPulse() const { return pulse; }
+
+private:
+  int pin;
+  bool started = false;
+  uint32_t period = 0;
+  uint32_t pulse = 0;
+};
+
+#endif // HOST_SIM_PWM_H
@@ -0,0 +1,345 @@
+/**
+ * @file I2cScheduler.cpp
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Non-blocking I2C transaction scheduler. See I2cScheduler.h.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ */
+#include "I2cScheduler.h"
+
+// Worker task settings (ESP32 / FreeRTOS builds only).
+#define I2C_WORKER_STACK 3072
+#define I2C_WORKER_PRIORITY 3
+#define I2C_WORKER_CORE 1
+
+/**
+ * @brief Construct a scheduler for one bus.
+ */
+I2cScheduler::I2cScheduler(TwoWire &wire) : wire(wire)
+{
+#if I2C_SCHEDULER_USE_TASK
+  worker = nullptr;
+#endif
+  for (uint8_t i = 0; i < I2C_PRIORITY_COUNT; i++)
+  {
+    queues[i].head = 0;
+    queues[i].tail = 0;
+  } // for
+  completions.head = 0;
+  completions.tail = 0;
+  resetStats();
+} // I2cScheduler()
+
+/**
+ * @brief Start the worker task (if enabled) and the utilization window.
+ */
+void I2cScheduler::begin()
+{
+  resetStats();
+#if I2C_SCHEDULER_USE_TASK
+  if (worker == nullptr)
+  {
+#if defined(ESP32)
+    xTaskCreatePinnedToCore(workerTask, "i2cWorker", I2C_WORKER_STACK, this,
+                            I2C_WORKER_PRIORITY, &worker, I2C_WORKER_CORE);
+#else
+    xTaskCreate(workerTask, "i2cWorker", I2C_WORKER_STACK / sizeof(StackType_t),
+                this, I2C_WORKER_PRIORITY, &worker);
+#endif
+  } // if
+#endif
+} // begin()
+
+/**
+ * @brief Queue a transaction without touching the bus.
+ */
+bool I2cScheduler::submit(const I2cTransaction &txn)
+{
+  uint8_t priority = txn.priority < I2C_PRIORITY_COUNT ? txn.priority
+                                                       : I2C_PRIORITY_COUNT - 1;
+  if (txn.writeLength > I2C_TXN_MAX_WRITE || txn.readLength > I2C_TXN_MAX_READ)
+  {
+    stats[priority].dropped++; // Does not fit the transaction's buffers.
+    return false;
+  } // if
+  I2cTransaction copy = txn;
+  copy.priority = priority;
+  copy.queuedUs = micros();
+  if (!push(queues[priority], copy))
+  {
+    stats[priority].dropped++;
+    return false;
+  } // if
+#if I2C_SCHEDULER_USE_TASK
+  if (worker != nullptr)
+  {
+    xTaskNotifyGive(worker);
+  } // if
+#endif
+  return true;
+} // submit()
+
+/**
+ * @brief Queue a write-only transaction.
+ */
+bool I2cScheduler::write(uint8_t address, uint8_t priority, const uint8_t *data,
+                         uint8_t length, I2cCallback callback, void *context)
+{
+  I2cTransaction txn;
+  txn.address = address;
+  txn.priority = priority;
+  txn.writeLength = length;
+  txn.readLength = 0;
+  // submit() refuses a longer one and counts it as dropped.
+  if (length <= I2C_TXN_MAX_WRITE)
+  {
+    memcpy(txn.writeData, data, length);
+  } // if
+  txn.callback = callback;
+  txn.context = context;
+  return submit(txn);
+} // write()
+
+/**
+ * @brief Hand finished transactions to their callbacks and record statistics.
+ */
+uint8_t I2cScheduler::dispatch()
+{
+  uint8_t count = 0;
+  I2cTransaction txn;
+  while (pop(completions, txn))
+  {
+    record(txn);
+    if (txn.callback != nullptr)
+    {
+      txn.callback(txn, txn.context);
+    } // if
+    count++;
+  } // while
+  return count;
+} // dispatch()
+
+/**
+ * @brief Cooperative worker for builds without a worker task.
+ */
+bool I2cScheduler::poll()
+{
+#if I2C_SCHEDULER_USE_TASK
+  return false; // The worker task owns the bus.
+#else
+  I2cTransaction txn;
+  if (!takeNext(txn))
+  {
+    return false;
+  } // if
+  execute(txn);
+  return true;
+#endif
+} // poll()
+
+/**
+ * @brief Number of queued transactions in one class.
+ */
+uint8_t I2cScheduler::pending(uint8_t priority) const
+{
+  if (priority >= I2C_PRIORITY_COUNT)
+  {
+    return 0;
+  } // if
+  return (uint8_t)(queues[priority].head.load(std::memory_order_acquire) -
+                   queues[priority].tail.load(std::memory_order_acquire));
+} // pending()
+
+/**
+ * @brief Print bus utilization and latency per class, then reset.
+ */
+void I2cScheduler::printStats(Stream &out)
+{
+  static const char *names[I2C_PRIORITY_COUNT] = {"servo", "normal", "display"};
+  uint32_t windowUs = micros() - windowStartUs;
+
+  out.print("<I2cScheduler> bus busy ");
+  out.print((uint32_t)busyUs);
+  out.print(" us of ");
+  out.print(windowUs);
+  out.print(" us (");
+  out.print(windowUs ? (float)busyUs * 100.0f / windowUs : 0.0f, 1);
+  out.println("% utilization)");
+
+  for (uint8_t i = 0; i < I2C_PRIORITY_COUNT; i++)
+  {
+    const I2cClassStats &s = stats[i];
+    out.print("<I2cScheduler> ");
+    out.print(names[i]);
+    out.print(": done=");
+    out.print(s.completed);
+    out.print(" failed=");
+    out.print(s.failed);
+    out.print(" dropped=");
+    out.print(s.dropped);
+    if (s.completed > 0)
+    {
+      out.print(" latency us min/avg/max=");
+      out.print(s.minUs);
+      out.print("/");
+      out.print((uint32_t)(s.totalUs / s.completed));
+      out.print("/");
+      out.print(s.maxUs);
+    } // if
+    out.println();
+  } // for
+  resetStats();
+} // printStats()
+
+/**
+ * @brief Clear statistics and restart the utilization window.
+ */
+void I2cScheduler::resetStats()
+{
+  for (uint8_t i = 0; i < I2C_PRIORITY_COUNT; i++)
+  {
+    stats[i].completed = 0;
+    stats[i].failed = 0;
+    stats[i].dropped = 0;
+    stats[i].minUs = UINT32_MAX;
+    stats[i].maxUs = 0;
+    stats[i].totalUs = 0;
+  } // for
+  busyUs = 0;
+  windowStartUs = micros();
+} // resetStats()
+
+/**
+ * @brief Copy a transaction into a ring. Producer side only.
+ */
+bool I2cScheduler::push(Ring &ring, const I2cTransaction &txn)
+{
+  uint8_t head = ring.head.load(std::memory_order_relaxed);
+  uint8_t tail = ring.tail.load(std::memory_order_acquire);
+  if ((uint8_t)(head - tail) >= I2C_QUEUE_DEPTH)
+  {
+    return false; // Full.
+  } // if
+  ring.slots[head & (I2C_QUEUE_DEPTH - 1)] = txn;
+  ring.head.store(head + 1, std::memory_order_release); // Publish the slot.
+  return true;
+} // push()
+
+/**
+ * @brief Copy the oldest transaction out of a ring. Consumer side only.
+ */
+bool I2cScheduler::pop(Ring &ring, I2cTransaction &txn)
+{
+  uint8_t tail = ring.tail.load(std::memory_order_relaxed);
+  uint8_t head = ring.head.load(std::memory_order_acquire);
+  if (head == tail)
+  {
+    return false; // Empty.
+  } // if
+  txn = ring.slots[tail & (I2C_QUEUE_DEPTH - 1)];
+  ring.tail.store(tail + 1, std::memory_order_release); // Free the slot.
+  return true;
+} // pop()
+
+/**
+ * @brief Take the oldest transaction from the highest priority non-empty class.
+ * @details Waits (returns false) while the completion ring is full so that a
+ * finished transaction is never lost.
+ */
+bool I2cScheduler::takeNext(I2cTransaction &txn)
+{
+  uint8_t head = completions.head.load(std::memory_order_relaxed);
+  uint8_t tail = completions.tail.load(std::memory_order_acquire);
+  if ((uint8_t)(head - tail) >= I2C_QUEUE_DEPTH)
+  {
+    return false; // loop() has not called dispatch() yet.
+  } // if
+  for (uint8_t i = 0; i < I2C_PRIORITY_COUNT; i++)
+  {
+    if (pop(queues[i], txn))
+    {
+      return true;
+    } // if
+  } // for
+  return false;
+} // takeNext()
+
+/**
+ * @brief Run one transaction on the bus and queue its completion.
+ */
+void I2cScheduler::execute(I2cTransaction &txn)
+{
+  txn.startedUs = micros();
+  txn.result = 0;
+  if (txn.writeLength > 0)
+  {
+    wire.beginTransmission(txn.address);
+    wire.write(txn.writeData, txn.writeLength);
+    // Keep the bus (repeated START) if a read follows.
+    txn.result = wire.endTransmission(txn.readLength == 0);
+  } // if
+  if (txn.result == 0 && txn.readLength > 0)
+  {
+    uint8_t length = txn.readLength > I2C_TXN_MAX_READ ? I2C_TXN_MAX_READ
+                                                       : txn.readLength;
+    uint8_t received = wire.requestFrom(txn.address, length);
+    for (uint8_t i = 0; i < received; i++)
+    {
+      txn.readData[i] = wire.read();
+    } // for
+    if (received != length)
+    {
+      txn.result = 4; // Same code Wire uses for "other error".
+    } // if
+  } // if
+  txn.doneUs = micros();
+  push(completions, txn); // Space was checked in takeNext().
+} // execute()
+
+/**
+ * @brief Fold one finished transaction into the statistics (loop() context).
+ */
+void I2cScheduler::record(const I2cTransaction &txn)
+{
+  I2cClassStats &s = stats[txn.priority];
+  uint32_t latency = txn.doneUs - txn.queuedUs;
+  s.completed++;
+  if (txn.result != 0)
+  {
+    s.failed++;
+  } // if
+  if (latency < s.minUs)
+  {
+    s.minUs = latency;
+  } // if
+  if (latency > s.maxUs)
+  {
+    s.maxUs = latency;
+  } // if
+  s.totalUs += latency;
+  busyUs += txn.doneUs - txn.startedUs;
+} // record()
+
+#if I2C_SCHEDULER_USE_TASK
+/**
+ * @brief Worker task: sleep until work is queued, then drain the queues.
+ */
+void I2cScheduler::workerTask(void *param)
+{
+  I2cScheduler *self = static_cast<I2cScheduler *>(param);
+  I2cTransaction txn;
+  for (;;)
+  {
+    if (self->takeNext(txn))
+    {
+      self->execute(txn);
+      continue;
+    } // if
+    // Nothing runnable: wait for submit() (or retry soon if loop() has not
+    // collected completions yet).
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1));
+  } // for
+} // workerTask()
+#endif
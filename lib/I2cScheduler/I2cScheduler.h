@@ -0,0 +1,213 @@
+/**
+ * @file I2cScheduler.h
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Non-blocking I2C transaction scheduler shared by every device on a bus.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details
+ * The LCD, PCA9685 and scanner sketches all call Wire directly. Each Wire call
+ * waits until its transfer is finished, so a slow LCD update holds up the next
+ * servo pose. The scheduler replaces those calls with transaction descriptors:
+ *
+ * 1. loop() fills in an I2cTransaction (address, bytes to write, bytes to read,
+ *    priority class, completion callback) and calls submit(). submit() copies
+ *    the descriptor into a fixed ring for its priority class and returns at
+ *    once. Nothing is allocated.
+ * 2. A worker runs the queued transactions, always taking the highest priority
+ *    class first, so servo frames overtake display text that is still queued.
+ * 3. Finished transactions are handed back through a completion ring and their
+ *    callbacks run from dispatch(), which loop() calls. Callbacks therefore run
+ *    in loop() context and never need to be interrupt safe.
+ *
+ * Where the worker runs:
+ * - ESP32: a FreeRTOS task (I2C_SCHEDULER_USE_TASK = 1, the default). The
+ *   ESP-IDF I2C driver behind Wire is interrupt driven and blocks the calling
+ *   task on a semaphore, so the worker sleeps while the bus is busy and loop()
+ *   never waits on the bus.
+ * - UNO R4 WiFi (RA4M1), without FreeRTOS (the default): there is no
+ *   background worker. poll() runs the next queued transaction from loop()
+ *   with an ordinary Wire call, so loop() does wait for the bus, for one
+ *   transaction per poll() call. Servo frames still go first, and a long
+ *   LCD update no longer holds up a servo frame behind it, but the
+ *   non-blocking promise above only holds on the ESP32. Neither Wire nor
+ *   this library uses the RA4M1's DMA or an interrupt-driven transfer.
+ * - UNO R4 with Arduino_FreeRTOS: set I2C_SCHEDULER_USE_TASK to 1 and the
+ *   task backend runs the transfers. The R4's Wire waits for a transfer in a
+ *   loop rather than sleeping, so the worker keeps the CPU busy while the bus
+ *   is, but loop() only runs into that when it has the lower priority.
+ *
+ * Statistics: bus busy time, bus utilization and per class queue-to-done
+ * latency (count, min, average, max) are kept in static storage and printed
+ * by printStats().
+ */
+#ifndef I2C_SCHEDULER_H
+#define I2C_SCHEDULER_H
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <atomic>
+
+#ifndef I2C_SCHEDULER_USE_TASK
+#if defined(ESP32)
+#define I2C_SCHEDULER_USE_TASK 1
+#else
+#define I2C_SCHEDULER_USE_TASK 0
+#endif
+#endif
+
+#if I2C_SCHEDULER_USE_TASK
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#else
+#include <Arduino_FreeRTOS.h>
+#endif
+#endif
+
+// Largest write payload in one transaction. 32 bytes fits the Wire buffer on
+// both the ESP32 and RA4M1 cores (a PCA9685 frame for 7 channels or one burst
+// of LCD nibbles).
+#define I2C_TXN_MAX_WRITE 32
+
+// Largest read payload in one transaction.
+#define I2C_TXN_MAX_READ 8
+
+// Queue depth per priority class. Must be a power of two.
+#define I2C_QUEUE_DEPTH 8
+
+/**
+ * @brief Priority classes, lowest number runs first.
+ */
+enum I2cPriority : uint8_t
+{
+  I2C_PRIORITY_SERVO = 0,   // Servo / motor frames, latency sensitive.
+  I2C_PRIORITY_NORMAL = 1,  // Sensors, scanner probes.
+  I2C_PRIORITY_DISPLAY = 2, // LCD text, can wait.
+  I2C_PRIORITY_COUNT = 3
+};
+
+struct I2cTransaction;
+
+/**
+ * @brief Completion callback. Runs from I2cScheduler::dispatch() in loop().
+ */
+typedef void (*I2cCallback)(const I2cTransaction &txn, void *context);
+
+/**
+ * @brief One I2C transaction: an optional write followed by an optional read.
+ */
+struct I2cTransaction
+{
+  uint8_t address;                      // 7-bit device address.
+  uint8_t priority;                     // One of I2cPriority.
+  uint8_t writeLength;                  // Bytes in writeData to send.
+  uint8_t readLength;                   // Bytes to read into readData.
+  uint8_t writeData[I2C_TXN_MAX_WRITE]; // Payload to send.
+  uint8_t readData[I2C_TXN_MAX_READ];   // Filled in by the worker.
+  uint8_t result;                       // Wire.endTransmission() code, 0 = OK.
+  uint32_t queuedUs;                    // micros() when submitted.
+  uint32_t startedUs;                   // micros() when the worker started it.
+  uint32_t doneUs;                      // micros() when the bus was released.
+  I2cCallback callback;                 // May be nullptr.
+  void *context;                        // Passed to callback.
+};
+
+/**
+ * @brief Latency statistics for one priority class.
+ */
+struct I2cClassStats
+{
+  uint32_t completed;  // Transactions finished.
+  uint32_t failed;     // Transactions with result != 0.
+  uint32_t dropped;    // submit() calls refused: queue full or too long.
+  uint32_t minUs;      // Smallest queue-to-done latency.
+  uint32_t maxUs;      // Largest queue-to-done latency.
+  uint64_t totalUs;    // Sum of latencies, for the average.
+};
+
+class I2cScheduler
+{
+public:
+  explicit I2cScheduler(TwoWire &wire);
+
+  /**
+   * @brief Start the worker. The caller must already have called Wire.begin().
+   */
+  void begin();
+
+  /**
+   * @brief Queue a transaction. Never waits for the bus.
+   * @return false if the queue for txn.priority is full, or the lengths are
+   * over I2C_TXN_MAX_WRITE or I2C_TXN_MAX_READ (both counted as dropped).
+   */
+  bool submit(const I2cTransaction &txn);
+
+  /**
+   * @brief Convenience wrapper to queue a register write.
+   * @return false as submit(), a length over I2C_TXN_MAX_WRITE is dropped.
+   */
+  bool write(uint8_t address, uint8_t priority, const uint8_t *data,
+             uint8_t length, I2cCallback callback = nullptr,
+             void *context = nullptr);
+
+  /**
+   * @brief Run completion callbacks for finished transactions. Call from loop().
+   * @return Number of callbacks run.
+   */
+  uint8_t dispatch();
+
+  /**
+   * @brief Run at most one queued transaction (only without a worker task).
+   * @return true if a transaction was run.
+   */
+  bool poll();
+
+  /**
+   * @brief Number of transactions waiting in one priority class.
+   */
+  uint8_t pending(uint8_t priority) const;
+
+  /**
+   * @brief Print utilization and per class latency, then reset the counters.
+   */
+  void printStats(Stream &out);
+
+  /**
+   * @brief Clear all statistics and restart the utilization window.
+   */
+  void resetStats();
+
+private:
+  /**
+   * @brief Fixed size single-producer/single-consumer ring of transactions.
+   */
+  struct Ring
+  {
+    I2cTransaction slots[I2C_QUEUE_DEPTH];
+    std::atomic<uint8_t> head; // Next slot to write (producer owned).
+    std::atomic<uint8_t> tail; // Next slot to read (consumer owned).
+  };
+
+  bool push(Ring &ring, const I2cTransaction &txn);
+  bool pop(Ring &ring, I2cTransaction &txn);
+  bool takeNext(I2cTransaction &txn);
+  void execute(I2cTransaction &txn);
+  void record(const I2cTransaction &txn);
+
+#if I2C_SCHEDULER_USE_TASK
+  static void workerTask(void *param);
+  TaskHandle_t worker;
+#endif
+
+  TwoWire &wire;
+  Ring queues[I2C_PRIORITY_COUNT];
+  Ring completions;
+  I2cClassStats stats[I2C_PRIORITY_COUNT];
+  uint64_t busyUs;
+  uint32_t windowStartUs;
+};
+
+#endif // I2C_SCHEDULER_H
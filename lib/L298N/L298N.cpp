@@ -0,0 +1,39 @@
+/**
+ * @file L298N.cpp
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Host side of the L298N port writes. See L298N.h.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details On the boards a port write is a register store in L298N.h and
+ * this file is empty.
+ */
+#include "L298N.h"
+
+#if !defined(ARDUINO_ARCH_RENESAS) && !defined(ESP32)
+/**
+ * @details Plays the port register: every pin on the port whose bit is in
+ * set or clear changes level, all in one counted call.
+ */
+void L298NPort::hostWrite(uint8_t port, uint32_t set, uint32_t clear)
+{
+  SimHal::count(SIM_HAL_PORT_WRITE);
+  for (uint8_t pin = 0; pin < SIM_HAL_PINS; pin++)
+  {
+    if (of(pin) != port)
+    {
+      continue;
+    } // if
+    if (clear & mask(pin))
+    {
+      SimHal::setPinLevel(pin, LOW);
+    } // if
+    if (set & mask(pin))
+    {
+      SimHal::setPinLevel(pin, HIGH);
+    } // if
+  } // for
+} // hostWrite()
+#endif
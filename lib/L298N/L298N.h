@@ -0,0 +1,312 @@
+/**
+ * @file L298N.h
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief L298N motor controller driver that changes the enable and direction
+ * pins of a motor with port writes instead of one digitalWrite() per pin.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details
+ * Each L298N channel has three inputs: EN switches the H-bridge on, IN1 and
+ * IN2 pick what each side of the motor is connected to:
+ *
+ *   mode      EN   IN1  IN2
+ *   coast     LOW  LOW  LOW   Bridge off, the motor spins down freely.
+ *   brake     HIGH HIGH HIGH  Both motor terminals shorted, a quick stop.
+ *   forward   HIGH LOW  HIGH  Same pin levels as the Lesson 3 sketch.
+ *   reverse   HIGH HIGH LOW
+ *
+ * Three digitalWrite() calls take about 2 us on the UNO R4, each one looking
+ * the pin up in a table, and in between the pins show a mix of the old and
+ * the new mode. Here the pins are template arguments, so the port register
+ * and bit of each pin are worked out by the compiler and set() is a few
+ * stores:
+ * - UNO R4 (RA4M1): one write to the port's PCNTR3 register sets some bits
+ *   and clears others in the same clock.
+ * - ESP32: a write to GPIO_OUT_W1TC (clear) and then to GPIO_OUT_W1TS (set).
+ * - Host (lib/HostSim): the same pin levels, counted as "port write".
+ * Pins that share a port change together. When EN is on another port, the
+ * IN pins are written first when the bridge is switched on and last when it
+ * is switched off, so the motor never runs in a half-changed direction. On
+ * the UNO R4, A4 and A5 (IN1, IN2 in the lessons) are both on port 1 and A3
+ * (EN) is on port 0.
+ *
+ * EN is a plain output here. To control the speed and the braking with PWM
+ * on EN (Lesson 3a), use L298NMotor (L298NMotor.h).
+ *
+ * Set the pins up with begin() in setup(). Port writes do not go through
+ * pinMode().
+ */
+#ifndef L298N_H
+#define L298N_H
+
+#include <Arduino.h>
+
+#if defined(ESP32)
+#include <soc/gpio_reg.h>
+#endif
+
+#if defined(ARDUINO_ARCH_RENESAS)
+// Address of PCNTR3 of RA4M1 port n. The low half (POSR) sets bits, the high
+// half (PORR) clears them. RA4M1 hardware manual, I/O ports.
+#define L298N_PCNTR3(port) (*(volatile uint32_t *)(0x40040008UL + 0x20UL * (port)))
+#endif
+
+// Port and bit of UNO R4 pins D0-D13 and A0-A5, as (port << 8) | bit, the
+// same form as the core's bsp_io_port_pin_t. From the UNO R4 WiFi variant.
+constexpr uint16_t L298N_UNO_R4_PINS[] = {
+    0x0301, 0x0302, 0x0104, 0x0105, 0x0106, 0x0107, 0x010B, // D0-D6
+    0x010C, 0x0304, 0x0303, 0x0103, 0x040B, 0x040A, 0x0102, // D7-D13
+    0x000E, 0x0000, 0x0001, 0x0002, 0x0101, 0x0100};        // A0-A5
+
+// UNO R4 pins in the table.
+#define L298N_UNO_R4_PIN_COUNT 20
+
+/**
+ * @brief What one channel of the L298N does.
+ */
+enum L298NMode : uint8_t
+{
+  L298N_COAST = 0,
+  L298N_BRAKE,
+  L298N_FORWARD,
+  L298N_REVERSE
+};
+
+namespace L298NPort
+{
+  /**
+   * @brief Output port a pin is on.
+   */
+  constexpr uint8_t of(uint8_t pin)
+  {
+#if defined(ARDUINO_ARCH_RENESAS)
+    return L298N_UNO_R4_PINS[pin] >> 8;
+#elif defined(ESP32)
+    return pin >> 5;
+#else
+    return pin < L298N_UNO_R4_PIN_COUNT ? L298N_UNO_R4_PINS[pin] >> 8 : 10 + (pin >> 5);
+#endif
+  } // of()
+
+  /**
+   * @brief The pin's bit in its port.
+   */
+  constexpr uint32_t mask(uint8_t pin)
+  {
+#if defined(ARDUINO_ARCH_RENESAS)
+    return 1UL << (L298N_UNO_R4_PINS[pin] & 0xFF);
+#elif defined(ESP32)
+    return 1UL << (pin & 31);
+#else
+    return 1UL << (pin < L298N_UNO_R4_PIN_COUNT ? L298N_UNO_R4_PINS[pin] & 0xFF : pin & 31);
+#endif
+  } // mask()
+
+#if !defined(ARDUINO_ARCH_RENESAS) && !defined(ESP32)
+  /**
+   * @brief Host version of write(), in L298N.cpp.
+   */
+  void hostWrite(uint8_t port, uint32_t set, uint32_t clear);
+#endif
+
+  /**
+   * @brief Set the bits in set and clear the bits in clear, on one port.
+   */
+  inline void write(uint8_t port, uint32_t set, uint32_t clear)
+  {
+#if defined(ARDUINO_ARCH_RENESAS)
+    L298N_PCNTR3(port) = (clear << 16) | set;
+#elif defined(ESP32)
+    if (port == 0)
+    {
+      REG_WRITE(GPIO_OUT_W1TC_REG, clear);
+      REG_WRITE(GPIO_OUT_W1TS_REG, set);
+    }
+    else
+    {
+      REG_WRITE(GPIO_OUT1_W1TC_REG, clear);
+      REG_WRITE(GPIO_OUT1_W1TS_REG, set);
+    } // else
+#else
+    hostWrite(port, set, clear);
+#endif
+  } // write()
+} // namespace L298NPort
+
+/**
+ * @brief One channel of an L298N: an enable pin and two direction pins.
+ * @tparam EN ENA or ENB.
+ * @tparam IN1 IN1 or IN3.
+ * @tparam IN2 IN2 or IN4.
+ */
+template <uint8_t EN, uint8_t IN1, uint8_t IN2>
+class L298NChannel
+{
+#if defined(ARDUINO_ARCH_RENESAS)
+  static_assert(EN < L298N_UNO_R4_PIN_COUNT && IN1 < L298N_UNO_R4_PIN_COUNT &&
+                    IN2 < L298N_UNO_R4_PIN_COUNT,
+                "L298N pins must be D0-D13 or A0-A5");
+#endif
+
+public:
+  /**
+   * @brief Make the three pins outputs and let the motor coast.
+   * @return false if the port table does not match this board's pins (UNO
+   * R4 only), then set() must not be used.
+   */
+  bool begin()
+  {
+#if defined(ARDUINO_ARCH_RENESAS)
+    if (!matches(EN) || !matches(IN1) || !matches(IN2))
+    {
+      return false;
+    } // if
+#endif
+    pinMode(EN, OUTPUT);
+    pinMode(IN1, OUTPUT);
+    pinMode(IN2, OUTPUT);
+    current = L298N_FORWARD; // Anything but coast, so set() writes.
+    set(L298N_COAST);
+    return true;
+  } // begin()
+
+  /**
+   * @brief Change the mode. Nothing is written if it is already set.
+   */
+  void set(L298NMode mode)
+  {
+    if (mode == current)
+    {
+      return;
+    } // if
+    current = mode;
+    bool enable = mode != L298N_COAST;
+    uint32_t enSet = enable ? EN_MASK : 0;
+    uint32_t in1Set = mode == L298N_BRAKE || mode == L298N_REVERSE ? IN1_MASK : 0;
+    uint32_t in2Set = mode == L298N_BRAKE || mode == L298N_FORWARD ? IN2_MASK : 0;
+
+    if (EN_PORT == IN1_PORT && EN_PORT == IN2_PORT)
+    {
+      uint32_t set = enSet | in1Set | in2Set;
+      L298NPort::write(EN_PORT, set, (EN_MASK | IN1_MASK | IN2_MASK) & ~set);
+      return;
+    } // if
+
+    if (!enable)
+    {
+      L298NPort::write(EN_PORT, 0, EN_MASK);
+    } // if
+    direction(mode);
+    if (enable)
+    {
+      L298NPort::write(EN_PORT, EN_MASK, 0);
+    } // if
+  } // set()
+
+  /**
+   * @brief Write IN1 and IN2 for a mode and leave EN alone, for when EN is
+   * a PWM output (L298NMotor). mode() does not change.
+   */
+  void direction(L298NMode mode)
+  {
+    uint32_t in1Set = mode == L298N_BRAKE || mode == L298N_REVERSE ? IN1_MASK : 0;
+    uint32_t in2Set = mode == L298N_BRAKE || mode == L298N_FORWARD ? IN2_MASK : 0;
+    if (IN1_PORT == IN2_PORT)
+    {
+      uint32_t set = in1Set | in2Set;
+      L298NPort::write(IN1_PORT, set, (IN1_MASK | IN2_MASK) & ~set);
+    }
+    else
+    {
+      // Clear first: in between, the bridge brakes rather than turns.
+      L298NPort::write(IN1_PORT, 0, IN1_MASK & ~in1Set);
+      L298NPort::write(IN2_PORT, 0, IN2_MASK & ~in2Set);
+      L298NPort::write(IN1_PORT, in1Set, 0);
+      L298NPort::write(IN2_PORT, in2Set, 0);
+    } // else
+  } // direction()
+
+  void coast() { set(L298N_COAST); }
+  void brake() { set(L298N_BRAKE); }
+  void forward() { set(L298N_FORWARD); }
+  void reverse() { set(L298N_REVERSE); }
+
+  /**
+   * @brief The last mode set.
+   */
+  L298NMode mode() const { return current; }
+
+  /**
+   * @brief Port writes one change of direction takes, 1 if the three pins
+   * share a port.
+   */
+  static constexpr uint8_t portWrites()
+  {
+    return EN_PORT == IN1_PORT && EN_PORT == IN2_PORT ? 1 : IN1_PORT == IN2_PORT ? 2 : 5;
+  } // portWrites()
+
+private:
+  static constexpr uint8_t EN_PORT = L298NPort::of(EN);
+  static constexpr uint8_t IN1_PORT = L298NPort::of(IN1);
+  static constexpr uint8_t IN2_PORT = L298NPort::of(IN2);
+  static constexpr uint32_t EN_MASK = L298NPort::mask(EN);
+  static constexpr uint32_t IN1_MASK = L298NPort::mask(IN1);
+  static constexpr uint32_t IN2_MASK = L298NPort::mask(IN2);
+
+#if defined(ARDUINO_ARCH_RENESAS)
+  /**
+   * @brief Check the table against the core's own pin configuration.
+   */
+  static bool matches(uint8_t pin)
+  {
+    return (uint16_t)digitalPinToBspPin(pin) == L298N_UNO_R4_PINS[pin];
+  } // matches()
+#endif
+
+  L298NMode current = L298N_COAST;
+};
+
+/**
+ * @brief Both channels of an L298N, motor A and motor B.
+ */
+template <uint8_t ENA, uint8_t IN1, uint8_t IN2, uint8_t ENB, uint8_t IN3, uint8_t IN4>
+class L298N
+{
+public:
+  /**
+   * @brief begin() both channels.
+   * @return false if either one failed.
+   */
+  bool begin()
+  {
+    bool okA = a.begin();
+    bool okB = b.begin();
+    return okA && okB;
+  } // begin()
+
+  /**
+   * @brief Let both motors coast.
+   */
+  void coast()
+  {
+    a.coast();
+    b.coast();
+  } // coast()
+
+  /**
+   * @brief Brake both motors.
+   */
+  void brake()
+  {
+    a.brake();
+    b.brake();
+  } // brake()
+
+  L298NChannel<ENA, IN1, IN2> a; // Motor A, OUT1 and OUT2.
+  L298NChannel<ENB, IN3, IN4> b; // Motor B, OUT3 and OUT4.
+};
+
+#endif // L298N_H
@@ -0,0 +1,225 @@
+/**
+ * @file L298NMotor.cpp
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Braking, reversal and current limit of L298NMotor. See L298NMotor.h.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ */
+#include "L298NMotor.h"
+#include <math.h>
+
+// How fast the current sensor cut wears off, per update() that reads under
+// the limit.
+#define L298N_CURRENT_RECOVERY 0.05f
+
+L298NMotorBase::L298NMotorBase(const L298NMotorConfig &config)
+    : config(config), speedSensor(nullptr), speedContext(nullptr),
+      currentSensor(nullptr), currentContext(nullptr), request(REQUEST_COAST),
+      wantDuty(0), speed(0.0f), currentScale(1.0f), outMode(L298N_COAST),
+      outDuty(0), lastMs(0), braking(false), reverseStartMs(0), reversalMs(0),
+      limited(0)
+{
+} // L298NMotorBase()
+
+void L298NMotorBase::start()
+{
+  lastMs = millis();
+  request = REQUEST_COAST;
+  outMode = L298N_COAST;
+  outDuty = 0;
+  braking = false;
+} // start()
+
+/**
+ * @details A reversal starts here, not in update(), so one that ran out of
+ * time is not started again by the next update(). A duty that no longer
+ * points against the motor ends one.
+ */
+void L298NMotorBase::drive(int16_t duty)
+{
+  request = REQUEST_DRIVE;
+  int16_t limit = (int16_t)config.maxDuty;
+  wantDuty = duty > limit ? limit : duty < -limit ? -limit : duty;
+  if (braking && wantDuty * speed >= 0.0f)
+  {
+    braking = false; // Called off: back to the direction it turns, or stop.
+  } // if
+  if (!braking && wantDuty * speed < 0.0f && fabsf(speed) * 100.0f > config.reversePercent)
+  {
+    braking = true;
+    reverseStartMs = millis();
+  } // if
+  update();
+} // drive()
+
+void L298NMotorBase::brake(uint16_t duty)
+{
+  request = REQUEST_BRAKE;
+  wantDuty = duty < config.maxDuty ? duty : config.maxDuty;
+  braking = false;
+  update();
+} // brake()
+
+void L298NMotorBase::coast()
+{
+  request = REQUEST_COAST;
+  braking = false;
+  update();
+} // coast()
+
+void L298NMotorBase::setSpeedSensor(L298NSpeedSensor sensor, void *context)
+{
+  speedSensor = sensor;
+  speedContext = context;
+} // setSpeedSensor()
+
+void L298NMotorBase::setCurrentSensor(L298NCurrentSensor sensor, void *context)
+{
+  currentSensor = sensor;
+  currentContext = context;
+} // setCurrentSensor()
+
+/**
+ * @details First order model: the speed moves towards a target with a time
+ * constant. A brake at duty d is coasting for 1 - d of the time and full
+ * brake for d, so their rates add in that proportion.
+ */
+void L298NMotorBase::integrate(uint32_t elapsedMs)
+{
+  float duty = (float)outDuty / config.maxDuty;
+  float target = 0.0f;
+  float rate = 1.0f / config.coastMs; // Per millisecond.
+  if (outMode == L298N_FORWARD || outMode == L298N_REVERSE)
+  {
+    target = outMode == L298N_FORWARD ? duty : -duty;
+    rate = 1.0f / config.spinUpMs;
+  }
+  else if (outMode == L298N_BRAKE)
+  {
+    rate = (1.0f - duty) / config.coastMs + duty / config.brakeMs;
+  } // else if
+  speed = target + (speed - target) * expf(-rate * elapsedMs);
+} // integrate()
+
+/**
+ * @brief Brake duty as a fraction, lowered so that stall current x speed x
+ * duty stays under the limit.
+ */
+float L298NMotorBase::brakeFraction(float wanted) const
+{
+  float peakMa = config.stallMa * fabsf(speed);
+  if (peakMa * wanted > config.limitMa)
+  {
+    return config.limitMa / peakMa;
+  } // if
+  return wanted;
+} // brakeFraction()
+
+/**
+ * @brief Scale by the current sensor cut and apply if anything changed.
+ */
+void L298NMotorBase::output(L298NMode mode, float fraction)
+{
+  uint16_t duty = (uint16_t)(fraction * currentScale * config.maxDuty + 0.5f);
+  if (mode == L298N_COAST)
+  {
+    duty = 0;
+  } // if
+  if (mode != outMode || duty != outDuty)
+  {
+    apply(mode, duty);
+    outMode = mode;
+    outDuty = duty;
+  } // if
+} // output()
+
+/**
+ * @details Order of work: move the model on by the time the last outputs
+ * were in force, replace it with the sensor reading if there is one, then
+ * work out the new outputs.
+ */
+void L298NMotorBase::update()
+{
+  uint32_t now = millis();
+  integrate(now - lastMs);
+  lastMs = now;
+
+  if (speedSensor != nullptr)
+  {
+    int16_t percent = speedSensor(speedContext);
+    if (percent >= 0)
+    {
+      // The sensor gives the size, the model knows the direction.
+      float size = percent / 100.0f;
+      speed = speed < 0.0f ? -size : size;
+    } // if
+  } // if
+
+  bool lowered = false; // By the current limit.
+  if (currentSensor != nullptr)
+  {
+    uint16_t ma = currentSensor(currentContext);
+    if (ma > config.limitMa)
+    {
+      currentScale *= (float)config.limitMa / ma;
+      lowered = true;
+    }
+    else
+    {
+      currentScale += L298N_CURRENT_RECOVERY;
+      if (currentScale > 1.0f)
+      {
+        currentScale = 1.0f;
+      } // if
+    } // else
+  } // if
+
+  if (request == REQUEST_COAST)
+  {
+    output(L298N_COAST, 0.0f);
+    return;
+  } // if
+
+  L298NMode mode = L298N_BRAKE;
+  float wanted = (float)wantDuty / config.maxDuty;
+  float fraction;
+  float threshold = config.reversePercent / 100.0f;
+  if (braking && (fabsf(speed) <= threshold || now - reverseStartMs >= config.maxBrakeMs))
+  {
+    braking = false;
+    reversalMs = now - reverseStartMs;
+  } // if
+  if (braking)
+  {
+    wanted = 1.0f; // Brake as hard as the limit allows.
+    fraction = brakeFraction(wanted);
+  }
+  else if (request == REQUEST_BRAKE)
+  {
+    fraction = brakeFraction(wanted);
+  }
+  else
+  {
+    // The current follows the gap between duty and speed.
+    float gap = (float)config.limitMa / config.stallMa;
+    float allowed = wanted;
+    if (allowed > speed + gap)
+    {
+      allowed = speed + gap;
+    }
+    else if (allowed < speed - gap)
+    {
+      allowed = speed - gap;
+    } // else if
+    mode = allowed < 0.0f ? L298N_REVERSE : L298N_FORWARD;
+    fraction = fabsf(allowed);
+    wanted = fabsf(wanted);
+  } // else
+  if (lowered || fraction < wanted - 0.001f)
+  {
+    limited++;
+  } // if
+  output(mode, fraction);
+} // update()
@@ -0,0 +1,228 @@
+/**
+ * @file L298NMotor.h
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Speed, braking and quick direction changes for one L298N channel
+ * with PWM on EN, kept under a current limit.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details
+ * Coasting (EN low) lets a motor spin down on its own friction, which takes
+ * seconds, so the Lesson 3a sketch waited 3 s before reversing. Switching
+ * straight to the other direction at speed puts the supply voltage and the
+ * motor's own back-EMF in series: about twice the stall current through the
+ * bridge. L298NMotor does it in between:
+ * - brake(duty) shorts the motor (IN1 and IN2 high) for duty of each PWM
+ *   period and lets it coast for the rest. More duty, a harder stop.
+ * - drive(duty) the other way while the motor turns first brakes it down to
+ *   reversePercent of full speed and only then reverses. reversing() is true
+ *   while it brakes.
+ * - Every output is held under limitMa. Braking current is about stall
+ *   current x speed x brake duty, driving current about stall current x the
+ *   difference between duty and speed, so the brake starts gentle at speed
+ *   and the drive duty ramps up as the motor catches up. A current sensor
+ *   (the L298N SENSE pin through a resistor) cuts the duty further if it
+ *   reads more than the limit.
+ *
+ * The speed comes from a sensor when there is one: an encoder's count rate,
+ * or the back-EMF on a motor terminal read through a voltage divider. Without
+ * one, or while it has no reading, a model estimates it from what the bridge
+ * was told to do: the speed moves towards the drive duty with time constant
+ * spinUpMs, and towards 0 with coastMs when coasting and brakeMs with full
+ * brake. Measure yours: time how long the motor takes to stop each way.
+ *
+ * Call update() often from loop(), at least every few milliseconds while
+ * braking. It reads the clock and the sensors and changes the outputs.
+ */
+#ifndef L298N_MOTOR_H
+#define L298N_MOTOR_H
+
+#include <Arduino.h>
+#include "L298N.h"
+
+/**
+ * @brief Reads the motor speed.
+ * @return Speed in percent of full speed (0-100, either direction), or below
+ * 0 if there is no reading right now.
+ */
+typedef int16_t (*L298NSpeedSensor)(void *context);
+
+/**
+ * @brief Reads the current through the bridge in mA.
+ */
+typedef uint16_t (*L298NCurrentSensor)(void *context);
+
+/**
+ * @brief What L298NMotor needs to know about the motor and the bridge.
+ */
+struct L298NMotorConfig
+{
+  uint16_t maxDuty;       // analogWrite() value for 100 %, 255 at 8 bits.
+  uint16_t stallMa;       // Current with the shaft held at 100 % duty.
+  uint16_t limitMa;       // Most current allowed through the bridge.
+  uint8_t reversePercent; // A reversal brakes until the speed is below this.
+  uint16_t spinUpMs;      // Speed model time constants, see above.
+  uint16_t coastMs;
+  uint16_t brakeMs;
+  uint16_t maxBrakeMs;    // Longest a reversal brakes, in case the speed is wrong.
+};
+
+// Meccano ER20 on 20 V through an L298N (2 A per channel). Rough guesses,
+// not measurements: ~8 ohm winding, about 1 s to coast to a stop.
+constexpr L298NMotorConfig L298N_ER20_CONFIG = {255, 2500, 2000, 10, 300, 800, 150, 1000};
+
+/**
+ * @brief The pin independent part of L298NMotor, in L298NMotor.cpp.
+ */
+class L298NMotorBase
+{
+public:
+  explicit L298NMotorBase(const L298NMotorConfig &config);
+  virtual ~L298NMotorBase() = default;
+
+  /**
+   * @brief Run at a duty, above 0 forward and below 0 reverse (-maxDuty to
+   * maxDuty). Brakes first if the motor turns the other way.
+   */
+  void drive(int16_t duty);
+
+  /**
+   * @brief Short brake at a duty (0 to maxDuty), less if the current limit
+   * needs it.
+   */
+  void brake(uint16_t duty);
+
+  /**
+   * @brief Bridge off, the motor spins down freely.
+   */
+  void coast();
+
+  /**
+   * @brief Read the clock and sensors and update the outputs.
+   */
+  void update();
+
+  void setSpeedSensor(L298NSpeedSensor sensor, void *context);
+  void setCurrentSensor(L298NCurrentSensor sensor, void *context);
+
+  /**
+   * @brief True while drive() brakes before changing direction.
+   */
+  bool reversing() const { return braking; }
+
+  /**
+   * @brief Speed from the sensor or the model, -100 to 100 %.
+   */
+  int16_t speedPercent() const { return (int16_t)(speed * 100.0f); }
+
+  /**
+   * @brief How long the last reversal braked in milliseconds.
+   */
+  uint32_t lastReversalMs() const { return reversalMs; }
+
+  /**
+   * @brief update() calls where the current limit lowered the duty.
+   */
+  uint32_t limitedUpdates() const { return limited; }
+
+protected:
+  /**
+   * @brief Start the clock, from the derived class's begin().
+   */
+  void start();
+
+  /**
+   * @brief Change the outputs. Only called when the mode or duty changes.
+   */
+  virtual void apply(L298NMode mode, uint16_t duty) = 0;
+
+private:
+  enum Request : uint8_t
+  {
+    REQUEST_COAST = 0,
+    REQUEST_BRAKE,
+    REQUEST_DRIVE
+  };
+
+  void integrate(uint32_t elapsedMs);
+  float brakeFraction(float wanted) const;
+  void output(L298NMode mode, float fraction);
+
+  L298NMotorConfig config;
+  L298NSpeedSensor speedSensor;
+  void *speedContext;
+  L298NCurrentSensor currentSensor;
+  void *currentContext;
+  Request request;
+  int16_t wantDuty;
+  float speed;        // -1 to 1, from the sensor or the model.
+  float currentScale; // Cut by the current sensor, 1 = no cut.
+  L298NMode outMode;
+  uint16_t outDuty;
+  uint32_t lastMs;
+  bool braking;       // A reversal is braking.
+  uint32_t reverseStartMs;
+  uint32_t reversalMs;
+  uint32_t limited;
+};
+
+/**
+ * @brief One L298N channel with PWM on EN.
+ * @tparam EN ENA or ENB, a PWM pin.
+ * @tparam IN1 IN1 or IN3.
+ * @tparam IN2 IN2 or IN4.
+ */
+template <uint8_t EN, uint8_t IN1, uint8_t IN2>
+class L298NMotor : public L298NMotorBase
+{
+public:
+  explicit L298NMotor(const L298NMotorConfig &config) : L298NMotorBase(config) {}
+
+  /**
+   * @brief Set up the pins and let the motor coast. Set up the PWM timer of
+   * EN after this if it needs one (Lesson 3a).
+   * @return false if the pins do not match the board, see L298NChannel.
+   */
+  bool begin()
+  {
+    if (!channel.begin())
+    {
+      return false;
+    } // if
+    start();
+    return true;
+  } // begin()
+
+protected:
+  /**
+   * @details The duty goes down before IN1 and IN2 change and up after, so
+   * the new mode never starts at the old mode's higher duty.
+   */
+  void apply(L298NMode mode, uint16_t duty) override
+  {
+    if (mode != inputs)
+    {
+      if (duty < enDuty)
+      {
+        analogWrite(EN, duty);
+        enDuty = duty;
+      } // if
+      channel.direction(mode);
+      inputs = mode;
+    } // if
+    if (duty != enDuty)
+    {
+      analogWrite(EN, duty);
+      enDuty = duty;
+    } // if
+  } // apply()
+
+private:
+  L298NChannel<EN, IN1, IN2> channel;
+  L298NMode inputs = L298N_COAST;
+  uint16_t enDuty = 0;
+};
+
+#endif // L298N_MOTOR_H
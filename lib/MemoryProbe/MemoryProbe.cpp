@@ -0,0 +1,117 @@
+/**
+ * @file MemoryProbe.cpp
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Heap and task stack usage. See MemoryProbe.h.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ */
+#include "MemoryProbe.h"
+
+#if defined(ESP32)
+#include <esp_heap_caps.h>
+#else
+#include <malloc.h>
+#endif
+
+MemoryProbe::MemoryProbe() : taskCount(0), minFree(UINT32_MAX), minLargest(UINT32_MAX)
+{
+} // MemoryProbe()
+
+bool MemoryProbe::watchTask(const char *name)
+{
+  if (taskCount >= MEMORY_PROBE_MAX_TASKS)
+  {
+    return false;
+  } // if
+  tasks[taskCount].name = name;
+#if defined(ESP32)
+  tasks[taskCount].handle = nullptr;
+#endif
+  taskCount++;
+  return true;
+} // watchTask()
+
+/**
+ * @brief Free bytes in the heap that malloc() and new use.
+ */
+uint32_t MemoryProbe::freeHeap() const
+{
+#if defined(ESP32)
+  return heap_caps_get_free_size(MALLOC_CAP_8BIT);
+#else
+  struct mallinfo info = mallinfo();
+  return info.fordblks;
+#endif
+} // freeHeap()
+
+/**
+ * @brief Largest single allocation that would succeed right now.
+ */
+uint32_t MemoryProbe::largestFreeBlock() const
+{
+#if defined(ESP32)
+  return heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+#else
+  return 0; // Not available from newlib.
+#endif
+} // largestFreeBlock()
+
+void MemoryProbe::sample()
+{
+  uint32_t free = freeHeap();
+  if (free < minFree)
+  {
+    minFree = free;
+  } // if
+  uint32_t largest = largestFreeBlock();
+  if (largest < minLargest)
+  {
+    minLargest = largest;
+  } // if
+} // sample()
+
+void MemoryProbe::report(Stream &out)
+{
+  sample();
+#if defined(ESP32)
+  // The ESP-IDF tracks its own all-time minimum, including moments between
+  // our samples.
+  uint32_t lowest = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+  if (lowest < minFree)
+  {
+    minFree = lowest;
+  } // if
+#endif
+  out.print("<MemoryProbe> heap free=");
+  out.print(freeHeap());
+  out.print(" min=");
+  out.print(minFree);
+  out.print(" largest block=");
+  out.print(largestFreeBlock());
+  out.print(" min largest block=");
+  out.println(minLargest);
+
+  for (uint8_t i = 0; i < taskCount; i++)
+  {
+    out.print("<MemoryProbe> task ");
+    out.print(tasks[i].name);
+#if defined(ESP32)
+    if (tasks[i].handle == nullptr)
+    {
+      tasks[i].handle = xTaskGetHandle(tasks[i].name);
+    } // if
+    if (tasks[i].handle == nullptr)
+    {
+      out.println(" not found");
+      continue;
+    } // if
+    out.print(" stack free min=");
+    out.print((uint32_t)uxTaskGetStackHighWaterMark(tasks[i].handle));
+    out.println(" bytes");
+#else
+    out.println(" stack not supported on this board");
+#endif
+  } // for
+} // report()
@@ -0,0 +1,84 @@
+/**
+ * @file MemoryProbe.h
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Heap and task stack usage, tracked cheaply and printed on demand.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details
+ * A sketch that runs for weeks must not slowly lose heap, and a heap that is
+ * split into small pieces (fragmented) can fail a large allocation even with
+ * plenty of free bytes. MemoryProbe keeps the numbers that show both:
+ * - Free heap now and the lowest it has ever been.
+ * - The largest free block now and the smallest it has ever been. If this
+ *   shrinks while free heap stays the same, the heap is fragmenting.
+ * - The stack high-water mark of each watched task (the least free stack it
+ *   has ever had). Close to zero means the task is about to overflow.
+ *
+ * sample() is cheap and can be called from loop() now and then. report()
+ * walks the tasks and prints everything, so only call it when asked.
+ *
+ * On the ESP32 the numbers come from the ESP-IDF heap and FreeRTOS. On other
+ * boards only free heap is available (from the C library), and task stacks
+ * are reported as not supported.
+ */
+#ifndef MEMORY_PROBE_H
+#define MEMORY_PROBE_H
+
+#include <Arduino.h>
+
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+// Most tasks that can be watched.
+#define MEMORY_PROBE_MAX_TASKS 8
+
+class MemoryProbe
+{
+public:
+  MemoryProbe();
+
+  /**
+   * @brief Watch a task's stack. The name must stay valid (use a literal).
+   * The task is looked up by name the first time it is needed, so it can be
+   * registered before the task exists. Only watch tasks that are never
+   * deleted, the handle is kept.
+   * @return false if the table is full.
+   */
+  bool watchTask(const char *name);
+
+  /**
+   * @brief Update the low-water marks. Cheap, no task walk.
+   */
+  void sample();
+
+  /**
+   * @brief Print heap and stack usage.
+   */
+  void report(Stream &out);
+
+  uint32_t freeHeap() const;
+  uint32_t largestFreeBlock() const;
+  uint32_t minFreeHeap() const { return minFree; }
+  uint32_t minLargestFreeBlock() const { return minLargest; }
+
+private:
+  struct WatchedTask
+  {
+    const char *name;
+#if defined(ESP32)
+    TaskHandle_t handle;
+#endif
+  };
+
+  WatchedTask tasks[MEMORY_PROBE_MAX_TASKS];
+  uint8_t taskCount;
+  uint32_t minFree;
+  uint32_t minLargest;
+};
+
+#endif // MEMORY_PROBE_H
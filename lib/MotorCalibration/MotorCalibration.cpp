@@ -0,0 +1,343 @@
+/**
+ * @file MotorCalibration.cpp
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Calibration records in the data flash. See MotorCalibration.h.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ */
+#include "MotorCalibration.h"
+
+#if defined(ARDUINO_ARCH_RENESAS)
+#include "r_flash_lp.h"
+
+// Where the data flash is in the RA4M1 memory map.
+#define CALIBRATION_FLASH_BASE 0x40100000UL
+
+static flash_lp_instance_ctrl_t flashCtrl;
+static flash_cfg_t flashCfg; // The driver keeps a pointer to it.
+
+/**
+ * @details Without background operation every write and erase returns when
+ * it is done, and no flash interrupt is needed.
+ */
+static bool flashOpen()
+{
+  flashCfg.data_flash_bgo = false;
+  flashCfg.p_callback = nullptr;
+  flashCfg.irq = FSP_INVALID_VECTOR;
+  flashCfg.err_irq = FSP_INVALID_VECTOR;
+  fsp_err_t err = R_FLASH_LP_Open(&flashCtrl, &flashCfg);
+  return err == FSP_SUCCESS || err == FSP_ERR_ALREADY_OPEN;
+} // flashOpen()
+
+static const uint8_t *flashRead(uint16_t offset)
+{
+  return (const uint8_t *)(CALIBRATION_FLASH_BASE + offset);
+} // flashRead()
+
+static bool flashWrite(uint16_t offset, const uint8_t *data, uint16_t length)
+{
+  return R_FLASH_LP_Write(&flashCtrl, (uint32_t)data, CALIBRATION_FLASH_BASE + offset,
+                          length) == FSP_SUCCESS;
+} // flashWrite()
+
+static bool flashErase(uint16_t offset)
+{
+  return R_FLASH_LP_Erase(&flashCtrl, CALIBRATION_FLASH_BASE + offset, 1) == FSP_SUCCESS;
+} // flashErase()
+#else
+// Size of the RA4M1 data flash.
+#define CALIBRATION_HOST_FLASH 8192
+
+static uint8_t hostFlash[CALIBRATION_HOST_FLASH];
+static bool hostErased = false; // hostFlash is set to 0xFF on first use.
+
+static bool flashOpen()
+{
+  return true;
+} // flashOpen()
+
+static const uint8_t *flashRead(uint16_t offset)
+{
+  if (!hostErased)
+  {
+    memset(hostFlash, 0xFF, sizeof(hostFlash));
+    hostErased = true;
+  } // if
+  return hostFlash + offset;
+} // flashRead()
+
+/**
+ * @details Writing flash can only clear bits, so a byte that was not erased
+ * reads back wrong, as on the board.
+ */
+static bool flashWrite(uint16_t offset, const uint8_t *data, uint16_t length)
+{
+  uint8_t *bytes = (uint8_t *)flashRead(offset);
+  for (uint16_t i = 0; i < length; i++)
+  {
+    bytes[i] &= data[i];
+    SimHal::count(SIM_HAL_FLASH_WRITE);
+  } // for
+  return true;
+} // flashWrite()
+
+static bool flashErase(uint16_t offset)
+{
+  memset((uint8_t *)flashRead(offset), 0xFF, CALIBRATION_BLOCK_SIZE);
+  SimHal::count(SIM_HAL_FLASH_ERASE);
+  return true;
+} // flashErase()
+#endif
+
+/**
+ * @brief Where a slot is in the data flash.
+ */
+static uint16_t slotOffset(uint8_t slot)
+{
+  return CALIBRATION_START + slot * CALIBRATION_SLOT_SIZE;
+} // slotOffset()
+
+CalibrationStore::CalibrationStore() : opened(false), sequence(0), next(0)
+{
+} // CalibrationStore()
+
+/**
+ * @details Bit by bit, no table: 28 bytes are a few microseconds and the
+ * table would take 1 KB of flash.
+ */
+uint32_t CalibrationStore::crc32(const uint8_t *data, size_t length)
+{
+  uint32_t crc = 0xFFFFFFFF;
+  for (size_t i = 0; i < length; i++)
+  {
+    crc ^= data[i];
+    for (uint8_t bit = 0; bit < 8; bit++)
+    {
+      crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+    } // for
+  } // for
+  return ~crc;
+} // crc32()
+
+/**
+ * @brief True for a record of this layout that was written to the end.
+ */
+bool CalibrationStore::valid(const Record &record)
+{
+  if (record.version != CALIBRATION_VERSION)
+  {
+    return false; // Erased (0xFF) or another layout.
+  } // if
+  return record.crc == crc32((const uint8_t *)&record, sizeof(Record) - sizeof(record.crc));
+} // valid()
+
+bool CalibrationStore::blank(uint8_t slot)
+{
+  const uint8_t *bytes = flashRead(slotOffset(slot));
+  for (uint8_t i = 0; i < CALIBRATION_SLOT_SIZE; i++)
+  {
+    if (bytes[i] != 0xFF)
+    {
+      return false;
+    } // if
+  } // for
+  return true;
+} // blank()
+
+bool CalibrationStore::sameKey(const Record &a, const Record &b)
+{
+  return a.version == b.version && a.profile == b.profile &&
+         a.supplyDeciVolts == b.supplyDeciVolts;
+} // sameKey()
+
+/**
+ * @brief True if no other slot has a newer record for the same profile and
+ * voltage.
+ */
+bool CalibrationStore::newest(const Record &record, uint8_t slot) const
+{
+  Record other;
+  for (uint8_t i = 0; i < CALIBRATION_SLOTS; i++)
+  {
+    if (i == slot)
+    {
+      continue;
+    } // if
+    memcpy(&other, flashRead(slotOffset(i)), sizeof(Record));
+    if (sameKey(other, record) && other.sequence > record.sequence && valid(other))
+    {
+      return false;
+    } // if
+  } // for
+  return true;
+} // newest()
+
+uint8_t CalibrationStore::begin()
+{
+  opened = flashOpen();
+  sequence = 0;
+  next = 0;
+  if (!opened)
+  {
+    return 0;
+  } // if
+  uint8_t found = 0;
+  Record record;
+  for (uint8_t slot = 0; slot < CALIBRATION_SLOTS; slot++)
+  {
+    memcpy(&record, flashRead(slotOffset(slot)), sizeof(Record));
+    if (!valid(record))
+    {
+      continue;
+    } // if
+    found++;
+    if (record.sequence > sequence)
+    {
+      sequence = record.sequence;
+      next = (slot + 1) % CALIBRATION_SLOTS;
+    } // if
+  } // for
+  return found;
+} // begin()
+
+/**
+ * @details The cheap checks come first, so only records of the profile
+ * asked for get their CRC worked out.
+ */
+bool CalibrationStore::load(MotorProfile profile, uint16_t supplyDeciVolts,
+                            MotorCalibration &calibration) const
+{
+  if (!opened)
+  {
+    return false;
+  } // if
+  bool found = false;
+  uint16_t bestDistance = 0;
+  uint32_t bestSequence = 0;
+  Record record;
+  for (uint8_t slot = 0; slot < CALIBRATION_SLOTS; slot++)
+  {
+    memcpy(&record, flashRead(slotOffset(slot)), sizeof(Record));
+    if (record.version != CALIBRATION_VERSION || record.profile != profile)
+    {
+      continue;
+    } // if
+    uint16_t distance = record.supplyDeciVolts > supplyDeciVolts
+                            ? record.supplyDeciVolts - supplyDeciVolts
+                            : supplyDeciVolts - record.supplyDeciVolts;
+    if (distance > CALIBRATION_VOLTAGE_TOLERANCE)
+    {
+      continue;
+    } // if
+    if (found && (distance > bestDistance ||
+                  (distance == bestDistance && record.sequence < bestSequence)))
+    {
+      continue;
+    } // if
+    if (!valid(record))
+    {
+      continue;
+    } // if
+    found = true;
+    bestDistance = distance;
+    bestSequence = record.sequence;
+    calibration = record.calibration;
+  } // for
+  return found;
+} // load()
+
+/**
+ * @details The CRC is the last field, so it is the last thing the flash
+ * writes. Until it is written the record fails valid().
+ */
+bool CalibrationStore::write(Record &record)
+{
+  record.sequence = sequence + 1;
+  record.crc = crc32((const uint8_t *)&record, sizeof(Record) - sizeof(record.crc));
+  if (!flashWrite(slotOffset(next), (const uint8_t *)&record, sizeof(Record)))
+  {
+    return false;
+  } // if
+  if (memcmp(flashRead(slotOffset(next)), &record, sizeof(Record)) != 0)
+  {
+    return false;
+  } // if
+  sequence = record.sequence;
+  next = (next + 1) % CALIBRATION_SLOTS;
+  return true;
+} // write()
+
+/**
+ * @brief Erase a block and write back the records in it that are still
+ * needed, leaving next at the first empty slot.
+ * @return false if the erase failed or no slot is left.
+ */
+bool CalibrationStore::recycle(uint8_t block)
+{
+  uint8_t first = block * CALIBRATION_SLOTS_PER_BLOCK;
+  Record keep[CALIBRATION_SLOTS_PER_BLOCK];
+  uint8_t kept = 0;
+  for (uint8_t slot = first; slot < first + CALIBRATION_SLOTS_PER_BLOCK; slot++)
+  {
+    memcpy(&keep[kept], flashRead(slotOffset(slot)), sizeof(Record));
+    if (valid(keep[kept]) && newest(keep[kept], slot))
+    {
+      kept++;
+    } // if
+  } // for
+
+  if (!flashErase(CALIBRATION_START + block * CALIBRATION_BLOCK_SIZE))
+  {
+    return false;
+  } // if
+  next = first;
+  for (uint8_t i = 0; i < kept; i++)
+  {
+    if (!write(keep[i]))
+    {
+      return false;
+    } // if
+  } // for
+  return kept < CALIBRATION_SLOTS_PER_BLOCK;
+} // recycle()
+
+/**
+ * @brief Move next to an empty slot. A slot that is neither empty nor read
+ * back as a record (a write cut short) is skipped. Reaching the start of a
+ * used block recycles it.
+ */
+bool CalibrationStore::makeRoom()
+{
+  for (uint8_t tries = 0; tries < CALIBRATION_SLOTS; tries++)
+  {
+    if (blank(next))
+    {
+      return true;
+    } // if
+    if (next % CALIBRATION_SLOTS_PER_BLOCK == 0)
+    {
+      return recycle(next / CALIBRATION_SLOTS_PER_BLOCK);
+    } // if
+    next = (next + 1) % CALIBRATION_SLOTS;
+  } // for
+  return false;
+} // makeRoom()
+
+bool CalibrationStore::save(MotorProfile profile, uint16_t supplyDeciVolts,
+                            const MotorCalibration &calibration)
+{
+  if (!opened || !makeRoom())
+  {
+    return false;
+  } // if
+  Record record;
+  memset(&record, 0xFF, sizeof(record));
+  record.version = CALIBRATION_VERSION;
+  record.profile = profile;
+  record.supplyDeciVolts = supplyDeciVolts;
+  record.calibration = calibration;
+  return write(record);
+} // save()
@@ -0,0 +1,178 @@
+/**
+ * @file MotorCalibration.h
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Motor settings measured once and kept in the UNO R4's data flash,
+ * so a sketch starts with them instead of guessing or sweeping again.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details
+ * The ER20 only turns above a threshold duty that depends on the PWM
+ * frequency and the supply voltage (100 Hz and 70 of 255 at 20 V, see
+ * testEr20PwmSettings.md). Finding it is a sweep of several minutes.
+ * CalibrationStore keeps what the sweep found, for each motor profile and
+ * supply voltage, in the RA4M1's 8 KB data flash:
+ *
+ *   CalibrationStore calibration;
+ *   setup(): calibration.begin();
+ *            calibration.load(MOTOR_PROFILE_ER20, 200, cal); // 20.0 V
+ *   after a sweep: calibration.save(MOTOR_PROFILE_ER20, 200, cal);
+ *
+ * Flash wears out. A byte can only be written once, then the whole 1 KB
+ * block it is in has to be erased before it can be written again, and a
+ * block lasts a limited number of erases. The EEPROM library hides this by
+ * erasing a block for almost every byte that changes. CalibrationStore uses
+ * the flash driver of the Renesas core (r_flash_lp) directly instead:
+ * - The area is CALIBRATION_BLOCKS blocks of slots of CALIBRATION_SLOT_SIZE
+ *   bytes. A save writes the next empty slot and never writes over a record.
+ * - When the writes come round to a used block, that block is erased once
+ *   and the records in it that are still the newest for their profile and
+ *   voltage are written back first. So a block is erased once every
+ *   CALIBRATION_SLOTS_PER_BLOCK saves at most, and both blocks wear at the
+ *   same rate.
+ *
+ * Every record carries:
+ * - a sequence number, one higher each save. The highest is the newest.
+ * - the layout version CALIBRATION_VERSION. A sketch built with another
+ *   layout ignores the record and starts from its defaults.
+ * - a CRC-32 of the rest, written last. A record cut short by a reset or a
+ *   flat battery fails it and is skipped, and the save before it is used. A
+ *   reset while a block is erased and its records are written back loses
+ *   the ones not yet written back.
+ *
+ * The data flash is read like RAM, so load() reads the 2 KB area straight
+ * from memory and only works out the CRC of records for the profile asked
+ * for. It takes microseconds and the sketch has its settings before the
+ * motor starts. save() waits for the flash, much longer when it erases a
+ * block: call it from a sweep, not from a control loop. Do not use the
+ * EEPROM library in the same sketch, it keeps its own copy of the flash
+ * driver's state.
+ *
+ * On the host the data flash is an array in RAM, empty every run. Bytes
+ * written and blocks erased are counted in SimHal.
+ */
+#ifndef MOTOR_CALIBRATION_H
+#define MOTOR_CALIBRATION_H
+
+#include <Arduino.h>
+
+// Offset of the calibration area in the data flash, the last two of its
+// eight blocks.
+#define CALIBRATION_START 6144
+
+// Data flash erase block of the RA4M1.
+#define CALIBRATION_BLOCK_SIZE 1024
+
+// Blocks the calibration area takes.
+#define CALIBRATION_BLOCKS 2
+
+// Bytes per record.
+#define CALIBRATION_SLOT_SIZE 32
+
+#define CALIBRATION_SLOTS_PER_BLOCK (CALIBRATION_BLOCK_SIZE / CALIBRATION_SLOT_SIZE)
+#define CALIBRATION_SLOTS (CALIBRATION_BLOCKS * CALIBRATION_SLOTS_PER_BLOCK)
+
+// Layout of MotorCalibration. Change it whenever that struct changes.
+#define CALIBRATION_VERSION 1
+
+// A record is used for a supply this far away, in tenths of a volt.
+#define CALIBRATION_VOLTAGE_TOLERANCE 5
+
+/**
+ * @brief Motors with their own calibrations.
+ */
+enum MotorProfile : uint8_t
+{
+  MOTOR_PROFILE_ER20 = 1, // Meccano ER20 through an L298N.
+  MOTOR_PROFILE_DC        // Small DC motor, such as the Lesson 3 one.
+};
+
+/**
+ * @brief What a sweep finds out about a motor on one supply. Duty values are
+ * analogWrite() values at 8 bits (0-255).
+ */
+struct MotorCalibration
+{
+  uint16_t pwmHz;     // PWM frequency with the lowest threshold.
+  uint16_t startDuty; // Lowest duty at which the motor turns at pwmHz.
+  uint16_t kickDuty;  // Duty for kickMs when starting from standstill.
+  uint16_t kickMs;    // 0 if the motor starts at startDuty without a kick.
+};
+
+// ER20 on 20 V, from the sweep in testEr20PwmSettings.md. It starts at the
+// threshold without a kick.
+constexpr MotorCalibration ER20_20V_CALIBRATION = {100, 70, 255, 0};
+
+/**
+ * @brief Saves and loads MotorCalibrations in the data flash.
+ */
+class CalibrationStore
+{
+public:
+  CalibrationStore();
+
+  /**
+   * @brief Open the flash and find the newest record, so save() knows where
+   * to write next.
+   * @return Records found.
+   */
+  uint8_t begin();
+
+  /**
+   * @brief The newest calibration for a profile and a supply voltage within
+   * CALIBRATION_VOLTAGE_TOLERANCE, the closest voltage first.
+   * @param supplyDeciVolts Supply in tenths of a volt, 200 for 20.0 V.
+   * @param calibration Set if one was found, unchanged if not.
+   * @return false if there is none.
+   */
+  bool load(MotorProfile profile, uint16_t supplyDeciVolts,
+            MotorCalibration &calibration) const;
+
+  /**
+   * @brief Write a calibration into the next empty slot.
+   * @return false if the flash could not be written or did not read back,
+   * or every slot holds the newest record of a different profile and
+   * voltage.
+   */
+  bool save(MotorProfile profile, uint16_t supplyDeciVolts,
+            const MotorCalibration &calibration);
+
+  /**
+   * @brief Sequence number of the newest record, 0 with none.
+   */
+  uint32_t saves() const { return sequence; }
+
+private:
+  /**
+   * @brief One slot in the flash, CALIBRATION_SLOT_SIZE bytes.
+   */
+  struct Record
+  {
+    uint8_t version;
+    uint8_t profile;
+    uint16_t supplyDeciVolts;
+    uint32_t sequence;
+    MotorCalibration calibration;
+    uint8_t reserved[CALIBRATION_SLOT_SIZE - 20]; // Left erased, 0xFF.
+    uint32_t crc;                                 // Of everything above.
+  };
+  static_assert(sizeof(Record) == CALIBRATION_SLOT_SIZE,
+                "A calibration record must fill exactly one slot");
+
+  static uint32_t crc32(const uint8_t *data, size_t length);
+  static bool valid(const Record &record);
+  static bool blank(uint8_t slot);
+  static bool sameKey(const Record &a, const Record &b);
+  bool newest(const Record &record, uint8_t slot) const;
+  bool makeRoom();
+  bool recycle(uint8_t block);
+  bool write(Record &record);
+
+  bool opened;       // The flash driver is open.
+  uint32_t sequence; // Newest record's sequence, 0 with none.
+  uint8_t next;      // Slot the next write() goes to.
+};
+
+#endif // MOTOR_CALIBRATION_H
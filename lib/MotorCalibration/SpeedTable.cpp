@@ -0,0 +1,97 @@
+/**
+ * @file SpeedTable.cpp
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Building speed tables. See SpeedTable.h.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ */
+#include "SpeedTable.h"
+
+SpeedTable::SpeedTable() : supply(0), hz(0)
+{
+  for (uint8_t i = 0; i < SPEED_TABLE_POINTS; i++)
+  {
+    point[i] = 0;
+  } // for
+} // SpeedTable()
+
+bool SpeedTable::fromCalibration(const MotorCalibration &calibration,
+                                 uint16_t supplyDeciVolts, uint32_t period)
+{
+  if (period == 0)
+  {
+    return false;
+  } // if
+  uint32_t threshold = (uint32_t)((uint64_t)calibration.startDuty * period / 255);
+  for (uint8_t i = 0; i < SPEED_TABLE_POINTS; i++)
+  {
+    point[i] = threshold + (uint32_t)((uint64_t)(period - threshold) * i / SPEED_TABLE_SEGMENTS);
+  } // for
+  supply = supplyDeciVolts;
+  hz = calibration.pwmHz;
+  return true;
+} // fromCalibration()
+
+/**
+ * @details The top speed is the last sample's. If the sweep stopped short of
+ * the full period, the motor is taken to reach no more than that at full.
+ */
+bool SpeedTable::fromSweep(const SpeedSample *samples, uint8_t count,
+                           uint16_t supplyDeciVolts, uint16_t pwmHz, uint32_t period)
+{
+  if (count == 0 || samples[count - 1].speed == 0 || samples[count - 1].counts > period)
+  {
+    return false;
+  } // if
+  uint8_t first = count; // First sample where the motor turns.
+  for (uint8_t i = 0; i < count; i++)
+  {
+    if (i > 0 && (samples[i].counts < samples[i - 1].counts ||
+                  samples[i].speed < samples[i - 1].speed))
+    {
+      return false;
+    } // if
+    if (first == count && samples[i].speed > 0)
+    {
+      first = i;
+    } // if
+  } // for
+
+  uint32_t top = samples[count - 1].speed;
+  uint32_t built[SPEED_TABLE_POINTS];
+  built[0] = samples[first].counts;
+  built[SPEED_TABLE_SEGMENTS] = period;
+  uint8_t j = first;
+  for (uint8_t k = 1; k < SPEED_TABLE_SEGMENTS; k++)
+  {
+    uint32_t target = top * k / SPEED_TABLE_SEGMENTS;
+    while (samples[j].speed < target)
+    {
+      j++; // Stops at the last sample, its speed is top.
+    } // while
+    uint32_t counts = samples[j].counts;
+    if (j > first)
+    {
+      // Between the sample below the target and this one.
+      const SpeedSample &below = samples[j - 1];
+      counts = below.counts + (uint32_t)((uint64_t)(samples[j].counts - below.counts) *
+                                         (target - below.speed) /
+                                         (samples[j].speed - below.speed));
+    } // if
+    if (counts < built[k - 1])
+    {
+      counts = built[k - 1];
+    } // if
+    built[k] = counts;
+  } // for
+
+  for (uint8_t i = 0; i < SPEED_TABLE_POINTS; i++)
+  {
+    point[i] = built[i];
+  } // for
+  supply = supplyDeciVolts;
+  hz = pwmHz;
+  return true;
+} // fromSweep()
@@ -0,0 +1,145 @@
+/**
+ * @file SpeedTable.h
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Turns a speed from 0 to 100 % into PWM timer counts, so equal steps
+ * of speed make equal steps of motor speed.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details
+ * The ER20 at 20 V and 100 Hz does not turn below duty 70 of 255, and above
+ * that its speed does not rise in step with the duty. Asked for speed 20 it
+ * does nothing, and the steps above the threshold are uneven. A SpeedTable
+ * fixes both:
+ * - 0 is stop. Any speed above 0 starts at the threshold and 100 % is the
+ *   full period, so the whole command range is range the motor uses.
+ * - In between, SPEED_TABLE_POINTS points, one every 1/16 of full speed,
+ *   give the counts for that speed. counts() interpolates between the two
+ *   points around the speed asked for.
+ * - Speeds and counts are integers: a speed is 0 to SPEED_FULL (65535 =
+ *   100 %), the top 4 bits pick the segment and the low 12 bits the place
+ *   in it. counts() is a shift, a mask, one multiply and no loop, the same
+ *   few cycles for every speed.
+ * - Counts are timer counts of the PWM period (see PwmOut in the UNO R4
+ *   core), not 8-bit analogWrite() values, so a step is as fine as the
+ *   timer allows: 1 of 30000 at 100 Hz instead of 1 of 255.
+ *
+ * A table belongs to one supply voltage and one PWM frequency, because the
+ * threshold and the curve move with both. Build it at boot:
+ * - fromCalibration(): from a MotorCalibration (lib/MotorCalibration) for
+ *   the supply. Only the threshold is known, so above it counts rise in a
+ *   straight line.
+ * - fromSweep(): from speeds measured at a series of duty cycles, with a
+ *   tachometer or an encoder. The points are placed where the measured
+ *   speed reaches each 1/16 of the top speed, which straightens out the
+ *   motor's curve as well.
+ */
+#ifndef SPEED_TABLE_H
+#define SPEED_TABLE_H
+
+#include <Arduino.h>
+#include "MotorCalibration.h"
+
+// Speed for 100 %. 0 is stop.
+#define SPEED_FULL 65535
+
+// Segments of the table, a power of two, and the low speed bits that place
+// a speed inside one.
+#define SPEED_TABLE_SEGMENTS 16
+#define SPEED_TABLE_FRACTION_BITS 12
+
+#define SPEED_TABLE_POINTS (SPEED_TABLE_SEGMENTS + 1)
+
+/**
+ * @brief One step of a sweep: the counts the timer was set to and the speed
+ * measured, in any unit (rpm, encoder counts a second).
+ */
+struct SpeedSample
+{
+  uint32_t counts;
+  uint16_t speed;
+};
+
+/**
+ * @brief Speed to timer counts for one supply voltage and PWM frequency.
+ */
+class SpeedTable
+{
+public:
+  SpeedTable();
+
+  /**
+   * @brief A straight line from the calibrated threshold to full.
+   * @param period Timer counts of one PWM period at calibration.pwmHz.
+   * @return false if the period is 0.
+   */
+  bool fromCalibration(const MotorCalibration &calibration, uint16_t supplyDeciVolts,
+                       uint32_t period);
+
+  /**
+   * @brief Points where the measured speed reaches each 1/16 of the top
+   * speed.
+   * @param samples Sorted by counts, speeds never going down, the motor
+   * turning in the last one.
+   * @param period Timer counts of one PWM period at pwmHz.
+   * @return false if the samples are not sorted or the motor never turned.
+   * The table is unchanged then.
+   */
+  bool fromSweep(const SpeedSample *samples, uint8_t count, uint16_t supplyDeciVolts,
+                 uint16_t pwmHz, uint32_t period);
+
+  /**
+   * @brief Timer counts for a speed, 0 to SPEED_FULL.
+   */
+  uint32_t counts(uint16_t speed) const
+  {
+    if (speed == 0)
+    {
+      return 0;
+    } // if
+    if (speed == SPEED_FULL)
+    {
+      return point[SPEED_TABLE_SEGMENTS];
+    } // if
+    uint8_t segment = speed >> SPEED_TABLE_FRACTION_BITS;
+    uint32_t fraction = speed & ((1U << SPEED_TABLE_FRACTION_BITS) - 1);
+    uint32_t low = point[segment];
+    return low + (((point[segment + 1] - low) * fraction) >> SPEED_TABLE_FRACTION_BITS);
+  } // counts()
+
+  /**
+   * @brief Speed for a percentage, 0 to 100.
+   */
+  static uint16_t fromPercent(float percent)
+  {
+    if (percent <= 0)
+    {
+      return 0;
+    } // if
+    if (percent >= 100)
+    {
+      return SPEED_FULL;
+    } // if
+    uint16_t speed = (uint16_t)(percent * SPEED_FULL / 100.0f + 0.5f);
+    return speed == 0 ? 1 : speed; // Above 0 always turns.
+  } // fromPercent()
+
+  /**
+   * @brief Counts at a point, 0 (the threshold) to SPEED_TABLE_SEGMENTS
+   * (full).
+   */
+  uint32_t at(uint8_t index) const { return point[index]; }
+
+  uint16_t supplyDeciVolts() const { return supply; }
+  uint16_t pwmHz() const { return hz; }
+  uint32_t period() const { return point[SPEED_TABLE_SEGMENTS]; }
+
+private:
+  uint32_t point[SPEED_TABLE_POINTS]; // Never going down.
+  uint16_t supply;
+  uint16_t hz;
+};
+
+#endif // SPEED_TABLE_H
@@ -0,0 +1,400 @@
+/**
+ * @file RobotClient.cpp
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Client (controller) side of the RobotLink protocol, without the
+ * radio. See RobotClient.h.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ */
+#include "RobotClient.h"
+
+RobotClient::RobotClient(RobotLinkTransport &link)
+    : framesSent(0), writesSent(0), writesRefused(0), telemetrySamples(0),
+      telemetryNotifications(0), telemetryBytes(0), link(link),
+      telemetryMode(ROBOT_TELEMETRY_MODE_PACKED), nextSeq(0), lastSendUs(0),
+      fieldSampleSeq(0), nextSyncSeq(0)
+{
+  memset(&latestTelemetry, 0, sizeof(latestTelemetry));
+  memset(&fieldSample, 0, sizeof(fieldSample));
+  memset(sentHistory, 0, sizeof(sentHistory));
+} // RobotClient()
+
+void RobotClient::startStream()
+{
+  nextSeq = 0;
+  lastSendUs = 0;
+  framesSent = 0;
+  writesSent = 0;
+  writesRefused = 0;
+  RobotSetpoint stale;
+  while (setpointQueue.pop(stale))
+  {
+  } // while
+  setpointQueue.resetDropped();
+  streamLatency.reset();
+  uplinkLatency.reset();
+  downlinkLatency.reset();
+  memset(sentHistory, 0, sizeof(sentHistory));
+  AckRecord staleAck;
+  while (ackRing.pop(staleAck))
+  {
+  } // while
+} // startStream()
+
+void RobotClient::resetTelemetry()
+{
+  TelemetryRecord stale;
+  while (telemetryRing.pop(stale))
+  {
+  } // while
+  telemetryNotifications = 0;
+  telemetryBytes = 0;
+  telemetryRing.overruns = 0;
+  fieldSampleSeq = 0;
+  memset(&fieldSample, 0, sizeof(fieldSample));
+  memset(&latestTelemetry, 0, sizeof(latestTelemetry));
+  telemetrySeq.reset();
+  telemetrySamples = 0;
+  telemetryAge.reset();
+} // resetTelemetry()
+
+void RobotClient::resetTimeSync()
+{
+  clock.reset();
+  SyncRecord stale;
+  while (syncRing.pop(stale))
+  {
+  } // while
+} // resetTimeSync()
+
+void RobotClient::onMessage(uint8_t channel, const uint8_t *data,
+                            size_t length)
+{
+  if (channel == ROBOT_CHANNEL_SETPOINT)
+  {
+    onAck(data, length);
+  }
+  else if (channel == ROBOT_CHANNEL_TELEMETRY)
+  {
+    onTelemetry(data, length);
+  }
+  else if (channel == ROBOT_CHANNEL_TIME_SYNC)
+  {
+    onTimeSync(data, length);
+  }
+  else if (channel >= ROBOT_CHANNEL_FIELD_0 && channel < ROBOT_CHANNELS)
+  {
+    onTelemetryField(channel - ROBOT_CHANNEL_FIELD_0, data, length);
+  } // else if
+} // onMessage()
+
+void RobotClient::onAck(const uint8_t *data, size_t length)
+{
+  if (length < ROBOT_ACK_SIZE)
+  {
+    return;
+  } // if
+  AckRecord ack;
+  ack.seq = data[0] | (data[1] << 8);
+  ack.appliedUs = (uint32_t)data[2] | ((uint32_t)data[3] << 8) |
+                  ((uint32_t)data[4] << 16) | ((uint32_t)data[5] << 24);
+  ack.receivedUs = micros();
+  ackRing.push(ack); // Dropped if loop() is behind.
+} // onAck()
+
+void RobotClient::pushTelemetry(const RobotTelemetry &t)
+{
+  TelemetryRecord record = {t, (uint32_t)micros()};
+  telemetryRing.push(record); // Dropped and counted if loop() is behind.
+} // pushTelemetry()
+
+void RobotClient::onTelemetry(const uint8_t *data, size_t length)
+{
+  telemetryNotifications++;
+  telemetryBytes += length;
+  RobotTelemetry batch[ROBOT_TELEMETRY_MAX_BATCH];
+  uint8_t count = decodeTelemetryBatch(data, length, batch, ROBOT_TELEMETRY_MAX_BATCH);
+  for (uint8_t i = 0; i < count; i++)
+  {
+    pushTelemetry(batch[i]);
+  } // for
+} // onTelemetry()
+
+/**
+ * @brief The errors field is sent last, so it completes a sample.
+ */
+void RobotClient::onTelemetryField(uint8_t field, const uint8_t *data,
+                                   size_t length)
+{
+  telemetryNotifications++;
+  telemetryBytes += length;
+  decodeTelemetryField(field, data, length, fieldSample);
+  if (field == ROBOT_FIELD_ERRORS)
+  {
+    fieldSample.seq = fieldSampleSeq++;
+    fieldSample.sampleUs = micros();
+    pushTelemetry(fieldSample);
+  } // if
+} // onTelemetryField()
+
+/**
+ * @brief The receive time is taken here, in the BLE task, as close to the
+ * radio as the sketch gets.
+ */
+void RobotClient::onTimeSync(const uint8_t *data, size_t length)
+{
+  uint32_t receivedUs = micros();
+  if (length < ROBOT_TIME_PONG_SIZE)
+  {
+    return;
+  } // if
+  SyncRecord record;
+  decodeTimeSync(data, length, record.sync);
+  record.receivedUs = receivedUs;
+  syncRing.push(record); // Dropped if loop() is behind.
+} // onTimeSync()
+
+bool RobotClient::sendCommand(uint8_t value)
+{
+  return link.send(ROBOT_CHANNEL_COMMAND, &value, 1);
+} // sendCommand()
+
+bool RobotClient::sendTelemetryConfig(uint16_t rateHz, uint16_t holdMs,
+                                      uint8_t mode)
+{
+  RobotTelemetryConfig config;
+  config.rateHz = rateHz;
+  config.mtu = link.mtu();
+  config.holdMs = holdMs;
+  config.mode = mode;
+  telemetryMode = mode;
+  uint8_t buffer[ROBOT_TELEMETRY_CONFIG_SIZE];
+  encodeTelemetryConfig(config, buffer);
+  return link.send(ROBOT_CHANNEL_TELEMETRY_CONFIG, buffer, sizeof(buffer));
+} // sendTelemetryConfig()
+
+bool RobotClient::sendTimeSync()
+{
+  RobotTimeSync sync = {nextSyncSeq++, 0, 0, 0};
+  uint8_t buffer[ROBOT_TIME_PONG_SIZE];
+  sync.clientSendUs = micros();
+  encodeTimeSync(sync, buffer);
+  return link.send(ROBOT_CHANNEL_TIME_SYNC, buffer, ROBOT_TIME_PING_SIZE);
+} // sendTimeSync()
+
+void RobotClient::processTimeSync(uint32_t intervalUs)
+{
+  SyncRecord record;
+  while (syncRing.pop(record))
+  {
+    clock.addSample(record.sync, record.receivedUs, intervalUs);
+  } // while
+} // processTimeSync()
+
+/**
+ * @brief A one-way time from two clocks can come out slightly negative
+ * while the estimate settles. Count it as 0.
+ */
+static uint32_t oneWayUs(uint32_t fromUs, uint32_t toUs)
+{
+  int32_t elapsed = (int32_t)(toUs - fromUs);
+  return elapsed > 0 ? elapsed : 0;
+} // oneWayUs()
+
+void RobotClient::queueSetpoint(RobotSetpoint sp)
+{
+  sp.seq = nextSeq++;
+  setpointQueue.push(sp);
+} // queueSetpoint()
+
+bool RobotClient::sendSetpoints(uint32_t intervalUs)
+{
+  if (setpointQueue.size() == 0 || micros() - lastSendUs < intervalUs)
+  {
+    return false;
+  } // if
+  // The MTU exchange may finish after the link comes up, so check it here.
+  uint8_t batchLimit = setpointsPerWrite(link.mtu());
+  uint8_t buffer[ROBOT_SETPOINT_SIZE * ROBOT_SETPOINT_MAX_BATCH];
+  uint8_t frames = 0;
+  RobotSetpoint sp;
+  while (frames < batchLimit && setpointQueue.peek(frames, sp))
+  {
+    encodeSetpoint(sp, buffer + frames * ROBOT_SETPOINT_SIZE);
+    frames++;
+  } // while
+  lastSendUs = micros();
+  if (!link.send(ROBOT_CHANNEL_SETPOINT, buffer, frames * ROBOT_SETPOINT_SIZE))
+  {
+    // Congested or going down. The frames stay queued, and if the link stays
+    // behind the queue drops the oldest and counts them.
+    writesRefused++;
+    return false;
+  } // if
+  for (uint8_t i = 0; i < frames; i++)
+  {
+    setpointQueue.peek(i, sp);
+    sentHistory[sp.seq % ROBOT_SENT_HISTORY].seq = sp.seq;
+    sentHistory[sp.seq % ROBOT_SENT_HISTORY].sentUs = sp.sentUs;
+  } // for
+  setpointQueue.discard(frames);
+  framesSent += frames;
+  writesSent++;
+  return true;
+} // sendSetpoints()
+
+void RobotClient::processAcks()
+{
+  AckRecord ack;
+  while (ackRing.pop(ack))
+  {
+    const SentRecord &sent = sentHistory[ack.seq % ROBOT_SENT_HISTORY];
+    if (sent.seq == ack.seq)
+    {
+      streamLatency.add(ack.receivedUs - sent.sentUs);
+      if (clock.valid())
+      {
+        uint32_t appliedUs = clock.toClientUs(ack.appliedUs);
+        uplinkLatency.add(oneWayUs(sent.sentUs, appliedUs));
+        downlinkLatency.add(oneWayUs(appliedUs, ack.receivedUs));
+      } // if
+    } // if
+  } // while
+} // processAcks()
+
+uint8_t RobotClient::processTelemetry()
+{
+  uint8_t taken = 0;
+  TelemetryRecord record;
+  while (telemetryRing.pop(record))
+  {
+    latestTelemetry = record.sample;
+    telemetrySeq.record(latestTelemetry.seq);
+    if (clock.valid() && telemetryMode == ROBOT_TELEMETRY_MODE_PACKED)
+    {
+      telemetryAge.add(oneWayUs(clock.toClientUs(latestTelemetry.sampleUs),
+                                record.receivedUs));
+    } // if
+    telemetrySamples++;
+    taken++;
+  } // while
+  return taken;
+} // processTelemetry()
+
+/**
+ * @details Round trip is from producing a frame to receiving the server's
+ * acknowledgement, so it includes queueing, one trip each way and the time
+ * the server takes to apply it. Once the clock is in sync it is split into
+ * up (produced to applied on the server) and down (applied to acknowledged).
+ */
+void RobotClient::printStreamReport(Print &out, float seconds)
+{
+  out.print(" stream: msgs/s=");
+  out.print(framesSent / seconds, 1);
+  out.print(" writes/s=");
+  out.print(writesSent / seconds, 1);
+  out.print(" refused=");
+  out.print(writesRefused);
+  out.print(" dropped=");
+  out.print(setpointQueue.dropped());
+  out.print(" acks=");
+  out.print(streamLatency.count());
+  out.print(" round trip us p50/p99/max=");
+  out.print(streamLatency.percentileUs(50));
+  out.print("/");
+  out.print(streamLatency.percentileUs(99));
+  out.print("/");
+  out.print(streamLatency.maxUs());
+  if (uplinkLatency.count() > 0)
+  {
+    out.print(" one-way us p50/p99 up=");
+    out.print(uplinkLatency.percentileUs(50));
+    out.print("/");
+    out.print(uplinkLatency.percentileUs(99));
+    out.print(" down=");
+    out.print(downlinkLatency.percentileUs(50));
+    out.print("/");
+    out.print(downlinkLatency.percentileUs(99));
+  } // if
+  out.println();
+  framesSent = 0;
+  writesSent = 0;
+  writesRefused = 0;
+  setpointQueue.resetDropped();
+  streamLatency.reset();
+  uplinkLatency.reset();
+  downlinkLatency.reset();
+} // printStreamReport()
+
+/**
+ * @details Compare notifications/s and bytes/s between the two telemetry
+ * modes: packed mode carries the same samples in far fewer, fuller
+ * notifications. Lost counts gaps in the server's sequence numbers and only
+ * means something in packed mode.
+ */
+void RobotClient::printTelemetryReport(Print &out, float seconds)
+{
+  out.print(" telemetry: mode=");
+  out.print(telemetryMode == ROBOT_TELEMETRY_MODE_FIELDS ? "fields" : "packed");
+  out.print(" samples/s=");
+  out.print(telemetrySamples / seconds, 1);
+  out.print(" notifications/s=");
+  out.print(telemetryNotifications.exchange(0) / seconds, 1);
+  out.print(" bytes/s=");
+  out.print(telemetryBytes.exchange(0) / seconds, 1);
+  out.print(" lost=");
+  out.print(telemetrySeq.lost);
+  out.print(" overruns=");
+  out.print(telemetryRing.overruns.exchange(0));
+  if (telemetryAge.count() > 0)
+  {
+    out.print(" age us p50/p99=");
+    out.print(telemetryAge.percentileUs(50));
+    out.print("/");
+    out.print(telemetryAge.percentileUs(99));
+  } // if
+  out.println();
+
+  static const char *const directions[] = {"STOP", "FWD", "REV", "BRAKE"};
+  const RobotTelemetry &t = latestTelemetry;
+  out.print("  duty L/R=");
+  out.print(t.dutyLeft);
+  out.print("/");
+  out.print(t.dutyRight);
+  out.print(" pwm=");
+  out.print(t.pwmHz);
+  out.print(" Hz state=");
+  out.print(directions[t.state & ROBOT_STATE_DIR_MASK]);
+  out.print(" joy=");
+  out.print(t.joyX);
+  out.print(",");
+  out.print(t.joyY);
+  out.print(" supply=");
+  out.print(t.supplyMv);
+  out.print(" mV errors=0x");
+  out.println(t.errors, HEX);
+
+  telemetrySamples = 0;
+  telemetrySeq.lost = 0;
+  telemetryAge.reset();
+} // printTelemetryReport()
+
+void RobotClient::printClockReport(Print &out) const
+{
+  if (!clock.valid())
+  {
+    out.print(" clock: not in sync yet, exchanges=");
+    out.println(clock.exchanges());
+    return;
+  } // if
+  out.print(" clock: server-client offset us=");
+  out.print((long)(int32_t)(clock.toServerUs(micros()) - micros()));
+  out.print(" drift ppm=");
+  out.print(clock.driftPpm(), 1);
+  out.print(" best round trip us=");
+  out.print(clock.roundTripUs());
+  out.print(" exchanges=");
+  out.println(clock.exchanges());
+} // printClockReport()
@@ -0,0 +1,207 @@
+/**
+ * @file RobotClient.h
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Client (controller) side of the RobotLink protocol, without the
+ * radio.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details
+ * One RobotClient talks to one server: it numbers and batches setpoints,
+ * times their acknowledgements, sends commands and the telemetry config,
+ * collects telemetry and keeps a ClockSync of the server's clock. With the
+ * clock in sync, the server's timestamps split every round trip into its
+ * two one-way hops. Messages go out through a RobotLinkTransport and come
+ * in through onMessage(), so the same code runs over the ESP32 BLE stack on
+ * the board and over SimBleLink on the host.
+ *
+ * Threads: on the ESP32 notifications arrive in the BLE task. onMessage() is
+ * the only function that may be called there. It hands acknowledgements and
+ * telemetry samples to loop() through single-producer/single-consumer rings
+ * and atomic counters. Everything else is called from loop().
+ */
+#ifndef ROBOT_CLIENT_H
+#define ROBOT_CLIENT_H
+
+#include <RobotLink.h>
+#include <RobotLinkTransport.h>
+#include <SpscRing.h> // See lib/EventBus.
+#include <atomic>
+
+// Send time of recent frames, indexed by sequence number, so an
+// acknowledgement can be timed.
+#define ROBOT_SENT_HISTORY 64
+
+// Acknowledgements waiting for processAcks().
+#define ROBOT_ACK_RING 16
+
+// Telemetry samples waiting for processTelemetry().
+#define ROBOT_TELEMETRY_RING 32
+
+// Time sync replies waiting for processTimeSync().
+#define ROBOT_SYNC_RING 4
+
+class RobotClient
+{
+public:
+  explicit RobotClient(RobotLinkTransport &link);
+
+  /**
+   * @brief Start a new setpoint stream (new link). Sequence numbers start
+   * from 0 again and the stream counters are cleared.
+   */
+  void startStream();
+
+  /**
+   * @brief Start telemetry counting over for a new link. Call before
+   * notifications are turned on, so onMessage() is not running yet.
+   */
+  void resetTelemetry();
+
+  /**
+   * @brief Handle one notification from the server. Safe to call from the
+   * BLE task.
+   */
+  void onMessage(uint8_t channel, const uint8_t *data, size_t length);
+
+  bool sendCommand(uint8_t value);
+
+  /**
+   * @brief Tell the server what telemetry to send. The MTU is included so the
+   * server can fill each notification.
+   */
+  bool sendTelemetryConfig(uint16_t rateHz, uint16_t holdMs, uint8_t mode);
+
+  /**
+   * @brief Send one time sync ping. Send them regularly (every 100 ms or so)
+   * so the drift can be followed.
+   */
+  bool sendTimeSync();
+
+  /**
+   * @brief Feed the replies onMessage() received to the clock.
+   * @param intervalUs Connection interval, 0 if unknown. See ClockSync.
+   */
+  void processTimeSync(uint32_t intervalUs);
+
+  /**
+   * @brief Forget the clock estimate (new link, the server may have reset).
+   */
+  void resetTimeSync();
+
+  /**
+   * @brief Number a setpoint in this link's sequence and queue it. The oldest
+   * frame is dropped if the link is behind.
+   */
+  void queueSetpoint(RobotSetpoint sp);
+
+  /**
+   * @brief Send the queued frames as one write, at most once per intervalUs.
+   * Frames leave the queue only when the radio takes the write. A refused
+   * write is tried again after another interval.
+   * @return true if a write went out.
+   */
+  bool sendSetpoints(uint32_t intervalUs);
+
+  /**
+   * @brief Time every acknowledgement against the frame's production time.
+   */
+  void processAcks();
+
+  /**
+   * @brief Take the samples onMessage() decoded.
+   * @return Number of samples taken.
+   */
+  uint8_t processTelemetry();
+
+  /**
+   * @brief Print the rest of a stream report line (rate, drops, round trip)
+   * for a window of the given length, then start a new window.
+   */
+  void printStreamReport(Print &out, float seconds);
+
+  /**
+   * @brief Print the rest of a telemetry report line and the newest sample,
+   * then start a new window.
+   */
+  void printTelemetryReport(Print &out, float seconds);
+
+  /**
+   * @brief Print the rest of a line with the clock offset, drift and the
+   * round trip of the exchange behind them.
+   */
+  void printClockReport(Print &out) const;
+
+  // Stream, loop() only.
+  SetpointQueue setpointQueue;    // Frames waiting to be sent.
+  LatencyHistogram streamLatency; // Produced-to-acknowledged time.
+  LatencyHistogram uplinkLatency; // Produced-to-applied (needs the clock).
+  LatencyHistogram downlinkLatency; // Applied-to-acknowledged (needs the clock).
+  uint32_t framesSent;
+  uint32_t writesSent;
+  uint32_t writesRefused;         // Writes the radio did not take, frames kept.
+
+  // Telemetry, loop() only.
+  SequenceTracker telemetrySeq;   // Lost packed samples.
+  RobotTelemetry latestTelemetry; // Newest sample.
+  uint32_t telemetrySamples;
+  LatencyHistogram telemetryAge;  // Sampled-to-received, packed mode only.
+
+  // Server clock, loop() only.
+  ClockSync clock;
+
+  // Written by onMessage().
+  std::atomic<uint32_t> telemetryNotifications;
+  std::atomic<uint32_t> telemetryBytes; // Payload bytes received.
+
+private:
+  struct SentRecord
+  {
+    uint16_t seq;
+    uint32_t sentUs;
+  };
+
+  struct AckRecord
+  {
+    uint16_t seq;
+    uint32_t appliedUs;  // Server clock.
+    uint32_t receivedUs;
+  };
+
+  struct TelemetryRecord
+  {
+    RobotTelemetry sample;
+    uint32_t receivedUs;
+  };
+
+  struct SyncRecord
+  {
+    RobotTimeSync sync;
+    uint32_t receivedUs;
+  };
+
+  void onAck(const uint8_t *data, size_t length);
+  void onTelemetry(const uint8_t *data, size_t length);
+  void onTelemetryField(uint8_t field, const uint8_t *data, size_t length);
+  void onTimeSync(const uint8_t *data, size_t length);
+  void pushTelemetry(const RobotTelemetry &t);
+
+  RobotLinkTransport &link;
+  uint8_t telemetryMode;          // Mode asked for in the last config.
+
+  uint16_t nextSeq;
+  unsigned long lastSendUs;
+  SentRecord sentHistory[ROBOT_SENT_HISTORY];
+  SpscRing<AckRecord, ROBOT_ACK_RING> ackRing;
+
+  SpscRing<TelemetryRecord, ROBOT_TELEMETRY_RING> telemetryRing;
+  RobotTelemetry fieldSample;     // Per-field sample being assembled.
+  uint16_t fieldSampleSeq;        // Per-field samples carry no sequence number.
+
+  uint16_t nextSyncSeq;
+  SpscRing<SyncRecord, ROBOT_SYNC_RING> syncRing;
+};
+
+#endif // ROBOT_CLIENT_H
@@ -0,0 +1,528 @@
+/**
+ * @file RobotLink.cpp
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Message formats and helpers shared by the BLE client and server.
+ * See RobotLink.h.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ */
+#include "RobotLink.h"
+
+// ATT write header (opcode + handle) that comes out of the MTU.
+#define ATT_WRITE_HEADER 3
+
+/**
+ * @brief Write a setpoint as little-endian bytes. The layout does not depend
+ * on the compiler's struct packing, so both boards agree on it.
+ */
+void encodeSetpoint(const RobotSetpoint &sp, uint8_t *out)
+{
+  out[0] = sp.seq & 0xFF;
+  out[1] = sp.seq >> 8;
+  out[2] = sp.sentUs & 0xFF;
+  out[3] = (sp.sentUs >> 8) & 0xFF;
+  out[4] = (sp.sentUs >> 16) & 0xFF;
+  out[5] = sp.sentUs >> 24;
+  out[6] = (uint16_t)sp.joyX & 0xFF;
+  out[7] = (uint16_t)sp.joyX >> 8;
+  out[8] = (uint16_t)sp.joyY & 0xFF;
+  out[9] = (uint16_t)sp.joyY >> 8;
+  out[10] = sp.dutyLeft;
+  out[11] = sp.dutyRight;
+  out[12] = sp.flags;
+} // encodeSetpoint()
+
+/**
+ * @brief Read a setpoint written by encodeSetpoint().
+ */
+void decodeSetpoint(const uint8_t *in, RobotSetpoint &sp)
+{
+  sp.seq = in[0] | (in[1] << 8);
+  sp.sentUs = (uint32_t)in[2] | ((uint32_t)in[3] << 8) |
+              ((uint32_t)in[4] << 16) | ((uint32_t)in[5] << 24);
+  sp.joyX = (int16_t)(in[6] | (in[7] << 8));
+  sp.joyY = (int16_t)(in[8] | (in[9] << 8));
+  sp.dutyLeft = in[10];
+  sp.dutyRight = in[11];
+  sp.flags = in[12];
+} // decodeSetpoint()
+
+/**
+ * @brief Frames that fit in one write for a negotiated ATT MTU.
+ */
+uint8_t setpointsPerWrite(uint16_t mtu)
+{
+  if (mtu <= ATT_WRITE_HEADER + ROBOT_SETPOINT_SIZE)
+  {
+    return 1;
+  } // if
+  uint16_t frames = (mtu - ATT_WRITE_HEADER) / ROBOT_SETPOINT_SIZE;
+  return frames > ROBOT_SETPOINT_MAX_BATCH ? ROBOT_SETPOINT_MAX_BATCH : frames;
+} // setpointsPerWrite()
+
+/**
+ * @brief Little-endian helpers for the encoders below.
+ */
+static void put16(uint8_t *out, uint16_t value)
+{
+  out[0] = value & 0xFF;
+  out[1] = value >> 8;
+} // put16()
+
+static uint16_t get16(const uint8_t *in)
+{
+  return in[0] | (in[1] << 8);
+} // get16()
+
+static void put32(uint8_t *out, uint32_t value)
+{
+  put16(out, value & 0xFFFF);
+  put16(out + 2, value >> 16);
+} // put32()
+
+static uint32_t get32(const uint8_t *in)
+{
+  return get16(in) | ((uint32_t)get16(in + 2) << 16);
+} // get32()
+
+void encodeTelemetry(const RobotTelemetry &t, uint8_t *out)
+{
+  put16(out, t.seq);
+  put16(out + 2, t.sampleUs & 0xFFFF);
+  put16(out + 4, t.sampleUs >> 16);
+  put16(out + 6, t.dutyLeft);
+  put16(out + 8, t.dutyRight);
+  put16(out + 10, t.pwmHz);
+  put16(out + 12, (uint16_t)t.joyX);
+  put16(out + 14, (uint16_t)t.joyY);
+  put16(out + 16, t.supplyMv);
+  out[18] = t.state;
+  out[19] = t.errors;
+} // encodeTelemetry()
+
+void decodeTelemetry(const uint8_t *in, RobotTelemetry &t)
+{
+  t.seq = get16(in);
+  t.sampleUs = get16(in + 2) | ((uint32_t)get16(in + 4) << 16);
+  t.dutyLeft = get16(in + 6);
+  t.dutyRight = get16(in + 8);
+  t.pwmHz = get16(in + 10);
+  t.joyX = (int16_t)get16(in + 12);
+  t.joyY = (int16_t)get16(in + 14);
+  t.supplyMv = get16(in + 16);
+  t.state = in[18];
+  t.errors = in[19];
+} // decodeTelemetry()
+
+uint8_t decodeTelemetryBatch(const uint8_t *in, size_t length,
+                             RobotTelemetry *out, uint8_t max)
+{
+  uint8_t count = 0;
+  while (count < max && length >= ROBOT_TELEMETRY_SIZE)
+  {
+    decodeTelemetry(in, out[count]);
+    in += ROBOT_TELEMETRY_SIZE;
+    length -= ROBOT_TELEMETRY_SIZE;
+    count++;
+  } // while
+  return count;
+} // decodeTelemetryBatch()
+
+uint8_t telemetryPerNotification(uint16_t mtu)
+{
+  // A notification has the same 3 byte header as a write.
+  uint16_t samples = mtu > ATT_WRITE_HEADER
+                         ? (mtu - ATT_WRITE_HEADER) / ROBOT_TELEMETRY_SIZE
+                         : 0;
+  if (samples < 1)
+  {
+    return 1;
+  } // if
+  return samples > ROBOT_TELEMETRY_MAX_BATCH ? ROBOT_TELEMETRY_MAX_BATCH
+                                             : samples;
+} // telemetryPerNotification()
+
+uint8_t encodeTelemetryField(const RobotTelemetry &t, uint8_t field,
+                             uint8_t *out)
+{
+  switch (field)
+  {
+  case ROBOT_FIELD_DUTY_LEFT:
+    put16(out, t.dutyLeft);
+    return 2;
+  case ROBOT_FIELD_DUTY_RIGHT:
+    put16(out, t.dutyRight);
+    return 2;
+  case ROBOT_FIELD_PWM_HZ:
+    put16(out, t.pwmHz);
+    return 2;
+  case ROBOT_FIELD_STATE:
+    out[0] = t.state;
+    return 1;
+  case ROBOT_FIELD_JOY_X:
+    put16(out, (uint16_t)t.joyX);
+    return 2;
+  case ROBOT_FIELD_JOY_Y:
+    put16(out, (uint16_t)t.joyY);
+    return 2;
+  case ROBOT_FIELD_SUPPLY:
+    put16(out, t.supplyMv);
+    return 2;
+  default:
+    out[0] = t.errors;
+    return 1;
+  } // switch
+} // encodeTelemetryField()
+
+void decodeTelemetryField(uint8_t field, const uint8_t *in, size_t length,
+                          RobotTelemetry &t)
+{
+  uint16_t value = length >= 2 ? get16(in) : (length == 1 ? in[0] : 0);
+  switch (field)
+  {
+  case ROBOT_FIELD_DUTY_LEFT:
+    t.dutyLeft = value;
+    break;
+  case ROBOT_FIELD_DUTY_RIGHT:
+    t.dutyRight = value;
+    break;
+  case ROBOT_FIELD_PWM_HZ:
+    t.pwmHz = value;
+    break;
+  case ROBOT_FIELD_STATE:
+    t.state = value;
+    break;
+  case ROBOT_FIELD_JOY_X:
+    t.joyX = (int16_t)value;
+    break;
+  case ROBOT_FIELD_JOY_Y:
+    t.joyY = (int16_t)value;
+    break;
+  case ROBOT_FIELD_SUPPLY:
+    t.supplyMv = value;
+    break;
+  default:
+    t.errors = value;
+    break;
+  } // switch
+} // decodeTelemetryField()
+
+void encodeTelemetryConfig(const RobotTelemetryConfig &c, uint8_t *out)
+{
+  put16(out, c.rateHz);
+  put16(out + 2, c.mtu);
+  put16(out + 4, c.holdMs);
+  out[6] = c.mode;
+} // encodeTelemetryConfig()
+
+void decodeTelemetryConfig(const uint8_t *in, RobotTelemetryConfig &c)
+{
+  c.rateHz = get16(in);
+  c.mtu = get16(in + 2);
+  c.holdMs = get16(in + 4);
+  c.mode = in[6];
+} // decodeTelemetryConfig()
+
+void encodeTimeSync(const RobotTimeSync &t, uint8_t *out)
+{
+  put16(out, t.seq);
+  put32(out + 2, t.clientSendUs);
+  put32(out + 6, t.serverReceiveUs);
+  put32(out + 10, t.serverSendUs);
+} // encodeTimeSync()
+
+void decodeTimeSync(const uint8_t *in, size_t length, RobotTimeSync &t)
+{
+  t.seq = get16(in);
+  t.clientSendUs = get32(in + 2);
+  t.serverReceiveUs = length >= ROBOT_TIME_PONG_SIZE ? get32(in + 6) : 0;
+  t.serverSendUs = length >= ROBOT_TIME_PONG_SIZE ? get32(in + 10) : 0;
+} // decodeTimeSync()
+
+SetpointQueue::SetpointQueue() : head(0), count(0), droppedCount(0)
+{
+} // SetpointQueue()
+
+/**
+ * @brief Add a frame. When full, overwrite the oldest one.
+ */
+bool SetpointQueue::push(const RobotSetpoint &sp)
+{
+  slots[head] = sp;
+  head = (head + 1) & (ROBOT_SETPOINT_QUEUE_DEPTH - 1);
+  if (count == ROBOT_SETPOINT_QUEUE_DEPTH)
+  {
+    droppedCount++; // The oldest frame was just overwritten.
+    return false;
+  } // if
+  count++;
+  return true;
+} // push()
+
+/**
+ * @brief Take the oldest frame.
+ */
+bool SetpointQueue::pop(RobotSetpoint &sp)
+{
+  if (count == 0)
+  {
+    return false;
+  } // if
+  uint8_t tail = (head - count) & (ROBOT_SETPOINT_QUEUE_DEPTH - 1);
+  sp = slots[tail];
+  count--;
+  return true;
+} // pop()
+
+bool SetpointQueue::peek(uint8_t index, RobotSetpoint &sp) const
+{
+  if (index >= count)
+  {
+    return false;
+  } // if
+  uint8_t slot = (head - count + index) & (ROBOT_SETPOINT_QUEUE_DEPTH - 1);
+  sp = slots[slot];
+  return true;
+} // peek()
+
+void SetpointQueue::discard(uint8_t frames)
+{
+  count = frames < count ? count - frames : 0;
+} // discard()
+
+/**
+ * @brief Record one received sequence number. Sequence numbers wrap at
+ * 65536, so "newer" means less than half the range ahead.
+ */
+bool SequenceTracker::record(uint16_t seq)
+{
+  received++;
+  if (!started)
+  {
+    started = true;
+    last = seq;
+    return true;
+  } // if
+  int16_t ahead = (int16_t)(seq - last);
+  if (ahead <= 0)
+  {
+    late++;
+    return false;
+  } // if
+  lost += ahead - 1;
+  last = seq;
+  return true;
+} // record()
+
+void SequenceTracker::reset()
+{
+  received = 0;
+  lost = 0;
+  late = 0;
+  started = false;
+  last = 0;
+} // reset()
+
+void LatencyHistogram::add(uint32_t us)
+{
+  uint32_t index = us / bucketUs;
+  if (index > ROBOT_LATENCY_BUCKETS)
+  {
+    index = ROBOT_LATENCY_BUCKETS;
+  } // if
+  buckets[index]++;
+  samples++;
+  if (us > largest)
+  {
+    largest = us;
+  } // if
+} // add()
+
+void LatencyHistogram::reset()
+{
+  memset(buckets, 0, sizeof(buckets));
+  samples = 0;
+  largest = 0;
+} // reset()
+
+/**
+ * @brief Walk the buckets until the running count reaches the percentile.
+ */
+uint32_t LatencyHistogram::percentileUs(uint8_t percent) const
+{
+  if (samples == 0)
+  {
+    return 0;
+  } // if
+  uint32_t target = ((uint64_t)samples * percent + 99) / 100;
+  uint32_t seen = 0;
+  for (uint16_t i = 0; i < ROBOT_LATENCY_BUCKETS; i++)
+  {
+    seen += buckets[i];
+    if (seen >= target)
+    {
+      uint32_t edge = (uint32_t)(i + 1) * bucketUs;
+      return edge < largest ? edge : largest;
+    } // if
+  } // for
+  return largest;
+} // percentileUs()
+
+void ClockSync::reset()
+{
+  points = 0;
+  nextPoint = 0;
+  windowCount = 0;
+  windowBestRoundTripUs = UINT32_MAX;
+  total = 0;
+  lastRoundTripUs = 0;
+  reference = {0, 0};
+  intercept = 0;
+  slope = 0;
+} // reset()
+
+/**
+ * @brief Turn one exchange into an offset, keep the best of each window and
+ * refit the line when a window completes.
+ */
+void ClockSync::addSample(const RobotTimeSync &t, uint32_t receivedUs,
+                          uint32_t intervalUs)
+{
+  total++;
+  uint32_t serverBusyUs = t.serverSendUs - t.serverReceiveUs;
+  uint32_t roundTripUs = (receivedUs - t.clientSendUs) - serverBusyUs;
+
+  Point sample;
+  bool usable = true;
+  if (intervalUs > 0)
+  {
+    // The reply left one connection event after the ping arrived.
+    sample.clientUs = receivedUs - intervalUs;
+    sample.offsetUs = t.serverReceiveUs - sample.clientUs;
+    usable = serverBusyUs < intervalUs / 2; // Otherwise it missed that event.
+  }
+  else
+  {
+    uint32_t there = t.serverReceiveUs - t.clientSendUs;
+    uint32_t back = t.serverSendUs - receivedUs;
+    sample.clientUs = t.clientSendUs + (receivedUs - t.clientSendUs) / 2;
+    sample.offsetUs = there + (int32_t)(back - there) / 2;
+  } // else
+  if (usable && roundTripUs < windowBestRoundTripUs)
+  {
+    windowBestRoundTripUs = roundTripUs;
+    windowBest = sample;
+  } // if
+
+  if (++windowCount < ROBOT_SYNC_WINDOW)
+  {
+    return;
+  } // if
+  if (windowBestRoundTripUs != UINT32_MAX)
+  {
+    history[nextPoint] = windowBest;
+    nextPoint = (nextPoint + 1) % ROBOT_SYNC_POINTS;
+    if (points < ROBOT_SYNC_POINTS)
+    {
+      points++;
+    } // if
+    lastRoundTripUs = windowBestRoundTripUs;
+    reference = windowBest;
+    fit();
+  } // if
+  windowCount = 0;
+  windowBestRoundTripUs = UINT32_MAX;
+} // addSample()
+
+/**
+ * @brief Least squares line through the kept points, relative to the newest
+ * one so the numbers stay small.
+ */
+void ClockSync::fit()
+{
+  if (points < 2)
+  {
+    intercept = 0;
+    slope = 0;
+    return;
+  } // if
+  double sumX = 0, sumY = 0, sumXX = 0, sumXY = 0;
+  for (uint8_t i = 0; i < points; i++)
+  {
+    double x = (int32_t)(history[i].clientUs - reference.clientUs);
+    double y = (int32_t)(history[i].offsetUs - reference.offsetUs);
+    sumX += x;
+    sumY += y;
+    sumXX += x * x;
+    sumXY += x * y;
+  } // for
+  double spread = points * sumXX - sumX * sumX;
+  if (spread <= 0)
+  {
+    return;
+  } // if
+  slope = (points * sumXY - sumX * sumY) / spread;
+  intercept = (sumY - slope * sumX) / points;
+} // fit()
+
+uint32_t ClockSync::toServerUs(uint32_t clientUs) const
+{
+  float correction = intercept + slope * (int32_t)(clientUs - reference.clientUs);
+  int32_t rounded = (int32_t)(correction + (correction >= 0 ? 0.5f : -0.5f));
+  return clientUs + reference.offsetUs + rounded;
+} // toServerUs()
+
+/**
+ * @brief The offset changes so slowly that one correction step is enough.
+ */
+uint32_t ClockSync::toClientUs(uint32_t serverUs) const
+{
+  uint32_t clientUs = serverUs - reference.offsetUs;
+  return serverUs - (toServerUs(clientUs) - clientUs);
+} // toClientUs()
+
+void LinkActivity::reset(unsigned long nowMs)
+{
+  memset(&last, 0, sizeof(last));
+  isIdle = false;
+  lastActiveMs = nowMs;
+  lastChangeMs = nowMs;
+} // reset()
+
+bool LinkActivity::noteSetpoint(const RobotSetpoint &sp, unsigned long nowMs)
+{
+  bool moving = sp.dutyLeft != 0 || sp.dutyRight != 0;
+  bool changed = sp.dutyLeft != last.dutyLeft || sp.dutyRight != last.dutyRight ||
+                 sp.flags != last.flags;
+  last = sp;
+  if (!moving && !changed)
+  {
+    return false;
+  } // if
+  return noteActivity(nowMs);
+} // noteSetpoint()
+
+bool LinkActivity::noteActivity(unsigned long nowMs)
+{
+  lastActiveMs = nowMs;
+  if (!isIdle)
+  {
+    return false;
+  } // if
+  isIdle = false;
+  lastChangeMs = nowMs;
+  return true;
+} // noteActivity()
+
+bool LinkActivity::poll(unsigned long nowMs)
+{
+  if (isIdle || nowMs - lastActiveMs < ROBOT_IDLE_AFTER_MS)
+  {
+    return false;
+  } // if
+  isIdle = true;
+  lastChangeMs = nowMs;
+  return true;
+} // poll()
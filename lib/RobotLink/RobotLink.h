@@ -0,0 +1,518 @@
+/**
+ * @file RobotLink.h
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Message formats and helpers shared by the BLE client and server.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details
+ * The ESP32 client and the UNO R4 server must agree on UUIDs and on the byte
+ * layout of every message, so both sketches include this file. Nothing here
+ * touches the radio. The same code builds for the ESP32, the RA4M1 and the
+ * host (lib/HostSim).
+ *
+ * Setpoint streaming:
+ * - The client packs each setpoint into a 13 byte RobotSetpoint frame with a
+ *   sequence number and its send time.
+ * - Frames go out with write-without-response, several frames per write when
+ *   the negotiated MTU allows. A write is n * ROBOT_SETPOINT_SIZE bytes with
+ *   no header.
+ * - Frames wait in a SetpointQueue. If the link falls behind, the oldest
+ *   frame is dropped. For a setpoint only the newest value matters.
+ * - The server acknowledges by notifying the sequence number of the last
+ *   frame it applied and the server time it applied it. The client times
+ *   that against the send time and keeps the result in a LatencyHistogram
+ *   for the 99th percentile.
+ *
+ * Telemetry:
+ * - The server samples its state into a 20 byte RobotTelemetry at the rate
+ *   the client asks for (RobotTelemetryConfig) and notifies it on the
+ *   telemetry characteristic.
+ * - Several samples share one notification when the MTU allows. A sample is
+ *   held for at most the config's hold time, so batching never makes the
+ *   data older than that.
+ * - For comparison, every field is also available as its own characteristic
+ *   (ROBOT_TELEMETRY_FIELD_UUID_n), notified once per sample when the client
+ *   selects ROBOT_TELEMETRY_MODE_FIELDS.
+ *
+ * Time sync:
+ * - The client writes a RobotTimeSync ping with its send time, the server
+ *   notifies it back with its own receive and send times.
+ * - ClockSync turns those into the offset and drift between the two clocks,
+ *   so server timestamps (setpoint applied, telemetry sampled) can be read
+ *   on the client's clock. That splits the round trip into one-way times.
+ *
+ * Link power:
+ * - LinkActivity watches the setpoints a client sends. Once the robot has
+ *   been stopped with an unchanged setpoint for ROBOT_IDLE_AFTER_MS, the
+ *   link may go idle: a long connection interval with slave latency, so the
+ *   server's radio sleeps through most events.
+ * - The first setpoint that changes wakes it again.
+ */
+#ifndef ROBOT_LINK_H
+#define ROBOT_LINK_H
+
+#include <Arduino.h>
+
+// GATT layout. The service and command characteristic are the ones Lesson 6
+// has always used.
+#define ROBOT_LINK_SERVICE_UUID "19b10000-e8f2-537e-4f6c-d104768a1214"
+#define ROBOT_LINK_COMMAND_UUID "19b10001-e8f2-537e-4f6c-d104768a1214"
+#define ROBOT_LINK_SETPOINT_UUID "19b10002-e8f2-537e-4f6c-d104768a1214"
+#define ROBOT_LINK_TIME_SYNC_UUID "19b10003-e8f2-537e-4f6c-d104768a1214"
+
+// Bytes in one encoded RobotSetpoint.
+#define ROBOT_SETPOINT_SIZE 13
+
+// Most frames in one write. 18 * 13 = 234 bytes fits a 247 byte MTU.
+#define ROBOT_SETPOINT_MAX_BATCH 18
+
+// Bytes in one acknowledgement notification (sequence number and the
+// server micros() when the frame was applied).
+#define ROBOT_ACK_SIZE 6
+
+// Bytes in a time sync ping (client) and its reply (server).
+#define ROBOT_TIME_PING_SIZE 6
+#define ROBOT_TIME_PONG_SIZE 14
+
+// Pings per ClockSync window. The one with the shortest round trip is kept.
+#define ROBOT_SYNC_WINDOW 8
+
+// Kept windows the drift is fitted over.
+#define ROBOT_SYNC_POINTS 8
+
+// A stopped robot whose setpoint has not changed for this long lets its
+// link go idle (milliseconds).
+#define ROBOT_IDLE_AFTER_MS 5000
+
+// Setpoint queue depth. Must be a power of two.
+#define ROBOT_SETPOINT_QUEUE_DEPTH 8
+
+// Latency histogram default resolution and range (250 us x 128 = 32 ms).
+// Samples above the range go in an overflow bucket.
+#define ROBOT_LATENCY_BUCKET_US 250
+#define ROBOT_LATENCY_BUCKETS 128
+
+// Telemetry service. The packed characteristic notifies batches of
+// ROBOT_TELEMETRY_SIZE byte samples, the config characteristic takes a
+// RobotTelemetryConfig from the client.
+#define ROBOT_TELEMETRY_SERVICE_UUID "19b10100-e8f2-537e-4f6c-d104768a1214"
+#define ROBOT_TELEMETRY_UUID "19b10101-e8f2-537e-4f6c-d104768a1214"
+#define ROBOT_TELEMETRY_CONFIG_UUID "19b10102-e8f2-537e-4f6c-d104768a1214"
+
+// One characteristic per telemetry field, in RobotTelemetryField order.
+#define ROBOT_TELEMETRY_FIELD_UUID_0 "19b10110-e8f2-537e-4f6c-d104768a1214"
+#define ROBOT_TELEMETRY_FIELD_UUID_1 "19b10111-e8f2-537e-4f6c-d104768a1214"
+#define ROBOT_TELEMETRY_FIELD_UUID_2 "19b10112-e8f2-537e-4f6c-d104768a1214"
+#define ROBOT_TELEMETRY_FIELD_UUID_3 "19b10113-e8f2-537e-4f6c-d104768a1214"
+#define ROBOT_TELEMETRY_FIELD_UUID_4 "19b10114-e8f2-537e-4f6c-d104768a1214"
+#define ROBOT_TELEMETRY_FIELD_UUID_5 "19b10115-e8f2-537e-4f6c-d104768a1214"
+#define ROBOT_TELEMETRY_FIELD_UUID_6 "19b10116-e8f2-537e-4f6c-d104768a1214"
+#define ROBOT_TELEMETRY_FIELD_UUID_7 "19b10117-e8f2-537e-4f6c-d104768a1214"
+
+// Bytes in one encoded RobotTelemetry. Fits the default 23 byte MTU.
+#define ROBOT_TELEMETRY_SIZE 20
+
+// Most samples in one notification. 12 * 20 = 240 bytes fits a 247 byte MTU.
+#define ROBOT_TELEMETRY_MAX_BATCH 12
+
+// Bytes in one encoded RobotTelemetryConfig.
+#define ROBOT_TELEMETRY_CONFIG_SIZE 7
+
+// RobotTelemetryConfig::mode values.
+#define ROBOT_TELEMETRY_MODE_PACKED 0 // Batches of packed samples.
+#define ROBOT_TELEMETRY_MODE_FIELDS 1 // One notification per field.
+
+// RobotTelemetry::state bits 0-1: motor direction.
+#define ROBOT_DIR_STOP 0
+#define ROBOT_DIR_FORWARD 1
+#define ROBOT_DIR_REVERSE 2
+#define ROBOT_DIR_BRAKE 3
+#define ROBOT_STATE_DIR_MASK 0x03
+
+// RobotTelemetry::errors bits.
+#define ROBOT_ERR_SETPOINT_LOST 0x01  // Setpoint frames went missing.
+#define ROBOT_ERR_SETPOINT_STALE 0x02 // No setpoint for a while, motors running.
+#define ROBOT_ERR_SUPPLY_LOW 0x04     // Motor supply below its minimum.
+
+// RobotSetpoint::flags bits.
+#define ROBOT_FLAG_LED 0x01     // Turn the status LED on.
+#define ROBOT_FLAG_REVERSE 0x02 // Drive backwards.
+#define ROBOT_FLAG_BRAKE 0x04   // Brake instead of coasting at zero duty.
+
+/**
+ * @brief One setpoint from the joystick.
+ */
+struct RobotSetpoint
+{
+  uint16_t seq;     // Incremented for every frame the client produces.
+  uint32_t sentUs;  // Client micros() when the frame was produced.
+  int16_t joyX;     // Joystick X, -512..511.
+  int16_t joyY;     // Joystick Y, -512..511.
+  uint8_t dutyLeft; // Motor duty, 0-255.
+  uint8_t dutyRight;
+  uint8_t flags;    // ROBOT_FLAG_ bits.
+};
+
+/**
+ * @brief One sample of the server's state.
+ */
+struct RobotTelemetry
+{
+  uint16_t seq;       // Incremented for every sample.
+  uint32_t sampleUs;  // Server micros() when sampled.
+  uint16_t dutyLeft;  // PWM compare counts applied to each motor.
+  uint16_t dutyRight;
+  uint16_t pwmHz;     // Motor PWM frequency.
+  int16_t joyX;       // Joystick sample from the last setpoint.
+  int16_t joyY;
+  uint16_t supplyMv;  // Motor supply voltage, 0 if not measured.
+  uint8_t state;      // ROBOT_DIR_ value in bits 0-1.
+  uint8_t errors;     // ROBOT_ERR_ bits.
+};
+
+/**
+ * @brief One time sync exchange. The ping carries the first two fields, the
+ * reply all four.
+ */
+struct RobotTimeSync
+{
+  uint16_t seq;
+  uint32_t clientSendUs;    // Client micros() when the ping was written.
+  uint32_t serverReceiveUs; // Server micros() when the ping arrived.
+  uint32_t serverSendUs;    // Server micros() when the reply was notified.
+};
+
+/**
+ * @brief Fields of RobotTelemetry that have their own characteristic. seq
+ * and sampleUs only exist in the packed form.
+ */
+enum RobotTelemetryField : uint8_t
+{
+  ROBOT_FIELD_DUTY_LEFT = 0,
+  ROBOT_FIELD_DUTY_RIGHT,
+  ROBOT_FIELD_PWM_HZ,
+  ROBOT_FIELD_STATE,
+  ROBOT_FIELD_JOY_X,
+  ROBOT_FIELD_JOY_Y,
+  ROBOT_FIELD_SUPPLY,
+  ROBOT_FIELD_ERRORS, // Sent last, completes a sample.
+  ROBOT_TELEMETRY_FIELDS
+};
+
+/**
+ * @brief What the client wants from the telemetry service.
+ */
+struct RobotTelemetryConfig
+{
+  uint16_t rateHz; // Samples per second, 0 = off.
+  uint16_t mtu;    // Negotiated ATT MTU, sets how many samples fit.
+  uint16_t holdMs; // Longest a sample may wait for its batch to fill.
+  uint8_t mode;    // ROBOT_TELEMETRY_MODE_ value.
+};
+
+/**
+ * @brief Write a setpoint as ROBOT_SETPOINT_SIZE little-endian bytes.
+ */
+void encodeSetpoint(const RobotSetpoint &sp, uint8_t *out);
+
+/**
+ * @brief Read a setpoint written by encodeSetpoint().
+ */
+void decodeSetpoint(const uint8_t *in, RobotSetpoint &sp);
+
+/**
+ * @brief Frames that fit in one write for a negotiated ATT MTU.
+ */
+uint8_t setpointsPerWrite(uint16_t mtu);
+
+/**
+ * @brief Write a telemetry sample as ROBOT_TELEMETRY_SIZE little-endian bytes.
+ */
+void encodeTelemetry(const RobotTelemetry &t, uint8_t *out);
+
+/**
+ * @brief Read a telemetry sample written by encodeTelemetry().
+ */
+void decodeTelemetry(const uint8_t *in, RobotTelemetry &t);
+
+/**
+ * @brief Decode every whole sample in one notification.
+ * @return Number of samples written to out (at most max).
+ */
+uint8_t decodeTelemetryBatch(const uint8_t *in, size_t length,
+                             RobotTelemetry *out, uint8_t max);
+
+/**
+ * @brief Samples that fit in one notification for a negotiated ATT MTU.
+ */
+uint8_t telemetryPerNotification(uint16_t mtu);
+
+/**
+ * @brief Write one field for its own characteristic.
+ * @return Bytes written (1 or 2).
+ */
+uint8_t encodeTelemetryField(const RobotTelemetry &t, uint8_t field,
+                             uint8_t *out);
+
+/**
+ * @brief Read one field written by encodeTelemetryField() into t.
+ */
+void decodeTelemetryField(uint8_t field, const uint8_t *in, size_t length,
+                          RobotTelemetry &t);
+
+void encodeTelemetryConfig(const RobotTelemetryConfig &c, uint8_t *out);
+void decodeTelemetryConfig(const uint8_t *in, RobotTelemetryConfig &c);
+
+/**
+ * @brief Write a time sync reply (ROBOT_TIME_PONG_SIZE bytes). Its first
+ * ROBOT_TIME_PING_SIZE bytes are the ping.
+ */
+void encodeTimeSync(const RobotTimeSync &t, uint8_t *out);
+
+/**
+ * @brief Read a ping or a reply. Fields the message does not have are 0.
+ */
+void decodeTimeSync(const uint8_t *in, size_t length, RobotTimeSync &t);
+
+/**
+ * @brief Fixed size queue that drops the oldest frame when it is full.
+ *
+ * @details Used from one task only (the client's loop()).
+ */
+class SetpointQueue
+{
+public:
+  SetpointQueue();
+
+  /**
+   * @brief Add a frame, dropping the oldest one if the queue is full.
+   * @return false if a frame was dropped to make room.
+   */
+  bool push(const RobotSetpoint &sp);
+
+  /**
+   * @brief Take the oldest frame.
+   * @return false if the queue is empty.
+   */
+  bool pop(RobotSetpoint &sp);
+
+  /**
+   * @brief Look at a frame without taking it, 0 is the oldest.
+   * @return false if there are not that many frames.
+   */
+  bool peek(uint8_t index, RobotSetpoint &sp) const;
+
+  /**
+   * @brief Take the oldest frames without reading them, once they are sent.
+   */
+  void discard(uint8_t frames);
+
+  uint8_t size() const { return count; }
+
+  /**
+   * @brief Frames dropped since the last resetDropped().
+   */
+  uint32_t dropped() const { return droppedCount; }
+  void resetDropped() { droppedCount = 0; }
+
+private:
+  RobotSetpoint slots[ROBOT_SETPOINT_QUEUE_DEPTH];
+  uint8_t head; // Next slot to write.
+  uint8_t count;
+  uint32_t droppedCount;
+};
+
+/**
+ * @brief Counts received, lost and late frames from their sequence numbers.
+ */
+class SequenceTracker
+{
+public:
+  SequenceTracker() { reset(); }
+
+  /**
+   * @brief Record one received sequence number.
+   * @return true if it is newer than every frame seen so far.
+   */
+  bool record(uint16_t seq);
+
+  void reset();
+
+  uint32_t received;   // Frames seen.
+  uint32_t lost;       // Gaps in the sequence (dropped by the client or link).
+  uint32_t late;       // Arrived after a newer frame, ignored.
+
+private:
+  bool started;
+  uint16_t last;
+};
+
+/**
+ * @brief Bucketed latency histogram. Gives percentiles without storing
+ * samples.
+ */
+class LatencyHistogram
+{
+public:
+  /**
+   * @param bucketUs Width of one bucket. The range is ROBOT_LATENCY_BUCKETS
+   * of them.
+   */
+  explicit LatencyHistogram(uint32_t bucketUs = ROBOT_LATENCY_BUCKET_US) : bucketUs(bucketUs)
+  {
+    reset();
+  }
+
+  void add(uint32_t us);
+  void reset();
+
+  /**
+   * @brief Upper edge of the bucket holding the given percentile (0-100).
+   * Returns maxUs() if it falls in the overflow bucket.
+   */
+  uint32_t percentileUs(uint8_t percent) const;
+
+  uint32_t count() const { return samples; }
+  uint32_t maxUs() const { return largest; }
+
+private:
+  uint32_t bucketUs;
+  uint32_t buckets[ROBOT_LATENCY_BUCKETS + 1]; // Last one is overflow.
+  uint32_t samples;
+  uint32_t largest;
+};
+
+/**
+ * @brief Estimates the offset and drift between the client's and the
+ * server's micros() from time sync exchanges.
+ *
+ * @details Each exchange gives four times: ping sent (t1) and reply received
+ * (t4) on the client, ping received (t2) and reply sent (t3) on the server.
+ * - Plain NTP assumes both directions take as long and puts the server's
+ *   clock at the midpoint. Over BLE that is wrong by about half a connection
+ *   interval: a write goes out at the next connection event, but the reply,
+ *   queued just after that event, always waits for the one after it.
+ * - When the connection interval I is known, the reply left exactly one
+ *   interval after the ping arrived, so the ping's event was at t4 - I - L
+ *   on the client and t2 - L on the server (L is the stack latency, the same
+ *   both ways). The offset is t2 - (t4 - I), whatever the queueing was.
+ * Retransmissions and a slow server add whole intervals, so of every
+ * ROBOT_SYNC_WINDOW pings only the one with the shortest round trip is used.
+ * A straight line through the last ROBOT_SYNC_POINTS of those gives the
+ * drift. All times wrap at 2^32 us like micros().
+ */
+class ClockSync
+{
+public:
+  ClockSync() { reset(); }
+
+  /**
+   * @brief Add one exchange.
+   * @param intervalUs Connection interval, 0 if unknown (NTP midpoint).
+   */
+  void addSample(const RobotTimeSync &t, uint32_t receivedUs, uint32_t intervalUs);
+
+  void reset();
+
+  /**
+   * @brief true once a window has completed.
+   */
+  bool valid() const { return points > 0; }
+
+  /**
+   * @brief A server micros() value on the client's clock, and back.
+   */
+  uint32_t toClientUs(uint32_t serverUs) const;
+  uint32_t toServerUs(uint32_t clientUs) const;
+
+  /**
+   * @brief How much faster the server's clock runs, parts per million.
+   */
+  float driftPpm() const { return slope * 1e6f; }
+
+  /**
+   * @brief Round trip of the exchange behind the newest point.
+   */
+  uint32_t roundTripUs() const { return lastRoundTripUs; }
+
+  uint32_t exchanges() const { return total; }
+
+private:
+  void fit();
+
+  struct Point
+  {
+    uint32_t clientUs;
+    uint32_t offsetUs; // Server minus client, modulo 2^32.
+  };
+
+  Point history[ROBOT_SYNC_POINTS];
+  uint8_t points;       // Points in history.
+  uint8_t nextPoint;
+  Point windowBest;
+  uint32_t windowBestRoundTripUs;
+  uint8_t windowCount;
+  uint32_t total;
+  uint32_t lastRoundTripUs;
+  Point reference;      // Newest point, the line goes through here.
+  float intercept;      // Offset at reference.clientUs, relative to reference.offsetUs.
+  float slope;          // Offset change per client microsecond.
+};
+
+/**
+ * @brief Decides when a link can trade latency for radio time.
+ *
+ * @details A link is active while the robot moves or its setpoint keeps
+ * changing, and goes idle once it has been stopped with the same setpoint
+ * for ROBOT_IDLE_AFTER_MS. Only what the robot acts on (duties and flags)
+ * counts, so joystick noise inside the dead band does not keep it awake. A
+ * moving robot never goes idle: stopping it must not wait for a slow link.
+ * What "idle" costs or saves is up to the caller, which asks for the
+ * connection parameters.
+ */
+class LinkActivity
+{
+public:
+  LinkActivity() { reset(0); }
+
+  /**
+   * @brief Start a new link as active.
+   */
+  void reset(unsigned long nowMs);
+
+  /**
+   * @brief Look at a setpoint about to be sent.
+   * @return true if it woke an idle link.
+   */
+  bool noteSetpoint(const RobotSetpoint &sp, unsigned long nowMs);
+
+  /**
+   * @brief Anything else the user did (a command).
+   * @return true if it woke an idle link.
+   */
+  bool noteActivity(unsigned long nowMs);
+
+  /**
+   * @brief Call regularly.
+   * @return true if the link has just gone idle.
+   */
+  bool poll(unsigned long nowMs);
+
+  bool idle() const { return isIdle; }
+
+  /**
+   * @brief millis() when the link last went active or idle.
+   */
+  unsigned long changedMs() const { return lastChangeMs; }
+
+private:
+  RobotSetpoint last;          // Last setpoint seen.
+  bool isIdle;
+  unsigned long lastActiveMs;  // Last time something changed.
+  unsigned long lastChangeMs;
+};
+
+#endif // ROBOT_LINK_H
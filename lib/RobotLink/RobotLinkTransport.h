@@ -0,0 +1,56 @@
+/**
+ * @file RobotLinkTransport.h
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief What RobotServer and RobotClient need from a link, and nothing more.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details
+ * The protocol logic (RobotServer.h, RobotClient.h) never calls a BLE library.
+ * It sends messages on numbered channels through a RobotLinkTransport, and
+ * the owner hands received messages to its onMessage(). A channel stands for
+ * one characteristic:
+ * - On the board, a small adapter in the sketch maps each channel to a
+ *   characteristic (server) or a cached handle (client).
+ * - On the host, SimBleLink (lib/HostSim) carries the messages with a
+ *   simulated connection interval, latency and loss.
+ * A message is one write or notification, at most mtu() - 3 bytes.
+ */
+#ifndef ROBOT_LINK_TRANSPORT_H
+#define ROBOT_LINK_TRANSPORT_H
+
+#include <RobotLink.h>
+
+// Message channels, one per characteristic.
+enum RobotChannel : uint8_t
+{
+  ROBOT_CHANNEL_COMMAND = 0,      // Client to server: LED command byte.
+  ROBOT_CHANNEL_SETPOINT,         // Client: setpoint batches. Server: acks.
+  ROBOT_CHANNEL_TELEMETRY,        // Server to client: packed telemetry.
+  ROBOT_CHANNEL_TELEMETRY_CONFIG, // Client to server: RobotTelemetryConfig.
+  ROBOT_CHANNEL_TIME_SYNC,        // Client: time sync pings. Server: replies.
+  ROBOT_CHANNEL_FIELD_0,          // Server to client: first per-field channel.
+  ROBOT_CHANNELS = ROBOT_CHANNEL_FIELD_0 + ROBOT_TELEMETRY_FIELDS
+};
+
+class RobotLinkTransport
+{
+public:
+  virtual ~RobotLinkTransport() {}
+
+  /**
+   * @brief Send one message. The client writes (the adapter picks with or
+   * without response per channel), the server notifies.
+   * @return false if it was not sent (no link, or no buffer free).
+   */
+  virtual bool send(uint8_t channel, const uint8_t *data, size_t length) = 0;
+
+  /**
+   * @brief Negotiated ATT MTU, 23 until the exchange is done.
+   */
+  virtual uint16_t mtu() const = 0;
+};
+
+#endif // ROBOT_LINK_TRANSPORT_H
@@ -0,0 +1,338 @@
+/**
+ * @file RobotServer.cpp
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Server (robot) side of the RobotLink protocol, without the radio.
+ * See RobotServer.h.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ */
+#include "RobotServer.h"
+
+RobotServer::RobotServer(RobotLinkTransport &link, uint16_t pwmHz)
+    : streamWrites(0), telemetryStats{0, 0, 0, 0}, link(link), pwmHz(pwmHz),
+      commandHandler(nullptr), setpointHandler(nullptr),
+      sampleHandler(nullptr), clockUs(micros), current{0, 0, 0, 0, 0, 0, 0},
+      lastSetpointMs(0), setpointLost(false),
+      config{0, 23, 100, ROBOT_TELEMETRY_MODE_PACKED}, telemetrySeq(0),
+      lastSampleUs(0), batchCount(0), batchLimit(1), batchStartMs(0)
+{
+} // RobotServer()
+
+void RobotServer::onConnect()
+{
+  streamSeq.reset(); // The client starts a new sequence on every connection.
+  lastSetpointMs = 0;
+  config.rateHz = 0; // Silent until this client asks for telemetry.
+  batchCount = 0;
+} // onConnect()
+
+void RobotServer::onDisconnect()
+{
+  current = {0, 0, 0, 0, 0, 0, 0}; // Stop when the link is gone.
+  config.rateHz = 0;
+  batchCount = 0;
+} // onDisconnect()
+
+void RobotServer::onMessage(uint8_t channel, const uint8_t *data,
+                            size_t length)
+{
+  uint32_t receivedUs = clockUs(); // First thing, for time sync.
+  switch (channel)
+  {
+  case ROBOT_CHANNEL_COMMAND:
+    if (length >= 1 && commandHandler != nullptr)
+    {
+      commandHandler(data[0]);
+    } // if
+    break;
+  case ROBOT_CHANNEL_SETPOINT:
+    onSetpoints(data, length);
+    break;
+  case ROBOT_CHANNEL_TELEMETRY_CONFIG:
+    onTelemetryConfig(data, length);
+    break;
+  case ROBOT_CHANNEL_TIME_SYNC:
+    onTimeSync(receivedUs, data, length);
+    break;
+  default:
+    break; // Server to client channels.
+  } // switch
+} // onMessage()
+
+/**
+ * @brief Apply a batch of setpoint frames in order, so the newest one wins.
+ * A frame older than one already applied is counted as late and skipped. One
+ * acknowledgement per batch tells the client which frame is now in effect
+ * and when (server clock) it took effect.
+ */
+void RobotServer::onSetpoints(const uint8_t *data, size_t length)
+{
+  streamWrites++;
+  bool applied = false;
+  for (size_t offset = 0; offset + ROBOT_SETPOINT_SIZE <= length;
+       offset += ROBOT_SETPOINT_SIZE)
+  {
+    RobotSetpoint sp;
+    decodeSetpoint(data + offset, sp);
+    uint32_t lostBefore = streamSeq.lost;
+    bool newer = streamSeq.record(sp.seq);
+    if (streamSeq.lost != lostBefore)
+    {
+      setpointLost = true;
+    } // if
+    if (newer)
+    {
+      applySetpoint(sp);
+      applied = true;
+    } // if
+  } // for
+
+  if (applied)
+  {
+    uint32_t appliedUs = clockUs();
+    uint8_t ack[ROBOT_ACK_SIZE] = {(uint8_t)(current.seq & 0xFF),
+                                   (uint8_t)(current.seq >> 8),
+                                   (uint8_t)(appliedUs & 0xFF),
+                                   (uint8_t)((appliedUs >> 8) & 0xFF),
+                                   (uint8_t)((appliedUs >> 16) & 0xFF),
+                                   (uint8_t)(appliedUs >> 24)};
+    link.send(ROBOT_CHANNEL_SETPOINT, ack, ROBOT_ACK_SIZE);
+  } // if
+} // onSetpoints()
+
+void RobotServer::applySetpoint(const RobotSetpoint &sp)
+{
+  lastSetpointMs = millis();
+  current = sp;
+  if (setpointHandler != nullptr)
+  {
+    setpointHandler(sp);
+  } // if
+} // applySetpoint()
+
+void RobotServer::onTelemetryConfig(const uint8_t *data, size_t length)
+{
+  if (length < ROBOT_TELEMETRY_CONFIG_SIZE)
+  {
+    return;
+  } // if
+  flushTelemetry(); // Send what was batched under the old config.
+  decodeTelemetryConfig(data, config);
+  if (config.rateHz > ROBOT_TELEMETRY_MAX_RATE_HZ)
+  {
+    config.rateHz = ROBOT_TELEMETRY_MAX_RATE_HZ;
+  } // if
+  batchLimit = telemetryPerNotification(config.mtu);
+  lastSampleUs = micros();
+  telemetryStats = {0, 0, 0, 0};
+} // onTelemetryConfig()
+
+/**
+ * @brief Send a ping straight back with the time it arrived and the time it
+ * left.
+ */
+void RobotServer::onTimeSync(uint32_t receivedUs, const uint8_t *data,
+                             size_t length)
+{
+  if (length < ROBOT_TIME_PING_SIZE)
+  {
+    return;
+  } // if
+  RobotTimeSync sync;
+  decodeTimeSync(data, length, sync);
+  sync.serverReceiveUs = receivedUs;
+  uint8_t reply[ROBOT_TIME_PONG_SIZE];
+  sync.serverSendUs = clockUs();
+  encodeTimeSync(sync, reply);
+  link.send(ROBOT_CHANNEL_TIME_SYNC, reply, ROBOT_TIME_PONG_SIZE);
+} // onTimeSync()
+
+void RobotServer::poll()
+{
+  if (config.rateHz == 0)
+  {
+    return;
+  } // if
+  unsigned long now = micros();
+  if (now - lastSampleUs >= 1000000UL / config.rateHz)
+  {
+    lastSampleUs = now;
+    RobotTelemetry t;
+    sampleTelemetry(t);
+    telemetryStats.samples++;
+    if (config.mode == ROBOT_TELEMETRY_MODE_FIELDS)
+    {
+      sendTelemetryFields(t);
+    }
+    else
+    {
+      queueTelemetry(t);
+    } // else
+  } // if
+  if (batchCount > 0 && millis() - batchStartMs >= config.holdMs)
+  {
+    flushTelemetry();
+  } // if
+} // poll()
+
+/**
+ * @brief Fill in one telemetry sample from the current state, then let the
+ * sketch add what only it can measure.
+ */
+void RobotServer::sampleTelemetry(RobotTelemetry &t)
+{
+  t.seq = telemetrySeq++;
+  t.sampleUs = clockUs();
+  t.dutyLeft = current.dutyLeft;
+  t.dutyRight = current.dutyRight;
+  t.pwmHz = pwmHz;
+  t.joyX = current.joyX;
+  t.joyY = current.joyY;
+  t.supplyMv = 0;
+
+  if (current.flags & ROBOT_FLAG_BRAKE)
+  {
+    t.state = ROBOT_DIR_BRAKE;
+  }
+  else if (current.dutyLeft == 0 && current.dutyRight == 0)
+  {
+    t.state = ROBOT_DIR_STOP;
+  }
+  else if (current.flags & ROBOT_FLAG_REVERSE)
+  {
+    t.state = ROBOT_DIR_REVERSE;
+  }
+  else
+  {
+    t.state = ROBOT_DIR_FORWARD;
+  } // else
+
+  t.errors = 0;
+  if (setpointLost)
+  {
+    t.errors |= ROBOT_ERR_SETPOINT_LOST;
+    setpointLost = false;
+  } // if
+  // A stopped robot is safe without setpoints, and an idle link (see
+  // LinkActivity) stops sending them.
+  bool moving = current.dutyLeft != 0 || current.dutyRight != 0;
+  if (moving && lastSetpointMs != 0 && millis() - lastSetpointMs > ROBOT_SETPOINT_STALE_MS)
+  {
+    t.errors |= ROBOT_ERR_SETPOINT_STALE;
+  } // if
+  if (sampleHandler != nullptr)
+  {
+    sampleHandler(t);
+  } // if
+} // sampleTelemetry()
+
+/**
+ * @brief Add a sample to the batch and send it when no more fit.
+ */
+void RobotServer::queueTelemetry(const RobotTelemetry &t)
+{
+  if (batchCount == 0)
+  {
+    batchStartMs = millis();
+  } // if
+  encodeTelemetry(t, batch + batchCount * ROBOT_TELEMETRY_SIZE);
+  batchCount++;
+  if (batchCount >= batchLimit)
+  {
+    flushTelemetry();
+  } // if
+} // queueTelemetry()
+
+/**
+ * @brief Send every batched sample in one notification.
+ */
+void RobotServer::flushTelemetry()
+{
+  if (batchCount == 0)
+  {
+    return;
+  } // if
+  send(ROBOT_CHANNEL_TELEMETRY, batch, batchCount * ROBOT_TELEMETRY_SIZE);
+  batchCount = 0;
+} // flushTelemetry()
+
+/**
+ * @brief Send each field on its own channel (comparison mode).
+ */
+void RobotServer::sendTelemetryFields(const RobotTelemetry &t)
+{
+  for (uint8_t field = 0; field < ROBOT_TELEMETRY_FIELDS; field++)
+  {
+    uint8_t buffer[2];
+    uint8_t length = encodeTelemetryField(t, field, buffer);
+    send(ROBOT_CHANNEL_FIELD_0 + field, buffer, length);
+  } // for
+} // sendTelemetryFields()
+
+/**
+ * @brief Send one telemetry notification and count what it cost.
+ */
+void RobotServer::send(uint8_t channel, const uint8_t *data, size_t length)
+{
+  unsigned long start = micros();
+  link.send(channel, data, length);
+  telemetryStats.busyUs += micros() - start;
+  telemetryStats.notifications++;
+  telemetryStats.bytes += length;
+} // send()
+
+void RobotServer::printTelemetryConfig(Print &out) const
+{
+  out.print("Telemetry config: rate=");
+  out.print(config.rateHz);
+  out.print(" Hz mode=");
+  out.print(config.mode == ROBOT_TELEMETRY_MODE_FIELDS ? "fields" : "packed");
+  out.print(" mtu=");
+  out.print(config.mtu);
+  out.print(" samples/notification=");
+  out.println(batchLimit);
+} // printTelemetryConfig()
+
+/**
+ * @details "lost" counts sequence numbers that never arrived. Most of them
+ * are frames the client dropped on purpose because the link fell behind.
+ */
+void RobotServer::printStreamReport(Print &out, float seconds)
+{
+  out.print("Stream: frames/s=");
+  out.print(streamSeq.received / seconds, 1);
+  out.print(" writes/s=");
+  out.print(streamWrites / seconds, 1);
+  out.print(" lost=");
+  out.print(streamSeq.lost);
+  out.print(" late=");
+  out.print(streamSeq.late);
+  out.print(" last seq=");
+  out.println(current.seq);
+  streamSeq.received = 0;
+  streamSeq.lost = 0;
+  streamSeq.late = 0;
+  streamWrites = 0;
+} // printStreamReport()
+
+/**
+ * @details "notify busy" is time spent inside the transport. On the UNO R4 it
+ * grows when notifications are sent faster than the link can carry them,
+ * because the BLE library then waits for the radio to free a buffer.
+ */
+void RobotServer::printTelemetryReport(Print &out, float seconds)
+{
+  out.print("Telemetry: mode=");
+  out.print(config.mode == ROBOT_TELEMETRY_MODE_FIELDS ? "fields" : "packed");
+  out.print(" samples/s=");
+  out.print(telemetryStats.samples / seconds, 1);
+  out.print(" notifications/s=");
+  out.print(telemetryStats.notifications / seconds, 1);
+  out.print(" bytes/s=");
+  out.print(telemetryStats.bytes / seconds, 1);
+  out.print(" notify busy us=");
+  out.println(telemetryStats.busyUs);
+  telemetryStats = {0, 0, 0, 0};
+} // printTelemetryReport()
@@ -0,0 +1,149 @@
+/**
+ * @file RobotServer.h
+ * @author The Aging Apprentice (theAgingApprentice@protonmail.com)
+ * @brief Server (robot) side of the RobotLink protocol, without the radio.
+ * @version 1.0
+ * @date 2026-10-18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ * @details
+ * Everything the UNO R4 server does with a message once it has arrived:
+ * applying setpoints in sequence order and acknowledging them, taking the
+ * LED command, answering time sync pings, and sampling, batching and sending
+ * telemetry. Messages come in through onMessage() and go out through a
+ * RobotLinkTransport, so the same code runs over ArduinoBLE on the board and
+ * over SimBleLink on the host.
+ *
+ * Hardware stays in the sketch. It is reached through three hooks: the
+ * command handler, the setpoint handler (drive the motors) and the sample
+ * handler (add measurements such as the supply voltage to a telemetry
+ * sample).
+ *
+ * Used from one task only. On the UNO R4 everything runs from BLE.poll() and
+ * loop().
+ */
+#ifndef ROBOT_SERVER_H
+#define ROBOT_SERVER_H
+
+#include <RobotLink.h>
+#include <RobotLinkTransport.h>
+
+// No setpoint for this long while the motors run sets ROBOT_ERR_SETPOINT_STALE.
+#define ROBOT_SETPOINT_STALE_MS 500
+
+// Highest telemetry rate a client may ask for (samples per second).
+#define ROBOT_TELEMETRY_MAX_RATE_HZ 500
+
+/**
+ * @brief What sending telemetry cost since the last report.
+ */
+struct RobotTelemetryStats
+{
+  uint32_t samples;
+  uint32_t notifications;
+  uint32_t bytes;  // Payload bytes notified.
+  uint32_t busyUs; // Time spent inside the transport sending notifications.
+};
+
+class RobotServer
+{
+public:
+  typedef void (*CommandHandler)(uint8_t value);
+  typedef void (*SetpointHandler)(const RobotSetpoint &sp);
+  typedef void (*SampleHandler)(RobotTelemetry &t);
+  typedef unsigned long (*Clock)();
+
+  /**
+   * @param link Where acknowledgements and telemetry are sent.
+   * @param pwmHz Motor PWM frequency reported in telemetry.
+   */
+  RobotServer(RobotLinkTransport &link, uint16_t pwmHz);
+
+  void setCommandHandler(CommandHandler handler) { commandHandler = handler; }
+  void setSetpointHandler(SetpointHandler handler) { setpointHandler = handler; }
+  void setSampleHandler(SampleHandler handler) { sampleHandler = handler; }
+
+  /**
+   * @brief Clock for every timestamp sent to the client (micros() unless
+   * set). The host bench gives the server a clock of its own, offset and
+   * drifting like a second board's.
+   */
+  void setClock(Clock clock) { clockUs = clock; }
+
+  /**
+   * @brief A client connected. It starts a new sequence and asks for
+   * telemetry again, so both are reset.
+   */
+  void onConnect();
+
+  /**
+   * @brief The client went away. The setpoint goes to zero (stop) and
+   * telemetry is turned off.
+   */
+  void onDisconnect();
+
+  /**
+   * @brief Handle one write from the client.
+   */
+  void onMessage(uint8_t channel, const uint8_t *data, size_t length);
+
+  /**
+   * @brief Take a telemetry sample when one is due and send full or expired
+   * batches. Call every loop().
+   */
+  void poll();
+
+  const RobotSetpoint &setpoint() const { return current; }
+  const RobotTelemetryConfig &telemetryConfig() const { return config; }
+  uint8_t telemetryBatchLimit() const { return batchLimit; }
+
+  void printTelemetryConfig(Print &out) const;
+
+  /**
+   * @brief Print the setpoint stream rate and losses over the last window of
+   * the given length, then reset the counters.
+   */
+  void printStreamReport(Print &out, float seconds);
+
+  /**
+   * @brief Print what telemetry cost over the last window, then reset it.
+   */
+  void printTelemetryReport(Print &out, float seconds);
+
+  SequenceTracker streamSeq;          // Received / lost / late frames.
+  uint32_t streamWrites;              // Writes (batches) received.
+  RobotTelemetryStats telemetryStats;
+
+private:
+  void onSetpoints(const uint8_t *data, size_t length);
+  void applySetpoint(const RobotSetpoint &sp);
+  void onTelemetryConfig(const uint8_t *data, size_t length);
+  void sampleTelemetry(RobotTelemetry &t);
+  void queueTelemetry(const RobotTelemetry &t);
+  void flushTelemetry();
+  void sendTelemetryFields(const RobotTelemetry &t);
+  void onTimeSync(uint32_t receivedUs, const uint8_t *data, size_t length);
+  void send(uint8_t channel, const uint8_t *data, size_t length);
+
+  RobotLinkTransport &link;
+  uint16_t pwmHz;
+  CommandHandler commandHandler;
+  SetpointHandler setpointHandler;
+  SampleHandler sampleHandler;
+  Clock clockUs;
+
+  RobotSetpoint current;         // Last setpoint applied.
+  unsigned long lastSetpointMs;  // 0 = no setpoint since connecting.
+  bool setpointLost;             // Frames went missing since the last sample.
+
+  RobotTelemetryConfig config;   // Off until the client writes one.
+  uint16_t telemetrySeq;
+  unsigned long lastSampleUs;
+  uint8_t batch[ROBOT_TELEMETRY_SIZE * ROBOT_TELEMETRY_MAX_BATCH];
+  uint8_t batchCount;            // Samples waiting in batch.
+  uint8_t batchLimit;            // Samples per notification for the MTU.
+  unsigned long batchStartMs;    // When the oldest waiting sample was taken.
+};
+
+#endif // ROBOT_SERVER_H